@@ -0,0 +1,1258 @@
+/**
+ * \file            calc.c
+ * \brief           This file contains the implementation of the calculator library: validation, compilation and evaluation
+ */
+
+/*
+ * Copyright (c) 2024 Daniil VERES
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * Author:          Daniil VERES <daniaveres@gmail.com>
+ * Version:         v1.0.0
+ */
+
+                    /* Functions used: */
+#include <ctype.h>  /* isalpha, isdigit */
+#include <math.h>   /* pow, fmod, floor, nan, fabs, isfinite */
+#include <stdatomic.h>  /* atomic_load_explicit */
+#include <stdint.h> /* int8_t, uint8_t, int16_t, int32_t */
+#include <stdio.h>  /* snprintf */
+#include <stdlib.h> /* malloc, realloc, calloc, free, strtod */
+#include <string.h> /* strlen, strstr, strpbrk, strcmp, memchr, memcpy */
+#include "calc_internal.h"
+
+                                        /* Constants used: */
+#define CALC_EVAL_STACK_NODES 128       /*!< Number of node values kept on the stack by \ref calc_eval before falling back to the heap */
+#define CALC_PARSE_MAX_DEPTH 1000       /*!< Deepest nesting of parentheses and calls, the parser recurses once per level */
+
+/**
+ * \brief           State of a single compilation, so that compilations never share anything
+ */
+typedef struct {
+    char* buffer;           /*!< A NUL-terminated copy of the source string */
+    char* str;              /*!< Current position in the buffer */
+    char token;             /*!< Current token */
+    calc_expr_t* expr;      /*!< The expression being built */
+    size_t depth;           /*!< Nesting of the expression being parsed */
+    size_t node_capacity;   /*!< Capacity of the node array */
+    size_t literal_capacity;    /*!< Capacity of the literal array */
+    calc_error_t error;     /*!< The first error met during the compilation */
+} calc_parser_t;
+
+/**
+ * \brief           Working memory of an evaluation, owned by one thread at a time
+ */
+struct calc_context {
+    double* values;         /*!< Values of the nodes of the expression being evaluated */
+    size_t capacity;        /*!< A number of values which fit into the memory */
+    uint8_t owns_values;    /*!< Set if the values have been allocated by the context */
+    calc_tape_entry_t* tape;    /*!< The tape of \ref calc_eval_gradient, one entry per node */
+    size_t tape_capacity;   /*!< A number of entries which fit into the tape */
+};
+
+static uint8_t validate(const char* str, size_t len, uint8_t imaginary);   /* A function used to check the input of the calculator */
+static uint8_t is_valid_input(const char* str, uint8_t imaginary);      /* A function used to check if the input is valid */
+static uint8_t is_valid_parenthesis(const char* str);   /* A function used to check if parentheses are valid */
+static uint8_t is_valid_point(const char* str);         /* A function used to check if decimal points are valid */
+static uint8_t is_valid_space(const char* str);         /* A function used to check if spaces are valid */
+static uint8_t has_random_letters(const char* str, uint8_t imaginary);  /* A function used to check if there are random letters in the input */
+
+static void get_token(calc_parser_t* parser);                                                   /* A function used to get a token from the input string */
+static void parse_error(calc_parser_t* parser, calc_error_code_t code);                         /* A function used to record the first compile error */
+static int32_t add_node(calc_parser_t* parser, calc_op_t op, int32_t a, int32_t b, double value); /* A function used to append a node to the expression */
+static int32_t add_power(calc_parser_t* parser, int32_t base, int32_t exponent);               /* A function used to append a power, specialized for a constant integer exponent */
+static void add_literal(calc_parser_t* parser, int32_t index, const char* begin, const char* end); /* A function used to keep the exact value of a literal */
+static int32_t add_call(calc_parser_t* parser, calc_function_id_t fn, int32_t a, int32_t b);  /* A function used to append a call of a math function */
+static int32_t add_variable(calc_parser_t* parser, const char* name, size_t length);            /* A function used to find or create a variable slot */
+
+static uint8_t context_reserve(calc_context_t* context, size_t count);                          /* A function used to grow the working memory of a context */
+static calc_error_code_t eval_nodes(const calc_expr_t* expr, const double* vars, double* values); /* A function used to calculate values of all nodes */
+static double eval_tree(const calc_expr_t* expr, int32_t index, const double* vars, const calc_function_t* functions, calc_error_code_t* code);  /* A function used to calculate a subtree recursively */
+
+                                                    /* A set of functions used to parse the input string */
+static int32_t factor(calc_parser_t* parser);       /* A function used to parse a factor (looking for a '(' to clarify the order and '-' to change sign) */
+static int32_t expression(calc_parser_t* parser);   /* A function used to parse an addition or a subtraction */
+static int32_t term(calc_parser_t* parser);         /* A function used to parse such terms as: '*', '/', ':', '%', '^' */
+static int32_t number(calc_parser_t* parser);       /* A function used to parse a numeric literal */
+static int32_t identifier(calc_parser_t* parser);   /* A function used to parse a function call or a variable */
+
+/**
+ * \brief           A function used to check if the input satisfies the rules of the interactive calculator
+ * \param[in]       str: A string to check, a trailing new line is optional
+ * \param[in]       len: Length of the string
+ * \return          1 if the input is valid, 0 otherwise
+ * \note            These rules are stricter than the grammar accepted by \ref calc_compile, e.g. variables are rejected
+ */
+uint8_t
+calc_validate(const char* str, size_t len) {
+    return validate(str, len, 0);
+}
+
+/**
+ * \brief           A function used to check if the input satisfies the rules of the interactive calculator in the complex mode
+ * \param[in]       str: A string to check, a trailing new line is optional
+ * \param[in]       len: Length of the string
+ * \return          1 if the input is valid, 0 otherwise
+ * \note            The rules of \ref calc_validate, except that the imaginary unit `i` is accepted
+ */
+uint8_t
+calc_validate_complex(const char* str, size_t len) {
+    return validate(str, len, 1);
+}
+
+/**
+ * \brief           A function used to check if the input satisfies the rules of the interactive calculator
+ * \param[in]       str: A string to check, a trailing new line is optional
+ * \param[in]       len: Length of the string
+ * \param[in]       imaginary: Set to `1` to accept the imaginary unit `i`
+ * \return          1 if the input is valid, 0 otherwise
+ */
+static uint8_t
+validate(const char* str, size_t len, uint8_t imaginary) {
+    uint8_t result;                                     /* A variable to store the result of the check */
+    char* input;                                        /* A new line terminated copy of the input */
+    if (len > 0 && memchr(str, '\0', len) != NULL) {   /* Check if the input contains a NUL byte */
+        return 0;                                       /* If so, it is invalid, the checks below stop at it */
+    }
+    input = (char*)malloc((len + 2) * sizeof(char));    /* Allocate memory for a new line terminated copy */
+    if (input == NULL) {                                /* Check if the memory has been allocated */
+        return 0;                                       /* An input that cannot be checked is not valid */
+    }
+    memcpy(input, str, len);                            /* Copy the input string */
+    if (len == 0 || input[len - 1] != '\n') {           /* Check if the new line is missing */
+        input[len++] = '\n';                            /* The checks below expect input as read by fgets */
+    }
+    input[len] = '\0';
+    result = is_valid_input(input, imaginary);          /* Check the input */
+    free(input);
+    input = NULL;
+    return result;
+}
+
+/**
+ * \brief           A function used to compile an expression into a form which can be evaluated many times
+ * \param[in]       str: A string to compile, it does not have to be NUL-terminated
+ * \param[in]       len: Length of the string
+ * \param[out]      error: An error report, may be NULL
+ * \return          A compiled expression to be released with \ref calc_free, NULL in case of an error
+ * \note            Letters which do not form a math function followed by '(' are treated as variables.
+ *                  Parentheses and calls nested deeper than \ref CALC_PARSE_MAX_DEPTH are invalid input
+ */
+calc_expr_t*
+calc_compile(const char* str, size_t len, calc_error_t* error) {
+    calc_parser_t parser = {0};     /* The state of this compilation */
+    int32_t root;                   /* An index of the root node */
+
+    parser.buffer = (char*)malloc((len + 1) * sizeof(char));
+    parser.expr = (calc_expr_t*)calloc(1, sizeof(calc_expr_t));
+    if (parser.buffer == NULL || parser.expr == NULL) {
+        parser.error.code = CALC_ERROR_FAILED_TO_ALLOCATE_MEMORY;
+    } else {
+        memcpy(parser.buffer, str, len);            /* Copy the source to make it NUL-terminated */
+        parser.buffer[len] = '\0';
+        parser.str = parser.buffer;
+        get_token(&parser);                         /* Get the first token */
+        root = expression(&parser);                 /* Parse the whole input */
+        if (root >= 0 && parser.token != '\0' && (parser.token != '\n' || *parser.str != '\0')) {    /* Check if something is left after the expression */
+            parse_error(&parser, CALC_ERROR_INVALID_INPUT);
+        }
+    }
+    free(parser.buffer);
+    parser.buffer = NULL;
+    if (parser.error.code != CALC_OK) {             /* Check if the compilation failed */
+        calc_free(parser.expr);
+        parser.expr = NULL;
+    }
+    if (error != NULL) {
+        *error = parser.error;
+    }
+    return parser.expr;
+}
+
+/**
+ * \brief           A function used to evaluate a compiled expression
+ * \param[in]       expr: A compiled expression
+ * \param[in]       vars: Values of the variables indexed by slot (see \ref calc_var_name), may be NULL if there are none
+ * \param[out]      error: An error report, may be NULL
+ * \return          The result of the calculation, NaN in case of an error
+ * \note            All the state of the evaluation lives on the stack of the caller, so the function can be called concurrently on the same handle
+ */
+double
+calc_eval(const calc_expr_t* expr, const double* vars, calc_error_t* error) {
+    double stack_values[CALC_EVAL_STACK_NODES];     /* Values of the nodes for small expressions */
+    calc_context_t context = {0};                   /* A context living for this call only */
+    double result;                                  /* A variable to store the result */
+    context.values = stack_values;
+    context.capacity = CALC_EVAL_STACK_NODES;
+    result = calc_eval_ctx(&context, expr, vars, error);
+    if (context.values != stack_values) {           /* Check if the context has grown to the heap */
+        free(context.values);
+        context.values = NULL;
+    }
+    return result;
+}
+
+/**
+ * \brief           A function used to create an evaluation context
+ * \return          A new context to be released with \ref calc_context_free, NULL if the memory has not been allocated
+ * \note            A context keeps the working memory of \ref calc_eval_ctx between the calls, one context must not be used by several threads at once
+ */
+calc_context_t*
+calc_context_create(void) {
+    return (calc_context_t*)calloc(1, sizeof(calc_context_t));
+}
+
+/**
+ * \brief           A function used to free an evaluation context
+ * \param[in]       context: A context, may be NULL
+ */
+void
+calc_context_free(calc_context_t* context) {
+    if (context == NULL) {
+        return;
+    }
+    free(context->values);
+    free(context->tape);
+    free(context);
+}
+
+/**
+ * \brief           A function used to evaluate a compiled expression using the memory of a context
+ * \param[in]       context: An evaluation context owned by the calling thread
+ * \param[in]       expr: A compiled expression
+ * \param[in]       vars: Values of the variables indexed by slot (see \ref calc_var_name), may be NULL if there are none
+ * \param[out]      error: An error report, may be NULL
+ * \return          The result of the calculation, NaN in case of an error
+ * \note            Once the context has grown to the size of the expression, the evaluation does not allocate memory
+ */
+double
+calc_eval_ctx(calc_context_t* context, const calc_expr_t* expr, const double* vars, calc_error_t* error) {
+    calc_error_code_t code = CALC_OK;               /* An error code of the evaluation */
+    double result = nan("");                        /* A variable to store the result */
+
+    if (context == NULL || expr == NULL || expr->node_count == 0) {
+        code = CALC_ERROR_UNKNOWN;
+    } else if (expr->var_count > 0 && vars == NULL) {
+        code = CALC_ERROR_INVALID_INPUT;
+    } else if (!context_reserve(context, expr->node_count)) {
+        code = CALC_ERROR_FAILED_TO_ALLOCATE_MEMORY;
+    } else {
+        code = eval_nodes(expr, vars, context->values);
+        if (code == CALC_OK) {
+            result = context->values[expr->node_count - 1]; /* The last node is the root */
+        }
+    }
+    if (error != NULL) {
+        error->code = code;
+        error->position = 0;
+    }
+    return result;
+}
+
+/**
+ * \brief           A function used to evaluate a compiled expression with a chosen engine
+ * \param[in]       context: An evaluation context, used by the engines which need working memory
+ * \param[in]       expr: A compiled expression
+ * \param[in]       vars: Values of the variables, may be NULL if there are none
+ * \param[in]       engine: The engine
+ * \param[out]      error: An error report, may be NULL
+ * \return          The result of the calculation, NaN in case of an error
+ * \note            All engines give the same results and errors, they are kept side by side to be checked against each other
+ */
+double
+calc_eval_engine(calc_context_t* context, const calc_expr_t* expr, const double* vars, calc_engine_t engine, calc_error_t* error) {
+    calc_error_code_t code = CALC_OK;
+    double result = nan("");
+    if (engine == CALC_ENGINE_LINEAR) {
+        return calc_eval_ctx(context, expr, vars, error);
+    }
+    if (expr == NULL || expr->node_count == 0 || engine >= CALC_ENGINE_COUNT) {
+        code = CALC_ERROR_UNKNOWN;
+    } else if (expr->var_count > 0 && vars == NULL) {
+        code = CALC_ERROR_INVALID_INPUT;
+    } else {
+        const calc_function_t* functions = atomic_load_explicit(&calc_dispatch, memory_order_acquire);
+        result = eval_tree(expr, (int32_t)expr->node_count - 1, vars, functions, &code);
+        if (code != CALC_OK) {
+            result = nan("");
+        }
+    }
+    if (error != NULL) {
+        error->code = code;
+        error->position = 0;
+    }
+    return result;
+}
+
+/**
+ * \brief           A function used to get the name of an engine
+ * \param[in]       engine: The engine
+ * \return          The name, "unknown" for a value out of range
+ */
+const char*
+calc_engine_name(calc_engine_t engine) {
+    switch (engine) {
+        case CALC_ENGINE_LINEAR:
+            return "linear";
+        case CALC_ENGINE_RECURSIVE:
+            return "recursive";
+        default:
+            return "unknown";
+    }
+}
+
+/**
+ * \brief           A function used to free a compiled expression
+ * \param[in]       expr: A compiled expression, may be NULL
+ */
+void
+calc_free(calc_expr_t* expr) {
+    if (expr == NULL) {
+        return;
+    }
+    for (size_t i = 0; i < expr->var_count; ++i) {  /* Loop through all variable names */
+        free(expr->var_names[i]);
+    }
+    free(expr->var_names);
+    free(expr->nodes);
+    for (size_t i = 0; i < expr->literal_count; ++i) {  /* Loop through all literals */
+        free(expr->literals[i].digits);
+    }
+    free(expr->literals);
+    free(expr);
+}
+
+/**
+ * \brief           A function used to get a number of variables of a compiled expression
+ * \param[in]       expr: A compiled expression
+ * \return          A number of variables, the length of the array expected by \ref calc_eval
+ */
+size_t
+calc_var_count(const calc_expr_t* expr) {
+    return expr != NULL ? expr->var_count : 0;
+}
+
+/**
+ * \brief           A function used to get a name of a variable
+ * \param[in]       expr: A compiled expression
+ * \param[in]       index: A variable slot
+ * \return          The name of the variable, NULL if the slot does not exist
+ */
+const char*
+calc_var_name(const calc_expr_t* expr, size_t index) {
+    return expr != NULL && index < expr->var_count ? expr->var_names[index] : NULL;
+}
+
+/**
+ * \brief           A function used to format a result the way the calculator prints it
+ * \param[in]       value: A result
+ * \param[out]      buffer: A buffer for the text
+ * \param[in]       size: Size of the buffer
+ * \return          Length of the text, as returned by snprintf
+ * \note            A number without a fractional part is printed without it, otherwise 10 digits after the point are printed
+ */
+int
+calc_format(double value, char* buffer, size_t size) {
+    if (value == floor(value)) {                        /* Check if there is no fractional part */
+        return snprintf(buffer, size, "%.0lf", value);  /* Print the result without the fractional part */
+    } else {                                            /* Else if there is a fractional part */
+        return snprintf(buffer, size, "%.10lf", value); /* Print the result with the fractional part */
+    }
+}
+
+/**
+ * \brief           A function used to get a description of an error code
+ * \param[in]       code: An error code
+ * \return          A static string describing the error
+ */
+const char*
+calc_error_string(calc_error_code_t code) {
+    switch (code) {
+        case CALC_OK:
+            return "no error";
+        case CALC_ERROR_FAILED_TO_ALLOCATE_MEMORY:
+            return "failed to allocate memory";
+        case CALC_ERROR_INVALID_INPUT:
+            return "invalid input";
+        case CALC_ERROR_UNDEFINED_FUNCTION:
+            return "undefined math function";
+        case CALC_ERROR_NOT_CONVERGED:
+            return "not converged";
+        case CALC_ERROR_UNKNOWN:
+        default:
+            return "unknown error";
+    }
+}
+
+/**
+ * \brief           A function used to make sure a context can hold values of all nodes of an expression
+ * \param[in]       context: An evaluation context
+ * \param[in]       count: A number of nodes
+ * \return          1 on success, 0 if the memory has not been allocated
+ */
+static uint8_t
+context_reserve(calc_context_t* context, size_t count) {
+    double* values;
+    if (count <= context->capacity) {               /* Check if the context is already big enough */
+        return 1;
+    }
+    values = (double*)malloc(count * sizeof(double));
+    if (values == NULL) {                           /* Check if the memory has been allocated */
+        return 0;
+    }
+    if (context->owns_values) {                     /* Memory borrowed from the stack of calc_eval is never freed here */
+        free(context->values);
+    }
+    context->values = values;
+    context->capacity = count;
+    context->owns_values = 1;
+    return 1;
+}
+
+/**
+ * \brief           A function used to make sure a context can hold the values and the tape of a reverse-mode evaluation
+ * \param[in]       context: An evaluation context
+ * \param[in]       count: A number of nodes
+ * \param[out]      values: Memory for the values of the nodes, which the backward sweep reuses for the adjoints
+ * \param[out]      tape: Memory for the tape, one entry per node
+ * \return          1 on success, 0 if the memory has not been allocated
+ * \note            Both arrays are kept by the context, so once it has grown to the size of the expression
+ *                  the evaluation does not allocate memory
+ */
+uint8_t
+calc_context_reserve_tape(calc_context_t* context, size_t count, double** values, calc_tape_entry_t** tape) {
+    if (!context_reserve(context, count)) {
+        return 0;
+    }
+    if (count > context->tape_capacity) {           /* Check if the tape is already big enough */
+        calc_tape_entry_t* entries = (calc_tape_entry_t*)malloc(count * sizeof(calc_tape_entry_t));
+        if (entries == NULL) {                      /* Check if the memory has been allocated */
+            return 0;
+        }
+        free(context->tape);
+        context->tape = entries;
+        context->tape_capacity = count;
+    }
+    *values = context->values;
+    *tape = context->tape;
+    return 1;
+}
+
+/**
+ * \brief           A function used to multiply two numbers exactly
+ * \param[in]       a: The first number
+ * \param[in]       b: The second number
+ * \param[out]      error: The rounding error, so that a * b == result + error exactly
+ * \return          The rounded product
+ * \note            Uses a fused multiply-add when the hardware has one, Dekker's splitting otherwise
+ */
+static inline double
+two_product(double a, double b, double* error) {
+    double p = a * b;
+#ifdef FP_FAST_FMA
+    *error = fma(a, b, -p);
+#else
+    const double split = 134217729.0;           /* 2^27 + 1 */
+    double ta = split * a, tb = split * b;
+    double ah = ta - (ta - a), al = a - ah;
+    double bh = tb - (tb - b), bl = b - bh;
+    *error = ((ah * bh - p) + ah * bl + al * bh) + al * bl;
+#endif /* FP_FAST_FMA */
+    return p;
+}
+
+/**
+ * \brief           A function used to raise a number to an integer power by squaring
+ * \param[in]       x: The base
+ * \param[in]       n: The exponent, at most \ref CALC_POWI_MAX in absolute value
+ * \return          x raised to the power n
+ * \note            The products are kept as unevaluated sums of two doubles, so the result is as accurate as pow:
+ *                  within one rounding of the exact power. Overflows, underflows and non-finite bases are left to pow.
+ */
+static double
+powi(double x, int32_t n) {
+    uint32_t m = (uint32_t)(n < 0 ? -n : n);
+    double hi = 1, lo = 0;                      /* The result so far, hi + lo */
+    double base_hi = x, base_lo = 0;            /* x raised to the power of the current bit, base_hi + base_lo */
+    double e, result;
+    for (;;) {
+        if (m & 1) {                            /* Multiply the result by the base */
+            double p = two_product(hi, base_hi, &e);
+            e += hi * base_lo + lo * base_hi;
+            hi = p + e;
+            lo = e - (hi - p);
+        }
+        m >>= 1;
+        if (m == 0) {
+            break;
+        }
+        {                                       /* Square the base */
+            double p = two_product(base_hi, base_hi, &e);
+            e += 2 * base_hi * base_lo;
+            base_hi = p + e;
+            base_lo = e - (base_hi - p);
+        }
+    }
+    if (!isfinite(hi) || fabs(hi) < 0x1p-969) { /* The error terms would be inexact, e.g. subnormal */
+        return pow(x, n);
+    }
+    if (n >= 0) {
+        return hi + lo;
+    }
+    result = 1 / hi;                            /* Correct the reciprocal by its residual 1 - result * (hi + lo) */
+    {
+        double p = two_product(result, hi, &e);
+        result += result * (((1 - p) - e) - result * lo);
+    }
+    return isfinite(result) && fabs(result) >= 0x1p-969 ? result : pow(x, n);
+}
+
+/**
+ * \brief           A function used to calculate the value of a node from the values of its operands
+ * \param[in]       node: The node
+ * \param[in]       x: Value of the first operand
+ * \param[in]       y: Value of the second operand
+ * \param[in]       vars: Values of the variables
+ * \param[in]       functions: The registry to dispatch calls through
+ * \param[out]      code: Set to an error code if the operation fails
+ * \return          The value of the node
+ * \note            Every engine calculates nodes with this function, so they can only differ in the order and the storage of the values
+ */
+static inline double
+apply_node(const calc_node_t* node, double x, double y, const double* vars, const calc_function_t* functions, calc_error_code_t* code) {
+    switch (node->op) {                                                 /* Calculate the value based on the operation */
+        case CALC_OP_CONST:
+            return node->value;
+        case CALC_OP_VAR:
+            return vars[node->a];
+        case CALC_OP_NEG:
+            return -x;
+        case CALC_OP_ADD:
+            return x + y;
+        case CALC_OP_SUB:
+            return x - y;
+        case CALC_OP_MUL:
+            return x * y;
+        case CALC_OP_DIV:
+            return x / y;
+        case CALC_OP_MOD:
+            return fmod(x, y);
+        case CALC_OP_POW:
+            if (fabs(y) <= CALC_POWI_MAX && y == (int32_t)y) {          /* An integer exponent known only at run time */
+                return powi(x, (int32_t)y);
+            }
+            return pow(x, y);
+        case CALC_OP_POWI:
+            switch ((int32_t)node->value) {                             /* The exponent is fixed at compile time */
+                case 0:
+                    return 1;
+                case 1:
+                    return x;
+                case 2:
+                    return x * x;                                       /* A single rounding, like pow */
+                case -1:
+                    return 1 / x;
+                default:
+                    return powi(x, (int32_t)node->value);
+            }
+        case CALC_OP_CALL: {
+            const calc_function_t* function = &functions[node->fn];
+            double args[2] = {x, y};                                    /* Arguments of the call */
+            if (calc_domain_contains(function->domain, args)) {
+                return function->impl(args);                            /* Dispatch through the registry */
+            }
+            *code = CALC_ERROR_UNDEFINED_FUNCTION;
+            return 0;
+        }
+        case CALC_OP_GUARD:
+            return x;
+        default:
+            *code = CALC_ERROR_UNKNOWN;
+            return 0;
+    }
+}
+
+/**
+ * \brief           A function used to calculate values of all nodes of an expression
+ * \param[in]       expr: A compiled expression
+ * \param[in]       vars: Values of the variables
+ * \param[out]      values: Values of the nodes, at least as many as nodes in the expression
+ * \return          \ref CALC_OK on success, an error code of the first failed operation otherwise
+ */
+static calc_error_code_t
+eval_nodes(const calc_expr_t* expr, const double* vars, double* values) {
+    calc_error_code_t code = CALC_OK;               /* An error code of the evaluation */
+    const calc_function_t* functions = atomic_load_explicit(&calc_dispatch, memory_order_acquire);   /* The registry, read once per evaluation */
+    for (size_t i = 0; code == CALC_OK && i < expr->node_count; ++i) {    /* Loop through all nodes in postfix order */
+        const calc_node_t* node = &expr->nodes[i];
+        double x = 0, y = 0;                                            /* Values of the operands */
+        if (node->op > CALC_OP_VAR) {
+            x = values[node->a];
+            if (node->b >= 0) {
+                y = values[node->b];
+            }
+        }
+        values[i] = apply_node(node, x, y, vars, functions, &code);
+    }
+    return code;
+}
+
+/**
+ * \brief           A function used to calculate the value of a subtree by walking it from its root
+ * \param[in]       expr: A compiled expression
+ * \param[in]       index: An index of the root node of the subtree
+ * \param[in]       vars: Values of the variables
+ * \param[in]       functions: The registry to dispatch calls through
+ * \param[out]      code: Set to an error code of the first failed operation
+ * \return          The value of the subtree
+ * \note            The operands are calculated first to last, so the first error is the same as of the linear pass
+ */
+static double
+eval_tree(const calc_expr_t* expr, int32_t index, const double* vars, const calc_function_t* functions, calc_error_code_t* code) {
+    const calc_node_t* node = &expr->nodes[index];
+    double x = 0, y = 0;                            /* Values of the operands */
+    if (node->op > CALC_OP_VAR) {
+        x = eval_tree(expr, node->a, vars, functions, code);
+        if (*code == CALC_OK && node->b >= 0) {
+            y = eval_tree(expr, node->b, vars, functions, code);
+        }
+        if (*code != CALC_OK) {
+            return 0;
+        }
+    }
+    return apply_node(node, x, y, vars, functions, code);
+}
+
+/**
+ * \brief           A function used to calculate the value of a node from the values of its operands in double precision
+ * \param[in]       node: The node
+ * \param[in]       x: Value of the first operand
+ * \param[in]       y: Value of the second operand
+ * \param[in]       vars: Values of the variables
+ * \param[in]       functions: The registry to dispatch calls through
+ * \param[out]      code: Set to an error code if the operation fails
+ * \return          The value of the node
+ * \note            The evaluators of the other numeric types fall back to it for the nodes they cannot calculate
+ */
+double
+calc_apply_node(const calc_node_t* node, double x, double y, const double* vars, const calc_function_t* functions, calc_error_code_t* code) {
+    return apply_node(node, x, y, vars, functions, code);
+}
+
+/**
+ * \brief           A function used to check if the input is valid
+ * \param[in]       str: A new line terminated string to check
+ * \param[in]       imaginary: Set to `1` to accept the imaginary unit `i`
+ * \return          1 if the input is valid, 0 otherwise
+ */
+static uint8_t
+is_valid_input(const char* str, uint8_t imaginary) {
+    size_t length;          /* A variable to store the length of the input string */
+    const char* digits = imaginary ? "0123456789i" : "0123456789";  /* The imaginary unit counts as a number */
+    length = strlen(str);   /* Get the length of the input string */
+    if (length < 2) {       /* Check if the input is too short to end with a character before the new line */
+        return str[0] == '\n'; /* Only an empty line can be considered as valid */
+    } else if (str[0] == '\n') {   /* Check if the input is empty */
+        return 1;           /* If so, it can be considered as valid */
+    } else if (str[0] == ' ') { /* Check if the input starts with a space */
+        return 0;               /* If so, it is invalid */
+    } else if (str[0] == '.' || str[0] == '*' || str[0] == '/' || str[0] == ':' || str[0] == '%' || str[0] == '^' || str[0] == ')'
+            || str[length - 2] == '.' || str[length - 2] == '+' || str[length - 2] == '*' || str[length - 2] == '/'
+            || str[length - 2] == ':' || str[length - 2] == '%' || str[length - 2] == '^' || str[length - 2] == '(') {  /* Check if the input starts or ends with an operator */
+        return 0;                                                                                                       /* If so, it is invalid */
+    } else if (strpbrk(str, "!\"#$%&'`~\\|<>?_@;=[]{}\t\v\f\r") != NULL) {  /* Check if the input contains invalid characters */
+        return 0;                                                           /* If so, it is invalid */
+    } else if (strpbrk(str, digits) != NULL && strpbrk(str, "+-*/:%^") == NULL && strpbrk(str, "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ") == NULL) {       /* Check if the input contains only numbers */
+        return 0;                                                                                                                                                       /* If so, it is invalid */
+    } else if (strpbrk(str, "+-*/:%^") != NULL && strpbrk(str, digits) == NULL) {       /* Check if the input contains only operators */
+        return 0;                                                                       /* If so, it is invalid */
+    } else if (strpbrk(str, "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ") != NULL && strpbrk(str, digits) == NULL) {          /* Check if the input contains only letters */
+        return 0;                                                                                                                       /* If so, it is invalid */
+    } else if (strpbrk(str, "()") != NULL && strpbrk(str, digits) == NULL && strpbrk(str, "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ") == NULL) {        /* Check if the input contains only parentheses */
+        return 0;                                                                                                                                                   /* If so, it is invalid */
+    } else if (strstr(str, "..") != NULL || strstr(str, ".+") != NULL || strstr(str, ".-") != NULL || strstr(str, ".*") != NULL || strstr(str, "./") != NULL
+            || strstr(str, ".:") != NULL || strstr(str, ".%") != NULL || strstr(str, ".^") != NULL || strstr(str, ".(") != NULL || strstr(str, ".)") != NULL
+            || strstr(str, ".,") != NULL || strstr(str, ". ") != NULL || strstr(str, "+.") != NULL || strstr(str, "+*") != NULL || strstr(str, "+/") != NULL
+            || strstr(str, "+:") != NULL || strstr(str, "+%") != NULL || strstr(str, "+^") != NULL || strstr(str, "+)") != NULL || strstr(str, "+,") != NULL
+            || strstr(str, "-.") != NULL || strstr(str, "-*") != NULL || strstr(str, "-/") != NULL || strstr(str, "-:") != NULL || strstr(str, "-%") != NULL
+            || strstr(str, "-^") != NULL || strstr(str, "-)") != NULL || strstr(str, "-,") != NULL || strstr(str, "*.") != NULL || strstr(str, "*+") != NULL
+            || strstr(str, "*/") != NULL || strstr(str, "*:") != NULL || strstr(str, "*%") != NULL || strstr(str, "*^") != NULL || strstr(str, "*)") != NULL
+            || strstr(str, "*,") != NULL || strstr(str, "/.") != NULL || strstr(str, "/+") != NULL || strstr(str, "/*") != NULL || strstr(str, "/:") != NULL
+            || strstr(str, "/%") != NULL || strstr(str, "/^") != NULL || strstr(str, "/)") != NULL || strstr(str, "/,") != NULL || strstr(str, ":.") != NULL
+            || strstr(str, ":+") != NULL || strstr(str, ":*") != NULL || strstr(str, ":/") != NULL || strstr(str, ":%") != NULL || strstr(str, ":^") != NULL
+            || strstr(str, ":)") != NULL || strstr(str, ":,") != NULL || strstr(str, "%.") != NULL || strstr(str, "%+") != NULL || strstr(str, "%-") != NULL
+            || strstr(str, "%*") != NULL || strstr(str, "%/") != NULL || strstr(str, "%:") != NULL || strstr(str, "%^") != NULL || strstr(str, "%)") != NULL
+            || strstr(str, "%,") != NULL || strstr(str, "^.") != NULL || strstr(str, "^+") != NULL || strstr(str, "^-") != NULL || strstr(str, "^*") != NULL
+            || strstr(str, "^/") != NULL || strstr(str, "^:") != NULL || strstr(str, "^%") != NULL || strstr(str, "^)") != NULL || strstr(str, "^,") != NULL
+            || strstr(str, "(.") != NULL || strstr(str, "(+") != NULL || strstr(str, "(*") != NULL || strstr(str, "(/") != NULL || strstr(str, "(:") != NULL
+            || strstr(str, "(%") != NULL || strstr(str, "(^") != NULL || strstr(str, "(,") != NULL || strstr(str, "()") != NULL || strstr(str, "  ") != NULL) { /* Check if the input contains invalid combinations of characters */
+        return 0;                                                                                                                                               /* If so, it is invalid */
+    } else if (!is_valid_parenthesis(str)) {    /* Check if parentheses are valid */
+        return 0;                               /* If not, the input is invalid */
+    } else if (!is_valid_point(str)) {          /* Check if decimal points are valid */
+        return 0;                               /* If not, the input is invalid */
+    } else if (!is_valid_space(str)) {          /* Check if spaces are valid */
+        return 0;                               /* If not, the input is invalid */
+    } else if (has_random_letters(str, imaginary)) {    /* Check if there are random letters in the input */
+        return 0;                               /* If so, the input is invalid */
+    } else {                                    /* Else if the input is valid */
+        return 1;                               /* Return 1 as sign of valid input */
+    }
+}
+
+/**
+ * \brief           A function used to check if parentheses are valid
+ * \param[in]       str: A string to check
+ * \return          1 if parentheses are valid, 0 otherwise
+ */
+static uint8_t
+is_valid_parenthesis(const char* str) {
+    size_t length, top = -1;    /* A variable to store the length of the input string and a variable to store the top of the stack */
+    length = strlen(str);       /* Get the length of the input string */
+    char* stack = (char*)malloc(length * sizeof(char));                     /* Allocate memory for a stack */
+    if (stack == NULL) {                                                    /* Check if the memory has been allocated */
+        return 0;                                                           /* Parentheses which cannot be checked are not valid */
+    }
+    for (size_t i = 0; i < length; ++i) {   /* Loop through all characters in the input string */
+        if (str[i] == '(') {                /* If the character is a left parenthesis */
+            if (i > 0 && isdigit((unsigned char)str[i - 1]) && isdigit((unsigned char)str[i + 1])) {   /* Check if the previous and the next characters are digits */
+                free(stack);
+                stack = NULL;
+                return 0;                                       /* If so, parentheses are invalid */
+            }
+            stack[++top] = str[i];          /* Push the character to the stack */
+        } else if (str[i] == ')') {         /* Else if the character is a right parenthesis */
+            if (top == (size_t)-1) {        /* Check if the stack is empty */
+                free(stack);
+                stack = NULL;
+                return 0;                   /* If so, parentheses are invalid */
+            }
+            char last = stack[top];         /* Get the last character from the stack */
+            --top;                          /* Decrement the top of the stack */
+            if (last != '(') {              /* Check if the last character from the stack is not a left parenthesis */
+                free(stack);
+                stack = NULL;
+                return 0;                   /* If so, parentheses are invalid */
+            }
+        }
+    }
+    if (top != (size_t)-1) {    /* Check if the stack is not empty */
+        free(stack);
+        stack = NULL;
+        return 0;       /* If so, parentheses are invalid */
+    } else {            /* Else if the stack is empty */
+        free(stack);
+        stack = NULL;
+        return 1;       /* Then parentheses are valid or absent */
+    }
+}
+
+/**
+ * \brief           A function used to check if decimal points are valid
+ * \param[in]       str: A string to check
+ * \return          1 if decimal points are valid, 0 otherwise
+ */
+static uint8_t
+is_valid_point(const char* str) {
+    size_t length;              /* A variable to store the length of the input string */
+    uint8_t active_point = 0;   /* A variable to store if a decimal point is active */
+    length = strlen(str);       /* Get the length of the input string */
+    for (size_t i = 1; i < length; ++i) {                       /* Loop through all characters in the input string */
+        if (str[i] == '.' && active_point) {                    /* If the character is a decimal point and a decimal point is active */
+            return 0;                                           /* Then it is not valid */
+        } else if (str[i] == '.' && !active_point) {            /* Else if the character is a decimal point and a decimal point is not active */
+            if (!isdigit((unsigned char)str[i - 1]) || !isdigit((unsigned char)str[i + 1])) { /* Check if the previous and the next characters are not digits */
+                return 0;                                       /* Then it is not valid */
+            } else {                                            /* Else if the previous and the next characters are digits */
+                active_point = 1;                               /* Set the decimal point active */
+            }
+        } else if (str[i] == '+' || str[i] == '-' || str[i] == '*' || str[i] == '/' || str[i] == ':' || str[i] == '%' || str[i] == '^') {   /* Else if the character is an operator */
+            active_point = 0;                                                                                                               /* Set the decimal point inactive */
+        }
+    }
+    return 1; /* If no errors were found during the check before that, then all the points are correct or absent */
+}
+
+/**
+ * \brief           A function used to check if spaces are valid
+ * \param[in]       str: A string to check
+ * \return          1 if spaces are valid, 0 otherwise
+ */
+static uint8_t
+is_valid_space(const char* str) {
+    size_t length;          /* A variable to store the length of the input string */
+    length = strlen(str);   /* Get the length of the input string */
+    for (size_t i = 1; i < length; ++i) {                                   /* Loop through all characters in the input string */
+        if (str[i] == ' ' && isdigit((unsigned char)str[i - 1]) && isdigit((unsigned char)str[i + 1])) {  /* If the character is a space and the previous and the next characters are digits */
+            return 0;                                                       /* Then it is not valid */
+        }
+    }
+    return 1;                                                               /* Otherwise it is valid */
+}
+
+/**
+ * \brief           A function used to check if there are random letters in the input
+ * \param[in]       str: A string to check
+ * \param[in]       imaginary: Set to `1` to accept the imaginary unit `i`
+ * \return          1 if there are random letters in the input, 0 otherwise
+ */
+static uint8_t
+has_random_letters(const char* str, uint8_t imaginary) {
+    size_t length, sub_string_length = -1;            /* A variable to store the length of the input string and a variable to store the length of a substring */
+    uint8_t is_valid_function, has_been_compared = 0; /* A variable to store if a function is valid and a variable to store if a function has been compared */
+    length = strlen(str);  /* Get the length of the input string */
+    char* sub_string = (char*)malloc((length + 1) * sizeof(char));          /* Allocate memory for a substring */
+    if (sub_string == NULL) {                                               /* Check if the memory has been allocated */
+        return 1;                                                           /* Letters which cannot be checked are considered random */
+    }
+    sub_string[0] = '\0';
+    for (size_t i = 0; i < length; ++i) {                           /* Loop through all characters in the input string */
+        if (isalpha((unsigned char)str[i])) {                       /* If the character is a letter */
+            sub_string[++sub_string_length] = str[i];               /* Add the character to the substring */
+            has_been_compared = 0;                                  /* Set the variable to store if a function has been compared to 0 */
+        } else if (!has_been_compared && *sub_string != '\0') {     /* Else if the character is not a letter and a function has not been compared and the substring is not empty */
+            sub_string[++sub_string_length] = '\0';                 /* Add the null terminator to the end of substring */
+            is_valid_function = 0;                                  /* Set the variable to store if a function is valid to 0 */
+            is_valid_function = calc_function_index(sub_string, (size_t)sub_string_length) >= 0; /* Look the name up in the function registry */
+            if (imaginary && strcmp(sub_string, "i") == 0 && str[i] != '(') {  /* If the letter is the imaginary unit */
+                has_been_compared = 1;
+                sub_string_length = -1;
+            } else if (!is_valid_function || str[i] != '(') {       /* If the function is not valid or the next character is not a left parenthesis */
+                free(sub_string);
+                sub_string = NULL;
+                return 1;                                           /* Then there are random letters in the input */
+            } else {                                                /* Else if the function is valid and the next character is a left parenthesis */
+                has_been_compared = 1;                              /* Set the variable to store if a function has been compared to 1 */
+                sub_string_length = -1;                             /* Set the length of the substring to -1 */
+            }
+        }
+    }
+    free(sub_string);
+    sub_string = NULL;
+    return 0;  /* If no errors were found during the check before that, then there are no random letters in the input */
+}
+
+/**
+ * \brief           Retrieves the next token from a string
+ * \param[in]       parser: The state of the compilation
+ * \note            The function skips all spaces and retrieves the next token from the input string
+ */
+static void
+get_token(calc_parser_t* parser) {
+    while (*parser->str == ' ') {       /* While a current pointer is space */
+        ++parser->str;                  /* Increment the pointer */
+    }
+    parser->token = *parser->str;       /* Get the current character */
+    if (*parser->str != '\0') {         /* Never step over the end of the string */
+        ++parser->str;                  /* Increment the pointer */
+    }
+}
+
+/**
+ * \brief           A function used to record a compile error at the current token
+ * \param[in]       parser: The state of the compilation
+ * \param[in]       code: An error code
+ * \note            Only the first error is kept, as it is the one closest to the cause
+ */
+static void
+parse_error(calc_parser_t* parser, calc_error_code_t code) {
+    if (parser->error.code == CALC_OK) {
+        parser->error.code = code;
+        parser->error.position = (size_t)(parser->str - parser->buffer);
+        if (parser->token != '\0' && parser->error.position > 0) {
+            --parser->error.position;   /* The pointer is already past the current token */
+        }
+    }
+}
+
+/**
+ * \brief           A function used to append a node to the expression
+ * \param[in]       parser: The state of the compilation
+ * \param[in]       op: An operation
+ * \param[in]       a: An index of the first operand or a variable slot
+ * \param[in]       b: An index of the second operand, -1 if there is none
+ * \param[in]       value: A value of a constant
+ * \return          An index of the new node, -1 in case of an error
+ */
+static int32_t
+add_node(calc_parser_t* parser, calc_op_t op, int32_t a, int32_t b, double value) {
+    calc_expr_t* expr = parser->expr;
+    if (expr->node_count == parser->node_capacity) {                /* Check if the node array is full */
+        size_t capacity = parser->node_capacity > 0 ? parser->node_capacity * 2 : 16;
+        calc_node_t* nodes = (calc_node_t*)realloc(expr->nodes, capacity * sizeof(calc_node_t));
+        if (nodes == NULL || capacity > INT32_MAX) {                /* Check if the memory has been allocated */
+            parse_error(parser, CALC_ERROR_FAILED_TO_ALLOCATE_MEMORY);
+            if (nodes != NULL) {
+                expr->nodes = nodes;
+            }
+            return -1;
+        }
+        expr->nodes = nodes;
+        parser->node_capacity = capacity;
+    }
+    expr->nodes[expr->node_count].op = (uint8_t)op;
+    expr->nodes[expr->node_count].fn = 0;
+    expr->nodes[expr->node_count].exact = op == CALC_OP_VAR
+        || (op > CALC_OP_VAR && expr->nodes[a].exact && (b < 0 || expr->nodes[b].exact));   /* Integer operands, checked at run time for variables */
+    expr->has_exact |= op > CALC_OP_VAR && expr->nodes[expr->node_count].exact;
+    expr->nodes[expr->node_count].a = a;
+    expr->nodes[expr->node_count].b = b;
+    expr->nodes[expr->node_count].value = value;
+    return (int32_t)expr->node_count++;
+}
+
+/**
+ * \brief           A function used to append a call of a math function to the expression
+ * \param[in]       parser: The state of the compilation
+ * \param[in]       fn: The function
+ * \param[in]       a: An index of the first argument
+ * \param[in]       b: An index of the second argument, -1 if there is none
+ * \return          An index of the new node, -1 in case of an error
+ */
+static int32_t
+add_call(calc_parser_t* parser, calc_function_id_t fn, int32_t a, int32_t b) {
+    int32_t index = add_node(parser, CALC_OP_CALL, a, b, 0);
+    if (index >= 0) {
+        parser->expr->nodes[index].fn = (uint8_t)fn;
+        parser->expr->nodes[index].exact &= calc_exact_function(fn);
+    }
+    return index;
+}
+
+/**
+ * \brief           A function used to append a power, specialized for a constant integer exponent
+ * \param[in]       parser: The state of the compilation
+ * \param[in]       base: An index of the base
+ * \param[in]       exponent: An index of the exponent, the last node of the expression
+ * \return          An index of the new node, -1 in case of an error
+ * \note            A constant exponent, possibly negated, up to \ref CALC_POWI_MAX in absolute value is folded into the node,
+ *                  so e.g. `x^2` is a single multiplication and `x^-1` a single division
+ */
+static int32_t
+add_power(calc_parser_t* parser, int32_t base, int32_t exponent) {
+    calc_expr_t* expr = parser->expr;
+    const calc_node_t* node = &expr->nodes[exponent];
+    size_t nodes = 1;                               /* Nodes of the exponent */
+    int32_t index;
+    double value;
+    if (node->op == CALC_OP_NEG && expr->nodes[node->a].op == CALC_OP_CONST) {
+        value = -expr->nodes[node->a].value;
+        nodes = 2;
+    } else if (node->op == CALC_OP_CONST) {
+        value = node->value;
+    } else {
+        return add_node(parser, CALC_OP_POW, base, exponent, 0);
+    }
+    if (fabs(value) > CALC_POWI_MAX || value != (int32_t)value) {
+        return add_node(parser, CALC_OP_POW, base, exponent, 0);
+    }
+    free(expr->literals[--expr->literal_count].digits); /* The literal of the exponent is the last one */
+    expr->node_count -= nodes;                      /* The exponent is folded into the new node */
+    index = add_node(parser, CALC_OP_POWI, base, -1, value);
+    if (index >= 0 && value < 0) {                  /* A negative power of an integer is a fraction */
+        expr->nodes[index].exact = 0;
+    }
+    return index;
+}
+
+/**
+ * \brief           A function used to find a variable slot by name, creating it on first use
+ * \param[in]       parser: The state of the compilation
+ * \param[in]       name: A name of the variable, not NUL-terminated
+ * \param[in]       length: Length of the name
+ * \return          The variable slot, -1 in case of an error
+ */
+static int32_t
+add_variable(calc_parser_t* parser, const char* name, size_t length) {
+    calc_expr_t* expr = parser->expr;
+    for (size_t i = 0; i < expr->var_count; ++i) {                  /* Loop through known variables */
+        if (strncmp(expr->var_names[i], name, length) == 0 && expr->var_names[i][length] == '\0') {
+            return (int32_t)i;
+        }
+    }
+    char** names = (char**)realloc(expr->var_names, (expr->var_count + 1) * sizeof(char*));
+    if (names == NULL) {
+        parse_error(parser, CALC_ERROR_FAILED_TO_ALLOCATE_MEMORY);
+        return -1;
+    }
+    expr->var_names = names;
+    names[expr->var_count] = (char*)malloc((length + 1) * sizeof(char));
+    if (names[expr->var_count] == NULL) {
+        parse_error(parser, CALC_ERROR_FAILED_TO_ALLOCATE_MEMORY);
+        return -1;
+    }
+    memcpy(names[expr->var_count], name, length);
+    names[expr->var_count][length] = '\0';
+    return (int32_t)expr->var_count++;
+}
+
+/**
+ * \brief           A function used to parse a factor
+ * \param[in]       parser: The state of the compilation
+ * \return          An index of the node holding the factor, -1 in case of an error
+ */
+static int32_t
+factor(calc_parser_t* parser) {
+    uint8_t negate = 0;             /* A variable to store if the sign has to be changed */
+    int32_t result;                 /* A variable to store the result */
+    if (parser->token == '-') {     /* Check if the token is a minus sign */
+        negate = 1;                 /* Change the sign of the factor if so */
+        get_token(parser);          /* Get the next token */
+    } else if (parser->token == '+') {  /* A leading plus does not change anything */
+        get_token(parser);
+    }
+    if (parser->token == '(') {                         /* Check if the token is a left parenthesis */
+        get_token(parser);                              /* Get the next token */
+        result = expression(parser);                    /* Parse the expression in parentheses */
+        if (result >= 0 && parser->token != ')') {      /* Check if the parenthesis is closed */
+            parse_error(parser, CALC_ERROR_INVALID_INPUT);
+            result = -1;
+        }
+        get_token(parser);                              /* Get the next token */
+    } else if (isdigit((unsigned char)parser->token) || parser->token == '.') { /* Else if the token is a digit or a decimal point */
+        result = number(parser);
+    } else if (isalpha((unsigned char)parser->token)) { /* Else if the token is a letter */
+        result = identifier(parser);
+    } else {                                            /* Anything else cannot start a factor */
+        parse_error(parser, CALC_ERROR_INVALID_INPUT);
+        result = -1;
+    }
+    if (result >= 0 && negate) {
+        result = add_node(parser, CALC_OP_NEG, result, -1, 0);
+    }
+    return result;
+}
+
+/**
+ * \brief           A function used to parse an expression
+ * \param[in]       parser: The state of the compilation
+ * \return          An index of the node holding the expression, -1 in case of an error
+ * \note            An expression nested deeper than \ref CALC_PARSE_MAX_DEPTH is invalid, so a long input cannot exhaust the stack
+ */
+static int32_t
+expression(calc_parser_t* parser) {
+    int32_t result;                 /* A variable to store the result */
+    if (++parser->depth > CALC_PARSE_MAX_DEPTH) {   /* Check if the nesting is too deep */
+        parse_error(parser, CALC_ERROR_INVALID_INPUT);
+        --parser->depth;
+        return -1;
+    }
+    result = term(parser);          /* Parse the first term */
+    while (result >= 0 && (parser->token == '+' || parser->token == '-')) { /* While the token is a plus or a minus sign */
+        calc_op_t op = parser->token == '+' ? CALC_OP_ADD : CALC_OP_SUB;   /* A variable to store an operation */
+        int32_t right;                                                      /* A variable to store the right part of the expression */
+        get_token(parser);                                                  /* Get the next token */
+        right = term(parser);                                               /* Parse the right part of the expression */
+        result = right >= 0 ? add_node(parser, op, result, right, 0) : -1;
+    }
+    --parser->depth;
+    return result;
+}
+
+/**
+ * \brief           A function used to parse a term
+ * \param[in]       parser: The state of the compilation
+ * \return          An index of the node holding the term, -1 in case of an error
+ * \note            All of '*', '/', ':', '%' and '^' have the same priority and are left associative
+ */
+static int32_t
+term(calc_parser_t* parser) {
+    int32_t result;                 /* A variable to store the result */
+    result = factor(parser);        /* Parse the first factor */
+    while (result >= 0 && (parser->token == '*' || parser->token == '/' || parser->token == ':' || parser->token == '%' || parser->token == '^')) { /* While the token is a multiplication, a division, a modulo, a power */
+        calc_op_t op;               /* A variable to store an operation */
+        int32_t right;              /* A variable to store the right part of the expression */
+        switch (parser->token) {    /* Find the operation based on the operator */
+            case '*':
+                op = CALC_OP_MUL;
+                break;
+            case '/':
+            case ':':
+                op = CALC_OP_DIV;
+                break;
+            case '%':
+                op = CALC_OP_MOD;
+                break;
+            default:
+                op = CALC_OP_POW;
+                break;
+        }
+        get_token(parser);          /* Get the next token */
+        right = factor(parser);     /* Parse the right part of the expression */
+        if (right < 0) {
+            result = -1;
+        } else if (op == CALC_OP_POW) {
+            result = add_power(parser, result, right);
+        } else {
+            result = add_node(parser, op, result, right, 0);
+        }
+    }
+    return result;
+}
+
+/**
+ * \brief           A function used to parse a numeric literal
+ * \param[in]       parser: The state of the compilation
+ * \return          An index of the constant node, -1 in case of an error
+ */
+static int32_t
+number(calc_parser_t* parser) {
+    char* begin = parser->str - 1;  /* The current token is the first character of the number */
+    char* end = begin;              /* A pointer past the last character of the number */
+    uint8_t has_decimal_point = 0, has_digits = 0;
+    char saved;                     /* A character replaced by the null terminator */
+    int32_t index;
+    double value;
+    while (isdigit((unsigned char)*end) || (!has_decimal_point && *end == '.')) {  /* While the character is a digit or the first decimal point */
+        if (*end == '.') {
+            has_decimal_point = 1;
+        } else {
+            has_digits = 1;
+        }
+        ++end;
+    }
+    if (!has_digits) {              /* A lonely decimal point is not a number */
+        parse_error(parser, CALC_ERROR_INVALID_INPUT);
+        return -1;
+    }
+    saved = *end;                   /* Terminate the number, so that strtod does not read an exponent */
+    *end = '\0';
+    value = strtod(begin, NULL);    /* Convert the number to a double */
+    *end = saved;
+    parser->str = end;
+    get_token(parser);              /* Get the next token */
+    index = add_node(parser, CALC_OP_CONST, -1, -1, value);
+    if (index >= 0) {
+        add_literal(parser, index, begin, end);
+    }
+    return parser->error.code == CALC_OK ? index : -1;
+}
+
+/**
+ * \brief           A function used to keep the exact value of a literal
+ * \param[in]       parser: The state of the compilation
+ * \param[in]       index: An index of the constant node of the literal
+ * \param[in]       begin: The first character of the literal
+ * \param[in]       end: A pointer past the last character
+ * \note            The digits are kept for \ref calc_eval_big, an integer literal fitting into \ref calc_int_t is also exact
+ *                  for \ref calc_eval_exact
+ */
+static void
+add_literal(calc_parser_t* parser, int32_t index, const char* begin, const char* end) {
+    calc_expr_t* expr = parser->expr;
+    calc_literal_t* literal;
+    uint8_t fits = 1;                                               /* Cleared when the integer overflows */
+    uint8_t has_decimal_point = 0;
+    size_t count = 0;                                               /* A number of digits */
+    if (expr->literal_count == parser->literal_capacity) {          /* Check if the literal array is full */
+        size_t capacity = parser->literal_capacity > 0 ? parser->literal_capacity * 2 : 8;
+        calc_literal_t* literals = (calc_literal_t*)realloc(expr->literals, capacity * sizeof(calc_literal_t));
+        if (literals == NULL) {                                     /* The old array is still owned by the expression */
+            parse_error(parser, CALC_ERROR_FAILED_TO_ALLOCATE_MEMORY);
+            return;
+        }
+        expr->literals = literals;
+        parser->literal_capacity = capacity;
+    }
+    literal = &expr->literals[expr->literal_count];
+    literal->digits = (char*)malloc((size_t)(end - begin + 1) * sizeof(char));
+    if (literal->digits == NULL) {
+        parse_error(parser, CALC_ERROR_FAILED_TO_ALLOCATE_MEMORY);
+        return;
+    }
+    literal->integer = 0;
+    literal->scale = 0;
+    for (const char* digit = begin; digit < end; ++digit) {         /* Loop through the characters, skipping the point */
+        if (*digit == '.') {
+            has_decimal_point = 1;
+            continue;
+        }
+        literal->digits[count++] = *digit;
+        literal->scale += has_decimal_point;                        /* Digits after the point */
+        fits = fits && !__builtin_mul_overflow(literal->integer, 10, &literal->integer)
+            && !__builtin_add_overflow(literal->integer, *digit - '0', &literal->integer);
+    }
+    literal->digits[count] = '\0';
+    expr->nodes[index].a = (int32_t)expr->literal_count++;
+    expr->nodes[index].exact = fits && literal->scale == 0;         /* A literal with a point is a fraction for the exact mode */
+}
+
+/**
+ * \brief           A function used to parse a function call or a variable
+ * \param[in]       parser: The state of the compilation
+ * \return          An index of the node holding the call or the variable, -1 in case of an error
+ */
+static int32_t
+identifier(calc_parser_t* parser) {
+    const char* name = parser->str - 1;     /* The current token is the first letter */
+    size_t length = 0;                      /* Length of the name */
+    const calc_function_t* function;        /* The function from the registry */
+    int32_t fn, result, arg, count = 0;
+    while (isalpha((unsigned char)name[length])) {
+        ++length;
+    }
+    parser->str += length - 1;
+    get_token(parser);                      /* Get the token after the name */
+    fn = calc_function_index(name, length);
+    if (parser->token != '(') {             /* Without parentheses the name is a variable */
+        if (fn >= 0) {                      /* A function name cannot be used as a variable */
+            parse_error(parser, CALC_ERROR_INVALID_INPUT);
+            return -1;
+        }
+        int32_t slot = add_variable(parser, name, length);
+        return slot >= 0 ? add_node(parser, CALC_OP_VAR, slot, -1, 0) : -1;
+    }
+    if (fn < 0) {                           /* Check if the function is in the registry */
+        parse_error(parser, CALC_ERROR_INVALID_INPUT);
+        return -1;
+    }
+    function = &calc_functions[fn];
+    result = -1;
+    do {                                    /* Loop through the arguments separated by commas */
+        get_token(parser);                  /* Skip '(' or ',' */
+        arg = expression(parser);
+        if (arg < 0) {
+            return -1;
+        }
+        ++count;
+        if (count == 1) {
+            result = arg;
+        } else if (function->arity == 2 && (function->variadic || count == 2)) {
+            result = add_call(parser, (calc_function_id_t)fn, result, arg);  /* Fold the argument list into a chain of binary calls */
+        } else {                            /* Too many arguments */
+            parse_error(parser, CALC_ERROR_INVALID_INPUT);
+            return -1;
+        }
+    } while (result >= 0 && parser->token == ',');
+    if (result < 0) {
+        return -1;
+    }
+    if (parser->token != ')' || (!function->variadic && count != function->arity)) {  /* Check if the call is closed and the number of arguments is right */
+        parse_error(parser, CALC_ERROR_INVALID_INPUT);
+        return -1;
+    }
+    get_token(parser);                      /* Get the token after ')' */
+    if (function->arity == 1) {             /* Binary functions have been added while folding */
+        result = add_call(parser, (calc_function_id_t)fn, result, -1);
+    }
+    return result;
+}
@@ -0,0 +1,230 @@
+/**
+ * \file            calc.h
+ * \brief           Public interface of the embeddable calculator library (libcalc)
+ */
+
+/*
+ * Copyright (c) 2024 Daniil VERES
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * Author:          Daniil VERES <daniaveres@gmail.com>
+ * Version:         v1.0.0
+ */
+
+#ifndef CALC_HDR_H
+#define CALC_HDR_H
+
+#include <stddef.h> /* size_t */
+#include <stdint.h> /* uint8_t, int64_t, uint64_t */
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/**
+ * \brief           Enumeration representing error codes reported by the library
+ * \note            Values match the exit codes of the calculator program
+ */
+typedef enum {
+    CALC_OK = 0,                                /*!< No error */
+    CALC_ERROR_FAILED_TO_ALLOCATE_MEMORY = 1,   /*!< Failed to allocate memory error code */
+    CALC_ERROR_INVALID_INPUT,                   /*!< Invalid input error code */
+    CALC_ERROR_UNDEFINED_FUNCTION,              /*!< Undefined function (argument out of domain) error code */
+    CALC_ERROR_UNKNOWN,                         /*!< Unknown error code */
+    CALC_ERROR_NOT_CONVERGED                    /*!< An approximation has not met the requested tolerance */
+} calc_error_code_t;
+
+/**
+ * \brief           Error report filled by the library functions
+ */
+typedef struct {
+    calc_error_code_t code;     /*!< Error code, \ref CALC_OK on success */
+    size_t position;            /*!< Offset in the source string where a compile error was detected */
+} calc_error_t;
+
+/**
+ * \brief           Opaque handle of a compiled expression
+ * \note            A compiled expression is immutable, so one handle can be evaluated from several threads at once
+ */
+typedef struct calc_expr calc_expr_t;
+
+/**
+ * \brief           Opaque handle of an evaluation context
+ * \note            A context holds the working memory of evaluations, so that a thread evaluating in a loop does not allocate
+ */
+typedef struct calc_context calc_context_t;
+
+/**
+ * \brief           Enumeration representing the evaluation engines
+ */
+typedef enum {
+    CALC_ENGINE_LINEAR = 0,     /*!< A single pass over the nodes in postfix order, the engine of \ref calc_eval */
+    CALC_ENGINE_RECURSIVE,      /*!< A recursive walk of the tree from the root, without working memory */
+    CALC_ENGINE_COUNT           /*!< A number of engines */
+} calc_engine_t;
+
+/**
+ * \brief           A result of an exact evaluation
+ * \note            An integer result is held in 128 bits, as two halves so that the header needs no compiler extension
+ */
+typedef struct {
+    double value;                   /*!< The result, the nearest double for an integer result */
+    uint8_t is_integer;             /*!< Set to `1` when the result is the exact integer held in \ref high and \ref low */
+    int64_t high;                   /*!< The high half of the integer in two's complement */
+    uint64_t low;                   /*!< The low half of the integer */
+} calc_result_t;
+
+/**
+ * \brief           A result of a decimal evaluation
+ * \note            A decimal result is the integer held in \ref high and \ref low divided by 10 to the power of \ref scale
+ */
+typedef struct {
+    double value;                   /*!< The result, a double close to a decimal result */
+    uint8_t is_decimal;             /*!< Set to `1` when the result is the decimal held in \ref high and \ref low */
+    int64_t high;                   /*!< The high half of the scaled integer in two's complement */
+    uint64_t low;                   /*!< The low half of the scaled integer */
+    uint32_t scale;                 /*!< A number of digits after the point */
+} calc_decimal_t;
+
+/**
+ * \brief           An interval of real numbers, the result of an interval evaluation
+ */
+typedef struct {
+    double lo;                      /*!< The lower bound */
+    double hi;                      /*!< The upper bound */
+} calc_interval_t;
+
+/**
+ * \brief           A complex number, the result of a complex evaluation
+ */
+typedef struct {
+    double re;                      /*!< The real part */
+    double im;                      /*!< The imaginary part */
+} calc_complex_t;
+
+/**
+ * \brief           A double-double number, the result of a double-double evaluation
+ * \note            The value is the unevaluated sum \ref hi + \ref lo, where \ref lo is at most half an ulp of \ref hi
+ */
+typedef struct {
+    double hi;                      /*!< The high part, the value rounded to double */
+    double lo;                      /*!< The low part */
+} calc_dd_t;
+
+/**
+ * \brief           Implementation of a math function
+ * \param[in]       args: Arguments of the call, \ref calc_function_t::arity values
+ * \return          Result of the function, the arguments are already checked against \ref calc_function_t::domain
+ */
+typedef double (*calc_function_impl_t)(const double* args);
+
+/**
+ * \brief           Enumeration representing domains of the math functions
+ */
+typedef enum {
+    CALC_DOMAIN_ALL = 0,                /*!< Defined for every argument */
+    CALC_DOMAIN_NON_NEGATIVE,           /*!< x >= 0 */
+    CALC_DOMAIN_POSITIVE,               /*!< x > 0 */
+    CALC_DOMAIN_UNIT_CLOSED,            /*!< -1 <= x <= 1 */
+    CALC_DOMAIN_UNIT_OPEN,              /*!< -1 < x < 1 */
+    CALC_DOMAIN_AT_LEAST_ONE,           /*!< x >= 1 */
+    CALC_DOMAIN_NON_ZERO,               /*!< x != 0 */
+    CALC_DOMAIN_COS_NON_ZERO,           /*!< cos(x) != 0 */
+    CALC_DOMAIN_SIN_NON_ZERO,           /*!< sin(x) != 0 */
+    CALC_DOMAIN_NON_NEGATIVE_INTEGER,   /*!< x is a non-negative integer */
+    CALC_DOMAIN_LOG_BASE                /*!< The base is positive and not 1, the argument is positive */
+} calc_domain_t;
+
+/**
+ * \brief           An entry of the function registry
+ */
+typedef struct {
+    const char* name;               /*!< Canonical name of the function */
+    calc_function_impl_t impl;      /*!< Implementation */
+    uint8_t arity;                  /*!< A number of arguments */
+    uint8_t variadic;               /*!< Set to `1` when more arguments are folded into a chain of binary calls */
+    uint8_t pure;                   /*!< Set to `1` when the result depends on the arguments only */
+    calc_domain_t domain;           /*!< Domain of the arguments */
+} calc_function_t;
+
+/**
+ * \brief           Counters of a math function collected while profiling is enabled
+ */
+typedef struct {
+    const char* name;               /*!< Canonical name of the function */
+    uint64_t calls;                 /*!< A number of calls */
+    uint64_t cycles;                /*!< Cycles spent in the calls, time stamp counter ticks on x86, nanoseconds elsewhere */
+} calc_profile_entry_t;
+
+uint8_t         calc_validate(const char* str, size_t len);
+uint8_t         calc_validate_complex(const char* str, size_t len);
+calc_expr_t*    calc_compile(const char* str, size_t len, calc_error_t* error);
+double          calc_eval(const calc_expr_t* expr, const double* vars, calc_error_t* error);
+void            calc_free(calc_expr_t* expr);
+
+calc_context_t* calc_context_create(void);
+void            calc_context_free(calc_context_t* context);
+double          calc_eval_ctx(calc_context_t* context, const calc_expr_t* expr, const double* vars, calc_error_t* error);
+double          calc_eval_engine(calc_context_t* context, const calc_expr_t* expr, const double* vars, calc_engine_t engine, calc_error_t* error);
+const char*     calc_engine_name(calc_engine_t engine);
+double          calc_eval_exact(calc_context_t* context, const calc_expr_t* expr, const double* vars, calc_result_t* result, calc_error_t* error);
+int             calc_format_result(const calc_result_t* result, char* buffer, size_t size);
+char*           calc_eval_big(const calc_expr_t* expr, const double* vars, size_t digits, calc_error_t* error);
+double          calc_eval_decimal(const calc_expr_t* expr, const double* vars, uint32_t scale, calc_decimal_t* result, calc_error_t* error);
+int             calc_format_decimal(const calc_decimal_t* result, char* buffer, size_t size);
+double          calc_eval_interval(const calc_expr_t* expr, const calc_interval_t* vars, calc_interval_t* result, calc_error_t* error);
+int             calc_format_interval(const calc_interval_t* result, char* buffer, size_t size);
+double          calc_eval_complex(const calc_expr_t* expr, const calc_complex_t* vars, calc_complex_t* result, calc_error_t* error);
+size_t          calc_eval_complex_columns(const calc_expr_t* expr, size_t rows, const double* const* re, const double* const* im,
+                                          double* result_re, double* result_im, calc_error_t* error);
+int             calc_format_complex(const calc_complex_t* result, char* buffer, size_t size);
+double          calc_eval_dd(const calc_expr_t* expr, const calc_dd_t* vars, calc_dd_t* result, calc_error_t* error);
+int             calc_format_dd(const calc_dd_t* result, char* buffer, size_t size);
+double          calc_eval_dual(const calc_expr_t* expr, const double* vars, double* gradient, calc_error_t* error);
+size_t          calc_eval_dual_columns(const calc_expr_t* expr, size_t rows, const double* const* vars, double* result,
+                                       double* const* gradient, calc_error_t* error);
+double          calc_eval_gradient(calc_context_t* context, const calc_expr_t* expr, const double* vars, double* gradient, calc_error_t* error);
+calc_expr_t*    calc_diff(const calc_expr_t* expr, const char* name, calc_error_t* error);
+double          calc_integrate(const calc_expr_t* expr, const char* name, const double* vars, double a, double b, double tolerance,
+                               size_t threads, double* estimate, calc_error_t* error);
+size_t          calc_eval_float_columns(const calc_expr_t* expr, size_t rows, const float* const* vars, float* result, calc_error_t* error);
+
+size_t          calc_var_count(const calc_expr_t* expr);
+const char*     calc_var_name(const calc_expr_t* expr, size_t index);
+const char*     calc_error_string(calc_error_code_t code);
+int             calc_format(double value, char* buffer, size_t size);
+
+size_t                  calc_function_count(void);
+const calc_function_t*  calc_function_get(size_t index);
+const calc_function_t*  calc_function_find(const char* name, size_t len);
+size_t                  calc_alias_count(void);
+const char*             calc_alias_name(size_t index);
+
+void                    calc_profile_enable(uint8_t enable);
+void                    calc_profile_reset(void);
+uint8_t                 calc_profile_get(size_t index, calc_profile_entry_t* entry);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* CALC_HDR_H */
@@ -0,0 +1,135 @@
+/**
+ * \file            calc_adjoint.c
+ * \brief           Reverse-mode automatic differentiation with a tape kept in the evaluation context
+ */
+
+/*
+ * Copyright (c) 2024 Daniil VERES
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * Author:          Daniil VERES <daniaveres@gmail.com>
+ * Version:         v1.0.0
+ */
+
+                            /* Functions used: */
+#include <math.h>           /* nan */
+#include <stdatomic.h>      /* atomic_load_explicit */
+#include "calc_internal.h"
+
+static inline double adjoint_term(double partial, double adjoint);             /* A function used to apply the chain rule backwards to an operand */
+
+/**
+ * \brief           A function used to evaluate an expression and its gradient in reverse mode
+ * \param[in]       context: An evaluation context owned by the calling thread, it keeps the tape between the calls
+ * \param[in]       expr: A compiled expression
+ * \param[in]       vars: Values of the variables indexed by slot, NULL if there are none
+ * \param[out]      gradient: Partial derivatives of the result with respect to the variables indexed by slot, may be NULL
+ * \param[out]      error: An error report, may be NULL
+ * \return          The result, as of \ref calc_eval, NaN in case of an error
+ * \note            The forward pass calculates the nodes and records the partial derivatives of every node with respect
+ *                  to its operands on a tape, 16 bytes per node; the backward sweep then carries the adjoints from the root
+ *                  to the variables, so the whole gradient costs a few evaluations however many variables there are.
+ *                  The tape and the adjoints live in the context, which does not allocate once it has grown to the size
+ *                  of the expression. Values, errors and profile counts are those of \ref calc_eval, the partials follow
+ *                  the rules of \ref calc_node_partials and agree with \ref calc_eval_dual up to the order of the sums,
+ *                  so where partials overflow one mode may give an infinity and the other NaN. The gradient is NaN on an error.
+ */
+double
+calc_eval_gradient(calc_context_t* context, const calc_expr_t* expr, const double* vars, double* gradient, calc_error_t* error) {
+    calc_error_code_t code = CALC_OK;
+    double root = nan("");
+    double* values = NULL;                      /* Values of the nodes, then their adjoints */
+    calc_tape_entry_t* tape = NULL;             /* Partials of the nodes with respect to their operands */
+
+    if (context == NULL || expr == NULL || expr->node_count == 0) {
+        code = CALC_ERROR_UNKNOWN;
+    } else if (expr->var_count > 0 && vars == NULL) {
+        code = CALC_ERROR_INVALID_INPUT;
+    } else if (!calc_context_reserve_tape(context, expr->node_count, &values, &tape)) {
+        code = CALC_ERROR_FAILED_TO_ALLOCATE_MEMORY;
+    } else {
+        const calc_function_t* functions = atomic_load_explicit(&calc_dispatch, memory_order_acquire);
+        for (size_t i = 0; code == CALC_OK && i < expr->node_count; ++i) {     /* The forward pass records the tape */
+            const calc_node_t* node = &expr->nodes[i];
+            double x = 0, y = 0;
+            if (node->op > CALC_OP_VAR) {
+                x = values[node->a];
+                y = node->b >= 0 ? values[node->b] : 0;
+            }
+            values[i] = calc_apply_node(node, x, y, vars, functions, &code);
+            if (code == CALC_OK && node->op > CALC_OP_VAR) {    /* The rules hold in the domain only */
+                calc_node_partials(node, x, y, values[i], &tape[i].dx, &tape[i].dy);
+            }
+        }
+        if (code == CALC_OK) {
+            root = values[expr->node_count - 1] + 0.0;     /* The last node is the root, -0 is printed as 0 */
+        }
+        if (code == CALC_OK && gradient != NULL) {
+            for (size_t k = 0; k < expr->var_count; ++k) {
+                gradient[k] = 0;
+            }
+            for (size_t i = 0; i + 1 < expr->node_count; ++i) {
+                values[i] = 0;                  /* The values are no longer needed */
+            }
+            values[expr->node_count - 1] = 1;   /* The derivative of the root with respect to itself */
+            for (size_t i = expr->node_count; i-- > 0;) {  /* The backward sweep, operands always precede their nodes */
+                const calc_node_t* node = &expr->nodes[i];
+                double adjoint = values[i];
+                if (adjoint == 0) {             /* Nothing depends on the node, e.g. the operand not returned by min */
+                    continue;
+                }
+                if (node->op == CALC_OP_VAR) {
+                    gradient[node->a] += adjoint;
+                } else if (node->op > CALC_OP_VAR) {
+                    values[node->a] += adjoint_term(tape[i].dx, adjoint);
+                    if (node->b >= 0) {
+                        values[node->b] += adjoint_term(tape[i].dy, adjoint);
+                    }
+                }
+            }
+            for (size_t k = 0; k < expr->var_count; ++k) {
+                gradient[k] += 0.0;             /* -0 is printed as 0 */
+            }
+        }
+    }
+    for (size_t k = 0; code != CALC_OK && expr != NULL && gradient != NULL && k < expr->var_count; ++k) {
+        gradient[k] = nan("");
+    }
+    if (error != NULL) {
+        error->code = code;
+        error->position = 0;
+    }
+    return root;
+}
+
+/**
+ * \brief           A function used to apply the chain rule backwards to an operand
+ * \param[in]       partial: The partial derivative of a node with respect to the operand
+ * \param[in]       adjoint: The partial derivative of the result with respect to the node, not 0
+ * \return          The product, 0 if the partial is 0
+ * \note            0 times anything is 0, as in the forward mode, so an infinite adjoint does not reach the operands
+ *                  of a node whose partial is 0
+ */
+static inline double
+adjoint_term(double partial, double adjoint) {
+    return partial == 0 ? 0 : partial * adjoint;
+}
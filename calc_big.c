@@ -0,0 +1,3139 @@
+/**
+ * \file            calc_big.c
+ * \brief           Arbitrary-precision evaluation with exact integers and binary floats of a chosen number of digits
+ */
+
+/*
+ * Copyright (c) 2024 Daniil VERES
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * Author:          Daniil VERES <daniaveres@gmail.com>
+ * Version:         v1.0.0
+ */
+
+#include <math.h>           /* frexp, ldexp, log2, floor, ceil, isfinite, signbit */
+#include <stdatomic.h>      /* atomic_load_explicit */
+#include <stdio.h>          /* sprintf */
+#include <stdlib.h>         /* malloc, calloc, realloc, free */
+#include <string.h>         /* memcpy, memset, strcpy, strlen */
+#include "calc_internal.h"
+
+                                        /* Constants used: */
+#define CALC_BIG_KARATSUBA_LIMBS 32     /*!< The smallest operand, in limbs, multiplied by Karatsuba instead of the schoolbook method */
+#define CALC_BIG_TOOM3_LIMBS 128        /*!< The smallest operand, in limbs, multiplied by Toom-3 instead of Karatsuba */
+#define CALC_BIG_NTT_LIMBS 1536         /*!< The smallest operand, in limbs, multiplied by the number theoretic transform */
+#define CALC_BIG_NEWTON_LIMBS 768       /*!< The shortest divisor and quotient, in limbs, divided by a reciprocal instead of the long division */
+#define CALC_BIG_MAX_BITS ((int64_t)1 << 25)    /*!< The largest magnitude, in bits, above which a value is infinite and below whose
+                                                     reciprocal it is zero, 2^25 bits are about 10 million digits */
+#define CALC_BIG_MAX_DIGITS 10000000    /*!< The largest number of significant digits of a fraction */
+#define CALC_BIG_GUARD_BITS 64          /*!< Bits kept beyond the requested digits, so that the printed digits are correctly rounded */
+#define CALC_BIG_FACT_MAX 1000000       /*!< The largest integer whose factorial is calculated exactly, it has 5565709 digits */
+#define CALC_BIG_DECIMAL_BASE 1000000000u   /*!< 10^9, the largest power of 10 fitting into a limb */
+#define CALC_BIG_DECIMAL_DIGITS 9       /*!< Digits of \ref CALC_BIG_DECIMAL_BASE */
+#define CALC_BIG_FUNCTION_GUARD 32      /*!< Bits the math functions calculate beyond the precision of their result */
+#define CALC_BIG_BURST_BITS 32          /*!< Bits of the first piece of an argument summed by the bit-burst algorithm */
+#define CALC_BIG_AGM_BITS 1000000       /*!< The smallest precision, in bits, of a logarithm calculated by the arithmetic-geometric mean */
+#define CALC_BIG_CHUDNOVSKY_BITS 47.11  /*!< Bits of pi added by every term of the Chudnovsky series, log2(640320^3 / 1728) */
+#define CALC_BIG_GAMMA_MAX_BITS ((int64_t)1 << 28)  /*!< The longest series of the gamma function, its terms times their bits, about 3500 digits
+                                                     of fact(3.5) or 20 digits of fact(600000.5) */
+#define CALC_BIG_CHUNK_LEVEL 5          /*!< Numbers of up to 2^5 chunks of 9 digits are divided by 10^9 repeatedly, longer ones are split */
+
+typedef uint32_t big_limb_t;            /*!< A digit of a natural number in base 2^32 */
+
+/**
+ * \brief           A natural number, the limbs are stored from the least significant one
+ */
+typedef struct {
+    big_limb_t* limbs;      /*!< Limbs, the most significant one is not zero */
+    size_t size;            /*!< A number of limbs, 0 for zero */
+    size_t capacity;        /*!< A number of allocated limbs */
+} big_nat_t;
+
+/**
+ * \brief           A value of a node, the magnitude multiplied by 2 to the power of the exponent
+ */
+typedef struct {
+    big_nat_t magnitude;    /*!< The magnitude */
+    int64_t exponent;       /*!< The binary exponent, 0 for an integer */
+    uint8_t negative;       /*!< Set to `1` when the value is negative, or is negative zero */
+    uint8_t is_integer;     /*!< Set to `1` when the value is an exact integer, which is never rounded */
+    uint8_t is_special;     /*!< Set to `1` when the value is an infinity or NaN held in \ref special */
+    double special;         /*!< The infinity or NaN */
+} big_value_t;
+
+/**
+ * \brief           Enumeration representing the series summed by binary splitting
+ */
+typedef enum {
+    BIG_SERIES_EXP = 0,     /*!< e^x, the sum of x^n / n! */
+    BIG_SERIES_SIN,         /*!< sin(x) / x, the sum of (-x^2)^n / (2n + 1)! */
+    BIG_SERIES_ATAN,        /*!< atan(x) / x, the sum of (-x^2)^n / (2n + 1) */
+    BIG_SERIES_ATANH,       /*!< atanh(x) / x, the sum of x^(2n) / (2n + 1) */
+    BIG_SERIES_PI           /*!< The Chudnovsky series, 426880 sqrt(10005) / pi */
+} big_series_kind_t;
+
+/**
+ * \brief           A series summed by binary splitting, its term n is a(n) / b(n) times the product of p(k) / q(k) for k up to n
+ */
+typedef struct {
+    big_series_kind_t kind; /*!< The series, which gives a(n), b(n) and the factors of p(n) and q(n) */
+    big_nat_t numerator;    /*!< p(n) for n above 0, the numerator of the argument or of its square */
+    big_limb_t denominator; /*!< A factor of q(n), the square of the denominator of the argument of \ref BIG_SERIES_ATANH */
+    int64_t shift;          /*!< q(n) is also multiplied by 2^shift, the power of 2 in the denominator of the argument */
+    uint8_t negative;       /*!< Set to `1` when p(n) is negative */
+} big_series_t;
+
+/**
+ * \brief           Products of a range of terms of a series
+ */
+typedef struct {
+    big_nat_t p;            /*!< The product of p(n) */
+    big_nat_t q;            /*!< The product of q(n), without the powers of 2 */
+    big_nat_t b;            /*!< The product of b(n), only for the arc tangents */
+    big_nat_t t;            /*!< The sum of the terms times the products of b(n) and q(n) */
+    int64_t shift;          /*!< The power of 2 in the product of q(n) */
+    uint8_t p_negative;     /*!< Set to `1` when the product of p(n) is negative */
+    uint8_t t_negative;     /*!< Set to `1` when the sum is negative */
+} big_split_t;
+
+/**
+ * \brief           Enumeration representing the constants kept during an evaluation
+ */
+typedef enum {
+    BIG_CONSTANT_PI = 0,    /*!< pi */
+    BIG_CONSTANT_LN2,       /*!< ln(2) */
+    BIG_CONSTANT_E,         /*!< e */
+    BIG_CONSTANT_LN10,      /*!< ln(10) */
+    BIG_CONSTANT_COUNT      /*!< A number of constants */
+} big_constant_t;
+
+/**
+ * \brief           Constants calculated during an evaluation, kept for the calls needing them again
+ */
+typedef struct {
+    big_value_t values[BIG_CONSTANT_COUNT];     /*!< The constants */
+    int64_t precisions[BIG_CONSTANT_COUNT];     /*!< Bits they are calculated to, 0 if not yet */
+} big_constants_t;
+
+static big_limb_t limbs_add(big_limb_t* result, const big_limb_t* a, size_t a_size, const big_limb_t* b, size_t b_size);     /* A function used to add limbs */
+static big_limb_t limbs_sub(big_limb_t* result, const big_limb_t* a, size_t a_size, const big_limb_t* b, size_t b_size);     /* A function used to subtract limbs */
+static void limbs_add_at(big_limb_t* result, size_t size, size_t offset, const big_limb_t* a, size_t a_size);                  /* A function used to add limbs at an offset */
+static uint8_t limbs_mul(big_limb_t* result, const big_limb_t* a, size_t a_size, const big_limb_t* b, size_t b_size);        /* A function used to multiply limbs, choosing the method by size */
+static void limbs_mul_schoolbook(big_limb_t* result, const big_limb_t* a, size_t a_size, const big_limb_t* b, size_t b_size); /* A function used to multiply limbs by the schoolbook method */
+static uint8_t limbs_mul_chunks(big_limb_t* result, const big_limb_t* a, size_t a_size, const big_limb_t* b, size_t b_size); /* A function used to multiply limbs of unbalanced sizes */
+static uint8_t limbs_mul_karatsuba(big_limb_t* result, const big_limb_t* a, size_t a_size, const big_limb_t* b, size_t b_size);  /* A function used to multiply limbs by Karatsuba */
+static uint8_t limbs_mul_toom3(big_limb_t* result, const big_limb_t* a, size_t a_size, const big_limb_t* b, size_t b_size);  /* A function used to multiply limbs by Toom-3 */
+#ifdef __SIZEOF_INT128__
+static uint8_t limbs_mul_ntt(big_limb_t* result, const big_limb_t* a, size_t a_size, const big_limb_t* b, size_t b_size);    /* A function used to multiply limbs by the number theoretic transform */
+#endif /* __SIZEOF_INT128__ */
+
+static uint8_t nat_reserve(big_nat_t* x, size_t capacity);                                  /* A function used to grow the limbs of a natural number */
+static void nat_trim(big_nat_t* x);                                                         /* A function used to drop leading zero limbs */
+static void nat_replace(big_nat_t* x, big_nat_t* value);                                    /* A function used to move a natural number into another one */
+static uint8_t nat_set(big_nat_t* x, const big_limb_t* limbs, size_t size);                 /* A function used to copy limbs into a natural number */
+static uint8_t nat_set_u64(big_nat_t* x, uint64_t value);                                   /* A function used to set a natural number to a native integer */
+static int64_t nat_bits(const big_nat_t* x);                                                /* A function used to get a number of significant bits */
+static uint64_t nat_extract(const big_nat_t* x, int64_t offset);                            /* A function used to read 64 bits at a bit offset */
+static uint8_t nat_is_zero_below(const big_nat_t* x, int64_t bits);                         /* A function used to check if the low bits are zero */
+static int nat_cmp(const big_nat_t* a, const big_nat_t* b);                                 /* A function used to compare natural numbers */
+static uint8_t nat_add(big_nat_t* result, const big_nat_t* a, const big_nat_t* b);          /* A function used to add natural numbers */
+static uint8_t nat_sub(big_nat_t* result, const big_nat_t* a, const big_nat_t* b);          /* A function used to subtract a smaller natural number */
+static uint8_t nat_mul(big_nat_t* result, const big_nat_t* a, const big_nat_t* b);          /* A function used to multiply natural numbers */
+static uint8_t nat_mul_small(big_nat_t* x, big_limb_t factor, big_limb_t addend);           /* A function used to multiply by a limb and add a limb */
+static big_limb_t nat_div_small(big_nat_t* x, big_limb_t divisor);                          /* A function used to divide by a limb */
+static uint8_t nat_divmod(big_nat_t* quotient, big_nat_t* remainder, const big_nat_t* a, const big_nat_t* b);   /* A function used to divide natural numbers */
+static uint8_t nat_divmod_knuth(big_nat_t* quotient, big_nat_t* remainder, const big_nat_t* a, const big_nat_t* b);     /* A function used to divide by the long division */
+static uint8_t nat_divmod_newton(big_nat_t* quotient, big_nat_t* remainder, const big_nat_t* a, const big_nat_t* b);    /* A function used to divide by a reciprocal */
+static uint8_t nat_reciprocal(big_nat_t* result, const big_nat_t* divisor, int64_t bits);  /* A function used to calculate a reciprocal */
+static uint8_t nat_rsqrt(big_nat_t* result, const big_nat_t* a, int64_t bits);            /* A function used to calculate a reciprocal square root */
+static uint8_t nat_sqrt(big_nat_t* root, big_nat_t* remainder, const big_nat_t* a);        /* A function used to calculate an integer square root */
+static uint8_t nat_shl(big_nat_t* result, const big_nat_t* a, int64_t bits);                /* A function used to shift a natural number left */
+static uint8_t nat_shr(big_nat_t* result, const big_nat_t* a, int64_t bits);                /* A function used to shift a natural number right */
+static uint8_t nat_pow(big_nat_t* result, const big_nat_t* base, uint64_t exponent);        /* A function used to raise a natural number to a power */
+static uint8_t nat_pow10(big_nat_t* result, uint64_t exponent);                             /* A function used to calculate a power of 10 */
+static uint8_t nat_product(big_nat_t* result, uint32_t low, uint32_t high);                 /* A function used to multiply a range of integers */
+static uint8_t nat_to_chunks(const big_nat_t* x, const big_nat_t* powers, size_t level, big_limb_t* chunks);   /* A function used to split a natural number into decimal chunks */
+static char* nat_to_decimal(const big_nat_t* x);                                            /* A function used to print a natural number in decimal */
+
+static void big_free(big_value_t* x);                                                       /* A function used to free the magnitude of a value */
+static uint8_t big_copy(big_value_t* x, const big_value_t* value);                          /* A function used to copy a value */
+static void big_replace(big_value_t* x, big_value_t* value);                                /* A function used to move a value into another one */
+static uint8_t big_from_double(big_value_t* x, double value);                               /* A function used to convert a double exactly */
+static uint8_t big_from_literal(big_value_t* x, const calc_literal_t* literal, int64_t precision);   /* A function used to convert a decimal literal */
+static double big_to_double(const big_value_t* x);                                          /* A function used to round a value to a double */
+static uint8_t big_to_int64(const big_value_t* x, int64_t* value);                          /* A function used to get a value as a native integer */
+static double big_log2(const big_value_t* x);                                               /* A function used to estimate the binary logarithm of a magnitude */
+static int big_cmp(const big_value_t* a, const big_value_t* b);                             /* A function used to compare values */
+static uint8_t big_round(big_value_t* x, int64_t precision, uint8_t sticky);                /* A function used to round a value to a number of bits */
+static uint8_t big_finish(big_value_t* x, int64_t precision, uint8_t sticky);               /* A function used to round a result which is not an exact integer */
+static uint8_t big_add_aligned(big_value_t* result, const big_value_t* a, const big_value_t* b, uint8_t subtract);   /* A function used to add values of the same exponent */
+static uint8_t big_add(big_value_t* result, const big_value_t* a, const big_value_t* b, uint8_t subtract, int64_t precision);    /* A function used to add or subtract values */
+static uint8_t big_mul(big_value_t* result, const big_value_t* a, const big_value_t* b, int64_t precision);       /* A function used to multiply values */
+static uint8_t big_div(big_value_t* result, const big_value_t* a, const big_value_t* b, int64_t precision);       /* A function used to divide values */
+static uint8_t big_mod(big_value_t* result, const big_value_t* a, const big_value_t* b, int64_t precision);       /* A function used to calculate a division remainder */
+static uint8_t big_pow(big_value_t* result, const big_value_t* a, int64_t exponent, int64_t precision);           /* A function used to raise a value to an integer power */
+static uint8_t big_to_integer(big_value_t* x, calc_function_id_t fn);                       /* A function used to round a value to an integer */
+static int big_cmp_one(const big_value_t* x);                                               /* A function used to compare a magnitude with 1 */
+static uint8_t big_domain_contains(calc_domain_t domain, const big_value_t* x, const big_value_t* y);  /* A function used to check arguments against a domain */
+static uint8_t big_from_nat(big_value_t* x, big_nat_t* magnitude, int64_t exponent, uint8_t negative, int64_t precision);    /* A function used to make a value of a natural number */
+static uint8_t big_floor_scaled(big_nat_t* result, const big_value_t* x, int64_t bits);     /* A function used to get the integral part of a scaled value */
+static uint8_t big_sqrt(big_value_t* result, const big_value_t* x, int64_t precision);      /* A function used to calculate a square root */
+static uint64_t series_length(big_series_kind_t kind, double magnitude, int64_t precision); /* A function used to count the terms of a series */
+static uint8_t series_term(const big_series_t* series, uint64_t n, big_split_t* split);     /* A function used to set the products of a term */
+static uint8_t nat_add_signed(big_nat_t* result, uint8_t* negative, const big_nat_t* a, uint8_t a_negative, const big_nat_t* b,
+                              uint8_t b_negative);                                          /* A function used to add natural numbers with signs */
+static uint8_t series_split(const big_series_t* series, uint64_t low, uint64_t high, uint8_t need_p, big_split_t* split);   /* A function used to split a series */
+static uint8_t series_sum(const big_series_t* series, uint64_t terms, int64_t precision, big_value_t* numerator, big_value_t* denominator);   /* A function used to sum a series */
+static uint8_t big_constant(big_constants_t* constants, big_constant_t id, int64_t precision, big_value_t* value);     /* A function used to get a constant */
+static uint8_t big_exp_reduced(big_value_t* result, const big_value_t* x, int64_t precision);  /* A function used to calculate e^x of a small argument */
+static uint8_t big_exp(big_value_t* result, const big_value_t* x, int64_t precision, big_constants_t* constants);     /* A function used to calculate e^x */
+static uint8_t big_ln_newton(big_value_t* result, const big_value_t* x, int64_t precision, big_constants_t* constants);   /* A function used to calculate ln(x) by Newton's iteration */
+static uint8_t big_ln_agm(big_value_t* result, const big_value_t* x, int64_t precision, big_constants_t* constants);  /* A function used to calculate ln(x) by the arithmetic-geometric mean */
+static uint8_t big_ln(big_value_t* result, const big_value_t* x, int64_t precision, big_constants_t* constants);      /* A function used to calculate ln(x) */
+static uint8_t big_power(big_value_t* result, const big_value_t* x, const big_value_t* y, int64_t precision,
+                         big_constants_t* constants);                                                           /* A function used to calculate x^y of a fraction y */
+static uint8_t big_gamma(big_value_t* result, const big_value_t* x, int64_t precision, big_constants_t* constants,
+                         calc_error_code_t* code);                                          /* A function used to calculate the factorial of a fraction */
+static uint8_t big_atan_reduced(big_value_t* result, const big_value_t* x, int64_t precision); /* A function used to calculate atan(x) of a small argument */
+static uint8_t big_atan(big_value_t* result, const big_value_t* x, int64_t precision, big_constants_t* constants);    /* A function used to calculate atan(x) */
+static uint8_t big_sincos_reduced(big_value_t* sine, big_value_t* cosine, const big_value_t* x, int64_t precision);   /* A function used to calculate sin(x) and cos(x) of a small argument */
+static uint8_t big_sincos(big_value_t* sine, big_value_t* cosine, const big_value_t* x, int64_t precision, big_constants_t* constants);  /* A function used to calculate sin(x) and cos(x) */
+static uint8_t big_call(calc_function_id_t fn, const big_value_t* x, const big_value_t* y, int64_t precision, big_constants_t* constants,
+                        big_value_t* value);                                                /* A function used to calculate a math function */
+static char* big_format(const big_value_t* x, size_t digits);                               /* A function used to print a value */
+static uint8_t apply_big(const calc_expr_t* expr, const calc_node_t* node, const big_value_t* x, const big_value_t* y, const double* vars,
+                         const calc_function_t* functions, int64_t precision, big_constants_t* constants, big_value_t* value,
+                         calc_error_code_t* code);                                          /* A function used to calculate a node */
+
+/**
+ * \brief           A function used to evaluate an expression with arbitrary precision
+ * \param[in]       expr: A compiled expression
+ * \param[in]       vars: Values of the variables, NULL if the expression has none
+ * \param[in]       digits: A number of significant digits of a fractional result, at least 1
+ * \param[out]      error: An error report, may be NULL
+ * \return          The result printed in decimal, to be freed with free, NULL in case of an error
+ * \note            Integers are exact however large they grow, up to 2^(2^25). Other values are binary floats rounded
+ *                  to the digits asked for and 64 more bits, and are printed rounded to the digits.
+ *                  The operations and math functions are calculated with arbitrary precision, except the powers of a negative
+ *                  base with a fractional exponent and the operations which give an infinity or NaN, which are calculated in double
+ *                  precision. fact of a fraction whose series would be too long is reported as invalid input. pi, e and ln(2) are calculated once per evaluation, when a function first needs them.
+ *                  Calls calculated with arbitrary precision are not counted by the function profile.
+ */
+char*
+calc_eval_big(const calc_expr_t* expr, const double* vars, size_t digits, calc_error_t* error) {
+    big_value_t* values = NULL;
+    big_constants_t constants = {0};
+    calc_error_code_t code = CALC_OK;
+    char* text = NULL;
+
+    if (expr == NULL || expr->node_count == 0) {
+        code = CALC_ERROR_UNKNOWN;
+    } else if ((expr->var_count > 0 && vars == NULL) || digits == 0 || digits > CALC_BIG_MAX_DIGITS) {
+        code = CALC_ERROR_INVALID_INPUT;
+    } else if ((values = (big_value_t*)calloc(expr->node_count, sizeof(big_value_t))) == NULL) {
+        code = CALC_ERROR_FAILED_TO_ALLOCATE_MEMORY;
+    } else {
+        const calc_function_t* functions = atomic_load_explicit(&calc_dispatch, memory_order_acquire);
+        int64_t precision = (int64_t)ceil((double)digits * 3.321928094887362) + CALC_BIG_GUARD_BITS;    /* log2(10) bits per digit */
+        for (size_t i = 0; code == CALC_OK && i < expr->node_count; ++i) {     /* Loop through all nodes in postfix order */
+            const calc_node_t* node = &expr->nodes[i];
+            const big_value_t* x = node->op > CALC_OP_VAR ? &values[node->a] : NULL;
+            const big_value_t* y = node->op > CALC_OP_VAR && node->b >= 0 ? &values[node->b] : NULL;
+            if (!apply_big(expr, node, x, y, vars, functions, precision, &constants, &values[i], &code) && code == CALC_OK) {
+                code = CALC_ERROR_FAILED_TO_ALLOCATE_MEMORY;
+            }
+        }
+        if (code == CALC_OK && (text = big_format(&values[expr->node_count - 1], digits)) == NULL) {   /* The last node is the root */
+            code = CALC_ERROR_FAILED_TO_ALLOCATE_MEMORY;
+        }
+        for (size_t i = 0; i < expr->node_count; ++i) {
+            big_free(&values[i]);
+        }
+        for (size_t i = 0; i < BIG_CONSTANT_COUNT; ++i) {
+            big_free(&constants.values[i]);
+        }
+        free(values);
+    }
+    if (error != NULL) {
+        error->code = code;
+        error->position = 0;
+    }
+    return text;
+}
+
+/**
+ * \brief           A function used to calculate the value of a node with arbitrary precision
+ * \param[in]       expr: The expression
+ * \param[in]       node: The node
+ * \param[in]       x: Value of the first operand, NULL if there is none
+ * \param[in]       y: Value of the second operand, NULL if there is none
+ * \param[in]       vars: Values of the variables
+ * \param[in]       functions: The registry to dispatch the calls calculated in double precision through
+ * \param[in]       precision: Bits of a fraction
+ * \param[in,out]   constants: The constants calculated so far
+ * \param[out]      value: The value of the node, initially zero
+ * \param[out]      code: Set to an error code if the operation fails
+ * \return          1 on success, 0 if memory cannot be allocated
+ */
+static uint8_t
+apply_big(const calc_expr_t* expr, const calc_node_t* node, const big_value_t* x, const big_value_t* y, const double* vars,
+          const calc_function_t* functions, int64_t precision, big_constants_t* constants, big_value_t* value, calc_error_code_t* code) {
+    int64_t exponent;
+    if (node->op == CALC_OP_CONST) {
+        return big_from_literal(value, &expr->literals[node->a], precision);
+    } else if (node->op == CALC_OP_VAR) {
+        return big_from_double(value, vars[node->a]);
+    } else if (node->op == CALC_OP_GUARD) {
+        return big_copy(value, x);
+    } else if (x->is_special || (y != NULL && y->is_special)) {
+        /* An infinity or NaN is calculated in double precision */
+    } else {
+        switch (node->op) {
+            case CALC_OP_NEG:
+                if (!big_copy(value, x)) {
+                    return 0;
+                }
+                value->negative = !value->negative;
+                return 1;
+            case CALC_OP_ADD:
+            case CALC_OP_SUB:
+                return big_add(value, x, y, node->op == CALC_OP_SUB, precision);
+            case CALC_OP_MUL:
+                return big_mul(value, x, y, precision);
+            case CALC_OP_DIV:
+                if (y->magnitude.size > 0) {    /* A division by zero gives an infinity or NaN */
+                    return big_div(value, x, y, precision);
+                }
+                break;
+            case CALC_OP_MOD:
+                if (y->magnitude.size > 0) {
+                    return big_mod(value, x, y, precision);
+                }
+                break;
+            case CALC_OP_POW:
+                if (big_to_int64(y, &exponent) && (exponent >= 0 || x->magnitude.size > 0)) {
+                    return big_pow(value, x, exponent, precision);
+                } else if (!x->negative && x->magnitude.size > 0) {
+                    return big_power(value, x, y, precision, constants);
+                }
+                break;                          /* A fractional exponent of a negative base or zero */
+            case CALC_OP_POWI:
+                if (node->value >= 0 || x->magnitude.size > 0) {
+                    return big_pow(value, x, (int64_t)node->value, precision);
+                }
+                break;
+            case CALC_OP_CALL:
+                if (!big_domain_contains(calc_functions[node->fn].domain, x, y)) {
+                    *code = CALC_ERROR_UNDEFINED_FUNCTION;
+                    return 1;
+                }
+                switch (node->fn) {
+                    case CALC_FN_FABS:
+                        if (!big_copy(value, x)) {
+                            return 0;
+                        }
+                        value->negative = 0;
+                        return 1;
+                    case CALC_FN_SIGN:
+                        value->is_integer = 1;
+                        value->negative = x->negative && x->magnitude.size > 0;
+                        return nat_set_u64(&value->magnitude, x->magnitude.size > 0);
+                    case CALC_FN_CEIL:
+                    case CALC_FN_FLOOR:
+                    case CALC_FN_ROUND:
+                    case CALC_FN_TRUNC:
+                        return big_copy(value, x) && big_to_integer(value, (calc_function_id_t)node->fn);
+                    case CALC_FN_MIN:
+                        return big_copy(value, big_cmp(y, x) < 0 ? y : x);
+                    case CALC_FN_MAX:
+                        return big_copy(value, big_cmp(y, x) > 0 ? y : x);
+                    case CALC_FN_FACT:
+                        if (big_to_int64(x, &exponent) && exponent <= CALC_BIG_FACT_MAX) {
+                            value->is_integer = 1;
+                            return nat_product(&value->magnitude, 1, exponent > 1 ? (uint32_t)exponent : 1);
+                        } else if (!x->is_integer) {
+                            return big_gamma(value, x, precision, constants, code);
+                        }
+                        break;                  /* An infinity for a huge integer */
+                    default:
+                        return big_call((calc_function_id_t)node->fn, x, y, precision, constants, value);
+                }
+                break;
+            default:
+                break;
+        }
+    }
+    return big_from_double(value, calc_apply_node(node, x != NULL ? big_to_double(x) : 0, y != NULL ? big_to_double(y) : 0,
+                                                  vars, functions, code));
+}
+
+/**
+ * \brief           A function used to add limbs
+ * \param[out]      result: The sum without the carry, \ref a_size limbs, may be \ref a
+ * \param[in]       a: The first addend
+ * \param[in]       a_size: A number of limbs of the first addend
+ * \param[in]       b: The second addend
+ * \param[in]       b_size: A number of limbs of the second addend, at most \ref a_size
+ * \return          The carry out of the most significant limb
+ */
+static big_limb_t
+limbs_add(big_limb_t* result, const big_limb_t* a, size_t a_size, const big_limb_t* b, size_t b_size) {
+    uint64_t carry = 0;
+    size_t i = 0;
+    for (; i < b_size; ++i) {
+        carry += (uint64_t)a[i] + b[i];
+        result[i] = (big_limb_t)carry;
+        carry >>= 32;
+    }
+    for (; i < a_size; ++i) {
+        carry += a[i];
+        result[i] = (big_limb_t)carry;
+        carry >>= 32;
+    }
+    return (big_limb_t)carry;
+}
+
+/**
+ * \brief           A function used to subtract limbs
+ * \param[out]      result: The difference, \ref a_size limbs, may be \ref a
+ * \param[in]       a: The minuend
+ * \param[in]       a_size: A number of limbs of the minuend
+ * \param[in]       b: The subtrahend
+ * \param[in]       b_size: A number of limbs of the subtrahend, at most \ref a_size
+ * \return          The borrow out of the most significant limb
+ */
+static big_limb_t
+limbs_sub(big_limb_t* result, const big_limb_t* a, size_t a_size, const big_limb_t* b, size_t b_size) {
+    uint64_t borrow = 0;
+    size_t i = 0;
+    for (; i < b_size; ++i) {
+        uint64_t difference = (uint64_t)a[i] - b[i] - borrow;
+        result[i] = (big_limb_t)difference;
+        borrow = difference >> 63;              /* A wrapped difference has the top bit set */
+    }
+    for (; i < a_size; ++i) {
+        uint64_t difference = (uint64_t)a[i] - borrow;
+        result[i] = (big_limb_t)difference;
+        borrow = difference >> 63;
+    }
+    return (big_limb_t)borrow;
+}
+
+/**
+ * \brief           A function used to add limbs into a longer number at an offset
+ * \param[in,out]   result: The number to add to
+ * \param[in]       size: A number of limbs of the number
+ * \param[in]       offset: An offset, in limbs, of the addend
+ * \param[in]       a: The addend
+ * \param[in]       a_size: A number of limbs of the addend, its leading zeros do not have to fit
+ * \note            The sum has to fit into the number
+ */
+static void
+limbs_add_at(big_limb_t* result, size_t size, size_t offset, const big_limb_t* a, size_t a_size) {
+    while (a_size > 0 && a[a_size - 1] == 0) {
+        --a_size;
+    }
+    if (a_size > 0 && limbs_add(result + offset, result + offset, a_size, a, a_size)) {
+        for (size_t i = offset + a_size; i < size && ++result[i] == 0; ++i) {}     /* Propagate the carry */
+    }
+}
+
+/**
+ * \brief           A function used to multiply limbs, choosing the method by the size of the operands
+ * \param[out]      result: The product, \ref a_size + \ref b_size limbs, not overlapping the operands
+ * \param[in]       a: The first factor
+ * \param[in]       a_size: A number of limbs of the first factor, at least 1
+ * \param[in]       b: The second factor
+ * \param[in]       b_size: A number of limbs of the second factor, at least 1
+ * \return          1 on success, 0 if memory cannot be allocated
+ * \note            The schoolbook method takes O(n^2), Karatsuba O(n^1.58), Toom-3 O(n^1.46) and the transform O(n log n)
+ *                  operations, so each one takes over from the previous one at its threshold. A factor much shorter than
+ *                  the other one is multiplied by chunks of the other one of its own size.
+ */
+static uint8_t
+limbs_mul(big_limb_t* result, const big_limb_t* a, size_t a_size, const big_limb_t* b, size_t b_size) {
+    if (a_size < b_size) {                      /* The first factor is the longer one */
+        const big_limb_t* limbs = a;
+        size_t size = a_size;
+        a = b;
+        a_size = b_size;
+        b = limbs;
+        b_size = size;
+    }
+    if (b_size < CALC_BIG_KARATSUBA_LIMBS) {
+        limbs_mul_schoolbook(result, a, a_size, b, b_size);
+        return 1;
+    } else if (b_size <= (a_size + 1) / 2) {    /* Too unbalanced to split both factors at the same point */
+        return limbs_mul_chunks(result, a, a_size, b, b_size);
+    }
+#ifdef __SIZEOF_INT128__
+    if (b_size >= CALC_BIG_NTT_LIMBS) {
+        return limbs_mul_ntt(result, a, a_size, b, b_size);
+    }
+#endif /* __SIZEOF_INT128__ */
+    if (b_size >= CALC_BIG_TOOM3_LIMBS && b_size > 2 * ((a_size + 2) / 3)) {
+        return limbs_mul_toom3(result, a, a_size, b, b_size);
+    }
+    return limbs_mul_karatsuba(result, a, a_size, b, b_size);
+}
+
+/**
+ * \brief           A function used to multiply limbs by the schoolbook method
+ * \param[out]      result: The product, \ref a_size + \ref b_size limbs
+ * \param[in]       a: The first factor
+ * \param[in]       a_size: A number of limbs of the first factor
+ * \param[in]       b: The second factor
+ * \param[in]       b_size: A number of limbs of the second factor
+ */
+static void
+limbs_mul_schoolbook(big_limb_t* result, const big_limb_t* a, size_t a_size, const big_limb_t* b, size_t b_size) {
+    memset(result, 0, (a_size + b_size) * sizeof(big_limb_t));
+    for (size_t j = 0; j < b_size; ++j) {       /* Loop through the limbs of the second factor */
+        uint64_t carry = 0, factor = b[j];
+        if (factor == 0) {
+            continue;
+        }
+        for (size_t i = 0; i < a_size; ++i) {   /* At most (2^32 - 1)^2 + 2 (2^32 - 1), which fits into 64 bits */
+            carry += a[i] * factor + result[i + j];
+            result[i + j] = (big_limb_t)carry;
+            carry >>= 32;
+        }
+        result[a_size + j] = (big_limb_t)carry;
+    }
+}
+
+/**
+ * \brief           A function used to multiply limbs of unbalanced sizes
+ * \param[out]      result: The product, \ref a_size + \ref b_size limbs
+ * \param[in]       a: The longer factor
+ * \param[in]       a_size: A number of limbs of the longer factor
+ * \param[in]       b: The shorter factor
+ * \param[in]       b_size: A number of limbs of the shorter factor
+ * \return          1 on success, 0 if memory cannot be allocated
+ * \note            The longer factor is cut into chunks of the size of the shorter one, so every product is balanced
+ */
+static uint8_t
+limbs_mul_chunks(big_limb_t* result, const big_limb_t* a, size_t a_size, const big_limb_t* b, size_t b_size) {
+    big_limb_t* product = (big_limb_t*)malloc(2 * b_size * sizeof(big_limb_t));
+    uint8_t ok = product != NULL;
+    memset(result, 0, (a_size + b_size) * sizeof(big_limb_t));
+    for (size_t i = 0; ok && i < a_size; i += b_size) {    /* Loop through the chunks */
+        size_t size = a_size - i < b_size ? a_size - i : b_size;
+        ok = limbs_mul(product, b, b_size, a + i, size);
+        if (ok) {
+            limbs_add_at(result, a_size + b_size, i, product, size + b_size);
+        }
+    }
+    free(product);
+    return ok;
+}
+
+/**
+ * \brief           A function used to multiply limbs by Karatsuba
+ * \param[out]      result: The product, \ref a_size + \ref b_size limbs
+ * \param[in]       a: The first factor
+ * \param[in]       a_size: A number of limbs of the first factor
+ * \param[in]       b: The second factor
+ * \param[in]       b_size: A number of limbs of the second factor, more than a half of \ref a_size
+ * \return          1 on success, 0 if memory cannot be allocated
+ * \note            With a = a1 B + a0 and b = b1 B + b0, the product is a1 b1 B^2 + ((a0 + a1)(b0 + b1) - a0 b0 - a1 b1) B + a0 b0,
+ *                  three half-size products instead of four
+ */
+static uint8_t
+limbs_mul_karatsuba(big_limb_t* result, const big_limb_t* a, size_t a_size, const big_limb_t* b, size_t b_size) {
+    size_t half = (a_size + 1) / 2;             /* Limbs of the low halves */
+    size_t size = half + 1;                     /* Limbs of the sums of the halves */
+    big_limb_t* sums = (big_limb_t*)malloc(4 * size * sizeof(big_limb_t));
+    big_limb_t* middle;                         /* The product of the sums */
+    uint8_t ok;
+    if (sums == NULL) {
+        return 0;
+    }
+    middle = sums + 2 * size;
+    sums[half] = limbs_add(sums, a, half, a + half, a_size - half);
+    sums[size + half] = limbs_add(sums + size, b, half, b + half, b_size - half);
+    ok = limbs_mul(result, a, half, b, half)    /* a0 b0 at the bottom, a1 b1 at the top of the result */
+        && limbs_mul(result + 2 * half, a + half, a_size - half, b + half, b_size - half)
+        && limbs_mul(middle, sums, size, sums + size, size);
+    if (ok) {
+        limbs_sub(middle, middle, 2 * size, result, 2 * half);
+        limbs_sub(middle, middle, 2 * size, result + 2 * half, a_size + b_size - 2 * half);
+        limbs_add_at(result, a_size + b_size, half, middle, 2 * size);
+    }
+    free(sums);
+    return ok;
+}
+
+/**
+ * \brief           A function used to evaluate a third of a factor at the points of Toom-3
+ * \param[out]      points: Values at 0, 1, -1, -2 and infinity, initially zero
+ * \param[in]       x: The factor
+ * \param[in]       size: A number of limbs of the factor
+ * \param[in]       third: Limbs of the lower two thirds, the top third has the rest
+ * \return          1 on success, 0 if memory cannot be allocated
+ */
+static uint8_t
+toom3_evaluate(big_value_t* points, const big_limb_t* x, size_t size, size_t third) {
+    big_value_t sum = {0};                      /* x0 + x2 */
+    uint8_t ok = nat_set(&points[0].magnitude, x, third)                    /* p(0) = x0 */
+        && nat_set(&points[4].magnitude, x + 2 * third, size - 2 * third)   /* p(inf) = x2 */
+        && nat_set(&points[1].magnitude, x + third, third)                  /* x1 for now */
+        && big_add_aligned(&sum, &points[0], &points[4], 0)
+        && big_add_aligned(&points[2], &sum, &points[1], 1)                 /* p(-1) = x0 - x1 + x2 */
+        && big_add_aligned(&points[1], &sum, &points[1], 0)                 /* p(1) = x0 + x1 + x2 */
+        && big_add_aligned(&sum, &points[2], &points[4], 0)
+        && nat_shl(&sum.magnitude, &sum.magnitude, 1)
+        && big_add_aligned(&points[3], &sum, &points[0], 1);                /* p(-2) = 2 (p(-1) + x2) - x0 */
+    big_free(&sum);
+    return ok;
+}
+
+/**
+ * \brief           A function used to multiply limbs by Toom-3
+ * \param[out]      result: The product, \ref a_size + \ref b_size limbs
+ * \param[in]       a: The first factor
+ * \param[in]       a_size: A number of limbs of the first factor
+ * \param[in]       b: The second factor
+ * \param[in]       b_size: A number of limbs of the second factor, more than two thirds of \ref a_size
+ * \return          1 on success, 0 if memory cannot be allocated
+ * \note            The factors are cut into thirds, taken as polynomials of degree 2 and evaluated at 0, 1, -1, -2 and infinity.
+ *                  Five products of the values give the product polynomial back by Bodrato's interpolation.
+ */
+static uint8_t
+limbs_mul_toom3(big_limb_t* result, const big_limb_t* a, size_t a_size, const big_limb_t* b, size_t b_size) {
+    size_t third = (a_size + 2) / 3;
+    big_value_t p[5] = {0}, q[5] = {0}, w[5] = {0}, twice = {0};
+    uint8_t ok = toom3_evaluate(p, a, a_size, third) && toom3_evaluate(q, b, b_size, third);
+    for (size_t i = 0; ok && i < 5; ++i) {      /* The products at the points */
+        ok = nat_mul(&w[i].magnitude, &p[i].magnitude, &q[i].magnitude);
+        w[i].negative = p[i].negative != q[i].negative;
+    }
+    ok = ok && big_add_aligned(&w[3], &w[3], &w[1], 1);         /* r3 = (r(-2) - r(1)) / 3 */
+    if (ok) {
+        nat_div_small(&w[3].magnitude, 3);
+    }
+    ok = ok && big_add_aligned(&w[1], &w[1], &w[2], 1)          /* r1 = (r(1) - r(-1)) / 2 */
+        && nat_shr(&w[1].magnitude, &w[1].magnitude, 1)
+        && big_add_aligned(&w[2], &w[2], &w[0], 1)              /* r2 = r(-1) - r(0) */
+        && big_add_aligned(&w[3], &w[2], &w[3], 1)              /* r3 = (r2 - r3) / 2 + 2 r(inf) */
+        && nat_shr(&w[3].magnitude, &w[3].magnitude, 1)
+        && nat_shl(&twice.magnitude, &w[4].magnitude, 1)
+        && big_add_aligned(&w[3], &w[3], &twice, 0)
+        && big_add_aligned(&w[2], &w[2], &w[1], 0)              /* r2 = r2 + r1 - r(inf) */
+        && big_add_aligned(&w[2], &w[2], &w[4], 1)
+        && big_add_aligned(&w[1], &w[1], &w[3], 1);             /* r1 = r1 - r3 */
+    if (ok) {
+        memset(result, 0, (a_size + b_size) * sizeof(big_limb_t));
+        for (size_t i = 0; i < 5; ++i) {        /* The coefficients are not negative */
+            limbs_add_at(result, a_size + b_size, i * third, w[i].magnitude.limbs, w[i].magnitude.size);
+        }
+    }
+    for (size_t i = 0; i < 5; ++i) {
+        big_free(&p[i]);
+        big_free(&q[i]);
+        big_free(&w[i]);
+    }
+    big_free(&twice);
+    return ok;
+}
+
+#ifdef __SIZEOF_INT128__
+#define CALC_BIG_NTT_PRIME 0xFFFFFFFF00000001ull    /*!< 2^64 - 2^32 + 1, whose group of units has roots of unity of every order up to 2^32 */
+#define CALC_BIG_NTT_GENERATOR 7                    /*!< A generator of the group of units */
+
+/**
+ * \brief           A function used to reduce a product modulo \ref CALC_BIG_NTT_PRIME
+ * \param[in]       x: The product
+ * \return          The remainder
+ * \note            2^64 is 2^32 - 1 and 2^96 is -1 modulo the prime, so no division is needed
+ */
+static inline uint64_t
+ntt_reduce(unsigned __int128 x) {
+    uint64_t low = (uint64_t)x, high = (uint64_t)(x >> 64);
+    uint64_t high_low = high & 0xFFFFFFFFu, high_high = high >> 32;
+    uint64_t result = low - high_high;          /* low - high_high 2^96 */
+    uint64_t product = high_low * 0xFFFFFFFFu;  /* high_low 2^64 */
+    if (low < high_high) {
+        result -= 0xFFFFFFFFu;                  /* Take 2^64 back */
+    }
+    result += product;
+    if (result < product) {
+        result += 0xFFFFFFFFu;                  /* Add the 2^64 carried out */
+    }
+    return result >= CALC_BIG_NTT_PRIME ? result - CALC_BIG_NTT_PRIME : result;
+}
+
+/**
+ * \brief           A function used to multiply modulo \ref CALC_BIG_NTT_PRIME
+ * \param[in]       a: The first factor
+ * \param[in]       b: The second factor
+ * \return          The product
+ */
+static inline uint64_t
+ntt_mul(uint64_t a, uint64_t b) {
+    return ntt_reduce((unsigned __int128)a * b);
+}
+
+/**
+ * \brief           A function used to raise to a power modulo \ref CALC_BIG_NTT_PRIME
+ * \param[in]       base: The base
+ * \param[in]       exponent: The exponent
+ * \return          The power
+ */
+static uint64_t
+ntt_pow(uint64_t base, uint64_t exponent) {
+    uint64_t result = 1;
+    for (; exponent > 0; exponent >>= 1) {
+        if (exponent & 1) {
+            result = ntt_mul(result, base);
+        }
+        base = ntt_mul(base, base);
+    }
+    return result;
+}
+
+/**
+ * \brief           A function used to calculate the number theoretic transform in place
+ * \param[in,out]   data: The values, \ref size of them
+ * \param[in]       roots: Powers 0 to \ref size / 2 - 1 of a root of unity of order \ref size
+ * \param[in]       size: A power of 2
+ */
+static void
+ntt_transform(uint64_t* data, const uint64_t* roots, size_t size) {
+    for (size_t i = 1, j = 0; i < size; ++i) {  /* Put the values in the bit reversed order */
+        size_t bit = size >> 1;
+        for (; j & bit; bit >>= 1) {
+            j ^= bit;
+        }
+        j ^= bit;
+        if (i < j) {
+            uint64_t value = data[i];
+            data[i] = data[j];
+            data[j] = value;
+        }
+    }
+    for (size_t length = 2; length <= size; length <<= 1) {    /* Butterflies of growing length */
+        size_t half = length / 2, stride = size / length;
+        for (size_t i = 0; i < size; i += length) {
+            for (size_t j = 0; j < half; ++j) {
+                uint64_t u = data[i + j], v = ntt_mul(data[i + j + half], roots[j * stride]);
+                uint64_t sum = u + v, difference = u - v;
+                if (sum < u) {
+                    sum += 0xFFFFFFFFu;         /* 2^64 is 2^32 - 1 modulo the prime */
+                }
+                data[i + j] = sum >= CALC_BIG_NTT_PRIME ? sum - CALC_BIG_NTT_PRIME : sum;
+                data[i + j + half] = u < v ? difference - 0xFFFFFFFFu : difference;
+            }
+        }
+    }
+}
+
+/**
+ * \brief           A function used to multiply limbs by the number theoretic transform
+ * \param[out]      result: The product, \ref a_size + \ref b_size limbs
+ * \param[in]       a: The first factor
+ * \param[in]       a_size: A number of limbs of the first factor
+ * \param[in]       b: The second factor
+ * \param[in]       b_size: A number of limbs of the second factor
+ * \return          1 on success, 0 if memory cannot be allocated
+ * \note            The factors are cut into 16-bit pieces, so a coefficient of the cyclic convolution, a sum of at most 2^32
+ *                  products below 2^32, is below the prime and is recovered exactly. A transform of a power of 2 up to 2^32
+ *                  values is exact modulo the prime, so no rounding can go wrong, unlike with a floating-point FFT.
+ */
+static uint8_t
+limbs_mul_ntt(big_limb_t* result, const big_limb_t* a, size_t a_size, const big_limb_t* b, size_t b_size) {
+    size_t pieces = 2 * (a_size + b_size), size = 1;
+    uint64_t *fa, *fb, *roots, root, scale;
+    unsigned __int128 carry = 0;
+    uint8_t square = a == b && a_size == b_size;
+    while (size < pieces) {
+        size <<= 1;
+    }
+    fa = (uint64_t*)calloc(size, sizeof(uint64_t));
+    fb = square ? fa : (uint64_t*)calloc(size, sizeof(uint64_t));  /* A square needs one forward transform */
+    roots = (uint64_t*)malloc(size / 2 * sizeof(uint64_t));
+    if (fa == NULL || fb == NULL || roots == NULL) {
+        free(fa);
+        if (!square) {
+            free(fb);
+        }
+        free(roots);
+        return 0;
+    }
+    for (size_t i = 0; i < a_size; ++i) {
+        fa[2 * i] = a[i] & 0xFFFFu;
+        fa[2 * i + 1] = a[i] >> 16;
+    }
+    for (size_t i = 0; !square && i < b_size; ++i) {
+        fb[2 * i] = b[i] & 0xFFFFu;
+        fb[2 * i + 1] = b[i] >> 16;
+    }
+    root = ntt_pow(CALC_BIG_NTT_GENERATOR, (CALC_BIG_NTT_PRIME - 1) / size);
+    roots[0] = 1;
+    for (size_t i = 1; i < size / 2; ++i) {
+        roots[i] = ntt_mul(roots[i - 1], root);
+    }
+    ntt_transform(fa, roots, size);
+    if (!square) {
+        ntt_transform(fb, roots, size);
+    }
+    for (size_t i = 0; i < size; ++i) {         /* A convolution is a product of the transforms */
+        fa[i] = ntt_mul(fa[i], fb[i]);
+    }
+    root = ntt_pow(root, CALC_BIG_NTT_PRIME - 2);                   /* The inverse transform uses the inverse root */
+    for (size_t i = 1; i < size / 2; ++i) {
+        roots[i] = ntt_mul(roots[i - 1], root);
+    }
+    ntt_transform(fa, roots, size);
+    scale = ntt_pow(size, CALC_BIG_NTT_PRIME - 2);                  /* and divides by the size */
+    for (size_t i = 0; i < pieces; i += 2) {    /* Propagate the carries of the coefficients */
+        uint64_t low;
+        carry += ntt_mul(fa[i], scale);
+        low = (uint64_t)(carry & 0xFFFFu);
+        carry >>= 16;
+        carry += ntt_mul(fa[i + 1], scale);
+        result[i / 2] = (big_limb_t)(low | (uint64_t)(carry & 0xFFFFu) << 16);
+        carry >>= 16;
+    }
+    free(fa);
+    if (!square) {
+        free(fb);
+    }
+    free(roots);
+    return 1;
+}
+#endif /* __SIZEOF_INT128__ */
+
+/**
+ * \brief           A function used to grow the limbs of a natural number
+ * \param[in,out]   x: The number
+ * \param[in]       capacity: A number of limbs needed
+ * \return          1 on success, 0 if memory cannot be allocated
+ */
+static uint8_t
+nat_reserve(big_nat_t* x, size_t capacity) {
+    if (capacity > x->capacity) {
+        big_limb_t* limbs = (big_limb_t*)realloc(x->limbs, capacity * sizeof(big_limb_t));
+        if (limbs == NULL) {
+            return 0;
+        }
+        x->limbs = limbs;
+        x->capacity = capacity;
+    }
+    return 1;
+}
+
+/**
+ * \brief           A function used to drop leading zero limbs
+ * \param[in,out]   x: The number
+ */
+static void
+nat_trim(big_nat_t* x) {
+    while (x->size > 0 && x->limbs[x->size - 1] == 0) {
+        --x->size;
+    }
+}
+
+/**
+ * \brief           A function used to move a natural number into another one
+ * \param[in,out]   x: The number to replace, its limbs are freed
+ * \param[in,out]   value: The new value, left empty
+ */
+static void
+nat_replace(big_nat_t* x, big_nat_t* value) {
+    free(x->limbs);
+    *x = *value;
+    value->limbs = NULL;
+    value->size = value->capacity = 0;
+}
+
+/**
+ * \brief           A function used to copy limbs into a natural number
+ * \param[out]      x: The number
+ * \param[in]       limbs: The limbs, may be ones of the number
+ * \param[in]       size: A number of limbs, leading zeros are dropped
+ * \return          1 on success, 0 if memory cannot be allocated
+ */
+static uint8_t
+nat_set(big_nat_t* x, const big_limb_t* limbs, size_t size) {
+    if (limbs != x->limbs) {
+        if (!nat_reserve(x, size)) {
+            return 0;
+        }
+        if (size > 0) {
+            memcpy(x->limbs, limbs, size * sizeof(big_limb_t));
+        }
+    }
+    x->size = size;
+    nat_trim(x);
+    return 1;
+}
+
+/**
+ * \brief           A function used to set a natural number to a native integer
+ * \param[out]      x: The number
+ * \param[in]       value: The value
+ * \return          1 on success, 0 if memory cannot be allocated
+ */
+static uint8_t
+nat_set_u64(big_nat_t* x, uint64_t value) {
+    big_limb_t limbs[2] = {(big_limb_t)value, (big_limb_t)(value >> 32)};
+    return nat_set(x, limbs, 2);
+}
+
+/**
+ * \brief           A function used to get a number of significant bits of a natural number
+ * \param[in]       x: The number
+ * \return          A number of bits, 0 for zero
+ */
+static int64_t
+nat_bits(const big_nat_t* x) {
+    return x->size == 0 ? 0 : (int64_t)x->size * 32 - __builtin_clz(x->limbs[x->size - 1]);
+}
+
+/**
+ * \brief           A function used to read 64 bits of a natural number at a bit offset
+ * \param[in]       x: The number
+ * \param[in]       offset: The offset of the lowest bit, bits at negative offsets read as zeros
+ * \return          The bits
+ */
+static uint64_t
+nat_extract(const big_nat_t* x, int64_t offset) {
+    uint64_t result = 0;
+    int64_t first = offset >= 0 ? offset / 32 : -((31 - offset) / 32);     /* The limb of the lowest bit, rounded down */
+    for (int64_t i = first; i < first + 3; ++i) {
+        int64_t position = i * 32 - offset;     /* The position of the limb in the result */
+        uint64_t limb = i >= 0 && (size_t)i < x->size ? x->limbs[i] : 0;
+        if (position < 0 && position > -64) {
+            result |= limb >> -position;
+        } else if (position >= 0 && position < 64) {
+            result |= limb << position;
+        }
+    }
+    return result;
+}
+
+/**
+ * \brief           A function used to check if the low bits of a natural number are zero
+ * \param[in]       x: The number
+ * \param[in]       bits: A number of low bits
+ * \return          1 if all of them are zero, 0 otherwise
+ */
+static uint8_t
+nat_is_zero_below(const big_nat_t* x, int64_t bits) {
+    size_t limbs = (size_t)bits / 32;
+    if (bits <= 0) {
+        return 1;
+    }
+    for (size_t i = 0; i < limbs && i < x->size; ++i) {
+        if (x->limbs[i] != 0) {
+            return 0;
+        }
+    }
+    return limbs >= x->size || bits % 32 == 0 || (x->limbs[limbs] & ((1u << bits % 32) - 1)) == 0;
+}
+
+/**
+ * \brief           A function used to compare natural numbers
+ * \param[in]       a: The first number
+ * \param[in]       b: The second number
+ * \return          A negative value, zero or a positive value if the first number is less than, equal to or greater than the second one
+ */
+static int
+nat_cmp(const big_nat_t* a, const big_nat_t* b) {
+    if (a->size != b->size) {
+        return a->size < b->size ? -1 : 1;
+    }
+    for (size_t i = a->size; i-- > 0;) {
+        if (a->limbs[i] != b->limbs[i]) {
+            return a->limbs[i] < b->limbs[i] ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * \brief           A function used to add natural numbers
+ * \param[out]      result: The sum, may be one of the addends
+ * \param[in]       a: The first addend
+ * \param[in]       b: The second addend
+ * \return          1 on success, 0 if memory cannot be allocated
+ */
+static uint8_t
+nat_add(big_nat_t* result, const big_nat_t* a, const big_nat_t* b) {
+    big_nat_t sum = {0};
+    if (a->size < b->size) {
+        const big_nat_t* x = a;
+        a = b;
+        b = x;
+    }
+    if (!nat_reserve(&sum, a->size + 1)) {
+        return 0;
+    }
+    sum.limbs[a->size] = limbs_add(sum.limbs, a->limbs, a->size, b->limbs, b->size);
+    sum.size = a->size + 1;
+    nat_trim(&sum);
+    nat_replace(result, &sum);
+    return 1;
+}
+
+/**
+ * \brief           A function used to subtract a natural number from a greater or equal one
+ * \param[out]      result: The difference, may be one of the operands
+ * \param[in]       a: The minuend
+ * \param[in]       b: The subtrahend
+ * \return          1 on success, 0 if memory cannot be allocated
+ */
+static uint8_t
+nat_sub(big_nat_t* result, const big_nat_t* a, const big_nat_t* b) {
+    big_nat_t difference = {0};
+    if (!nat_reserve(&difference, a->size + 1)) {
+        return 0;
+    }
+    limbs_sub(difference.limbs, a->limbs, a->size, b->limbs, b->size);
+    difference.size = a->size;
+    nat_trim(&difference);
+    nat_replace(result, &difference);
+    return 1;
+}
+
+/**
+ * \brief           A function used to multiply natural numbers
+ * \param[out]      result: The product, may be one of the factors
+ * \param[in]       a: The first factor
+ * \param[in]       b: The second factor
+ * \return          1 on success, 0 if memory cannot be allocated
+ */
+static uint8_t
+nat_mul(big_nat_t* result, const big_nat_t* a, const big_nat_t* b) {
+    big_nat_t product = {0};
+    if (a->size > 0 && b->size > 0) {
+        if (!nat_reserve(&product, a->size + b->size) || !limbs_mul(product.limbs, a->limbs, a->size, b->limbs, b->size)) {
+            free(product.limbs);
+            return 0;
+        }
+        product.size = a->size + b->size;
+        nat_trim(&product);
+    }
+    nat_replace(result, &product);
+    return 1;
+}
+
+/**
+ * \brief           A function used to multiply a natural number by a limb and add a limb in place
+ * \param[in,out]   x: The number
+ * \param[in]       factor: The factor
+ * \param[in]       addend: The addend
+ * \return          1 on success, 0 if memory cannot be allocated
+ */
+static uint8_t
+nat_mul_small(big_nat_t* x, big_limb_t factor, big_limb_t addend) {
+    uint64_t carry = addend;
+    for (size_t i = 0; i < x->size; ++i) {
+        carry += (uint64_t)x->limbs[i] * factor;
+        x->limbs[i] = (big_limb_t)carry;
+        carry >>= 32;
+    }
+    if (carry > 0) {
+        if (!nat_reserve(x, x->size + 1)) {
+            return 0;
+        }
+        x->limbs[x->size++] = (big_limb_t)carry;
+    }
+    return 1;
+}
+
+/**
+ * \brief           A function used to divide a natural number by a limb in place
+ * \param[in,out]   x: The dividend, replaced by the quotient
+ * \param[in]       divisor: The divisor, not zero
+ * \return          The remainder
+ */
+static big_limb_t
+nat_div_small(big_nat_t* x, big_limb_t divisor) {
+    uint64_t remainder = 0;
+    for (size_t i = x->size; i-- > 0;) {
+        uint64_t current = remainder << 32 | x->limbs[i];
+        x->limbs[i] = (big_limb_t)(current / divisor);
+        remainder = current % divisor;
+    }
+    nat_trim(x);
+    return (big_limb_t)remainder;
+}
+
+/**
+ * \brief           A function used to divide natural numbers
+ * \param[out]      quotient: The quotient, may be NULL or one of the operands
+ * \param[out]      remainder: The remainder, may be NULL or one of the operands
+ * \param[in]       a: The dividend
+ * \param[in]       b: The divisor, not zero
+ * \return          1 on success, 0 if memory cannot be allocated
+ * \note            A long divisor and quotient are divided by a multiplication with a reciprocal, which costs a few
+ *                  multiplications instead of the quadratic time of the long division
+ */
+static uint8_t
+nat_divmod(big_nat_t* quotient, big_nat_t* remainder, const big_nat_t* a, const big_nat_t* b) {
+    if (b->size >= CALC_BIG_NEWTON_LIMBS && a->size >= b->size + CALC_BIG_NEWTON_LIMBS) {
+        return nat_divmod_newton(quotient, remainder, a, b);
+    }
+    return nat_divmod_knuth(quotient, remainder, a, b);
+}
+
+/**
+ * \brief           A function used to divide natural numbers by the long division
+ * \param[out]      quotient: The quotient, may be NULL or one of the operands
+ * \param[out]      remainder: The remainder, may be NULL or one of the operands
+ * \param[in]       a: The dividend
+ * \param[in]       b: The divisor, not zero
+ * \return          1 on success, 0 if memory cannot be allocated
+ * \note            Knuth's algorithm D: every limb of the quotient is estimated from the top two limbs of the remainder and
+ *                  the top limb of the divisor, which is normalized so that the estimate is at most 2 too large
+ */
+static uint8_t
+nat_divmod_knuth(big_nat_t* quotient, big_nat_t* remainder, const big_nat_t* a, const big_nat_t* b) {
+    big_nat_t q = {0}, r = {0};
+    size_t n = b->size, m = a->size;
+    if (nat_cmp(a, b) < 0) {
+        if (!nat_set(&r, a->limbs, a->size)) {
+            return 0;
+        }
+    } else if (n == 1) {
+        if (!nat_set(&q, a->limbs, a->size) || !nat_set_u64(&r, nat_div_small(&q, b->limbs[0]))) {
+            free(q.limbs);
+            return 0;
+        }
+    } else {
+        int shift = __builtin_clz(b->limbs[n - 1]);
+        big_limb_t* un = (big_limb_t*)malloc((m + 1 + n) * sizeof(big_limb_t));
+        big_limb_t* vn = un + m + 1;
+        if (un == NULL || !nat_reserve(&q, m - n + 1) || !nat_reserve(&r, n)) {
+            free(un);
+            free(q.limbs);
+            free(r.limbs);
+            return 0;
+        }
+        for (size_t i = n - 1; i > 0; --i) {    /* Normalize, so the top bit of the divisor is set */
+            vn[i] = b->limbs[i] << shift | (big_limb_t)((uint64_t)b->limbs[i - 1] >> (32 - shift));
+        }
+        vn[0] = b->limbs[0] << shift;
+        un[m] = (big_limb_t)((uint64_t)a->limbs[m - 1] >> (32 - shift));
+        for (size_t i = m - 1; i > 0; --i) {
+            un[i] = a->limbs[i] << shift | (big_limb_t)((uint64_t)a->limbs[i - 1] >> (32 - shift));
+        }
+        un[0] = a->limbs[0] << shift;
+        for (size_t j = m - n + 1; j-- > 0;) {  /* Loop through the limbs of the quotient from the top */
+            uint64_t numerator = (uint64_t)un[j + n] << 32 | un[j + n - 1];
+            uint64_t estimate = numerator / vn[n - 1], rest = numerator % vn[n - 1];
+            int64_t borrow = 0, t;
+            while (estimate > 0xFFFFFFFFu || estimate * vn[n - 2] > (rest << 32 | un[j + n - 2])) {
+                --estimate;
+                rest += vn[n - 1];
+                if (rest > 0xFFFFFFFFu) {
+                    break;
+                }
+            }
+            for (size_t i = 0; i < n; ++i) {    /* Multiply and subtract */
+                uint64_t product = estimate * vn[i];
+                t = (int64_t)un[i + j] - borrow - (int64_t)(product & 0xFFFFFFFFu);
+                un[i + j] = (big_limb_t)t;
+                borrow = (int64_t)(product >> 32) - (t >> 32);
+            }
+            t = (int64_t)un[j + n] - borrow;
+            un[j + n] = (big_limb_t)t;
+            if (t < 0) {                        /* The estimate was 1 too large, add the divisor back */
+                --estimate;
+                un[j + n] += limbs_add(un + j, un + j, n, vn, n);
+            }
+            q.limbs[j] = (big_limb_t)estimate;
+        }
+        for (size_t i = 0; i < n; ++i) {        /* Denormalize the remainder */
+            r.limbs[i] = (big_limb_t)(((uint64_t)un[i + 1] << 32 | un[i]) >> shift);
+        }
+        q.size = m - n + 1;
+        r.size = n;
+        nat_trim(&q);
+        nat_trim(&r);
+        free(un);
+    }
+    if (quotient != NULL) {
+        nat_replace(quotient, &q);
+    }
+    if (remainder != NULL) {
+        nat_replace(remainder, &r);
+    }
+    free(q.limbs);
+    free(r.limbs);
+    return 1;
+}
+
+/**
+ * \brief           A function used to divide natural numbers by a reciprocal
+ * \param[out]      quotient: The quotient, may be NULL or one of the operands
+ * \param[out]      remainder: The remainder, may be NULL or one of the operands
+ * \param[in]       a: The dividend, longer than the divisor
+ * \param[in]       b: The divisor, not zero
+ * \return          1 on success, 0 if memory cannot be allocated
+ * \note            The reciprocal has 32 bits more than the quotient, so the estimate of the quotient is at most a few
+ *                  units off and is corrected by comparing its product with the dividend
+ */
+static uint8_t
+nat_divmod_newton(big_nat_t* quotient, big_nat_t* remainder, const big_nat_t* a, const big_nat_t* b) {
+    big_nat_t q = {0}, r = {0}, reciprocal = {0}, product = {0}, one = {0};
+    int64_t a_bits = nat_bits(a), b_bits = nat_bits(b), bits = a_bits - b_bits + 33;
+    int64_t drop = a_bits > bits + 2 ? a_bits - bits - 2 : 0;   /* Bits of the dividend below the precision of the reciprocal */
+    uint8_t ok = nat_set_u64(&one, 1) && nat_reciprocal(&reciprocal, b, bits) && nat_shr(&q, a, drop)
+                 && nat_mul(&q, &q, &reciprocal) && nat_shr(&q, &q, bits + b_bits - drop) && nat_mul(&product, &q, b);
+    while (ok && nat_cmp(&product, a) > 0) {
+        ok = nat_sub(&q, &q, &one) && nat_sub(&product, &product, b);
+    }
+    ok = ok && nat_sub(&r, a, &product);
+    while (ok && nat_cmp(&r, b) >= 0) {
+        ok = nat_mul_small(&q, 1, 1) && nat_sub(&r, &r, b);
+    }
+    if (ok && quotient != NULL) {
+        nat_replace(quotient, &q);
+    }
+    if (ok && remainder != NULL) {
+        nat_replace(remainder, &r);
+    }
+    free(q.limbs);
+    free(r.limbs);
+    free(reciprocal.limbs);
+    free(product.limbs);
+    free(one.limbs);
+    return ok;
+}
+
+/**
+ * \brief           A function used to calculate a reciprocal by Newton's iteration
+ * \param[out]      result: About 2^(2 bits) / d, where d is the divisor scaled to \ref bits bits
+ * \param[in]       divisor: The divisor, not zero
+ * \param[in]       bits: Bits of the reciprocal
+ * \return          1 on success, 0 if memory cannot be allocated
+ * \note            A reciprocal x of half the bits gives x + x (1 - d x), which has twice the correct bits, so the
+ *                  reciprocal costs a few multiplications of the full size. The result is a few units off.
+ */
+static uint8_t
+nat_reciprocal(big_nat_t* result, const big_nat_t* divisor, int64_t bits) {
+    big_nat_t scaled = {0}, estimate = {0}, error = {0}, power = {0};
+    int64_t divisor_bits = nat_bits(divisor), half = bits / 2 + 16;
+    uint8_t negative = 0;
+    uint8_t ok = (divisor_bits > bits ? nat_shr(&scaled, divisor, divisor_bits - bits) : nat_shl(&scaled, divisor, bits - divisor_bits))
+                 && nat_set_u64(&power, 1);
+    if (ok && bits <= 32 * CALC_BIG_NEWTON_LIMBS) {     /* Short enough for the long division */
+        ok = nat_shl(&power, &power, 2 * bits) && nat_divmod_knuth(result, NULL, &power, &scaled);
+    } else if (ok) {
+        ok = nat_reciprocal(&estimate, divisor, half) && nat_mul(&error, &scaled, &estimate) && nat_shl(&power, &power, bits + half);
+        negative = ok && nat_cmp(&error, &power) > 0;   /* The error 2^(bits + half) - d x, scaled by 2^(bits + half) */
+        ok = ok && (negative ? nat_sub(&error, &error, &power) : nat_sub(&error, &power, &error))
+             && nat_shr(&error, &error, half - 4) && nat_mul(&error, &error, &estimate) && nat_shr(&error, &error, half + 4)
+             && nat_shl(result, &estimate, bits - half)
+             && (negative ? nat_sub(result, result, &error) : nat_add(result, result, &error));
+    }
+    free(scaled.limbs);
+    free(estimate.limbs);
+    free(error.limbs);
+    free(power.limbs);
+    return ok;
+}
+
+/**
+ * \brief           A function used to calculate a reciprocal square root by Newton's iteration
+ * \param[out]      result: About 2^(2 bits) / sqrt(a)
+ * \param[in]       a: The number, of 2 bits - 1 or 2 bits bits
+ * \param[in]       bits: Bits of the result
+ * \return          1 on success, 0 if memory cannot be allocated
+ * \note            A root x of half the bits gives x + x (1 - a x^2) / 2, which has twice the correct bits. Only the top bits
+ *                  of a affect them, so a step costs a few multiplications of the result size. The result is a few units off.
+ */
+static uint8_t
+nat_rsqrt(big_nat_t* result, const big_nat_t* a, int64_t bits) {
+    big_nat_t top = {0}, estimate = {0}, error = {0}, power = {0};
+    int64_t half = bits / 2 + 16, step = bits - half, drop = nat_bits(a) - bits - 64, shift;
+    uint8_t negative = 0, ok = nat_set_u64(&power, 1);
+    drop = drop > 0 ? drop : 0;
+    if (ok && bits <= 16 * CALC_BIG_NEWTON_LIMBS) {     /* Short enough for the root of 2^(4 bits) / a */
+        ok = nat_shl(&power, &power, 4 * bits) && nat_divmod(&error, NULL, &power, a) && nat_sqrt(result, NULL, &error);
+    } else if (ok) {                                    /* The error 2^(4 bits) - a x^2, scaled by 2^(2 step + drop) */
+        ok = nat_shr(&top, a, 2 * step) && nat_rsqrt(&estimate, &top, half) && nat_mul(&error, &estimate, &estimate)
+             && nat_shr(&top, a, drop) && nat_mul(&error, &error, &top) && nat_shl(&power, &power, 4 * bits - 2 * step - drop);
+        negative = ok && nat_cmp(&error, &power) > 0;
+        shift = 4 * bits - 2 * step - drop - 2 * half - 32;     /* Bits of the error below the precision of the step */
+        ok = ok && (negative ? nat_sub(&error, &error, &power) : nat_sub(&error, &power, &error))
+             && nat_shr(&error, &error, shift) && nat_mul(&error, &error, &estimate)
+             && nat_shr(&error, &error, 4 * bits + 1 - 3 * step - drop - shift) && nat_shl(result, &estimate, step)
+             && (negative ? nat_sub(result, result, &error) : nat_add(result, result, &error));
+    }
+    free(top.limbs);
+    free(estimate.limbs);
+    free(error.limbs);
+    free(power.limbs);
+    return ok;
+}
+
+/**
+ * \brief           A function used to calculate an integer square root
+ * \param[out]      root: The largest integer whose square is at most the number, may be NULL
+ * \param[out]      remainder: The number minus the square of the root, may be NULL
+ * \param[in]       a: The number
+ * \return          1 on success, 0 if memory cannot be allocated
+ * \note            A short number takes a step of Newton's iteration from the root of its top half. A long one is multiplied
+ *                  by its reciprocal square root, which needs no division.
+ */
+static uint8_t
+nat_sqrt(big_nat_t* root, big_nat_t* remainder, const big_nat_t* a) {
+    big_nat_t x = {0}, y = {0}, square = {0}, one = {0};
+    int64_t bits = nat_bits(a), drop = bits / 4 - 32, half = (bits + 1) / 2 + 32, shift = (2 * half - bits) & ~(int64_t)1;
+    uint8_t ok = nat_set_u64(&one, 1);
+    if (a->size == 0) {
+        /* The root of zero is zero */
+    } else if (bits <= 256) {                   /* Newton's iteration down from a power of 2 above the root */
+        ok = ok && nat_shl(&x, &one, (bits + 1) / 2);
+        while (ok && (ok = nat_divmod(&y, NULL, a, &x) && nat_add(&y, &y, &x) && nat_shr(&y, &y, 1)) && nat_cmp(&y, &x) < 0) {
+            nat_replace(&x, &y);
+        }
+    } else if (bits <= 64 * CALC_BIG_NEWTON_LIMBS) {    /* One step from above the root of the top bits */
+        ok = ok && nat_shr(&y, a, 2 * drop) && nat_sqrt(&x, NULL, &y) && nat_add(&x, &x, &one) && nat_shl(&x, &x, drop)
+             && nat_divmod(&y, NULL, a, &x) && nat_add(&x, &x, &y) && nat_shr(&x, &x, 1);
+    } else {                                    /* sqrt(a) = a / sqrt(a), from the top bits of a */
+        drop = bits - half - 64;
+        ok = ok && nat_shl(&y, a, shift) && nat_rsqrt(&x, &y, half) && nat_shr(&y, a, drop) && nat_mul(&x, &x, &y)
+             && nat_shr(&x, &x, 2 * half - shift / 2 - drop) && nat_add(&x, &x, &one);
+    }
+    ok = ok && nat_mul(&square, &x, &x);
+    while (ok && nat_cmp(&square, a) > 0) {     /* (x - 1)^2 = x^2 - x - (x - 1) */
+        ok = nat_sub(&square, &square, &x) && nat_sub(&x, &x, &one) && nat_sub(&square, &square, &x);
+    }
+    ok = ok && (remainder == NULL || nat_sub(remainder, a, &square));
+    if (ok && root != NULL) {
+        nat_replace(root, &x);
+    }
+    free(x.limbs);
+    free(y.limbs);
+    free(square.limbs);
+    free(one.limbs);
+    return ok;
+}
+
+/**
+ * \brief           A function used to shift a natural number left
+ * \param[out]      result: The shifted number, may be the operand
+ * \param[in]       a: The number
+ * \param[in]       bits: A number of bits, not negative
+ * \return          1 on success, 0 if memory cannot be allocated
+ */
+static uint8_t
+nat_shl(big_nat_t* result, const big_nat_t* a, int64_t bits) {
+    big_nat_t shifted = {0};
+    size_t limbs = (size_t)bits / 32;
+    int shift = (int)(bits % 32);
+    if (a->size == 0) {
+        result->size = 0;
+        return 1;
+    } else if (!nat_reserve(&shifted, a->size + limbs + 1)) {
+        return 0;
+    }
+    memset(shifted.limbs, 0, limbs * sizeof(big_limb_t));
+    shifted.limbs[a->size + limbs] = (big_limb_t)((uint64_t)a->limbs[a->size - 1] >> (32 - shift));
+    for (size_t i = a->size - 1; i > 0; --i) {
+        shifted.limbs[i + limbs] = a->limbs[i] << shift | (big_limb_t)((uint64_t)a->limbs[i - 1] >> (32 - shift));
+    }
+    shifted.limbs[limbs] = a->limbs[0] << shift;
+    shifted.size = a->size + limbs + 1;
+    nat_trim(&shifted);
+    nat_replace(result, &shifted);
+    return 1;
+}
+
+/**
+ * \brief           A function used to shift a natural number right, dropping the low bits
+ * \param[out]      result: The shifted number, may be the operand
+ * \param[in]       a: The number
+ * \param[in]       bits: A number of bits, not negative
+ * \return          1 on success, 0 if memory cannot be allocated
+ */
+static uint8_t
+nat_shr(big_nat_t* result, const big_nat_t* a, int64_t bits) {
+    size_t limbs = (size_t)bits / 32, size;
+    int shift = (int)(bits % 32);
+    if (limbs >= a->size) {
+        result->size = 0;
+        return 1;
+    }
+    size = a->size - limbs;
+    if (result != a && !nat_reserve(result, size)) {
+        return 0;
+    }
+    for (size_t i = 0; i < size; ++i) {         /* Forward, so the operand can be overwritten in place */
+        uint64_t high = i + 1 < size ? a->limbs[i + limbs + 1] : 0;
+        result->limbs[i] = (big_limb_t)((high << 32 | a->limbs[i + limbs]) >> shift);
+    }
+    result->size = size;
+    nat_trim(result);
+    return 1;
+}
+
+/**
+ * \brief           A function used to raise a natural number to a power by squaring
+ * \param[out]      result: The power, may be the base
+ * \param[in]       base: The base
+ * \param[in]       exponent: The exponent
+ * \return          1 on success, 0 if memory cannot be allocated
+ */
+static uint8_t
+nat_pow(big_nat_t* result, const big_nat_t* base, uint64_t exponent) {
+    big_nat_t power = {0}, factor = {0};
+    uint8_t ok = nat_set_u64(&power, 1) && nat_set(&factor, base->limbs, base->size);
+    for (int bit = exponent > 0 ? 63 - __builtin_clzll(exponent) : -1; ok && bit >= 0; --bit) {  /* From the top bit down */
+        ok = nat_mul(&power, &power, &power) && ((exponent >> bit & 1) == 0 || nat_mul(&power, &power, &factor));
+    }
+    if (ok) {
+        nat_replace(result, &power);
+    }
+    free(power.limbs);
+    free(factor.limbs);
+    return ok;
+}
+
+/**
+ * \brief           A function used to calculate a power of 10
+ * \param[out]      result: The power
+ * \param[in]       exponent: The exponent
+ * \return          1 on success, 0 if memory cannot be allocated
+ * \note            10^n is 5^n shifted by n bits, so the squarings work on numbers 30% shorter
+ */
+static uint8_t
+nat_pow10(big_nat_t* result, uint64_t exponent) {
+    big_nat_t five = {0};
+    uint8_t ok = nat_set_u64(&five, 5) && nat_pow(result, &five, exponent) && nat_shl(result, result, (int64_t)exponent);
+    free(five.limbs);
+    return ok;
+}
+
+/**
+ * \brief           A function used to multiply a range of integers
+ * \param[out]      result: The product
+ * \param[in]       low: The first integer, at least 1
+ * \param[in]       high: The last integer, at least \ref low
+ * \return          1 on success, 0 if memory cannot be allocated
+ * \note            The range is halved until it is short, so the factors of every multiplication have similar sizes
+ *                  and the subquadratic methods pay off
+ */
+static uint8_t
+nat_product(big_nat_t* result, uint32_t low, uint32_t high) {
+    big_nat_t left = {0}, right = {0};
+    uint32_t middle = low + (high - low) / 2;
+    uint8_t ok;
+    if (high - low < 16) {                      /* A product of a few integers fits into a few limbs */
+        ok = nat_set_u64(result, low);
+        for (uint32_t i = low + 1; ok && i <= high; ++i) {
+            ok = nat_mul_small(result, i, 0);
+        }
+        return ok;
+    }
+    ok = nat_product(&left, low, middle) && nat_product(&right, middle + 1, high) && nat_mul(result, &left, &right);
+    free(left.limbs);
+    free(right.limbs);
+    return ok;
+}
+
+/**
+ * \brief           A function used to split a natural number into chunks of 9 decimal digits
+ * \param[in]       x: The number, below \ref powers[level]
+ * \param[in]       powers: 10^(9 2^k) for k up to \ref level
+ * \param[in]       level: The number gives 2^level chunks, padded with zero chunks
+ * \param[out]      chunks: The chunks from the least significant one
+ * \return          1 on success, 0 if memory cannot be allocated
+ * \note            The number is divided by the power splitting its chunks in halves and the halves are split recursively,
+ *                  so the long divisions work on long numbers and only short numbers are divided by 10^9 repeatedly
+ */
+static uint8_t
+nat_to_chunks(const big_nat_t* x, const big_nat_t* powers, size_t level, big_limb_t* chunks) {
+    big_nat_t high = {0}, low = {0};
+    uint8_t ok;
+    if (level <= CALC_BIG_CHUNK_LEVEL) {
+        ok = nat_set(&low, x->limbs, x->size);
+        for (size_t i = 0; ok && i < ((size_t)1 << level); ++i) {  /* The divisor is a constant, so the compiler divides by multiplying */
+            uint64_t remainder = 0;
+            for (size_t j = low.size; j-- > 0;) {
+                uint64_t current = remainder << 32 | low.limbs[j];
+                low.limbs[j] = (big_limb_t)(current / CALC_BIG_DECIMAL_BASE);
+                remainder = current % CALC_BIG_DECIMAL_BASE;
+            }
+            nat_trim(&low);
+            chunks[i] = (big_limb_t)remainder;
+        }
+    } else {
+        ok = nat_divmod(&high, &low, x, &powers[level - 1])
+            && nat_to_chunks(&low, powers, level - 1, chunks)
+            && nat_to_chunks(&high, powers, level - 1, chunks + ((size_t)1 << (level - 1)));
+    }
+    free(high.limbs);
+    free(low.limbs);
+    return ok;
+}
+
+/**
+ * \brief           A function used to print a natural number in decimal
+ * \param[in]       x: The number
+ * \return          A NUL-terminated string to be freed with free, NULL if memory cannot be allocated
+ */
+static char*
+nat_to_decimal(const big_nat_t* x) {
+    big_nat_t powers[48] = {{0}};               /* 10^(9 2^k), squared until one exceeds the number */
+    big_limb_t* chunks = NULL;
+    size_t level = 0, count;
+    char* text = NULL;
+    uint8_t ok = nat_set_u64(&powers[0], CALC_BIG_DECIMAL_BASE);
+    while (ok && nat_cmp(x, &powers[level]) >= 0) {
+        ok = nat_mul(&powers[level + 1], &powers[level], &powers[level]);
+        ++level;
+    }
+    count = (size_t)1 << level;
+    ok = ok && (chunks = (big_limb_t*)malloc(count * sizeof(big_limb_t))) != NULL && nat_to_chunks(x, powers, level, chunks)
+        && (text = (char*)malloc(count * CALC_BIG_DECIMAL_DIGITS + 1)) != NULL;
+    if (ok) {
+        char* end = text;
+        while (count > 1 && chunks[count - 1] == 0) {               /* Drop the padding */
+            --count;
+        }
+        for (big_limb_t chunk = chunks[count - 1]; chunk > 0 || end == text; chunk /= 10) {   /* The top chunk without leading zeros */
+            *end++ = (char)('0' + chunk % 10);
+        }
+        for (char *left = text, *right = end - 1; left < right; ++left, --right) {
+            char digit = *left;
+            *left = *right;
+            *right = digit;
+        }
+        for (size_t i = count - 1; i-- > 0;) {
+            big_limb_t chunk = chunks[i];
+            for (int j = CALC_BIG_DECIMAL_DIGITS - 1; j >= 0; --j) {
+                end[j] = (char)('0' + chunk % 10);
+                chunk /= 10;
+            }
+            end += CALC_BIG_DECIMAL_DIGITS;
+        }
+        *end = '\0';
+    }
+    for (size_t i = 0; i <= level; ++i) {
+        free(powers[i].limbs);
+    }
+    free(chunks);
+    return text;
+}
+
+/**
+ * \brief           A function used to free the magnitude of a value
+ * \param[in,out]   x: The value, left zero
+ */
+static void
+big_free(big_value_t* x) {
+    free(x->magnitude.limbs);
+    memset(x, 0, sizeof(big_value_t));
+}
+
+/**
+ * \brief           A function used to copy a value
+ * \param[out]      x: The copy
+ * \param[in]       value: The value
+ * \return          1 on success, 0 if memory cannot be allocated
+ */
+static uint8_t
+big_copy(big_value_t* x, const big_value_t* value) {
+    big_nat_t magnitude = x->magnitude;
+    if (x == value) {
+        return 1;
+    }
+    *x = *value;
+    x->magnitude = magnitude;
+    return nat_set(&x->magnitude, value->magnitude.limbs, value->magnitude.size);
+}
+
+/**
+ * \brief           A function used to move a value into another one
+ * \param[in,out]   x: The value to replace, its magnitude is freed
+ * \param[in,out]   value: The new value, left zero
+ */
+static void
+big_replace(big_value_t* x, big_value_t* value) {
+    free(x->magnitude.limbs);
+    *x = *value;
+    memset(value, 0, sizeof(big_value_t));
+}
+
+/**
+ * \brief           A function used to convert a double exactly
+ * \param[out]      x: The value
+ * \param[in]       value: The double
+ * \return          1 on success, 0 if memory cannot be allocated
+ */
+static uint8_t
+big_from_double(big_value_t* x, double value) {
+    int exponent;
+    int64_t shift;
+    uint64_t mantissa;
+    x->negative = signbit(value) != 0;
+    x->is_special = !isfinite(value);
+    x->special = value;
+    x->is_integer = 0;
+    x->exponent = 0;
+    x->magnitude.size = 0;
+    if (x->is_special || value == 0) {
+        x->is_integer = !x->is_special;
+        return 1;
+    }
+    mantissa = (uint64_t)ldexp(frexp(fabs(value), &exponent), 53);     /* 53 bits, exact */
+    x->exponent = exponent - 53;
+    while ((mantissa & 1) == 0 && x->exponent < 0) {                  /* Drop trailing zeros, so integers are recognized */
+        mantissa >>= 1;
+        ++x->exponent;
+    }
+    if (!nat_set_u64(&x->magnitude, mantissa)) {
+        return 0;
+    }
+    if (x->exponent >= 0) {
+        shift = x->exponent;
+        x->is_integer = 1;
+        x->exponent = 0;
+        return nat_shl(&x->magnitude, &x->magnitude, shift);
+    }
+    return 1;
+}
+
+/**
+ * \brief           A function used to convert a decimal literal
+ * \param[out]      x: The value, initially zero
+ * \param[in]       literal: The literal
+ * \param[in]       precision: Bits of a fraction
+ * \return          1 on success, 0 if memory cannot be allocated
+ */
+static uint8_t
+big_from_literal(big_value_t* x, const calc_literal_t* literal, int64_t precision) {
+    const char* digit = literal->digits;
+    size_t length = strlen(literal->digits);
+    big_value_t scale = {0};
+    uint8_t ok = 1;
+    x->is_integer = 1;
+    for (size_t count = length % CALC_BIG_DECIMAL_DIGITS; ok && *digit != '\0'; count = CALC_BIG_DECIMAL_DIGITS) {   /* 9 digits at a time */
+        big_limb_t chunk = 0, factor = 1;
+        for (size_t i = 0; i < (count > 0 ? count : CALC_BIG_DECIMAL_DIGITS); ++i) {
+            chunk = chunk * 10 + (big_limb_t)(*digit++ - '0');
+            factor *= 10;
+        }
+        ok = nat_mul_small(&x->magnitude, factor, chunk);
+    }
+    if (ok && literal->scale > 0) {             /* Divide by 10 to the power of the digits after the point */
+        scale.is_integer = 1;
+        ok = nat_pow10(&scale.magnitude, (uint64_t)literal->scale) && big_div(x, x, &scale, precision);
+        big_free(&scale);
+    }
+    return ok && big_finish(x, precision, 0);
+}
+
+/**
+ * \brief           A function used to round a value to the nearest double
+ * \param[in]       x: The value
+ * \return          The double, an infinity or zero out of range
+ */
+static double
+big_to_double(const big_value_t* x) {
+    int64_t bits = nat_bits(&x->magnitude), exponent = x->exponent;
+    uint64_t top;
+    double value;
+    if (x->is_special) {
+        return x->special;
+    } else if (bits <= 64) {
+        top = nat_extract(&x->magnitude, 0);
+    } else {                                    /* The top 64 bits and a sticky bit of the rest, rounded once by the conversion */
+        top = nat_extract(&x->magnitude, bits - 64) | !nat_is_zero_below(&x->magnitude, bits - 64);
+        exponent += bits - 64;
+    }
+    value = exponent > 4096 ? (top > 0 ? INFINITY : 0) : exponent < -4096 ? 0 : ldexp((double)top, (int)exponent);
+    return x->negative ? -value : value;
+}
+
+/**
+ * \brief           A function used to get an integral value as a native integer
+ * \param[in]       x: The value
+ * \param[out]      value: The integer
+ * \return          1 if the value is an integer below 2^62 in magnitude, 0 otherwise
+ */
+static uint8_t
+big_to_int64(const big_value_t* x, int64_t* value) {
+    int64_t bits = nat_bits(&x->magnitude);
+    if (x->is_special || x->exponent + bits > 62) {
+        return 0;
+    } else if (x->exponent < 0 && !nat_is_zero_below(&x->magnitude, -x->exponent)) {
+        return 0;                               /* A fraction */
+    }
+    *value = x->exponent >= 0 ? (int64_t)(nat_extract(&x->magnitude, 0) << x->exponent) : (int64_t)nat_extract(&x->magnitude, -x->exponent);
+    *value = x->negative ? -*value : *value;
+    return 1;
+}
+
+/**
+ * \brief           A function used to estimate the binary logarithm of the magnitude of a value
+ * \param[in]       x: The value, not zero
+ * \return          The logarithm, with the precision of a double
+ */
+static double
+big_log2(const big_value_t* x) {
+    int64_t bits = nat_bits(&x->magnitude);
+    return (double)(x->exponent + bits) + log2(ldexp((double)nat_extract(&x->magnitude, bits - 64), -64));
+}
+
+/**
+ * \brief           A function used to compare finite values
+ * \param[in]       a: The first value
+ * \param[in]       b: The second value
+ * \return          A negative value, zero or a positive value if the first value is less than, equal to or greater than the second one
+ */
+static int
+big_cmp(const big_value_t* a, const big_value_t* b) {
+    int64_t a_bits = nat_bits(&a->magnitude), b_bits = nat_bits(&b->magnitude);
+    int sign = a->negative ? -1 : 1;
+    if (a_bits == 0 || b_bits == 0 || a->negative != b->negative) {  /* Zeros of both signs are equal */
+        return (a_bits == 0 ? 0 : a->negative ? -1 : 1) - (b_bits == 0 ? 0 : b->negative ? -1 : 1);
+    } else if (a->exponent + a_bits != b->exponent + b_bits) {
+        return a->exponent + a_bits < b->exponent + b_bits ? -sign : sign;
+    }
+    for (int64_t offset = 64; offset - 64 < (a_bits > b_bits ? a_bits : b_bits); offset += 64) {   /* 64 bits at a time from the top */
+        uint64_t x = nat_extract(&a->magnitude, a_bits - offset), y = nat_extract(&b->magnitude, b_bits - offset);
+        if (x != y) {
+            return x < y ? -sign : sign;
+        }
+    }
+    return 0;
+}
+
+/**
+ * \brief           A function used to round a value to a number of bits, half to even
+ * \param[in,out]   x: The value, no longer an integer
+ * \param[in]       precision: A number of bits
+ * \param[in]       sticky: Set to `1` when nonzero bits below the value have already been dropped
+ * \return          1 on success, 0 if memory cannot be allocated
+ */
+static uint8_t
+big_round(big_value_t* x, int64_t precision, uint8_t sticky) {
+    int64_t bits = nat_bits(&x->magnitude), shift = bits - precision;
+    uint8_t half, rest;
+    x->is_integer = 0;
+    if (shift <= 0) {
+        return 1;
+    }
+    half = (nat_extract(&x->magnitude, shift - 1) & 1) != 0;
+    rest = sticky || !nat_is_zero_below(&x->magnitude, shift - 1);
+    if (!nat_shr(&x->magnitude, &x->magnitude, shift)) {
+        return 0;
+    }
+    x->exponent += shift;
+    if (half && (rest || (x->magnitude.limbs[0] & 1))) {
+        if (!nat_mul_small(&x->magnitude, 1, 1)) {
+            return 0;
+        }
+        if (nat_bits(&x->magnitude) > precision) {  /* Rounded up to a power of 2 */
+            x->exponent += 1;
+            return nat_shr(&x->magnitude, &x->magnitude, 1);
+        }
+    }
+    return 1;
+}
+
+/**
+ * \brief           A function used to finish a result, rounding it unless it is an exact integer
+ * \param[in,out]   x: The value
+ * \param[in]       precision: Bits of a fraction
+ * \param[in]       sticky: Set to `1` when nonzero bits below the value have already been dropped
+ * \return          1 on success, 0 if memory cannot be allocated
+ * \note            A value out of the range of 2^-(2^25) to 2^(2^25) becomes an infinity or zero
+ */
+static uint8_t
+big_finish(big_value_t* x, int64_t precision, uint8_t sticky) {
+    int64_t bits = nat_bits(&x->magnitude);
+    if ((!x->is_integer || bits > CALC_BIG_MAX_BITS) && !big_round(x, precision, sticky)) {
+        return 0;
+    }
+    bits = nat_bits(&x->magnitude);
+    if (bits > 0 && x->exponent + bits > CALC_BIG_MAX_BITS) {
+        return big_from_double(x, x->negative ? -INFINITY : INFINITY);
+    } else if (bits > 0 && x->exponent + bits < -CALC_BIG_MAX_BITS) {
+        return big_from_double(x, x->negative ? -0.0 : 0.0);
+    }
+    return 1;
+}
+
+/**
+ * \brief           A function used to add values of the same exponent exactly
+ * \param[out]      result: The sum, may be one of the operands, its exponent and flags are kept
+ * \param[in]       a: The first value
+ * \param[in]       b: The second value
+ * \param[in]       subtract: Set to `1` to subtract the second value
+ * \return          1 on success, 0 if memory cannot be allocated
+ */
+static uint8_t
+big_add_aligned(big_value_t* result, const big_value_t* a, const big_value_t* b, uint8_t subtract) {
+    big_nat_t sum = {0};
+    uint8_t b_negative = b->negative != subtract, negative = a->negative, ok;
+    if (a->negative == b_negative) {
+        ok = nat_add(&sum, &a->magnitude, &b->magnitude);
+    } else if (nat_cmp(&a->magnitude, &b->magnitude) >= 0) {
+        ok = nat_sub(&sum, &a->magnitude, &b->magnitude);
+    } else {
+        ok = nat_sub(&sum, &b->magnitude, &a->magnitude);
+        negative = b_negative;
+    }
+    if (ok) {
+        nat_replace(&result->magnitude, &sum);
+        result->negative = negative;
+    }
+    return ok;
+}
+
+/**
+ * \brief           A function used to add or subtract values
+ * \param[out]      result: The result, may be one of the operands
+ * \param[in]       a: The first value
+ * \param[in]       b: The second value
+ * \param[in]       subtract: Set to `1` to subtract the second value
+ * \param[in]       precision: Bits of a fraction
+ * \return          1 on success, 0 if memory cannot be allocated
+ * \note            An operand entirely below the rounding point of the other one only matters by its sign,
+ *                  so it is replaced by a single bit and the alignment never shifts by more than the precision
+ */
+static uint8_t
+big_add(big_value_t* result, const big_value_t* a, const big_value_t* b, uint8_t subtract, int64_t precision) {
+    big_value_t sum = {0}, x = {0}, y = {0};
+    int64_t a_top = a->exponent + nat_bits(&a->magnitude), b_top = b->exponent + nat_bits(&b->magnitude);
+    uint8_t ok = big_copy(&x, a) && big_copy(&y, b);
+    y.negative = b->negative != subtract;
+    if (ok && a->magnitude.size > 0 && b->magnitude.size > 0 && !(a->is_integer && b->is_integer)) {
+        big_value_t* low = a_top < b_top ? &x : &y;
+        const big_value_t* high = a_top < b_top ? &y : &x;
+        int64_t high_top = a_top < b_top ? b_top : a_top, low_top = a_top < b_top ? a_top : b_top;
+        int64_t cut = high->exponent < high_top - precision - 3 ? high->exponent : high_top - precision - 3;
+        if (low_top < cut) {                    /* Any value below 2^cut rounds the same */
+            low->exponent = cut - 1;
+            ok = nat_set_u64(&low->magnitude, 1);
+        }
+        if (ok && x.exponent != y.exponent) {   /* Shift the operand with the greater exponent */
+            big_value_t* shifted = x.exponent > y.exponent ? &x : &y;
+            int64_t exponent = x.exponent > y.exponent ? y.exponent : x.exponent;
+            ok = nat_shl(&shifted->magnitude, &shifted->magnitude, shifted->exponent - exponent);
+            shifted->exponent = exponent;
+        }
+    }
+    if (ok && a->magnitude.size == 0) {
+        ok = big_copy(&sum, &y);
+    } else if (ok && b->magnitude.size == 0) {
+        ok = big_copy(&sum, &x);
+    } else if (ok) {
+        sum.exponent = x.exponent;
+        sum.is_integer = a->is_integer && b->is_integer;
+        ok = big_add_aligned(&sum, &x, &y, 0);
+    }
+    if (ok) {
+        sum.is_integer = a->is_integer && b->is_integer;
+        if (sum.magnitude.size == 0) {          /* x - x is +0, only -0 + -0 is -0 */
+            sum.negative = x.negative && y.negative;
+            sum.exponent = 0;
+        }
+        ok = big_finish(&sum, precision, 0);
+    }
+    if (ok) {
+        big_replace(result, &sum);
+    }
+    big_free(&sum);
+    big_free(&x);
+    big_free(&y);
+    return ok;
+}
+
+/**
+ * \brief           A function used to multiply values
+ * \param[out]      result: The product, may be one of the operands
+ * \param[in]       a: The first value
+ * \param[in]       b: The second value
+ * \param[in]       precision: Bits of a fraction
+ * \return          1 on success, 0 if memory cannot be allocated
+ */
+static uint8_t
+big_mul(big_value_t* result, const big_value_t* a, const big_value_t* b, int64_t precision) {
+    big_value_t product = {0};
+    product.exponent = a->exponent + b->exponent;
+    product.negative = a->negative != b->negative;
+    product.is_integer = a->is_integer && b->is_integer;
+    if (!nat_mul(&product.magnitude, &a->magnitude, &b->magnitude) || !big_finish(&product, precision, 0)) {
+        big_free(&product);
+        return 0;
+    }
+    big_replace(result, &product);
+    return 1;
+}
+
+/**
+ * \brief           A function used to divide values
+ * \param[out]      result: The quotient, may be one of the operands
+ * \param[in]       a: The dividend
+ * \param[in]       b: The divisor, not zero
+ * \param[in]       precision: Bits of a fraction
+ * \return          1 on success, 0 if memory cannot be allocated
+ * \note            A quotient of integers without a remainder is an integer, any other quotient is calculated
+ *                  to 2 bits more than the precision and rounded with the remainder as the sticky bit
+ */
+static uint8_t
+big_div(big_value_t* result, const big_value_t* a, const big_value_t* b, int64_t precision) {
+    big_value_t quotient = {0};
+    big_nat_t remainder = {0}, dividend = {0};
+    int64_t shift = precision + 2 + nat_bits(&b->magnitude) - nat_bits(&a->magnitude);
+    uint8_t ok = 1;
+    quotient.negative = a->negative != b->negative;
+    if (a->is_integer && b->is_integer) {
+        ok = nat_divmod(&quotient.magnitude, &remainder, &a->magnitude, &b->magnitude);
+        quotient.is_integer = remainder.size == 0;
+    }
+    if (ok && !quotient.is_integer) {
+        shift = shift > 0 ? shift : 0;
+        quotient.exponent = a->exponent - b->exponent - shift;
+        ok = nat_shl(&dividend, &a->magnitude, shift) && nat_divmod(&quotient.magnitude, &remainder, &dividend, &b->magnitude);
+    }
+    ok = ok && big_finish(&quotient, precision, remainder.size > 0);
+    if (ok) {
+        big_replace(result, &quotient);
+    }
+    big_free(&quotient);
+    free(remainder.limbs);
+    free(dividend.limbs);
+    return ok;
+}
+
+/**
+ * \brief           A function used to calculate a division remainder exactly
+ * \param[out]      result: The remainder, may be one of the operands
+ * \param[in]       a: The dividend
+ * \param[in]       b: The divisor, not zero
+ * \param[in]       precision: Bits of a fraction
+ * \return          1 on success, 0 if memory cannot be allocated
+ * \note            The sign follows the dividend, like fmod
+ */
+static uint8_t
+big_mod(big_value_t* result, const big_value_t* a, const big_value_t* b, int64_t precision) {
+    big_value_t remainder = {0};
+    big_nat_t x = {0}, y = {0};
+    int64_t exponent = a->exponent < b->exponent ? a->exponent : b->exponent;
+    uint8_t ok = nat_shl(&x, &a->magnitude, a->exponent - exponent) && nat_shl(&y, &b->magnitude, b->exponent - exponent)
+        && nat_divmod(NULL, &remainder.magnitude, &x, &y);
+    remainder.exponent = exponent;
+    remainder.negative = a->negative;
+    remainder.is_integer = a->is_integer && b->is_integer;
+    ok = ok && big_finish(&remainder, precision, 0);
+    if (ok) {
+        big_replace(result, &remainder);
+    }
+    big_free(&remainder);
+    free(x.limbs);
+    free(y.limbs);
+    return ok;
+}
+
+/**
+ * \brief           A function used to raise a value to an integer power by squaring
+ * \param[out]      result: The power
+ * \param[in]       a: The base, not zero for a negative exponent
+ * \param[in]       exponent: The exponent
+ * \param[in]       precision: Bits of a fraction
+ * \return          1 on success, 0 if memory cannot be allocated
+ * \note            A non-negative power of an integer is exact. A power of a fraction is rounded after every multiplication
+ *                  to the precision and as many more bits as the exponent has, which cover the error growing with the exponent.
+ *                  A negative power is the reciprocal of the positive one.
+ */
+static uint8_t
+big_pow(big_value_t* result, const big_value_t* a, int64_t exponent, int64_t precision) {
+    big_value_t power = {0}, base = {0};
+    uint64_t n = exponent < 0 ? -(uint64_t)exponent : (uint64_t)exponent;
+    int64_t working = precision + CALC_BIG_GUARD_BITS + 64;
+    double magnitude = a->magnitude.size > 0 ? big_log2(a) * (double)exponent : 0;    /* log2 of the power */
+    uint8_t ok;
+    power.negative = a->negative && (n & 1);
+    power.is_integer = 1;
+    if (fabs(magnitude) > (double)CALC_BIG_MAX_BITS + 1) {         /* Out of range, not worth calculating */
+        double value = magnitude > 0 ? INFINITY : 0;
+        ok = big_from_double(&power, power.negative ? -value : value);
+        exponent = 0;                           /* Already the power of the reciprocal */
+    } else if (n == 0 || a->magnitude.size == 0) {
+        ok = nat_set_u64(&power.magnitude, n == 0);
+    } else if (a->is_integer) {
+        ok = nat_pow(&power.magnitude, &a->magnitude, n);
+    } else {
+        ok = big_copy(&base, a) && big_round(&base, working, 0) && nat_set_u64(&power.magnitude, 1);
+        base.negative = 0;
+        for (int bit = 63 - __builtin_clzll(n); ok && bit >= 0; --bit) {
+            ok = big_mul(&power, &power, &power, working) && ((n >> bit & 1) == 0 || big_mul(&power, &power, &base, working));
+        }
+        power.negative = a->negative && (n & 1);
+    }
+    if (ok && exponent < 0) {
+        big_free(&base);                        /* Reused as the dividend 1 */
+        base.is_integer = 1;
+        ok = nat_set_u64(&base.magnitude, 1) && big_div(&power, &base, &power, precision);
+    } else if (ok && !power.is_special) {
+        ok = big_finish(&power, precision, 0);
+    }
+    if (ok) {
+        big_replace(result, &power);
+    }
+    big_free(&power);
+    big_free(&base);
+    return ok;
+}
+
+/**
+ * \brief           A function used to round a value to an integer
+ * \param[in,out]   x: The value
+ * \param[in]       fn: \ref CALC_FN_CEIL, \ref CALC_FN_FLOOR, \ref CALC_FN_ROUND (half away from zero) or \ref CALC_FN_TRUNC
+ * \return          1 on success, 0 if memory cannot be allocated
+ */
+static uint8_t
+big_to_integer(big_value_t* x, calc_function_id_t fn) {
+    int64_t bits = -x->exponent;                /* Bits of the fraction */
+    uint8_t fraction, half, up;
+    if (x->is_integer) {
+        return 1;
+    } else if (bits <= 0) {                     /* A float without a fraction */
+        x->is_integer = 1;
+        x->exponent = 0;
+        return nat_shl(&x->magnitude, &x->magnitude, -bits);
+    }
+    fraction = !nat_is_zero_below(&x->magnitude, bits);
+    half = (nat_extract(&x->magnitude, bits - 1) & 1) != 0;
+    switch (fn) {
+        case CALC_FN_CEIL:
+            up = fraction && !x->negative;
+            break;
+        case CALC_FN_FLOOR:
+            up = fraction && x->negative;
+            break;
+        case CALC_FN_ROUND:
+            up = half;
+            break;
+        default:
+            up = 0;
+            break;
+    }
+    x->is_integer = 1;
+    x->exponent = 0;
+    return nat_shr(&x->magnitude, &x->magnitude, bits) && (!up || nat_mul_small(&x->magnitude, 1, 1));
+}
+
+/**
+ * \brief           A function used to compare the magnitude of a value with 1
+ * \param[in]       x: The value
+ * \return          A negative value, zero or a positive value if the magnitude is less than, equal to or greater than 1
+ */
+static int
+big_cmp_one(const big_value_t* x) {
+    int64_t bits = nat_bits(&x->magnitude), top = x->exponent + bits;
+    if (bits == 0 || top <= 0) {
+        return -1;
+    } else if (top > 1) {
+        return 1;
+    }
+    return nat_is_zero_below(&x->magnitude, bits - 1) ? 0 : 1;    /* 1 is a power of 2 */
+}
+
+/**
+ * \brief           A function used to check the arguments of a math function against its domain exactly
+ * \param[in]       domain: The domain
+ * \param[in]       x: The first argument
+ * \param[in]       y: The second argument, NULL if there is none
+ * \return          1 if the arguments are in the domain, 0 otherwise
+ */
+static uint8_t
+big_domain_contains(calc_domain_t domain, const big_value_t* x, const big_value_t* y) {
+    int sign = x->magnitude.size == 0 ? 0 : x->negative ? -1 : 1;
+    switch (domain) {
+        case CALC_DOMAIN_NON_NEGATIVE:
+            return sign >= 0;
+        case CALC_DOMAIN_POSITIVE:
+            return sign > 0;
+        case CALC_DOMAIN_UNIT_CLOSED:
+            return big_cmp_one(x) <= 0;
+        case CALC_DOMAIN_UNIT_OPEN:
+            return big_cmp_one(x) < 0;
+        case CALC_DOMAIN_AT_LEAST_ONE:
+            return sign > 0 && big_cmp_one(x) >= 0;
+        case CALC_DOMAIN_NON_ZERO:
+        case CALC_DOMAIN_SIN_NON_ZERO:          /* sin(x) and tanh(x) are zero only at 0 for a rational x */
+            return sign != 0;
+        case CALC_DOMAIN_NON_NEGATIVE_INTEGER:
+            return sign >= 0 && (x->exponent >= 0 || nat_is_zero_below(&x->magnitude, -x->exponent));
+        case CALC_DOMAIN_LOG_BASE:
+            return sign > 0 && big_cmp_one(x) != 0 && y->magnitude.size > 0 && !y->negative;
+        default:                                /* cos(x) is never zero for a rational x */
+            return 1;
+    }
+}
+
+/**
+ * \brief           A function used to move a natural number into a value and round it
+ * \param[out]      x: The value
+ * \param[in,out]   magnitude: The magnitude, left zero
+ * \param[in]       exponent: The binary exponent
+ * \param[in]       negative: Set to `1` when the value is negative
+ * \param[in]       precision: A number of bits
+ * \return          1 on success, 0 if memory cannot be allocated
+ */
+static uint8_t
+big_from_nat(big_value_t* x, big_nat_t* magnitude, int64_t exponent, uint8_t negative, int64_t precision) {
+    nat_replace(&x->magnitude, magnitude);
+    x->exponent = exponent;
+    x->negative = negative;
+    x->is_special = 0;
+    return big_round(x, precision, 0);
+}
+
+/**
+ * \brief           A function used to get the magnitude of a value scaled by a power of 2, rounded down to an integer
+ * \param[out]      result: The integer
+ * \param[in]       x: The value
+ * \param[in]       bits: The power of 2
+ * \return          1 on success, 0 if memory cannot be allocated
+ */
+static uint8_t
+big_floor_scaled(big_nat_t* result, const big_value_t* x, int64_t bits) {
+    int64_t shift = x->exponent + bits;
+    return shift >= 0 ? nat_shl(result, &x->magnitude, shift) : nat_shr(result, &x->magnitude, -shift);
+}
+
+/**
+ * \brief           A function used to calculate a square root
+ * \param[out]      result: The root, may be the argument
+ * \param[in]       x: The argument, not negative
+ * \param[in]       precision: Bits of a fraction
+ * \return          1 on success, 0 if memory cannot be allocated
+ * \note            The root of a square integer is exact
+ */
+static uint8_t
+big_sqrt(big_value_t* result, const big_value_t* x, int64_t precision) {
+    big_value_t root = {0};
+    big_nat_t scaled = {0}, remainder = {0};
+    int64_t shift = 2 * precision + 4 - nat_bits(&x->magnitude);
+    uint8_t ok;
+    shift = shift > 0 ? shift : 0;
+    shift += (x->exponent - shift) & 1;         /* The exponent is halved */
+    ok = nat_shl(&scaled, &x->magnitude, shift) && nat_sqrt(&root.magnitude, &remainder, &scaled);
+    root.exponent = (x->exponent - shift) / 2;
+    root.negative = x->negative;                /* sqrt(-0) is -0 */
+    if (ok && x->is_integer && remainder.size == 0) {
+        root.is_integer = 1;
+        root.exponent = 0;
+        ok = nat_shr(&root.magnitude, &root.magnitude, shift / 2);
+    }
+    ok = ok && big_finish(&root, precision, remainder.size > 0);
+    if (ok) {
+        big_replace(result, &root);
+    }
+    big_free(&root);
+    free(scaled.limbs);
+    free(remainder.limbs);
+    return ok;
+}
+
+/**
+ * \brief           A function used to count the terms of a series needed for a precision
+ * \param[in]       kind: The series
+ * \param[in]       magnitude: The binary logarithm of the argument, at most 0
+ * \param[in]       precision: A number of bits
+ * \return          A number of terms
+ */
+static uint64_t
+series_length(big_series_kind_t kind, double magnitude, int64_t precision) {
+    double bits = 0;
+    uint64_t n = 0;
+    while (bits < (double)precision + 16) {     /* Every term is smaller than the previous one by the bits it adds */
+        ++n;
+        switch (kind) {
+            case BIG_SERIES_EXP:
+                bits += log2((double)n) - magnitude;
+                break;
+            case BIG_SERIES_SIN:
+                bits += log2(2.0 * (double)n * (2.0 * (double)n + 1)) - 2 * magnitude;
+                break;
+            case BIG_SERIES_PI:
+                bits += CALC_BIG_CHUDNOVSKY_BITS;
+                break;
+            default:
+                bits -= 2 * magnitude;
+                break;
+        }
+    }
+    return n + 1;
+}
+
+/**
+ * \brief           A function used to set the products of a single term of a series
+ * \param[in]       series: The series
+ * \param[in]       n: The index of the term
+ * \param[out]      split: The products, initially zero
+ * \return          1 on success, 0 if memory cannot be allocated
+ */
+static uint8_t
+series_term(const big_series_t* series, uint64_t n, big_split_t* split) {
+    uint8_t ok = 1;
+    if (n == 0) {                               /* The first term is a(0) */
+        return nat_set_u64(&split->p, 1) && nat_set_u64(&split->q, 1) && nat_set_u64(&split->b, 1)
+            && nat_set_u64(&split->t, series->kind == BIG_SERIES_PI ? 13591409 : 1);
+    }
+    split->shift = series->shift;
+    split->p_negative = split->t_negative = series->negative;
+    switch (series->kind) {
+        case BIG_SERIES_EXP:
+            ok = nat_set_u64(&split->q, n);
+            break;
+        case BIG_SERIES_SIN:
+            ok = nat_set_u64(&split->q, 2 * n * (2 * n + 1));
+            break;
+        case BIG_SERIES_ATAN:
+        case BIG_SERIES_ATANH:
+            ok = nat_set_u64(&split->q, series->denominator) && nat_set_u64(&split->b, 2 * n + 1);
+            break;
+        case BIG_SERIES_PI:                     /* p(n) = -(6n - 5)(2n - 1)(6n - 1), q(n) = n^3 640320^3 / 24, a(n) = 13591409 + 545140134 n */
+            return nat_set_u64(&split->p, (6 * n - 5) * (2 * n - 1)) && nat_mul_small(&split->p, (big_limb_t)(6 * n - 1), 0)
+                && nat_set_u64(&split->q, n * n * n) && nat_mul_small(&split->q, 36864000, 0) && nat_mul_small(&split->q, 296740963, 0)
+                && nat_set_u64(&split->t, 13591409 + 545140134 * n) && nat_mul(&split->t, &split->t, &split->p);
+    }
+    return ok && nat_set(&split->p, series->numerator.limbs, series->numerator.size)
+        && nat_set(&split->t, series->numerator.limbs, series->numerator.size);
+}
+
+/**
+ * \brief           A function used to add natural numbers with signs
+ * \param[out]      result: The sum, may be one of the operands
+ * \param[out]      negative: Set to `1` when the sum is negative
+ * \param[in]       a: The magnitude of the first addend
+ * \param[in]       a_negative: Set to `1` when the first addend is negative
+ * \param[in]       b: The magnitude of the second addend
+ * \param[in]       b_negative: Set to `1` when the second addend is negative
+ * \return          1 on success, 0 if memory cannot be allocated
+ */
+static uint8_t
+nat_add_signed(big_nat_t* result, uint8_t* negative, const big_nat_t* a, uint8_t a_negative, const big_nat_t* b, uint8_t b_negative) {
+    if (a_negative == b_negative) {
+        *negative = a_negative;
+        return nat_add(result, a, b);
+    } else if (nat_cmp(a, b) >= 0) {
+        *negative = a_negative;
+        return nat_sub(result, a, b);
+    }
+    *negative = b_negative;
+    return nat_sub(result, b, a);
+}
+
+/**
+ * \brief           A function used to calculate the products of a range of terms of a series by binary splitting
+ * \param[in]       series: The series
+ * \param[in]       low: The first term
+ * \param[in]       high: The term after the last one
+ * \param[in]       need_p: Set to `0` when the product of p(n) is not needed, as on the right edge of the range
+ * \param[out]      split: The products, initially zero
+ * \return          1 on success, 0 if memory cannot be allocated
+ * \note            The products of the halves are combined, so the numbers multiplied grow with the range and most of the work
+ *                  is a few multiplications of long numbers, which are subquadratic
+ */
+static uint8_t
+series_split(const big_series_t* series, uint64_t low, uint64_t high, uint8_t need_p, big_split_t* split) {
+    big_split_t left = {0}, right = {0};
+    big_nat_t product = {0};
+    uint64_t middle = low + (high - low) / 2;
+    uint8_t has_b = series->kind == BIG_SERIES_ATAN || series->kind == BIG_SERIES_ATANH, ok;
+    if (high - low == 1) {
+        return series_term(series, low, split);
+    }
+    ok = series_split(series, low, middle, 1, &left) && series_split(series, middle, high, need_p, &right)
+        && nat_mul(&split->t, &left.t, &right.q)            /* T = B(r) Q(r) 2^shift(r) T(l) + B(l) P(l) T(r) */
+        && (!has_b || nat_mul(&split->t, &split->t, &right.b))
+        && nat_shl(&split->t, &split->t, right.shift)
+        && nat_mul(&product, &left.p, &right.t)
+        && (!has_b || nat_mul(&product, &product, &left.b))
+        && nat_add_signed(&split->t, &split->t_negative, &split->t, left.t_negative, &product, left.p_negative != right.t_negative)
+        && nat_mul(&split->q, &left.q, &right.q)
+        && (!has_b || nat_mul(&split->b, &left.b, &right.b))
+        && (!need_p || nat_mul(&split->p, &left.p, &right.p));
+    split->shift = left.shift + right.shift;
+    split->p_negative = left.p_negative != right.p_negative;
+    free(left.p.limbs);
+    free(left.q.limbs);
+    free(left.b.limbs);
+    free(left.t.limbs);
+    free(right.p.limbs);
+    free(right.q.limbs);
+    free(right.b.limbs);
+    free(right.t.limbs);
+    free(product.limbs);
+    return ok;
+}
+
+/**
+ * \brief           A function used to sum a series by binary splitting
+ * \param[in]       series: The series
+ * \param[in]       terms: A number of terms
+ * \param[in]       precision: Bits of the results
+ * \param[out]      numerator: The sum times the denominator
+ * \param[out]      denominator: A value between 1/2 and 1
+ * \return          1 on success, 0 if memory cannot be allocated
+ * \note            The sum is left as a fraction, so a product of several sums needs a single division
+ */
+static uint8_t
+series_sum(const big_series_t* series, uint64_t terms, int64_t precision, big_value_t* numerator, big_value_t* denominator) {
+    big_split_t split = {0};
+    int64_t scale;
+    uint8_t ok = series_split(series, 0, terms, 0, &split)
+        && ((series->kind != BIG_SERIES_ATAN && series->kind != BIG_SERIES_ATANH) || nat_mul(&split.q, &split.q, &split.b));
+    scale = nat_bits(&split.q);                 /* Both are scaled by the same power of 2, which keeps them in range */
+    ok = ok && big_from_nat(numerator, &split.t, -scale - split.shift, split.t_negative, precision)
+        && big_from_nat(denominator, &split.q, -scale, 0, precision);
+    free(split.p.limbs);
+    free(split.q.limbs);
+    free(split.b.limbs);
+    free(split.t.limbs);
+    return ok;
+}
+
+/**
+ * \brief           A function used to get a constant, calculating it on first use
+ * \param[in,out]   constants: The constants calculated so far
+ * \param[in]       id: The constant
+ * \param[in]       precision: Bits of the result
+ * \param[out]      value: The constant
+ * \return          1 on success, 0 if memory cannot be allocated
+ * \note            pi = 426880 sqrt(10005) / the Chudnovsky series, which adds 14 digits per term.
+ *                  ln(2) = 18 atanh(1/26) - 2 atanh(1/4801) + 8 atanh(1/8749), e is the sum of 1 / n!.
+ */
+static uint8_t
+big_constant(big_constants_t* constants, big_constant_t id, int64_t precision, big_value_t* value) {
+    static const uint32_t ln2_terms[3][2] = {{26, 18}, {4801, 2}, {8749, 8}};  /* Machin-like formula of ln(2) */
+    big_value_t computed = {0}, a = {0}, b = {0};
+    big_series_t series = {0};
+    int64_t working = precision + CALC_BIG_FUNCTION_GUARD;
+    uint8_t ok = 1;
+    if (constants->precisions[id] < precision) {
+        switch (id) {
+            case BIG_CONSTANT_PI:
+                series.kind = BIG_SERIES_PI;
+                series.negative = 1;
+                ok = series_sum(&series, series_length(BIG_SERIES_PI, 0, working), working, &a, &b)
+                    && big_from_double(&computed, 10005) && big_sqrt(&computed, &computed, working)
+                    && big_mul(&computed, &computed, &b, working) && big_div(&computed, &computed, &a, working)
+                    && big_from_double(&b, 426880) && big_mul(&computed, &computed, &b, working);
+                break;
+            case BIG_CONSTANT_LN2:
+                series.kind = BIG_SERIES_ATANH;
+                ok = nat_set_u64(&series.numerator, 1);
+                for (size_t i = 0; ok && i < 3; ++i) {  /* atanh(1/m) = the series of 1/m^2, divided by m */
+                    series.denominator = ln2_terms[i][0] * ln2_terms[i][0];
+                    ok = series_sum(&series, series_length(BIG_SERIES_ATANH, -log2((double)ln2_terms[i][0]), working), working, &a, &b)
+                        && big_div(&a, &a, &b, working) && big_from_double(&b, ln2_terms[i][1]) && big_mul(&a, &a, &b, working)
+                        && big_from_double(&b, ln2_terms[i][0]) && big_div(&a, &a, &b, working) && big_add(&computed, &computed, &a, i == 1, working);
+                }
+                break;
+            case BIG_CONSTANT_E:
+                series.kind = BIG_SERIES_EXP;
+                ok = nat_set_u64(&series.numerator, 1)
+                    && series_sum(&series, series_length(BIG_SERIES_EXP, 0, working), working, &a, &b) && big_div(&computed, &a, &b, working);
+                break;
+            default:
+                ok = big_from_double(&a, 10) && big_ln(&computed, &a, working, constants);
+                break;
+        }
+        if (ok) {
+            big_replace(&constants->values[id], &computed);
+            constants->precisions[id] = working;
+        }
+    }
+    big_free(&computed);
+    big_free(&a);
+    big_free(&b);
+    free(series.numerator.limbs);
+    return ok && big_copy(value, &constants->values[id]) && big_round(value, precision, 1);
+}
+
+/**
+ * \brief           A function used to calculate the exponential function of a small argument
+ * \param[out]      result: The result
+ * \param[in]       x: The argument, below 1 in magnitude
+ * \param[in]       precision: Bits of the result
+ * \return          1 on success, 0 if memory cannot be allocated
+ * \note            The bit-burst algorithm: the argument is cut into pieces of 32, 32, 64, 128, ... bits after its leading zeros,
+ *                  so e^x is the product of e^piece. A piece of 2^j bits is below 2^-(2^j), so its series needs a few terms of
+ *                  short numbers, and every series is summed by binary splitting.
+ */
+static uint8_t
+big_exp_reduced(big_value_t* result, const big_value_t* x, int64_t precision) {
+    big_value_t product = {0}, divisor = {0}, numerator = {0}, denominator = {0};
+    big_series_t series = {0};
+    big_nat_t previous = {0}, current = {0};
+    int64_t offset = -(x->exponent + nat_bits(&x->magnitude));      /* Zero bits after the point */
+    uint8_t ok = big_from_double(&product, 1) && big_from_double(&divisor, 1);
+    series.kind = BIG_SERIES_EXP;
+    series.negative = x->negative;
+    offset = offset > 0 ? offset : 0;
+    for (int64_t done = 0, length = CALC_BIG_BURST_BITS; ok && done < precision + 8 && done < -x->exponent; done = offset + length, length *= 2) {
+        int64_t bits = offset + length;
+        ok = big_floor_scaled(&current, x, bits) && nat_shl(&previous, &previous, bits - done)
+            && nat_sub(&series.numerator, &current, &previous);                 /* The bits from done to bits */
+        if (ok && series.numerator.size > 0) {
+            series.shift = bits;
+            ok = series_sum(&series, series_length(BIG_SERIES_EXP, (double)(nat_bits(&series.numerator) - bits), precision), precision,
+                            &numerator, &denominator)
+                && big_mul(&product, &product, &numerator, precision) && big_mul(&divisor, &divisor, &denominator, precision);
+        }
+        nat_replace(&previous, &current);
+    }
+    ok = ok && big_div(result, &product, &divisor, precision);
+    big_free(&product);
+    big_free(&divisor);
+    big_free(&numerator);
+    big_free(&denominator);
+    free(series.numerator.limbs);
+    free(previous.limbs);
+    free(current.limbs);
+    return ok;
+}
+
+/**
+ * \brief           A function used to calculate the exponential function
+ * \param[out]      result: The result, may be the argument
+ * \param[in]       x: The argument
+ * \param[in]       precision: Bits of the result
+ * \param[in,out]   constants: The constants calculated so far
+ * \return          1 on success, 0 if memory cannot be allocated
+ * \note            e^n of an integer is a power of e. Otherwise x = k ln(2) + r with |r| <= ln(2) / 2 and e^x = 2^k e^r.
+ */
+static uint8_t
+big_exp(big_value_t* result, const big_value_t* x, int64_t precision, big_constants_t* constants) {
+    big_value_t reduced = {0}, power = {0};
+    int64_t working = precision + CALC_BIG_FUNCTION_GUARD, n;
+    uint8_t ok;
+    if (x->magnitude.size == 0) {
+        return big_from_double(result, 1);
+    } else if (big_log2(x) > 25) {              /* Beyond 2^(2^25) or below its reciprocal */
+        return big_from_double(result, x->negative ? 0 : INFINITY);
+    } else if (big_to_int64(x, &n)) {
+        ok = big_constant(constants, BIG_CONSTANT_E, working + 32, &power) && big_pow(result, &power, n, precision);
+        big_free(&power);
+        return ok;
+    }
+    n = (int64_t)floor(big_to_double(x) / 0.69314718055994531 + 0.5);  /* ln(2) */
+    ok = big_constant(constants, BIG_CONSTANT_LN2, working + 32, &power) && big_from_double(&reduced, (double)n)
+        && big_mul(&power, &power, &reduced, working + 32) && big_add(&reduced, x, &power, 1, working + 32)
+        && big_exp_reduced(result, &reduced, working);
+    result->exponent += n;
+    ok = ok && big_finish(result, precision, 1);
+    big_free(&reduced);
+    big_free(&power);
+    return ok;
+}
+
+/**
+ * \brief           A function used to calculate the natural logarithm of a value near 1 by Newton's iteration
+ * \param[out]      result: The result
+ * \param[in]       x: The argument, between 1/2 and 2
+ * \param[in]       precision: Bits of the result
+ * \param[in,out]   constants: The constants calculated so far
+ * \return          1 on success, 0 if memory cannot be allocated
+ * \note            y + x e^-y - 1 has twice the correct bits of y, so the precision doubles from a double estimate and
+ *                  the last exponential at the full precision costs most
+ */
+static uint8_t
+big_ln_newton(big_value_t* result, const big_value_t* x, int64_t precision, big_constants_t* constants) {
+    big_value_t y = {0}, power = {0}, one = {0};
+    int64_t precisions[64];
+    size_t count = 0;
+    uint8_t ok = big_from_double(&y, log(big_to_double(x))) && big_from_double(&one, 1);
+    for (int64_t bits = precision; bits > 48; bits = bits / 2 + 16) {
+        precisions[count++] = bits;
+    }
+    while (ok && count-- > 0) {
+        ok = big_copy(&power, &y);
+        power.negative = !power.negative;
+        ok = ok && big_exp(&power, &power, precisions[count], constants) && big_mul(&power, &power, x, precisions[count])
+            && big_add(&power, &power, &one, 1, precisions[count]) && big_add(&y, &y, &power, 0, precisions[count]);
+    }
+    if (ok) {
+        big_replace(result, &y);
+    }
+    big_free(&y);
+    big_free(&power);
+    big_free(&one);
+    return ok;
+}
+
+/**
+ * \brief           A function used to calculate the natural logarithm of a value near 1 by the arithmetic-geometric mean
+ * \param[out]      result: The result
+ * \param[in]       x: The argument, between 1/2 and 2
+ * \param[in]       precision: Bits of the result
+ * \param[in,out]   constants: The constants calculated so far
+ * \return          1 on success, 0 if memory cannot be allocated
+ * \note            ln(s) = pi / (2 AGM(1, 4 / s)) with an error below 1 / s^2, so for s = x 2^m with m over half the precision
+ *                  ln(x) = pi / (2 AGM(1, 4 / s)) - m ln(2). The mean converges quadratically, so it takes about 2 log2(precision)
+ *                  steps of a multiplication and a square root.
+ */
+static uint8_t
+big_ln_agm(big_value_t* result, const big_value_t* x, int64_t precision, big_constants_t* constants) {
+    big_value_t a = {0}, b = {0}, product = {0}, difference = {0};
+    int64_t shift = precision / 2 + 8, working = precision + 64;
+    uint8_t ok = big_from_double(&a, 1) && big_copy(&b, x);
+    b.exponent += shift;
+    b.is_integer = 0;
+    ok = ok && big_from_double(&product, 4) && big_div(&b, &product, &b, working);
+    while (ok) {
+        ok = big_add(&difference, &a, &b, 1, working);
+        if (!ok || difference.magnitude.size == 0 || big_log2(&difference) < big_log2(&a) - (double)working / 2 - 4) {
+            break;                              /* The next mean is correct to the working precision */
+        }
+        ok = big_mul(&product, &a, &b, working) && big_add(&a, &a, &b, 0, working) && big_sqrt(&b, &product, working);
+        a.exponent -= 1;
+    }
+    ok = ok && big_add(&a, &a, &b, 0, working) && big_constant(constants, BIG_CONSTANT_PI, working, &b) && big_div(&a, &b, &a, working)
+        && big_constant(constants, BIG_CONSTANT_LN2, working, &b) && big_from_double(&product, (double)shift)
+        && big_mul(&b, &b, &product, working) && big_add(result, &a, &b, 1, precision);
+    big_free(&a);
+    big_free(&b);
+    big_free(&product);
+    big_free(&difference);
+    return ok;
+}
+
+/**
+ * \brief           A function used to calculate the natural logarithm
+ * \param[out]      result: The result, may be the argument
+ * \param[in]       x: The argument, positive
+ * \param[in]       precision: Bits of the result
+ * \param[in,out]   constants: The constants calculated so far
+ * \return          1 on success, 0 if memory cannot be allocated
+ * \note            x = 2^k m with m between 1/sqrt(2) and sqrt(2), ln(x) = k ln(2) + ln(m). For m near 1 ln(m) loses
+ *                  -log2|m - 1| bits, which are added to the precision, or is m - 1 - (m - 1)^2 / 2 when that is exact enough.
+ *                  From \ref CALC_BIG_AGM_BITS the arithmetic-geometric mean is faster than Newton's iteration.
+ */
+static uint8_t
+big_ln(big_value_t* result, const big_value_t* x, int64_t precision, big_constants_t* constants) {
+    big_value_t m = {0}, y = {0}, t = {0};
+    int64_t k = (int64_t)floor(big_log2(x) + 0.5), working = precision + CALC_BIG_FUNCTION_GUARD;
+    double small;
+    uint8_t ok = big_copy(&m, x) && big_from_double(&t, 1);
+    m.exponent -= k;
+    m.is_integer = 0;
+    ok = ok && big_add(&y, &m, &t, 1, nat_bits(&m.magnitude) + 2);             /* m - 1, exact */
+    small = ok && y.magnitude.size > 0 ? -big_log2(&y) : 0;
+    if (!ok || y.magnitude.size == 0) {
+        /* ln(1) = 0 */
+    } else if (k == 0 && small > (double)(working + 8) / 2) {                   /* ln(1 + d) = d - d^2 / 2 + d^3 / 3 - ... */
+        ok = big_mul(&t, &y, &y, working);
+        t.exponent -= 1;
+        ok = ok && big_add(&y, &y, &t, 1, working);
+    } else {
+        working += k == 0 && small > 0 ? (int64_t)small : 0;
+        ok = working >= CALC_BIG_AGM_BITS ? big_ln_agm(&y, &m, working, constants) : big_ln_newton(&y, &m, working, constants);
+    }
+    if (ok && k != 0) {
+        ok = big_constant(constants, BIG_CONSTANT_LN2, working + 64, &m) && big_from_double(&t, (double)k)
+            && big_mul(&m, &m, &t, working + 64) && big_add(&y, &y, &m, 0, working);
+    }
+    if (ok && y.magnitude.size == 0 && k == 0) {
+        ok = big_from_double(&y, 0);            /* An exact 0 */
+    }
+    ok = ok && (y.is_integer || big_finish(&y, precision, 1));
+    if (ok) {
+        big_replace(result, &y);
+    }
+    big_free(&m);
+    big_free(&y);
+    big_free(&t);
+    return ok;
+}
+
+/**
+ * \brief           A function used to raise a value to a fractional power
+ * \param[out]      result: The result
+ * \param[in]       x: The base, positive
+ * \param[in]       y: The exponent
+ * \param[in]       precision: Bits of the result
+ * \param[in,out]   constants: The constants calculated so far
+ * \return          1 on success, 0 if memory cannot be allocated
+ * \note            x^y = e^(y ln(x)). An error of y ln(x) is relative in e^(y ln(x)), so the logarithm takes the bits of the
+ *                  integer part of y ln(x) more.
+ */
+static uint8_t
+big_power(big_value_t* result, const big_value_t* x, const big_value_t* y, int64_t precision, big_constants_t* constants) {
+    big_value_t z = {0};
+    double magnitude = big_log2(y) + log2(fabs(big_log2(x)) + 1);     /* At least log2|y ln(x)| */
+    int64_t working = precision + CALC_BIG_FUNCTION_GUARD + (magnitude > 0 ? (int64_t)fmin(magnitude, 64) : 0);
+    uint8_t ok = big_ln(&z, x, working, constants) && big_mul(&z, &z, y, working) && big_exp(result, &z, precision, constants);
+    big_free(&z);
+    return ok;
+}
+
+/**
+ * \brief           A function used to calculate the factorial of a fraction, the gamma function of the fraction plus 1
+ * \param[out]      result: The result
+ * \param[in]       x: The argument, positive and not an integer
+ * \param[in]       precision: Bits of the result
+ * \param[in,out]   constants: The constants calculated so far
+ * \param[out]      code: Set to \ref CALC_ERROR_INVALID_INPUT if the series is longer than \ref CALC_BIG_GAMMA_MAX_BITS
+ * \return          1 on success, 0 if memory cannot be allocated
+ * \note            Γ(s) = N^s e^-N / s times the sum of N^n / ((s + 1) ... (s + n)), up to the upper incomplete gamma
+ *                  function of s at N, which is below Γ(s) 2^-precision for N about precision ln(2) + s ln(N). The terms
+ *                  are positive, so they are summed one by one without cancellation; s has all the bits of the precision,
+ *                  which leaves nothing for binary splitting to gain. A series longer than \ref CALC_BIG_GAMMA_MAX_BITS
+ *                  is reported instead of printing wrong digits.
+ */
+static uint8_t
+big_gamma(big_value_t* result, const big_value_t* x, int64_t precision, big_constants_t* constants, calc_error_code_t* code) {
+    big_value_t s = {0}, n = {0}, k = {0}, term = {0}, sum = {0}, power = {0};
+    int64_t working = precision + 2 * CALC_BIG_FUNCTION_GUARD;     /* The rounding of s is magnified by s ψ(s) */
+    double sd, nd, logterm = 0, peak = 0;
+    uint64_t terms = 0;
+    uint8_t ok = big_from_double(&s, 1) && big_add(&s, x, &s, 0, working);
+
+    sd = big_to_double(&s);
+    nd = (double)working * 0.69314718055994531 + 2;
+    for (int i = 0; i < 8; ++i) {               /* Γ(s, N) is below 2 N^(s - 1) e^-N from N = 2s */
+        nd = fmax(2 * sd, (double)working * 0.69314718055994531 + 1 + (sd - 1) * log(nd) - lgamma(sd));
+    }
+    nd = ceil(nd);
+    while ((logterm > peak - ((double)working + 16) * 0.69314718055994531 || (double)terms < nd)
+           && (double)terms * (double)working <= (double)CALC_BIG_GAMMA_MAX_BITS) {  /* A huge argument stops at the limit */
+        ++terms;                                /* Terms rise up to n = N - s and fall faster than 2^-n from 2N */
+        logterm += log(nd) - log(sd + (double)terms);
+        peak = fmax(peak, logterm);
+    }
+    if (ok && (double)terms * (double)working > (double)CALC_BIG_GAMMA_MAX_BITS) {
+        *code = CALC_ERROR_INVALID_INPUT;
+        big_free(&s);
+        return 1;
+    }
+    working += (int64_t)log2((double)terms) + 1;     /* Every term adds a rounding */
+    ok = ok && big_from_double(&n, nd) && big_from_double(&term, 1) && big_from_double(&sum, 1);
+    for (uint64_t i = 1; ok && i <= terms; ++i) {   /* term(i) = term(i - 1) N / (s + i) */
+        ok = big_from_double(&k, (double)i) && big_add(&k, &s, &k, 0, working)
+            && big_mul(&term, &term, &n, working) && big_div(&term, &term, &k, working) && big_add(&sum, &sum, &term, 0, working);
+    }
+    ok = ok && big_power(&power, &n, &s, working, constants)                          /* N^s */
+        && big_mul(&sum, &sum, &power, working) && big_div(&sum, &sum, &s, working);
+    n.negative = 1;
+    ok = ok && big_exp(&power, &n, working, constants)                                 /* e^-N */
+        && big_mul(&sum, &sum, &power, working) && big_finish(&sum, precision, 1);
+    if (ok) {
+        big_replace(result, &sum);
+    }
+    big_free(&s);
+    big_free(&n);
+    big_free(&k);
+    big_free(&term);
+    big_free(&sum);
+    big_free(&power);
+    return ok;
+}
+
+/**
+ * \brief           A function used to calculate the arc tangent of a small argument
+ * \param[out]      result: The result
+ * \param[in]       x: The argument, positive and at most 1/8
+ * \param[in]       precision: Bits of the result
+ * \return          1 on success, 0 if memory cannot be allocated
+ * \note            The bit-burst algorithm: a piece p of the leading bits of the argument has a short series, and
+ *                  atan(x) = atan(p) + atan((x - p) / (1 + x p)), whose argument starts twice as far below the point
+ */
+static uint8_t
+big_atan_reduced(big_value_t* result, const big_value_t* x, int64_t precision) {
+    big_value_t sum = {0}, rest = {0}, piece = {0}, numerator = {0}, denominator = {0}, one = {0};
+    big_series_t series = {0};
+    int64_t offset = -(x->exponent + nat_bits(&x->magnitude));      /* Zero bits after the point */
+    uint8_t ok = big_copy(&rest, x) && big_from_double(&one, 1);
+    series.kind = BIG_SERIES_ATAN;
+    series.denominator = 1;
+    series.negative = 1;
+    for (int64_t length = CALC_BIG_BURST_BITS; ok && rest.magnitude.size > 0 && length < 2 * (precision + 8); length *= 2) {
+        int64_t bits = offset + length;
+        ok = big_floor_scaled(&piece.magnitude, &rest, bits);
+        if (ok && piece.magnitude.size > 0) {   /* atan(p) = p times the series of p^2 */
+            series.shift = 2 * bits;
+            piece.exponent = -bits;
+            ok = nat_mul(&series.numerator, &piece.magnitude, &piece.magnitude)
+                && series_sum(&series, series_length(BIG_SERIES_ATAN, (double)(nat_bits(&piece.magnitude) - bits), precision), precision,
+                              &numerator, &denominator)
+                && big_mul(&numerator, &numerator, &piece, precision) && big_div(&numerator, &numerator, &denominator, precision)
+                && big_add(&sum, &sum, &numerator, 0, precision)
+                && big_mul(&denominator, &rest, &piece, precision) && big_add(&denominator, &denominator, &one, 0, precision)
+                && big_add(&rest, &rest, &piece, 1, precision) && big_div(&rest, &rest, &denominator, precision);
+        }
+    }
+    ok = ok && big_add(result, &sum, &rest, 0, precision);  /* atan(r) = r for the rest below the precision */
+    big_free(&sum);
+    big_free(&rest);
+    big_free(&piece);
+    big_free(&numerator);
+    big_free(&denominator);
+    big_free(&one);
+    free(series.numerator.limbs);
+    return ok;
+}
+
+/**
+ * \brief           A function used to calculate the arc tangent
+ * \param[out]      result: The result, may be the argument
+ * \param[in]       x: The argument
+ * \param[in]       precision: Bits of the result
+ * \param[in,out]   constants: The constants calculated so far
+ * \return          1 on success, 0 if memory cannot be allocated
+ * \note            atan(x) = pi/2 - atan(1/x) above 1, and atan(x) = 2 atan(x / (1 + sqrt(1 + x^2))) halves the argument
+ *                  until it is below 1/8
+ */
+static uint8_t
+big_atan(big_value_t* result, const big_value_t* x, int64_t precision, big_constants_t* constants) {
+    big_value_t z = {0}, t = {0}, one = {0};
+    int64_t working = precision + CALC_BIG_FUNCTION_GUARD, halvings = 0;
+    int compared = big_cmp_one(x);
+    uint8_t ok = big_copy(&z, x) && big_from_double(&one, 1);
+    z.negative = 0;
+    if (!ok || x->magnitude.size == 0) {
+        /* atan(0) = 0, of the same sign */
+    } else if (compared == 0) {                 /* atan(1) = pi/4 */
+        ok = big_constant(constants, BIG_CONSTANT_PI, precision, &z);
+        z.exponent -= 2;
+    } else {
+        ok = compared < 0 || big_div(&z, &one, &z, working);
+        while (ok && big_log2(&z) > -3) {
+            ok = big_mul(&t, &z, &z, working) && big_add(&t, &t, &one, 0, working) && big_sqrt(&t, &t, working)
+                && big_add(&t, &t, &one, 0, working) && big_div(&z, &z, &t, working);
+            ++halvings;
+        }
+        ok = ok && big_atan_reduced(&z, &z, working);
+        z.exponent += halvings;
+        if (ok && compared > 0) {
+            ok = big_constant(constants, BIG_CONSTANT_PI, working, &t);
+            t.exponent -= 1;
+            ok = ok && big_add(&z, &t, &z, 1, working);
+        }
+        ok = ok && big_finish(&z, precision, 1);
+    }
+    z.negative = x->negative;
+    if (ok) {
+        big_replace(result, &z);
+    }
+    big_free(&z);
+    big_free(&t);
+    big_free(&one);
+    return ok;
+}
+
+/**
+ * \brief           A function used to calculate the sine and cosine of a small argument
+ * \param[out]      sine: The sine
+ * \param[out]      cosine: The cosine
+ * \param[in]       x: The argument, not negative and at most 1
+ * \param[in]       precision: Bits of the results
+ * \return          1 on success, 0 if memory cannot be allocated
+ * \note            The bit-burst algorithm: the argument is cut into pieces like for \ref big_exp_reduced, the sine of every
+ *                  piece is a short series, its cosine is sqrt(1 - sin^2), and the pieces are added by the rotation formulas
+ */
+static uint8_t
+big_sincos_reduced(big_value_t* sine, big_value_t* cosine, const big_value_t* x, int64_t precision) {
+    big_value_t s = {0}, c = {0}, piece = {0}, sin_p = {0}, cos_p = {0}, numerator = {0}, denominator = {0}, one = {0};
+    big_series_t series = {0};
+    big_nat_t previous = {0}, current = {0};
+    int64_t offset = -(x->exponent + nat_bits(&x->magnitude));      /* Zero bits after the point */
+    uint8_t ok = big_from_double(&c, 1) && big_from_double(&one, 1);
+    series.kind = BIG_SERIES_SIN;
+    series.negative = 1;
+    offset = offset > 0 ? offset : 0;
+    for (int64_t done = 0, length = CALC_BIG_BURST_BITS; ok && done < offset + precision + 8 && done < -x->exponent; done = offset + length, length *= 2) {
+        int64_t bits = offset + length;
+        ok = big_floor_scaled(&current, x, bits) && nat_shl(&previous, &previous, bits - done)
+            && nat_sub(&piece.magnitude, &current, &previous);
+        if (ok && piece.magnitude.size > 0) {   /* sin(p) = p times the series of p^2 */
+            series.shift = 2 * bits;
+            piece.exponent = -bits;
+            ok = nat_mul(&series.numerator, &piece.magnitude, &piece.magnitude)
+                && series_sum(&series, series_length(BIG_SERIES_SIN, (double)(nat_bits(&piece.magnitude) - bits), precision), precision,
+                              &numerator, &denominator)
+                && big_mul(&numerator, &numerator, &piece, precision) && big_div(&sin_p, &numerator, &denominator, precision)
+                && big_mul(&cos_p, &sin_p, &sin_p, precision) && big_add(&cos_p, &one, &cos_p, 1, precision)
+                && big_sqrt(&cos_p, &cos_p, precision)
+                && big_mul(&numerator, &s, &cos_p, precision) && big_mul(&denominator, &c, &sin_p, precision)
+                && big_mul(&c, &c, &cos_p, precision) && big_mul(&cos_p, &s, &sin_p, precision)
+                && big_add(&s, &numerator, &denominator, 0, precision)  /* sin(a + p) = sin(a) cos(p) + cos(a) sin(p) */
+                && big_add(&c, &c, &cos_p, 1, precision);               /* cos(a + p) = cos(a) cos(p) - sin(a) sin(p) */
+        }
+        nat_replace(&previous, &current);
+    }
+    if (ok) {
+        big_replace(sine, &s);
+        big_replace(cosine, &c);
+    }
+    big_free(&s);
+    big_free(&c);
+    big_free(&piece);
+    big_free(&sin_p);
+    big_free(&cos_p);
+    big_free(&numerator);
+    big_free(&denominator);
+    big_free(&one);
+    free(series.numerator.limbs);
+    free(previous.limbs);
+    free(current.limbs);
+    return ok;
+}
+
+/**
+ * \brief           A function used to calculate the sine and cosine
+ * \param[out]      sine: The sine, may be NULL
+ * \param[out]      cosine: The cosine, may be NULL
+ * \param[in]       x: The argument
+ * \param[in]       precision: Bits of the results
+ * \param[in,out]   constants: The constants calculated so far
+ * \return          1 on success, 0 if memory cannot be allocated
+ * \note            x = k pi/2 + r with |r| <= pi/4. pi has as many more bits as x has integral bits, and as r is nearer a multiple
+ *                  of pi/2 the reduction is repeated with more bits until r has the precision.
+ */
+static uint8_t
+big_sincos(big_value_t* sine, big_value_t* cosine, const big_value_t* x, int64_t precision, big_constants_t* constants) {
+    big_value_t r = {0}, k = {0}, half_pi = {0}, s = {0}, c = {0}, t = {0};
+    int64_t working = precision + CALC_BIG_FUNCTION_GUARD, guard = 64, integral = x->magnitude.size > 0 ? (int64_t)floor(big_log2(x)) : -1;
+    unsigned quadrant = 0;
+    uint8_t ok = big_copy(&r, x);
+    if (integral >= 0) {                        /* Below 1 in magnitude there is nothing to reduce */
+        for (uint8_t reduced = 0; ok && !reduced;) {
+            int64_t wide = working + integral + guard;
+            ok = big_constant(constants, BIG_CONSTANT_PI, wide, &half_pi);
+            half_pi.exponent -= 1;
+            ok = ok && big_div(&k, x, &half_pi, wide) && big_to_integer(&k, CALC_FN_ROUND) && big_mul(&t, &k, &half_pi, wide)
+                && big_add(&r, x, &t, 1, wide);
+            if (ok && r.magnitude.size > 0 && -big_log2(&r) + 16 < (double)guard) {
+                reduced = 1;
+            } else {                            /* r lost more bits than the guard */
+                guard = r.magnitude.size > 0 ? 2 * (int64_t)-big_log2(&r) + 64 : 2 * guard;
+            }
+        }
+        quadrant = k.magnitude.size > 0 ? k.magnitude.limbs[0] & 3 : 0;
+        quadrant = k.negative ? (4 - quadrant) & 3 : quadrant;
+    }
+    if (ok && r.magnitude.size > 0) {
+        uint8_t negative = r.negative;
+        r.negative = 0;
+        ok = big_sincos_reduced(&s, &c, &r, working);
+        s.negative = negative;
+    } else {
+        ok = ok && big_copy(&s, &r) && big_from_double(&c, 1);      /* sin(+-0) = +-0, cos(0) = 1 */
+    }
+    if (ok && (quadrant & 1)) {                 /* sin(r + pi/2) = cos(r), cos(r + pi/2) = -sin(r) */
+        big_replace(&t, &s);
+        big_replace(&s, &c);
+        big_replace(&c, &t);
+        c.negative = !c.negative;
+    }
+    if (quadrant & 2) {                         /* sin(r + pi) = -sin(r), cos(r + pi) = -cos(r) */
+        s.negative = !s.negative;
+        c.negative = !c.negative;
+    }
+    ok = ok && (s.is_integer || big_finish(&s, precision, 1)) && (c.is_integer || big_finish(&c, precision, 1));
+    if (ok && sine != NULL) {
+        big_replace(sine, &s);
+    }
+    if (ok && cosine != NULL) {
+        big_replace(cosine, &c);
+    }
+    big_free(&r);
+    big_free(&k);
+    big_free(&half_pi);
+    big_free(&s);
+    big_free(&c);
+    big_free(&t);
+    return ok;
+}
+
+/**
+ * \brief           A function used to calculate a math function with arbitrary precision
+ * \param[in]       fn: The function, a root, logarithm, exponential, trigonometric or hyperbolic function, rad or deg
+ * \param[in]       x: The first argument, in the domain
+ * \param[in]       y: The second argument, NULL if there is none
+ * \param[in]       precision: Bits of the result
+ * \param[in,out]   constants: The constants calculated so far
+ * \param[out]      value: The result
+ * \return          1 on success, 0 if memory cannot be allocated
+ * \note            The functions are built from \ref big_sqrt, \ref big_exp, \ref big_ln, \ref big_atan and \ref big_sincos, with
+ *                  more bits where a formula cancels: -log2|x| near 0, where the result is about x or 1/x
+ */
+static uint8_t
+big_call(calc_function_id_t fn, const big_value_t* x, const big_value_t* y, int64_t precision, big_constants_t* constants, big_value_t* value) {
+    big_value_t a = {0}, b = {0}, one = {0};
+    double magnitude = x->magnitude.size > 0 ? big_log2(x) : -INFINITY;
+    int64_t working = precision + CALC_BIG_FUNCTION_GUARD, extra = magnitude < 0 && x->magnitude.size > 0 ? (int64_t)-magnitude : 0;
+    uint8_t ok = big_from_double(&one, 1), tiny = magnitude < -(double)(working / 2 + 8);  /* x^2 is below the precision */
+    if (tiny && (fn == CALC_FN_SIN || fn == CALC_FN_TAN || fn == CALC_FN_ASIN || fn == CALC_FN_ATAN || fn == CALC_FN_SINH
+                 || fn == CALC_FN_TANH || fn == CALC_FN_ASINH || fn == CALC_FN_ATANH || fn == CALC_FN_ACTANH)) {
+        ok = ok && big_copy(&a, x) && big_finish(&a, precision, 1);         /* f(x) = x (1 + O(x^2)) */
+    } else if (tiny && (fn == CALC_FN_CTAN || fn == CALC_FN_CTANH)) {
+        ok = ok && big_div(&a, &one, x, precision);
+    } else if (fn == CALC_FN_COSH && x->magnitude.size == 0) {
+        ok = ok && big_copy(&a, &one);                  /* e^0 is the integer 1, which the halving below would not halve */
+    } else {
+        switch (fn) {
+            case CALC_FN_SQRT:
+                ok = ok && big_sqrt(&a, x, precision);
+                break;
+            case CALC_FN_EXP:
+                ok = ok && big_exp(&a, x, precision, constants);
+                break;
+            case CALC_FN_LN:
+                ok = ok && big_ln(&a, x, precision, constants);
+                break;
+            case CALC_FN_LOG10:
+                ok = ok && big_ln(&a, x, working, constants) && big_constant(constants, BIG_CONSTANT_LN10, working, &b)
+                    && big_div(&a, &a, &b, precision);
+                break;
+            case CALC_FN_LOG:                       /* log(base, x) */
+                ok = ok && big_ln(&a, y, working, constants) && big_ln(&b, x, working, constants) && big_div(&a, &a, &b, precision);
+                break;
+            case CALC_FN_SIN:
+            case CALC_FN_COS:
+                ok = ok && big_sincos(fn == CALC_FN_SIN ? &a : NULL, fn == CALC_FN_COS ? &a : NULL, x, precision, constants);
+                break;
+            case CALC_FN_TAN:
+            case CALC_FN_CTAN:
+                ok = ok && big_sincos(&a, &b, x, working, constants)
+                    && (fn == CALC_FN_TAN ? big_div(&a, &a, &b, precision) : big_div(&a, &b, &a, precision));
+                break;
+            case CALC_FN_ATAN:
+                ok = ok && big_atan(&a, x, precision, constants);
+                break;
+            case CALC_FN_ACTAN:                     /* atan(1/x), plus pi below 0, so the result is between 0 and pi */
+                if (x->magnitude.size == 0) {
+                    ok = ok && big_constant(constants, BIG_CONSTANT_PI, precision, &a);
+                    a.exponent -= 1;
+                    break;
+                }
+                ok = ok && big_div(&a, &one, x, working) && big_atan(&a, &a, working, constants)
+                    && (!x->negative || (big_constant(constants, BIG_CONSTANT_PI, working, &b) && big_add(&a, &a, &b, 0, working)))
+                    && big_finish(&a, precision, 1);
+                break;
+            case CALC_FN_ASIN:                      /* atan(x / sqrt((1 - x)(1 + x))) */
+            case CALC_FN_ACOS:                      /* 2 atan(sqrt((1 - x) / (1 + x))) */
+                if (big_cmp_one(x) == 0 && (fn == CALC_FN_ASIN || x->negative)) {     /* asin(+-1) = +-pi/2, acos(-1) = pi */
+                    ok = ok && big_constant(constants, BIG_CONSTANT_PI, precision, &a);
+                    a.exponent -= fn == CALC_FN_ASIN;
+                    a.negative = fn == CALC_FN_ASIN && x->negative;
+                    break;
+                }
+                ok = ok && big_add(&a, &one, x, 1, working) && big_add(&b, &one, x, 0, working);
+                if (fn == CALC_FN_ASIN) {
+                    ok = ok && big_mul(&a, &a, &b, working) && big_sqrt(&a, &a, working) && big_div(&a, x, &a, working)
+                        && big_atan(&a, &a, precision, constants);
+                } else {
+                    ok = ok && big_div(&a, &a, &b, working) && big_sqrt(&a, &a, working) && big_atan(&a, &a, precision, constants);
+                    a.exponent += !a.is_integer;    /* acos(1) = 0 is exact */
+                }
+                break;
+            case CALC_FN_SINH:
+            case CALC_FN_COSH:
+            case CALC_FN_TANH:
+            case CALC_FN_CTANH:                     /* From e^|x| and e^-|x|, which cancel near 0 */
+                working += fn == CALC_FN_COSH ? 0 : extra;
+                ok = ok && big_copy(&a, x);
+                a.negative = 0;
+                ok = ok && big_exp(&a, &a, working, constants);
+                if (ok && a.is_special) {           /* e^|x| is infinite, tanh(x) = +-1 */
+                    ok = big_from_double(&a, fn == CALC_FN_SINH || fn == CALC_FN_COSH ? INFINITY : 1);
+                } else if (ok) {
+                    ok = big_div(&b, &one, &a, working) && big_add(&one, &a, &b, 1, working) && big_add(&a, &a, &b, 0, working);
+                    if (fn == CALC_FN_SINH || fn == CALC_FN_COSH) {     /* (e^x -+ e^-x) / 2 */
+                        ok = ok && big_copy(&b, fn == CALC_FN_SINH ? &one : &a);
+                        b.exponent -= 1;
+                        ok = ok && big_finish(&b, precision, 1) && big_copy(&a, &b);
+                    } else {
+                        ok = ok && (fn == CALC_FN_TANH ? big_div(&a, &one, &a, precision) : big_div(&a, &a, &one, precision));
+                    }
+                }
+                a.negative = fn != CALC_FN_COSH && x->negative;
+                break;
+            case CALC_FN_ASINH:                     /* ln(|x| + sqrt(x^2 + 1)) */
+            case CALC_FN_ACOSH:                     /* ln(x + sqrt((x - 1)(x + 1))) */
+                ok = ok && big_copy(&a, x);
+                a.negative = 0;
+                if (fn == CALC_FN_ACOSH && big_cmp_one(x) == 0) {
+                    ok = ok && big_from_double(&a, 0);
+                    break;
+                } else if (magnitude > (double)(working / 2 + 8)) {     /* ln(2|x|) */
+                    a.exponent += 1;
+                    a.is_integer = 0;
+                } else if (fn == CALC_FN_ASINH) {
+                    working += extra;
+                    ok = ok && big_mul(&b, x, x, working) && big_add(&b, &b, &one, 0, working) && big_sqrt(&b, &b, working)
+                        && big_add(&a, &a, &b, 0, working);
+                } else {                            /* The root is about sqrt(2 (x - 1)) near 1 */
+                    ok = ok && big_add(&b, x, &one, 1, working);
+                    working += big_log2(&b) < 0 ? (int64_t)-big_log2(&b) / 2 + 2 : 0;
+                    ok = ok && big_add(&a, x, &one, 0, working) && big_mul(&b, &b, &a, working) && big_sqrt(&b, &b, working)
+                        && big_add(&a, x, &b, 0, working);
+                }
+                ok = ok && big_ln(&a, &a, precision, constants);
+                a.negative = fn == CALC_FN_ASINH && x->negative;
+                break;
+            case CALC_FN_ATANH:
+            case CALC_FN_ACTANH:                    /* ln((1 + x) / (1 - x)) / 2 */
+                working += extra;
+                ok = ok && big_add(&a, &one, x, 0, working) && big_add(&b, &one, x, 1, working) && big_div(&a, &a, &b, working)
+                    && big_ln(&a, &a, precision, constants);
+                a.exponent -= !a.is_integer;
+                break;
+            case CALC_FN_RAD:                       /* x pi / 180 */
+            case CALC_FN_DEG:                       /* x 180 / pi */
+                ok = ok && big_constant(constants, BIG_CONSTANT_PI, working, &a) && big_from_double(&b, 180)
+                    && (fn == CALC_FN_RAD ? big_mul(&a, x, &a, working) && big_div(&a, &a, &b, precision)
+                                          : big_mul(&b, x, &b, working) && big_div(&a, &b, &a, precision));
+                break;
+            default:
+                break;
+        }
+    }
+    if (ok) {
+        big_replace(value, &a);
+    }
+    big_free(&a);
+    big_free(&b);
+    big_free(&one);
+    return ok;
+}
+
+/**
+ * \brief           A function used to print a value
+ * \param[in]       x: The value
+ * \param[in]       digits: Significant digits of a fraction
+ * \return          A NUL-terminated string to be freed with free, NULL if memory cannot be allocated
+ * \note            An integer is printed with all of its digits. A fraction is rounded to the digits, half to even, and
+ *                  printed without trailing zeros, in scientific notation when its decimal exponent is below -5 or not below
+ *                  the digits, like %g. An infinity or NaN is printed by \ref calc_format.
+ */
+static char*
+big_format(const big_value_t* x, size_t digits) {
+    big_nat_t numerator = {0}, denominator = {0}, power = {0}, remainder = {0};
+    char *text = NULL, *significand = NULL;
+    int64_t decimal_exponent;
+    size_t length = 0;
+    uint8_t ok = 1;
+    if (x->is_special) {
+        char buffer[32];
+        calc_format(x->special, buffer, sizeof(buffer));
+        text = (char*)malloc(strlen(buffer) + 1);
+        return text != NULL ? strcpy(text, buffer) : NULL;
+    } else if (x->is_integer || x->magnitude.size == 0) {
+        significand = nat_to_decimal(&x->magnitude);
+        if (significand == NULL || (text = (char*)malloc(strlen(significand) + 2)) == NULL) {
+            free(significand);
+            return NULL;
+        }
+        text[0] = '-';
+        strcpy(text + x->negative, significand);
+        free(significand);
+        return text;
+    }
+    decimal_exponent = (int64_t)floor((double)(x->exponent + nat_bits(&x->magnitude) - 1) * 0.30102999566398120);  /* log10(2) */
+    for (int attempt = 0; ok && attempt < 3; ++attempt) {           /* The estimate of the decimal exponent can be 1 off */
+        int64_t scale = (int64_t)digits - 1 - decimal_exponent;     /* The significand is the value times 10^scale */
+        int64_t shift = x->exponent < 0 && scale >= 0 ? -x->exponent : 0;
+        uint8_t up;
+        if (shift > 0) {                        /* The denominator is a power of 2, the division is a shift */
+            ok = nat_set(&numerator, x->magnitude.limbs, x->magnitude.size) && nat_pow10(&power, (uint64_t)scale)
+                && nat_mul(&numerator, &numerator, &power);
+            up = ok && (nat_extract(&numerator, shift - 1) & 1) != 0
+                && (!nat_is_zero_below(&numerator, shift - 1) || (nat_extract(&numerator, shift) & 1) != 0);   /* Half to even */
+            ok = ok && nat_shr(&numerator, &numerator, shift);
+        } else {
+            int compared;
+            ok = nat_set(&numerator, x->magnitude.limbs, x->magnitude.size) && nat_set_u64(&denominator, 1)
+                && nat_shl(x->exponent > 0 ? &numerator : &denominator, x->exponent > 0 ? &numerator : &denominator,
+                           x->exponent > 0 ? x->exponent : -x->exponent)
+                && nat_pow10(&power, (uint64_t)(scale > 0 ? scale : -scale))
+                && nat_mul(scale > 0 ? &numerator : &denominator, scale > 0 ? &numerator : &denominator, &power)
+                && nat_divmod(&numerator, &remainder, &numerator, &denominator)
+                && nat_shl(&remainder, &remainder, 1);
+            compared = ok ? nat_cmp(&remainder, &denominator) : 0;
+            up = compared > 0 || (compared == 0 && numerator.size > 0 && (numerator.limbs[0] & 1));  /* Half to even */
+        }
+        if (!ok || (up && !nat_mul_small(&numerator, 1, 1))) {
+            ok = 0;
+            break;
+        }
+        free(significand);
+        significand = nat_to_decimal(&numerator);
+        ok = significand != NULL;
+        length = ok ? strlen(significand) : 0;
+        if (length == digits) {
+            break;
+        }
+        decimal_exponent += length > digits ? 1 : -1;
+    }
+    if (ok && length == digits) {
+        while (length > 1 && significand[length - 1] == '0') {    /* Trim trailing zeros */
+            significand[--length] = '\0';
+        }
+        text = (char*)malloc(length + (size_t)(decimal_exponent < 0 ? -decimal_exponent : decimal_exponent) + 32);
+    }
+    if (text != NULL) {
+        char* end = text;
+        if (x->negative) {
+            *end++ = '-';
+        }
+        if (decimal_exponent < -5 || decimal_exponent >= (int64_t)digits) {    /* Scientific notation */
+            *end++ = significand[0];
+            if (length > 1) {
+                *end++ = '.';
+                memcpy(end, significand + 1, length - 1);
+                end += length - 1;
+            }
+            sprintf(end, "e%c%02lld", decimal_exponent < 0 ? '-' : '+', (long long)(decimal_exponent < 0 ? -decimal_exponent : decimal_exponent));
+        } else if (decimal_exponent < 0) {      /* 0.000ddd */
+            *end++ = '0';
+            *end++ = '.';
+            memset(end, '0', (size_t)(-decimal_exponent - 1));
+            end += -decimal_exponent - 1;
+            strcpy(end, significand);
+        } else {                                /* ddd.ddd or ddd000 */
+            size_t integral = (size_t)decimal_exponent + 1;
+            for (size_t i = 0; i < integral; ++i) {
+                *end++ = i < length ? significand[i] : '0';
+            }
+            if (length > integral) {
+                *end++ = '.';
+                memcpy(end, significand + integral, length - integral);
+                end += length - integral;
+            }
+            *end = '\0';
+        }
+    }
+    free(significand);
+    free(numerator.limbs);
+    free(denominator.limbs);
+    free(power.limbs);
+    free(remainder.limbs);
+    return text;
+}
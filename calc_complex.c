@@ -0,0 +1,757 @@
+/**
+ * \file            calc_complex.c
+ * \brief           Evaluation over complex numbers, a row at a time or in columns with the parts in separate vectors
+ */
+
+/*
+ * Copyright (c) 2024 Daniil VERES
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * Author:          Daniil VERES <daniaveres@gmail.com>
+ * Version:         v1.0.0
+ */
+
+                            /* Functions used: */
+#include <complex.h>        /* double complex, creal, cimag, carg, csqrt, clog, cexp, csin, ccos, ctan, casin, cacos, catan, csinh, ccosh, ctanh, casinh, cacosh, catanh, cpow, cabs */
+#include <float.h>          /* DBL_MIN, DBL_MAX */
+#include <math.h>           /* ceil, floor, round, trunc, fabs, log10, isfinite, isnan, nan */
+#include <stdatomic.h>      /* atomic_load_explicit */
+#include <stdio.h>          /* snprintf */
+#include <stdlib.h>         /* malloc, free, aligned_alloc */
+#include <string.h>         /* strcmp */
+#include "calc_internal.h"
+
+                                        /* Constants used: */
+#define CALC_COMPLEX_STACK_NODES 128    /*!< Number of node values kept on the stack by \ref calc_eval_complex before falling back to the heap */
+#define CALC_COMPLEX_LANES 4            /*!< Rows held in one vector of the columnar evaluator */
+#define CALC_COMPLEX_BLOCK 64           /*!< Rows calculated together by the columnar evaluator, a multiple of \ref CALC_COMPLEX_LANES */
+#define COMPLEX_VECTORS (CALC_COMPLEX_BLOCK / CALC_COMPLEX_LANES)   /*!< Vectors of a column of a block */
+#define COMPLEX_UNIT "i"                /*!< Name of the imaginary unit */
+#define COMPLEX_POWI_MAX 64             /*!< The largest absolute integer exponent raised by squaring, like the double evaluation */
+#define COMPLEX_GAMMA_G 7               /*!< The parameter g of the Lanczos approximation of the gamma function */
+#define COMPLEX_GAMMA_TERMS 9           /*!< A number of coefficients of the Lanczos approximation */
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846     /*!< Pi number */
+#endif /* M_PI */
+#ifndef M_LN10
+#define M_LN10 2.30258509299404568402   /*!< Natural logarithm of 10 */
+#endif /* M_LN10 */
+#ifndef CMPLX
+#define CMPLX(x, y) __builtin_complex((double)(x), (double)(y))   /*!< A complex number of its parts, C11 */
+#endif /* CMPLX */
+
+typedef double complex_vector_t __attribute__((vector_size(CALC_COMPLEX_LANES * sizeof(double))));  /*!< A part of \ref CALC_COMPLEX_LANES rows */
+typedef int64_t complex_mask_t __attribute__((vector_size(CALC_COMPLEX_LANES * sizeof(double))));   /*!< A comparison of vectors, -1 in the lanes where it holds */
+
+/**
+ * \brief           Values of a node for a block of rows, the real and the imaginary parts in separate vectors
+ */
+typedef struct {
+    complex_vector_t re[COMPLEX_VECTORS];   /*!< Real parts */
+    complex_vector_t im[COMPLEX_VECTORS];   /*!< Imaginary parts */
+} complex_block_t;
+
+/**
+ * \brief           Coefficients of the Lanczos approximation for g = 7
+ */
+static const double complex_gamma_coefficients[COMPLEX_GAMMA_TERMS] = {
+    0.99999999999980993, 676.5203681218851, -1259.1392167224028,
+    771.32342877765313, -176.61502916214059, 12.507343278686905,
+    -0.13857109526572012, 9.9843695780195716e-6, 1.5056327351493116e-7,
+};
+
+static calc_complex_t complex_make(double re, double im);                       /* A function used to make a complex number of its parts */
+static calc_complex_t complex_from(double complex z);                           /* A function used to convert a C complex number */
+static calc_complex_t complex_mul(calc_complex_t x, calc_complex_t y);          /* A function used to multiply complex numbers */
+static calc_complex_t complex_div(calc_complex_t x, calc_complex_t y);          /* A function used to divide complex numbers */
+static calc_complex_t complex_powi(calc_complex_t x, int32_t n);                /* A function used to raise a complex number to an integer power */
+static double complex complex_gamma(double complex z);                          /* A function used to calculate the gamma function */
+static uint8_t complex_less(calc_complex_t x, calc_complex_t y);                /* A function used to order complex numbers */
+static calc_complex_t complex_call(const calc_function_t* functions, calc_function_id_t fn, calc_complex_t x, calc_complex_t y, calc_error_code_t* code);  /* A function used to calculate a math function */
+static calc_complex_t apply_complex(const calc_node_t* node, calc_complex_t x, calc_complex_t y, const calc_function_t* functions, calc_error_code_t* code);  /* A function used to calculate an operation on complex numbers */
+static int32_t complex_unit_slot(const calc_expr_t* expr);                      /* A function used to find the variable of the imaginary unit */
+static calc_complex_t block_get(const complex_block_t* block, size_t row);      /* A function used to read a row of a block */
+static void block_set(complex_block_t* block, size_t row, calc_complex_t value);    /* A function used to write a row of a block */
+static uint8_t mask_any(complex_mask_t mask);                                   /* A function used to check if a comparison holds in any lane */
+static void block_mul(const complex_block_t* x, const complex_block_t* y, complex_block_t* out);    /* A function used to multiply blocks */
+static void block_div(const complex_block_t* x, const complex_block_t* y, complex_block_t* out);    /* A function used to divide blocks */
+static void block_powi(const complex_block_t* x, int32_t n, complex_block_t* out);  /* A function used to raise a block to an integer power */
+static void block_node(const calc_expr_t* expr, size_t index, complex_block_t* blocks, const double* const* re, const double* const* im,
+                       size_t start, size_t count, int32_t unit, const calc_function_t* functions, calc_error_code_t* codes);   /* A function used to calculate a node for a block of rows */
+
+/**
+ * \brief           A function used to evaluate an expression over complex numbers
+ * \param[in]       expr: A compiled expression
+ * \param[in]       vars: Values of the variables indexed by slot, NULL if there are none but `i`
+ * \param[out]      result: The result, may be NULL
+ * \param[out]      error: An error report, may be NULL
+ * \return          The real part of the result, NaN in case of an error
+ * \note            A variable named `i` is the imaginary unit, its slot in `vars` is not read. An operation on real numbers
+ *                  in the domain of the double evaluation gives the same result as \ref calc_eval, the others continue
+ *                  over complex numbers, so `sqrt(-4)` is `2i` and `ln(-1)` is `3.1415926536i`. A real argument is taken
+ *                  from above a branch cut. A call with finite arguments whose result is not finite, as `ln(0)`
+ *                  or `fact(-1)`, fails with \ref CALC_ERROR_UNDEFINED_FUNCTION. Calls are not counted by the function profile
+ *                  unless they take the double path.
+ */
+double
+calc_eval_complex(const calc_expr_t* expr, const calc_complex_t* vars, calc_complex_t* result, calc_error_t* error) {
+    calc_complex_t stack_values[CALC_COMPLEX_STACK_NODES];     /* Values of the nodes for small expressions */
+    calc_complex_t* values = stack_values;
+    calc_error_code_t code = CALC_OK;
+    calc_complex_t root = {nan(""), nan("")};
+    int32_t unit = complex_unit_slot(expr);
+
+    if (expr == NULL || expr->node_count == 0) {
+        code = CALC_ERROR_UNKNOWN;
+    } else if (expr->var_count > (unit >= 0 ? 1u : 0u) && vars == NULL) {
+        code = CALC_ERROR_INVALID_INPUT;
+    } else if (expr->node_count > CALC_COMPLEX_STACK_NODES
+               && (values = (calc_complex_t*)malloc(expr->node_count * sizeof(calc_complex_t))) == NULL) {
+        code = CALC_ERROR_FAILED_TO_ALLOCATE_MEMORY;
+    } else {
+        const calc_function_t* functions = atomic_load_explicit(&calc_dispatch, memory_order_acquire);
+        for (size_t i = 0; code == CALC_OK && i < expr->node_count; ++i) {     /* Loop through all nodes in postfix order */
+            const calc_node_t* node = &expr->nodes[i];
+            if (node->op == CALC_OP_CONST) {
+                values[i] = complex_make(node->value, 0);
+            } else if (node->op == CALC_OP_VAR) {
+                values[i] = node->a == unit ? complex_make(0, 1) : vars[node->a];
+            } else {
+                values[i] = apply_complex(node, values[node->a], node->b >= 0 ? values[node->b] : complex_make(0, 0), functions, &code);
+            }
+        }
+        if (code == CALC_OK) {
+            root = values[expr->node_count - 1];    /* The last node is the root */
+            root.re += 0.0;                         /* -0 is printed as 0 */
+            root.im += 0.0;
+        }
+        if (values != stack_values) {
+            free(values);
+        }
+    }
+    if (result != NULL) {
+        *result = root;
+    }
+    if (error != NULL) {
+        error->code = code;
+        error->position = 0;
+    }
+    return root.re;
+}
+
+/**
+ * \brief           A function used to evaluate an expression over complex numbers for many rows of variables at once
+ * \param[in]       expr: A compiled expression
+ * \param[in]       rows: A number of rows
+ * \param[in]       re: Columns of the real parts of the variables indexed by slot, `rows` values each, NULL if there are none but `i`
+ * \param[in]       im: Columns of the imaginary parts, NULL if every variable is real, a column may be NULL too
+ * \param[out]      result_re: Real parts of the results, `rows` values
+ * \param[out]      result_im: Imaginary parts of the results, `rows` values, may be NULL
+ * \param[out]      error: An error report with the error of the first failed row, may be NULL
+ * \return          A number of rows calculated without an error, the results of the other rows are NaN
+ * \note            Every row gives the same result as \ref calc_eval_complex. The rows are calculated in blocks of
+ *                  \ref CALC_COMPLEX_BLOCK, a node at a time, with the real and the imaginary parts in separate vectors:
+ *                  additions, multiplications, divisions and integer powers take several rows per instruction,
+ *                  the rows where they need special care and the math functions are calculated one by one.
+ */
+size_t
+calc_eval_complex_columns(const calc_expr_t* expr, size_t rows, const double* const* re, const double* const* im,
+                          double* result_re, double* result_im, calc_error_t* error) {
+    complex_block_t* blocks = NULL;             /* Values of the nodes for the current block of rows */
+    calc_error_code_t code = CALC_OK;           /* The error of the first failed row */
+    size_t succeeded = 0, filled = 0;           /* Rows without an error, rows with results */
+    int32_t unit = complex_unit_slot(expr);
+
+    if (expr == NULL || expr->node_count == 0 || result_re == NULL) {
+        code = CALC_ERROR_UNKNOWN;
+    } else if (expr->var_count > (unit >= 0 ? 1u : 0u) && re == NULL) {
+        code = CALC_ERROR_INVALID_INPUT;
+    } else if (rows > 0 && (blocks = (complex_block_t*)aligned_alloc(_Alignof(complex_block_t),
+                                                                      expr->node_count * sizeof(complex_block_t))) == NULL) {
+        code = CALC_ERROR_FAILED_TO_ALLOCATE_MEMORY;
+    } else {
+        const calc_function_t* functions = atomic_load_explicit(&calc_dispatch, memory_order_acquire);
+        for (size_t start = 0; start < rows; start += CALC_COMPLEX_BLOCK) {    /* Loop through the blocks of rows */
+            size_t count = rows - start < CALC_COMPLEX_BLOCK ? rows - start : CALC_COMPLEX_BLOCK;
+            calc_error_code_t codes[CALC_COMPLEX_BLOCK] = {CALC_OK};           /* Errors of the rows of the block */
+            const complex_block_t* root = &blocks[expr->node_count - 1];      /* The last node is the root */
+            for (size_t i = 0; i < expr->node_count; ++i) {                   /* Loop through all nodes in postfix order */
+                block_node(expr, i, blocks, re, im, start, count, unit, functions, codes);
+            }
+            for (size_t r = 0; r < count; ++r) {
+                calc_complex_t value = block_get(root, r);
+                if (codes[r] != CALC_OK) {
+                    value = complex_make(nan(""), nan(""));
+                    code = code == CALC_OK ? codes[r] : code;
+                } else {
+                    ++succeeded;
+                }
+                result_re[start + r] = value.re + 0.0;      /* -0 is printed as 0 */
+                if (result_im != NULL) {
+                    result_im[start + r] = value.im + 0.0;
+                }
+            }
+            filled += count;
+        }
+        free(blocks);
+    }
+    for (size_t r = filled; result_re != NULL && r < rows; ++r) {     /* Nothing has been calculated after an error of the arguments */
+        result_re[r] = nan("");
+        if (result_im != NULL) {
+            result_im[r] = nan("");
+        }
+    }
+    if (error != NULL) {
+        error->code = code;
+        error->position = 0;
+    }
+    return succeeded;
+}
+
+/**
+ * \brief           A function used to format a complex result
+ * \param[in]       result: The result
+ * \param[out]      buffer: A buffer for the text
+ * \param[in]       size: Size of the buffer
+ * \return          Length of the text, as returned by snprintf
+ * \note            Both parts are printed as by \ref calc_format, as `a+bi`, `a-bi` or `bi`, a real result without the
+ *                  imaginary part, and the imaginary unit without the coefficient 1
+ */
+int
+calc_format_complex(const calc_complex_t* result, char* buffer, size_t size) {
+    char part[512];                             /* Enough for any double without exponent */
+    int len = 0, part_len;
+    double im = result->im;
+    if (im == 0) {                              /* A real number */
+        return calc_format(result->re, buffer, size);
+    }
+    if (result->re != 0) {
+        len = calc_format(result->re, buffer, size);
+        if (len < 0) {
+            return len;
+        }
+    }
+    part_len = fabs(im) == 1 ? 0 : calc_format(fabs(im), part, sizeof(part));
+    if (part_len < 0 || (size_t)part_len >= sizeof(part)) {
+        return -1;
+    }
+    part[part_len] = '\0';
+    part_len = snprintf((size_t)len < size ? buffer + len : NULL, (size_t)len < size ? size - (size_t)len : 0, "%s%si",
+                        im < 0 ? "-" : len > 0 ? "+" : "", part);
+    return part_len < 0 ? part_len : len + part_len;
+}
+
+/**
+ * \brief           A function used to make a complex number of its parts
+ * \param[in]       re: The real part
+ * \param[in]       im: The imaginary part
+ * \return          The complex number
+ */
+static inline calc_complex_t
+complex_make(double re, double im) {
+    calc_complex_t z = {re, im};
+    return z;
+}
+
+/**
+ * \brief           A function used to convert a complex number of the C library
+ * \param[in]       z: The number
+ * \return          The same number
+ */
+static inline calc_complex_t
+complex_from(double complex z) {
+    return complex_make(creal(z), cimag(z));
+}
+
+/**
+ * \brief           A function used to multiply complex numbers
+ * \param[in]       x: The first factor
+ * \param[in]       y: The second factor
+ * \return          The product
+ * \note            A product of real numbers is calculated as such, which keeps the sign of a zero product.
+ *                  The textbook formula is used for the others unless it gives NaN, which happens with infinite parts,
+ *                  then they are calculated as by the C library
+ */
+static inline calc_complex_t
+complex_mul(calc_complex_t x, calc_complex_t y) {
+    calc_complex_t z;
+    if (x.im == 0 && y.im == 0) {
+        return complex_make(x.re * y.re, 0);
+    }
+    z = complex_make(x.re * y.re - x.im * y.im, x.re * y.im + x.im * y.re);
+    if (isnan(z.re) || isnan(z.im)) {
+        return complex_from(CMPLX(x.re, x.im) * CMPLX(y.re, y.im));
+    }
+    return z;
+}
+
+/**
+ * \brief           A function used to divide complex numbers
+ * \param[in]       x: The dividend
+ * \param[in]       y: The divisor
+ * \return          The quotient
+ * \note            A real divisor divides both parts. Otherwise the textbook formula is used while the squared modulus
+ *                  of the divisor is a normal double, and the scaling division of the C library beyond that
+ */
+static inline calc_complex_t
+complex_div(calc_complex_t x, calc_complex_t y) {
+    double d;
+    if (y.im == 0) {                            /* The same rounding as the division of reals */
+        calc_complex_t z = complex_make(x.re / y.re, x.im / y.re);
+        if (isnan(z.im) && x.im == 0) {         /* A real number divided by 0 */
+            z.im = 0;
+        }
+        return z;
+    }
+    d = y.re * y.re + y.im * y.im;
+    if (d >= DBL_MIN && d <= DBL_MAX) {
+        return complex_make((x.re * y.re + x.im * y.im) / d, (x.im * y.re - x.re * y.im) / d);
+    }
+    return complex_from(CMPLX(x.re, x.im) / CMPLX(y.re, y.im));
+}
+
+/**
+ * \brief           A function used to raise a complex number to an integer power by squaring
+ * \param[in]       x: The base
+ * \param[in]       n: The exponent
+ * \return          The power, the reciprocal of the positive power for a negative exponent
+ * \note            \ref block_powi follows the same steps, so both give the same result
+ */
+static calc_complex_t
+complex_powi(calc_complex_t x, int32_t n) {
+    calc_complex_t result = complex_make(1, 0);
+    uint32_t m = n < 0 ? -(uint32_t)n : (uint32_t)n;
+    while (m != 0) {
+        if (m & 1) {
+            result = complex_mul(result, x);
+        }
+        m >>= 1;
+        if (m != 0) {
+            x = complex_mul(x, x);
+        }
+    }
+    return n < 0 ? complex_div(complex_make(1, 0), result) : result;
+}
+
+/**
+ * \brief           A function used to calculate the gamma function of a complex number
+ * \param[in]       z: The argument
+ * \return          Γ(z) with about 15 significant digits, NaN at the poles
+ * \note            The Lanczos approximation for g = 7, with the reflection formula left of 1/2
+ */
+static double complex
+complex_gamma(double complex z) {
+    double complex sum, t;
+    if (cimag(z) == 0 && creal(z) <= 0 && creal(z) == floor(creal(z))) {   /* A pole */
+        return CMPLX(nan(""), nan(""));
+    }
+    if (creal(z) < 0.5) {
+        return M_PI / (csin(M_PI * z) * complex_gamma(1 - z));
+    }
+    z -= 1;
+    sum = complex_gamma_coefficients[0];
+    for (int32_t k = 1; k < COMPLEX_GAMMA_TERMS; ++k) {
+        sum += complex_gamma_coefficients[k] / (z + k);
+    }
+    t = z + COMPLEX_GAMMA_G + 0.5;
+    return sqrt(2 * M_PI) * cpow(t, z + 0.5) * cexp(-t) * sum;
+}
+
+/**
+ * \brief           A function used to order complex numbers for min and max
+ * \param[in]       x: The first number
+ * \param[in]       y: The second number
+ * \return          1 if `x` goes before `y`, by the real parts and then by the imaginary parts
+ */
+static inline uint8_t
+complex_less(calc_complex_t x, calc_complex_t y) {
+    return x.re < y.re || (x.re == y.re && x.im < y.im);
+}
+
+/**
+ * \brief           A function used to calculate a math function of complex numbers
+ * \param[in]       functions: The registry to dispatch calls on real numbers through
+ * \param[in]       fn: The function
+ * \param[in]       x: The first argument
+ * \param[in]       y: The second argument of a binary function
+ * \param[out]      code: Set to \ref CALC_ERROR_UNDEFINED_FUNCTION at a pole
+ * \return          The value of the function
+ * \note            Real arguments in the domain of a function are calculated by the registry, as in double precision.
+ *                  The other functions are extended as the double ones are defined, e.g. `ctan` is `1/tan`,
+ *                  `actan` is `pi/2 - atan`, `fact(z)` is Γ(z + 1), `abs` is the modulus, `sign` is `z/abs(z)`,
+ *                  rounding functions round both parts and `min` and `max` order by the real parts first
+ */
+static calc_complex_t
+complex_call(const calc_function_t* functions, calc_function_id_t fn, calc_complex_t x, calc_complex_t y, calc_error_code_t* code) {
+    double complex z = CMPLX(x.re, x.im + 0.0), w, r;  /* A real argument lies above a branch cut, not below */
+    if (x.im == 0 && y.im == 0) {
+        double args[2] = {x.re, y.re};
+        if (calc_domain_contains(functions[fn].domain, args)) {
+            return complex_make(functions[fn].impl(args), 0);
+        }
+    }
+    w = CMPLX(y.re, y.im + 0.0);
+    switch (fn) {
+        case CALC_FN_SQRT:   r = csqrt(z);                                  break;
+        case CALC_FN_LN:     r = clog(z);                                   break;
+        case CALC_FN_EXP:    r = cexp(z);                                   break;
+        case CALC_FN_SIN:    r = csin(z);                                   break;
+        case CALC_FN_COS:    r = ccos(z);                                   break;
+        case CALC_FN_TAN:    r = ctan(z);                                   break;
+        case CALC_FN_CTAN:   r = 1 / ctan(z);                               break;
+        case CALC_FN_ASIN:   r = casin(z);                                  break;
+        case CALC_FN_ACOS:   r = cacos(z);                                  break;
+        case CALC_FN_ATAN:   r = catan(z);                                  break;
+        case CALC_FN_ACTAN:  r = M_PI / 2 - catan(z);                       break;
+        case CALC_FN_SINH:   r = csinh(z);                                  break;
+        case CALC_FN_COSH:   r = ccosh(z);                                  break;
+        case CALC_FN_TANH:   r = ctanh(z);                                  break;
+        case CALC_FN_CTANH:  r = 1 / ctanh(z);                              break;
+        case CALC_FN_ASINH:  r = casinh(z);                                 break;
+        case CALC_FN_ACOSH:  r = cacosh(z);                                 break;
+        case CALC_FN_ATANH:  r = catanh(z);                                 break;
+        case CALC_FN_ACTANH: r = clog((1 + z) / (1 - z)) / 2;               break;   /* As the double version */
+        case CALC_FN_FABS:   r = cabs(z);                                   break;
+        case CALC_FN_CEIL:   r = CMPLX(ceil(x.re), ceil(x.im));             break;
+        case CALC_FN_FLOOR:  r = CMPLX(floor(x.re), floor(x.im));           break;
+        case CALC_FN_ROUND:  r = CMPLX(round(x.re), round(x.im));           break;
+        case CALC_FN_TRUNC:  r = CMPLX(trunc(x.re), trunc(x.im));           break;
+        case CALC_FN_SIGN:   r = z == 0 ? 0 : z / cabs(z);                  break;
+        case CALC_FN_RAD:    r = CMPLX(x.re * M_PI / 180, x.im * M_PI / 180);   break;
+        case CALC_FN_DEG:    r = CMPLX(x.re * 180 / M_PI, x.im * 180 / M_PI);   break;
+        case CALC_FN_FACT:   r = complex_gamma(z + 1);                      break;
+        case CALC_FN_LOG:    r = clog(w) / clog(z);                         break;   /* The base is the first argument */
+        case CALC_FN_LOG10:  r = CMPLX(log10(cabs(z)), carg(z) / M_LN10);  break;
+        case CALC_FN_MIN:    return complex_less(y, x) ? y : x;
+        case CALC_FN_MAX:    return complex_less(x, y) ? y : x;
+        default:
+            *code = CALC_ERROR_UNKNOWN;
+            return complex_make(0, 0);
+    }
+    if ((!isfinite(creal(r)) || !isfinite(cimag(r))) && isfinite(x.re) && isfinite(x.im)
+        && (functions[fn].arity == 1 || (isfinite(y.re) && isfinite(y.im)))) {  /* A pole or an overflow */
+        *code = CALC_ERROR_UNDEFINED_FUNCTION;
+        return complex_make(0, 0);
+    }
+    return complex_from(r);
+}
+
+/**
+ * \brief           A function used to calculate the value of a node from the values of its operands over complex numbers
+ * \param[in]       node: The node, not a constant or a variable
+ * \param[in]       x: Value of the first operand
+ * \param[in]       y: Value of the second operand
+ * \param[in]       functions: The registry to dispatch calls on real numbers through
+ * \param[out]      code: Set to an error code if the operation fails
+ * \return          The value of the node
+ * \note            Operations on real numbers defined in double precision are calculated by \ref calc_apply_node
+ */
+static calc_complex_t
+apply_complex(const calc_node_t* node, calc_complex_t x, calc_complex_t y, const calc_function_t* functions, calc_error_code_t* code) {
+    switch (node->op) {
+        case CALC_OP_NEG:
+            return complex_make(-x.re, -x.im);
+        case CALC_OP_ADD:
+            return complex_make(x.re + y.re, x.im + y.im);
+        case CALC_OP_SUB:
+            return complex_make(x.re - y.re, x.im - y.im);
+        case CALC_OP_MUL:
+            return complex_mul(x, y);
+        case CALC_OP_DIV:
+            return complex_div(x, y);
+        case CALC_OP_MOD: {
+            calc_complex_t q;
+            if (x.im == 0 && y.im == 0) {
+                return complex_make(calc_apply_node(node, x.re, y.re, NULL, functions, code), 0);
+            }
+            q = complex_div(x, y);              /* The remainder of the quotient truncated in both parts */
+            q = complex_mul(y, complex_make(trunc(q.re), trunc(q.im)));
+            return complex_make(x.re - q.re, x.im - q.im);
+        }
+        case CALC_OP_POW:
+            if (x.im == 0 && y.im == 0 && (x.re >= 0 || y.re == trunc(y.re) || isnan(x.re) || isnan(y.re))) {
+                return complex_make(calc_apply_node(node, x.re, y.re, NULL, functions, code), 0);
+            }
+            if (y.im == 0 && fabs(y.re) <= COMPLEX_POWI_MAX && y.re == (int32_t)y.re) {
+                return complex_powi(x, (int32_t)y.re);
+            }
+            if (x.re == 0 && x.im == 0) {       /* 0 to a power with a positive real part is 0, the others are poles */
+                if (y.re > 0) {
+                    return complex_make(0, 0);
+                }
+                *code = CALC_ERROR_UNDEFINED_FUNCTION;
+                return complex_make(0, 0);
+            }
+            return complex_from(cpow(CMPLX(x.re, x.im + 0.0), CMPLX(y.re, y.im)));
+        case CALC_OP_POWI:
+            if (x.im == 0) {
+                return complex_make(calc_apply_node(node, x.re, 0, NULL, functions, code), 0);
+            }
+            return complex_powi(x, (int32_t)node->value);
+        case CALC_OP_CALL:
+            return complex_call(functions, (calc_function_id_t)node->fn, x, y, code);
+        case CALC_OP_GUARD:
+            return x;
+        default:
+            *code = CALC_ERROR_UNKNOWN;
+            return complex_make(0, 0);
+    }
+}
+
+/**
+ * \brief           A function used to find the variable of the imaginary unit
+ * \param[in]       expr: A compiled expression, may be NULL
+ * \return          The slot of the variable named `i`, -1 if there is none
+ */
+static int32_t
+complex_unit_slot(const calc_expr_t* expr) {
+    for (size_t i = 0; expr != NULL && i < expr->var_count; ++i) {
+        if (strcmp(expr->var_names[i], COMPLEX_UNIT) == 0) {
+            return (int32_t)i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * \brief           A function used to read a row of a block
+ * \param[in]       block: The block
+ * \param[in]       row: The row
+ * \return          The value of the row
+ */
+static inline calc_complex_t
+block_get(const complex_block_t* block, size_t row) {
+    return complex_make(block->re[row / CALC_COMPLEX_LANES][row % CALC_COMPLEX_LANES],
+                        block->im[row / CALC_COMPLEX_LANES][row % CALC_COMPLEX_LANES]);
+}
+
+/**
+ * \brief           A function used to write a row of a block
+ * \param[in]       block: The block
+ * \param[in]       row: The row
+ * \param[in]       value: The value of the row
+ */
+static inline void
+block_set(complex_block_t* block, size_t row, calc_complex_t value) {
+    block->re[row / CALC_COMPLEX_LANES][row % CALC_COMPLEX_LANES] = value.re;
+    block->im[row / CALC_COMPLEX_LANES][row % CALC_COMPLEX_LANES] = value.im;
+}
+
+/**
+ * \brief           A function used to check if a comparison of vectors holds in any lane
+ * \param[in]       mask: The comparison
+ * \return          1 if any lane is set, 0 otherwise
+ */
+static inline uint8_t
+mask_any(complex_mask_t mask) {
+    int64_t any = 0;
+    for (size_t k = 0; k < CALC_COMPLEX_LANES; ++k) {
+        any |= mask[k];
+    }
+    return any != 0;
+}
+
+/**
+ * \brief           A function used to multiply blocks, row by row
+ * \param[in]       x: The first factors
+ * \param[in]       y: The second factors
+ * \param[out]      out: The products, may be one of the factors
+ * \note            The rows of real numbers take the product of the real parts, as \ref complex_mul,
+ *                  the rows where the textbook formula gives NaN are recalculated by it
+ */
+static void
+block_mul(const complex_block_t* x, const complex_block_t* y, complex_block_t* out) {
+    for (size_t v = 0; v < COMPLEX_VECTORS; ++v) {
+        complex_vector_t xr = x->re[v], xi = x->im[v], yr = y->re[v], yi = y->im[v];
+        complex_vector_t re = xr * yr - xi * yi, im = xr * yi + xi * yr;
+        complex_mask_t real = (xi == 0) & (yi == 0);
+        complex_mask_t bad;
+        re = (complex_vector_t)(((complex_mask_t)(xr * yr) & real) | ((complex_mask_t)re & ~real));
+        im = (complex_vector_t)((complex_mask_t)im & ~real);
+        bad = (re != re) | (im != im);
+        out->re[v] = re;
+        out->im[v] = im;
+        if (mask_any(bad)) {
+            for (size_t k = 0; k < CALC_COMPLEX_LANES; ++k) {
+                if (bad[k]) {
+                    size_t row = v * CALC_COMPLEX_LANES + k;
+                    block_set(out, row, complex_mul(complex_make(xr[k], xi[k]), complex_make(yr[k], yi[k])));
+                }
+            }
+        }
+    }
+}
+
+/**
+ * \brief           A function used to divide blocks, row by row
+ * \param[in]       x: The dividends
+ * \param[in]       y: The divisors
+ * \param[out]      out: The quotients, may be one of the operands
+ * \note            The rows needing more than the textbook formula or the division of both parts by a real divisor
+ *                  are recalculated by \ref complex_div
+ */
+static void
+block_div(const complex_block_t* x, const complex_block_t* y, complex_block_t* out) {
+    for (size_t v = 0; v < COMPLEX_VECTORS; ++v) {
+        complex_vector_t xr = x->re[v], xi = x->im[v], yr = y->re[v], yi = y->im[v];
+        complex_vector_t d = yr * yr + yi * yi;
+        complex_vector_t re = (xr * yr + xi * yi) / d, im = (xi * yr - xr * yi) / d;
+        complex_vector_t real_re = xr / yr, real_im = xi / yr;
+        complex_mask_t real = yi == 0;
+        complex_mask_t bad = ~real & ~((d >= DBL_MIN) & (d <= DBL_MAX));
+        re = (complex_vector_t)(((complex_mask_t)real_re & real) | ((complex_mask_t)re & ~real));
+        im = (complex_vector_t)(((complex_mask_t)real_im & real) | ((complex_mask_t)im & ~real));
+        bad |= im != im;
+        out->re[v] = re;
+        out->im[v] = im;
+        if (mask_any(bad)) {
+            for (size_t k = 0; k < CALC_COMPLEX_LANES; ++k) {
+                if (bad[k]) {
+                    size_t row = v * CALC_COMPLEX_LANES + k;
+                    block_set(out, row, complex_div(complex_make(xr[k], xi[k]), complex_make(yr[k], yi[k])));
+                }
+            }
+        }
+    }
+}
+
+/**
+ * \brief           A function used to raise a block to an integer power, row by row
+ * \param[in]       x: The bases
+ * \param[in]       n: The exponent
+ * \param[out]      out: The powers
+ * \note            The steps are those of \ref complex_powi, the rows of real bases are then recalculated
+ *                  in double precision, like \ref apply_complex does
+ */
+static void
+block_powi(const complex_block_t* x, int32_t n, complex_block_t* out) {
+    complex_block_t base = *x;
+    uint32_t m = n < 0 ? -(uint32_t)n : (uint32_t)n;
+    for (size_t v = 0; v < COMPLEX_VECTORS; ++v) {
+        out->re[v] = (complex_vector_t){0} + 1;
+        out->im[v] = (complex_vector_t){0};
+    }
+    while (m != 0) {
+        if (m & 1) {
+            block_mul(out, &base, out);
+        }
+        m >>= 1;
+        if (m != 0) {
+            block_mul(&base, &base, &base);
+        }
+    }
+    if (n < 0) {
+        complex_block_t one;
+        for (size_t v = 0; v < COMPLEX_VECTORS; ++v) {
+            one.re[v] = (complex_vector_t){0} + 1;
+            one.im[v] = (complex_vector_t){0};
+        }
+        block_div(&one, out, out);
+    }
+}
+
+/**
+ * \brief           A function used to calculate a node for a block of rows
+ * \param[in]       expr: A compiled expression
+ * \param[in]       index: An index of the node
+ * \param[in,out]   blocks: Values of all nodes for the block, the value of the node is written
+ * \param[in]       re: Columns of the real parts of the variables
+ * \param[in]       im: Columns of the imaginary parts of the variables, may be NULL
+ * \param[in]       start: The first row of the block
+ * \param[in]       count: A number of rows in the block, the rest of the block is filled with zeros
+ * \param[in]       unit: The slot of the imaginary unit, -1 if there is none
+ * \param[in]       functions: The registry to dispatch calls on real numbers through
+ * \param[in,out]   codes: Errors of the rows, only the first error of a row is kept
+ */
+static void
+block_node(const calc_expr_t* expr, size_t index, complex_block_t* blocks, const double* const* re, const double* const* im,
+           size_t start, size_t count, int32_t unit, const calc_function_t* functions, calc_error_code_t* codes) {
+    const calc_node_t* node = &expr->nodes[index];
+    complex_block_t* out = &blocks[index];
+    const complex_block_t* x = node->op > CALC_OP_VAR ? &blocks[node->a] : NULL;
+    const complex_block_t* y = node->op > CALC_OP_VAR && node->b >= 0 ? &blocks[node->b] : NULL;
+    switch (node->op) {
+        case CALC_OP_CONST:
+            for (size_t v = 0; v < COMPLEX_VECTORS; ++v) {
+                out->re[v] = (complex_vector_t){0} + node->value;
+                out->im[v] = (complex_vector_t){0};
+            }
+            return;
+        case CALC_OP_VAR:
+            for (size_t r = 0; r < CALC_COMPLEX_BLOCK; ++r) {
+                calc_complex_t value = complex_make(0, 0);
+                if (node->a == unit) {
+                    value.im = 1;
+                } else if (r < count) {
+                    value.re = re[node->a][start + r];
+                    value.im = im != NULL && im[node->a] != NULL ? im[node->a][start + r] : 0;
+                }
+                block_set(out, r, value);
+            }
+            return;
+        case CALC_OP_NEG:
+            for (size_t v = 0; v < COMPLEX_VECTORS; ++v) {
+                out->re[v] = -x->re[v];
+                out->im[v] = -x->im[v];
+            }
+            return;
+        case CALC_OP_ADD:
+            for (size_t v = 0; v < COMPLEX_VECTORS; ++v) {
+                out->re[v] = x->re[v] + y->re[v];
+                out->im[v] = x->im[v] + y->im[v];
+            }
+            return;
+        case CALC_OP_SUB:
+            for (size_t v = 0; v < COMPLEX_VECTORS; ++v) {
+                out->re[v] = x->re[v] - y->re[v];
+                out->im[v] = x->im[v] - y->im[v];
+            }
+            return;
+        case CALC_OP_MUL:
+            block_mul(x, y, out);
+            return;
+        case CALC_OP_DIV:
+            block_div(x, y, out);
+            return;
+        case CALC_OP_POWI:
+            block_powi(x, (int32_t)node->value, out);
+            for (size_t r = 0; r < count; ++r) {        /* Real bases are raised in double precision */
+                calc_complex_t base = block_get(x, r);
+                if (base.im == 0) {
+                    calc_error_code_t code = CALC_OK;
+                    block_set(out, r, apply_complex(node, base, base, functions, &code));
+                }
+            }
+            return;
+        default:                                        /* Powers, remainders and calls, row by row */
+            for (size_t r = 0; r < count; ++r) {
+                calc_error_code_t code = CALC_OK;
+                calc_complex_t value = apply_complex(node, block_get(x, r), y != NULL ? block_get(y, r) : complex_make(0, 0), functions, &code);
+                if (code != CALC_OK && codes[r] == CALC_OK) {
+                    codes[r] = code;
+                }
+                block_set(out, r, value);
+            }
+            return;
+    }
+}
@@ -0,0 +1,1129 @@
+/**
+ * \file            calc_dd.c
+ * \brief           Evaluation in double-double precision, about 106 bits, with error-free transformations
+ */
+
+/*
+ * Copyright (c) 2024 Daniil VERES
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * Author:          Daniil VERES <daniaveres@gmail.com>
+ * Version:         v1.0.0
+ */
+
+                            /* Functions used: */
+#include <math.h>           /* fma, sqrt, exp, log, atan2, sin, cos, floor, ceil, round, ldexp, frexp, fabs, isfinite, nan, tgamma, copysign */
+#include <stdatomic.h>      /* atomic_load_explicit */
+#include <stdio.h>          /* snprintf */
+#include <stdlib.h>         /* malloc, free */
+#include <string.h>         /* strlen */
+#include "calc_internal.h"
+
+                                        /* Constants used: */
+#define CALC_DD_STACK_NODES 128         /*!< Number of node values kept on the stack by \ref calc_eval_dd before falling back to the heap */
+#define CALC_DD_DIGITS 31               /*!< Significant digits printed by \ref calc_format_dd */
+#define DD_EPSILON 0x1p-106             /*!< The relative precision of a double-double, a series stops at terms below it */
+#define DD_FACTORIALS 23                /*!< Entries of \ref dd_inverse_factorials, 1/3! to 1/25! */
+#define DD_POWI_MAX 0x1p31              /*!< Integer exponents below it in absolute value are raised by squaring */
+#define DD_REDUCE_MAX 0x1p50            /*!< The largest argument of the trigonometric functions reduced in double-double */
+#define DD_EXP_MAX 709.782712893384     /*!< The largest argument of exp with a finite result */
+#define DD_EXP_MIN -745.1332191019412   /*!< The smallest argument of exp with a non-zero result */
+#define DD_LOG1P_MAX 0.0625             /*!< The largest |x| for which ln(1 + x) is summed as a series */
+#define DD_SINH_SERIES 0.25             /*!< The largest |x| for which sinh(x) is summed as a series */
+#define DD_HUGE 1e150                   /*!< Arguments of asinh and acosh above it are not squared */
+#define DD_FACT_MAX 170                 /*!< The largest integer with a finite factorial */
+#define DD_EXACT_DIGITS 15              /*!< Digits of a literal which are exact in double */
+#define DD_EXACT_POWERS 23              /*!< Entries of \ref dd_powers_of_ten, the powers of 10 exact in double */
+
+#ifndef M_SQRT1_2
+#define M_SQRT1_2 0.70710678118654752440    /*!< The square root of 1/2 */
+#endif /* M_SQRT1_2 */
+
+/**
+ * \brief           Pi and the other constants of the math functions rounded to double-double
+ */
+static const calc_dd_t dd_pi = {3.141592653589793, 1.2246467991473532e-16};
+static const calc_dd_t dd_pi_2 = {1.5707963267948966, 6.123233995736766e-17};
+static const calc_dd_t dd_pi_16 = {0.19634954084936207, 7.654042494670958e-18};
+static const calc_dd_t dd_ln2 = {0.6931471805599453, 2.3190468138462996e-17};
+static const calc_dd_t dd_ln10 = {2.302585092994046, -2.1707562233822494e-16};
+
+/**
+ * \brief           Pi/2 and ln(2) as sums of three doubles, so that an argument can be reduced by their multiples exactly
+ */
+static const double dd_pi_2_parts[3] = {1.5707963267948966, 6.123233995736766e-17, -1.4973849048591698e-33};
+static const double dd_ln2_parts[3] = {0.6931471805599453, 2.3190468138462996e-17, 5.707708438416212e-34};
+
+/**
+ * \brief           sin(k pi / 16) and cos(k pi / 16) for k from 1 to 4
+ */
+static const calc_dd_t dd_sin_table[4] = {
+    {0.19509032201612828, -7.991079068461731e-18}, {0.3826834323650898, -1.0050772696461588e-17},
+    {0.5555702330196022, 4.709410940561677e-17}, {0.7071067811865476, -4.833646656726457e-17},
+};
+static const calc_dd_t dd_cos_table[4] = {
+    {0.9807852804032304, 1.8546939997825006e-17}, {0.9238795325112867, 1.7645047084336677e-17},
+    {0.8314696123025452, 1.4073856984728024e-18}, {0.7071067811865476, -4.833646656726457e-17},
+};
+
+/**
+ * \brief           10^n for n from 0 to 22
+ */
+static const double dd_powers_of_ten[DD_EXACT_POWERS] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
+
+/**
+ * \brief           1/n! for n from 3 to 25, the coefficients of the Taylor series
+ */
+static const calc_dd_t dd_inverse_factorials[DD_FACTORIALS] = {
+    {0.16666666666666666, 9.25185853854297e-18}, {0.041666666666666664, 2.3129646346357427e-18},
+    {0.008333333333333333, 1.1564823173178714e-19}, {0.001388888888888889, -5.300543954373577e-20},
+    {0.0001984126984126984, 1.7209558293420705e-22}, {2.48015873015873e-05, 2.1511947866775882e-23},
+    {2.7557319223985893e-06, -1.858393274046472e-22}, {2.755731922398589e-07, 2.3767714622250297e-23},
+    {2.505210838544172e-08, -1.448814070935912e-24}, {2.08767569878681e-09, -1.20734505911326e-25},
+    {1.6059043836821613e-10, 1.2585294588752098e-26}, {1.1470745597729725e-11, 2.0655512752830745e-28},
+    {7.647163731819816e-13, 7.03872877733453e-30}, {4.779477332387385e-14, 4.399205485834081e-31},
+    {2.8114572543455206e-15, 1.6508842730861433e-31}, {1.5619206968586225e-16, 1.1910679660273754e-32},
+    {8.22063524662433e-18, 2.2141894119604265e-34}, {4.110317623312165e-19, 1.4412973378659527e-36},
+    {1.9572941063391263e-20, -1.3643503830087908e-36}, {8.896791392450574e-22, -7.911402614872376e-38},
+    {3.868170170630684e-23, -8.843177655482344e-40}, {1.6117375710961184e-24, -3.6846573564509766e-41},
+    {6.446950284384474e-26, -1.9330404233703465e-42},
+};
+
+static calc_dd_t dd_make(double hi, double lo);                                /* A function used to make a double-double of its parts */
+static double quick_two_sum(double a, double b, double* error);                 /* A function used to add numbers exactly, the first not smaller */
+static double two_sum(double a, double b, double* error);                       /* A function used to add numbers exactly */
+static double two_product(double a, double b, double* error);                   /* A function used to multiply numbers exactly */
+static calc_dd_t dd_add(calc_dd_t x, calc_dd_t y);                              /* A function used to add double-doubles */
+static calc_dd_t dd_add_d(calc_dd_t x, double y);                               /* A function used to add a double to a double-double */
+static calc_dd_t dd_neg(calc_dd_t x);                                           /* A function used to negate a double-double */
+static calc_dd_t dd_sub(calc_dd_t x, calc_dd_t y);                              /* A function used to subtract double-doubles */
+static calc_dd_t dd_mul(calc_dd_t x, calc_dd_t y);                              /* A function used to multiply double-doubles */
+static calc_dd_t dd_mul_d(calc_dd_t x, double y);                               /* A function used to multiply a double-double by a double */
+static calc_dd_t dd_sqr(calc_dd_t x);                                           /* A function used to square a double-double */
+static calc_dd_t dd_div(calc_dd_t x, calc_dd_t y);                              /* A function used to divide double-doubles */
+static calc_dd_t dd_div_d(calc_dd_t x, double y);                               /* A function used to divide a double-double by a double */
+static calc_dd_t dd_ldexp(calc_dd_t x, int e);                                  /* A function used to multiply a double-double by a power of 2 */
+static uint8_t dd_less(calc_dd_t x, calc_dd_t y);                               /* A function used to compare double-doubles */
+static calc_dd_t dd_floor(calc_dd_t x);                                         /* A function used to round a double-double down */
+static calc_dd_t dd_ceil(calc_dd_t x);                                          /* A function used to round a double-double up */
+static calc_dd_t dd_trunc(calc_dd_t x);                                         /* A function used to round a double-double toward zero */
+static calc_dd_t dd_round(calc_dd_t x);                                         /* A function used to round a double-double half away from zero */
+static calc_dd_t dd_sqrt(calc_dd_t x);                                          /* A function used to calculate a square root */
+static calc_dd_t dd_exp(calc_dd_t x);                                           /* A function used to calculate the exponential function */
+static calc_dd_t dd_log1p(calc_dd_t x);                                         /* A function used to calculate ln(1 + x) */
+static calc_dd_t dd_log(calc_dd_t x);                                           /* A function used to calculate the natural logarithm */
+static void dd_sincos(calc_dd_t x, calc_dd_t* sine, calc_dd_t* cosine);         /* A function used to calculate the sine and the cosine */
+static calc_dd_t dd_atan2(calc_dd_t y, calc_dd_t x);                            /* A function used to calculate the angle of a point */
+static calc_dd_t dd_sinh(calc_dd_t x);                                          /* A function used to calculate the hyperbolic sine */
+static calc_dd_t dd_tanh(calc_dd_t x);                                          /* A function used to calculate the hyperbolic tangent */
+static calc_dd_t dd_powi(calc_dd_t x, int32_t n);                               /* A function used to raise a double-double to an integer power */
+static calc_dd_t dd_fact(calc_dd_t x);                                          /* A function used to calculate the factorial */
+static calc_dd_t dd_from_literal(const calc_literal_t* literal, double value);  /* A function used to convert a literal */
+static uint8_t dd_domain_contains(calc_domain_t domain, calc_dd_t x, calc_dd_t y);  /* A function used to check the arguments of a call */
+static calc_dd_t dd_call(calc_function_id_t fn, calc_dd_t x, calc_dd_t y);      /* A function used to calculate a math function */
+static calc_dd_t apply_dd(const calc_expr_t* expr, const calc_node_t* node, calc_dd_t x, calc_dd_t y, const calc_dd_t* vars,
+                          const calc_function_t* functions, calc_error_code_t* code);  /* A function used to calculate a node */
+
+/**
+ * \brief           A function used to evaluate an expression in double-double precision
+ * \param[in]       expr: A compiled expression
+ * \param[in]       vars: Values of the variables indexed by slot, NULL if there are none
+ * \param[out]      result: The result, may be NULL
+ * \param[out]      error: An error report, may be NULL
+ * \return          The result rounded to double, NaN in case of an error
+ * \note            A value is the unevaluated sum of two doubles, about 106 bits or 31 digits. Literals, pi, ln(2) and ln(10)
+ *                  are rounded to double-double, so e.g. 0.1+0.2-0.3 is about -1.5e-33 and sin(rad(180)) is below 1e-32.
+ *                  The operations and the math functions are calculated in double-double, except the trigonometric functions
+ *                  of arguments above 2^50 and fact of a fraction, which are calculated in double precision. An operation
+ *                  whose result is not finite, and a value below 2^-969 whose low part would underflow, are as of \ref calc_eval.
+ *                  Arguments are checked against the domains in double-double, so acosh(1 - 1e-20) is undefined.
+ *                  Calls are not counted by the function profile unless they take the double path.
+ */
+double
+calc_eval_dd(const calc_expr_t* expr, const calc_dd_t* vars, calc_dd_t* result, calc_error_t* error) {
+    calc_dd_t stack_values[CALC_DD_STACK_NODES];   /* Values of the nodes for small expressions */
+    calc_dd_t* values = stack_values;
+    calc_error_code_t code = CALC_OK;
+    calc_dd_t root = {nan(""), 0};
+
+    if (expr == NULL || expr->node_count == 0) {
+        code = CALC_ERROR_UNKNOWN;
+    } else if (expr->var_count > 0 && vars == NULL) {
+        code = CALC_ERROR_INVALID_INPUT;
+    } else if (expr->node_count > CALC_DD_STACK_NODES
+               && (values = (calc_dd_t*)malloc(expr->node_count * sizeof(calc_dd_t))) == NULL) {
+        code = CALC_ERROR_FAILED_TO_ALLOCATE_MEMORY;
+    } else {
+        const calc_function_t* functions = atomic_load_explicit(&calc_dispatch, memory_order_acquire);
+        for (size_t i = 0; code == CALC_OK && i < expr->node_count; ++i) {     /* Loop through all nodes in postfix order */
+            const calc_node_t* node = &expr->nodes[i];
+            calc_dd_t x = {0, 0}, y = {0, 0};                                   /* Values of the operands */
+            if (node->op > CALC_OP_VAR) {
+                x = values[node->a];
+                if (node->b >= 0) {
+                    y = values[node->b];
+                }
+            }
+            values[i] = apply_dd(expr, node, x, y, vars, functions, &code);
+        }
+        if (code == CALC_OK) {
+            root = values[expr->node_count - 1];    /* The last node is the root */
+            root.hi += 0.0;                         /* -0 is printed as 0 */
+        }
+        if (values != stack_values) {
+            free(values);
+        }
+    }
+    if (result != NULL) {
+        *result = root;
+    }
+    if (error != NULL) {
+        error->code = code;
+        error->position = 0;
+    }
+    return root.hi;
+}
+
+/**
+ * \brief           A function used to format a double-double result
+ * \param[in]       result: The result
+ * \param[out]      buffer: A buffer for the text
+ * \param[in]       size: Size of the buffer
+ * \return          Length of the text, as returned by snprintf
+ * \note            The result is rounded to \ref CALC_DD_DIGITS significant digits and printed without trailing zeros,
+ *                  in scientific notation when its decimal exponent is below -5 or not below the digits, like %g.
+ *                  An infinity or NaN is printed by \ref calc_format.
+ */
+int
+calc_format_dd(const calc_dd_t* result, char* buffer, size_t size) {
+    char digits[CALC_DD_DIGITS + 2];            /* The digits and one more to round */
+    char text[CALC_DD_DIGITS + 16];             /* The mantissa with a point */
+    calc_dd_t x = result->hi < 0 ? dd_neg(*result) : *result;
+    int exponent, len = 0, count = CALC_DD_DIGITS;
+    if (!isfinite(result->hi) || result->hi == 0) {
+        return calc_format(result->hi + 0.0, buffer, size);
+    }
+    exponent = (int)floor(log10(x.hi));
+    if (exponent > 0) {                         /* Scale into [1, 10), in two steps so that no power of 10 overflows */
+        x = dd_div(dd_div(x, dd_powi(dd_make(10, 0), exponent / 2)), dd_powi(dd_make(10, 0), exponent - exponent / 2));
+    } else if (exponent < 0) {
+        x = dd_mul(dd_mul(x, dd_powi(dd_make(10, 0), -exponent / 2)), dd_powi(dd_make(10, 0), -exponent + exponent / 2));
+    }
+    if (!dd_less(x, dd_make(10, 0))) {          /* log10 of the high part may be one off, and 1 - 1e-40 is below 1 */
+        x = dd_div_d(x, 10);
+        ++exponent;
+    } else if (dd_less(x, dd_make(1, 0))) {
+        x = dd_mul_d(x, 10);
+        --exponent;
+    }
+    for (int i = 0; i <= CALC_DD_DIGITS; ++i) { /* Peel the digits off one by one */
+        double digit = dd_floor(x).hi;
+        digit = digit < 0 ? 0 : digit > 9 ? 9 : digit;
+        digits[i] = (char)('0' + (int)digit);
+        x = dd_mul_d(dd_add_d(x, -digit), 10);
+    }
+    if (digits[CALC_DD_DIGITS] >= '5') {        /* Round half up by the extra digit */
+        int i = CALC_DD_DIGITS - 1;
+        for (; i >= 0 && digits[i] == '9'; --i) {
+            digits[i] = '0';
+        }
+        if (i < 0) {                            /* 9.99... rounds to 10 */
+            digits[0] = '1';
+            ++exponent;
+        } else {
+            ++digits[i];
+        }
+    }
+    while (count > 1 && digits[count - 1] == '0') { /* Drop the trailing zeros */
+        --count;
+    }
+    if (result->hi < 0) {
+        text[len++] = '-';
+    }
+    if (exponent < -5 || exponent >= CALC_DD_DIGITS) {  /* d.ddd followed by the exponent */
+        text[len++] = digits[0];
+        if (count > 1) {
+            text[len++] = '.';
+            for (int i = 1; i < count; ++i) {
+                text[len++] = digits[i];
+            }
+        }
+        text[len] = '\0';
+        return snprintf(buffer, size, "%se%c%02d", text, exponent < 0 ? '-' : '+', exponent < 0 ? -exponent : exponent);
+    }
+    if (exponent < 0) {                         /* 0.000ddd */
+        text[len++] = '0';
+        text[len++] = '.';
+        for (int i = -1; i > exponent; --i) {
+            text[len++] = '0';
+        }
+        for (int i = 0; i < count; ++i) {
+            text[len++] = digits[i];
+        }
+    } else {                                    /* ddd.ddd or ddd000 */
+        for (int i = 0; i <= exponent || i < count; ++i) {
+            if (i == exponent + 1) {
+                text[len++] = '.';
+            }
+            text[len++] = i < count ? digits[i] : '0';
+        }
+    }
+    text[len] = '\0';
+    return snprintf(buffer, size, "%s", text);
+}
+
+/**
+ * \brief           A function used to make a double-double of its parts
+ * \param[in]       hi: The high part
+ * \param[in]       lo: The low part, at most half an ulp of the high part
+ * \return          The double-double
+ */
+static inline calc_dd_t
+dd_make(double hi, double lo) {
+    calc_dd_t x = {hi, lo};
+    return x;
+}
+
+/**
+ * \brief           A function used to add two numbers exactly, when the first is not smaller in magnitude than the second
+ * \param[in]       a: The first number
+ * \param[in]       b: The second number
+ * \param[out]      error: The rounding error, so that a + b == result + error exactly
+ * \return          The rounded sum
+ */
+static inline double
+quick_two_sum(double a, double b, double* error) {
+    double s = a + b;
+    *error = b - (s - a);
+    return s;
+}
+
+/**
+ * \brief           A function used to add two numbers exactly
+ * \param[in]       a: The first number
+ * \param[in]       b: The second number
+ * \param[out]      error: The rounding error, so that a + b == result + error exactly
+ * \return          The rounded sum
+ */
+static inline double
+two_sum(double a, double b, double* error) {
+    double s = a + b, v = s - a;
+    *error = (a - (s - v)) + (b - v);
+    return s;
+}
+
+/**
+ * \brief           A function used to multiply two numbers exactly
+ * \param[in]       a: The first number
+ * \param[in]       b: The second number
+ * \param[out]      error: The rounding error, so that a * b == result + error exactly
+ * \return          The rounded product
+ * \note            Uses a fused multiply-add when the hardware has one, Dekker's splitting otherwise, like the powers of calc.c
+ */
+static inline double
+two_product(double a, double b, double* error) {
+    double p = a * b;
+#ifdef FP_FAST_FMA
+    *error = fma(a, b, -p);
+#else
+    const double split = 134217729.0;           /* 2^27 + 1 */
+    double ta = split * a, tb = split * b;
+    double ah = ta - (ta - a), al = a - ah;
+    double bh = tb - (tb - b), bl = b - bh;
+    *error = ((ah * bh - p) + ah * bl + al * bh) + al * bl;
+#endif /* FP_FAST_FMA */
+    return p;
+}
+
+/**
+ * \brief           A function used to add double-doubles
+ * \param[in]       x: The first term
+ * \param[in]       y: The second term
+ * \return          The sum, within 2^-106 of it relatively even when the terms cancel
+ */
+static inline calc_dd_t
+dd_add(calc_dd_t x, calc_dd_t y) {
+    double e, f, t;
+    double s = two_sum(x.hi, y.hi, &e);
+    t = two_sum(x.lo, y.lo, &f);
+    e += t;
+    s = quick_two_sum(s, e, &e);
+    e += f;
+    s = quick_two_sum(s, e, &e);
+    return dd_make(s, e);
+}
+
+/**
+ * \brief           A function used to add a double to a double-double
+ * \param[in]       x: The first term
+ * \param[in]       y: The second term
+ * \return          The sum
+ */
+static inline calc_dd_t
+dd_add_d(calc_dd_t x, double y) {
+    double e;
+    double s = two_sum(x.hi, y, &e);
+    e += x.lo;
+    s = quick_two_sum(s, e, &e);
+    return dd_make(s, e);
+}
+
+/**
+ * \brief           A function used to negate a double-double
+ * \param[in]       x: The number
+ * \return          -x
+ */
+static inline calc_dd_t
+dd_neg(calc_dd_t x) {
+    return dd_make(-x.hi, -x.lo);
+}
+
+/**
+ * \brief           A function used to subtract double-doubles
+ * \param[in]       x: The minuend
+ * \param[in]       y: The subtrahend
+ * \return          The difference
+ */
+static inline calc_dd_t
+dd_sub(calc_dd_t x, calc_dd_t y) {
+    return dd_add(x, dd_neg(y));
+}
+
+/**
+ * \brief           A function used to multiply double-doubles
+ * \param[in]       x: The first factor
+ * \param[in]       y: The second factor
+ * \return          The product
+ */
+static inline calc_dd_t
+dd_mul(calc_dd_t x, calc_dd_t y) {
+    double e;
+    double p = two_product(x.hi, y.hi, &e);
+    e += x.hi * y.lo + x.lo * y.hi;
+    p = quick_two_sum(p, e, &e);
+    return dd_make(p, e);
+}
+
+/**
+ * \brief           A function used to multiply a double-double by a double
+ * \param[in]       x: The first factor
+ * \param[in]       y: The second factor
+ * \return          The product
+ */
+static inline calc_dd_t
+dd_mul_d(calc_dd_t x, double y) {
+    double e;
+    double p = two_product(x.hi, y, &e);
+    e += x.lo * y;
+    p = quick_two_sum(p, e, &e);
+    return dd_make(p, e);
+}
+
+/**
+ * \brief           A function used to square a double-double
+ * \param[in]       x: The number
+ * \return          x * x
+ */
+static inline calc_dd_t
+dd_sqr(calc_dd_t x) {
+    double e;
+    double p = two_product(x.hi, x.hi, &e);
+    e += 2 * x.hi * x.lo;
+    p = quick_two_sum(p, e, &e);
+    return dd_make(p, e);
+}
+
+/**
+ * \brief           A function used to divide double-doubles
+ * \param[in]       x: The dividend
+ * \param[in]       y: The divisor
+ * \return          The quotient
+ * \note            The quotient of the high parts is corrected twice by the remainders, division by zero is left to double
+ */
+static calc_dd_t
+dd_div(calc_dd_t x, calc_dd_t y) {
+    double q1, q2, q3;
+    calc_dd_t r;
+    if (y.hi == 0) {
+        return dd_make(x.hi / y.hi, 0);
+    }
+    q1 = x.hi / y.hi;
+    r = dd_sub(x, dd_mul_d(y, q1));
+    q2 = r.hi / y.hi;
+    r = dd_sub(r, dd_mul_d(y, q2));
+    q3 = r.hi / y.hi;
+    q1 = quick_two_sum(q1, q2, &q2);
+    return dd_add_d(dd_make(q1, q2), q3);
+}
+
+/**
+ * \brief           A function used to divide a double-double by a double
+ * \param[in]       x: The dividend
+ * \param[in]       y: The divisor, not zero
+ * \return          The quotient
+ */
+static calc_dd_t
+dd_div_d(calc_dd_t x, double y) {
+    double e, f;
+    double q1 = x.hi / y, q2;
+    double p = two_product(q1, y, &e);          /* The remainder x - q1 * y */
+    double s = two_sum(x.hi, -p, &f);
+    f -= e;
+    f += x.lo;
+    q2 = (s + f) / y;
+    q1 = quick_two_sum(q1, q2, &q2);
+    return dd_make(q1, q2);
+}
+
+/**
+ * \brief           A function used to multiply a double-double by a power of 2
+ * \param[in]       x: The number
+ * \param[in]       e: The exponent
+ * \return          x * 2^e
+ */
+static inline calc_dd_t
+dd_ldexp(calc_dd_t x, int e) {
+    return dd_make(ldexp(x.hi, e), ldexp(x.lo, e));
+}
+
+/**
+ * \brief           A function used to compare double-doubles
+ * \param[in]       x: The first number
+ * \param[in]       y: The second number
+ * \return          1 if x < y, 0 otherwise or if either is NaN
+ */
+static inline uint8_t
+dd_less(calc_dd_t x, calc_dd_t y) {
+    return x.hi < y.hi || (x.hi == y.hi && x.lo < y.lo);
+}
+
+/**
+ * \brief           A function used to round a double-double down
+ * \param[in]       x: The number
+ * \return          The largest integer not above x
+ */
+static calc_dd_t
+dd_floor(calc_dd_t x) {
+    double hi = floor(x.hi), lo = 0;
+    if (hi == x.hi) {                           /* An integer high part, the low part decides */
+        lo = floor(x.lo);
+        hi = quick_two_sum(hi, lo, &lo);
+    }
+    return dd_make(hi, lo);
+}
+
+/**
+ * \brief           A function used to round a double-double up
+ * \param[in]       x: The number
+ * \return          The smallest integer not below x
+ */
+static calc_dd_t
+dd_ceil(calc_dd_t x) {
+    double hi = ceil(x.hi), lo = 0;
+    if (hi == x.hi) {                           /* An integer high part, the low part decides */
+        lo = ceil(x.lo);
+        hi = quick_two_sum(hi, lo, &lo);
+    }
+    return dd_make(hi, lo);
+}
+
+/**
+ * \brief           A function used to round a double-double toward zero
+ * \param[in]       x: The number
+ * \return          The integer part of x
+ */
+static calc_dd_t
+dd_trunc(calc_dd_t x) {
+    return x.hi < 0 ? dd_ceil(x) : dd_floor(x);
+}
+
+/**
+ * \brief           A function used to round a double-double to the nearest integer, half away from zero like round
+ * \param[in]       x: The number
+ * \return          The rounded number
+ */
+static calc_dd_t
+dd_round(calc_dd_t x) {
+    calc_dd_t t = dd_trunc(x), f = dd_sub(x, t);
+    if (f.hi >= 0.5) {
+        return dd_add_d(t, 1);
+    } else if (f.hi <= -0.5) {
+        return dd_add_d(t, -1);
+    }
+    return t;
+}
+
+/**
+ * \brief           A function used to calculate the square root of a double-double
+ * \param[in]       x: The argument, not below 0
+ * \return          The square root
+ * \note            The reciprocal square root of the high part is corrected by a single Newton step (Karp's method)
+ */
+static calc_dd_t
+dd_sqrt(calc_dd_t x) {
+    double r, a;
+    if (x.hi <= 0) {
+        return dd_make(sqrt(x.hi), 0);
+    }
+    r = 1 / sqrt(x.hi);
+    a = x.hi * r;
+    return dd_add_d(dd_make(a, 0), dd_sub(x, dd_sqr(dd_make(a, 0))).hi * r * 0.5);
+}
+
+/**
+ * \brief           A function used to calculate the exponential function of a double-double
+ * \param[in]       x: The argument
+ * \return          e^x, an infinity above \ref DD_EXP_MAX
+ * \note            The argument is reduced by a multiple of ln(2) exactly and divided by 512, the series of e^r - 1
+ *                  is squared back nine times as (e^r - 1)(e^r + 1) to keep the small terms
+ */
+static calc_dd_t
+dd_exp(calc_dd_t x) {
+    double k;
+    calc_dd_t r, p, s;
+    if (x.hi > DD_EXP_MAX) {
+        return dd_make(INFINITY, 0);
+    } else if (x.hi < DD_EXP_MIN) {
+        return dd_make(0, 0);
+    }
+    k = floor(x.hi / dd_ln2.hi + 0.5);
+    p.hi = two_product(k, dd_ln2_parts[0], &p.lo);  /* Exact multiples of the parts of ln(2) */
+    r = dd_sub(x, p);
+    p.hi = two_product(k, dd_ln2_parts[1], &p.lo);
+    r = dd_add_d(dd_sub(r, p), -k * dd_ln2_parts[2]);
+    r = dd_ldexp(r, -9);                        /* |r| <= ln(2) / 1024 */
+    p = dd_sqr(r);
+    s = dd_add(r, dd_ldexp(p, -1));
+    for (size_t n = 0; n < DD_FACTORIALS; ++n) {   /* The series of e^r - 1 */
+        calc_dd_t term;
+        p = dd_mul(p, r);
+        term = dd_mul(p, dd_inverse_factorials[n]);
+        s = dd_add(s, term);
+        if (fabs(term.hi) <= DD_EPSILON * fabs(s.hi)) {
+            break;
+        }
+    }
+    for (int i = 0; i < 9; ++i) {               /* e^(2r) - 1 = 2 (e^r - 1) + (e^r - 1)^2 */
+        s = dd_add(dd_ldexp(s, 1), dd_sqr(s));
+    }
+    return dd_ldexp(dd_add_d(s, 1), (int)k);
+}
+
+/**
+ * \brief           A function used to calculate ln(1 + x) of a double-double
+ * \param[in]       x: The argument, above -1
+ * \return          ln(1 + x), accurate relatively for a small x
+ * \note            A small x is summed as the series of 2 atanh(x / (2 + x)), the others are passed to \ref dd_log
+ */
+static calc_dd_t
+dd_log1p(calc_dd_t x) {
+    calc_dd_t t, t2, p, s;
+    if (fabs(x.hi) >= DD_LOG1P_MAX) {
+        return dd_log(dd_add_d(x, 1));
+    }
+    t = dd_div(x, dd_add_d(x, 2));
+    t2 = dd_sqr(t);
+    p = t;
+    s = t;
+    for (int k = 3; k < 64; k += 2) {           /* t + t^3/3 + t^5/5 + ... */
+        calc_dd_t term;
+        p = dd_mul(p, t2);
+        term = dd_div_d(p, k);
+        s = dd_add(s, term);
+        if (fabs(term.hi) <= DD_EPSILON * fabs(s.hi)) {
+            break;
+        }
+    }
+    return dd_ldexp(s, 1);
+}
+
+/**
+ * \brief           A function used to calculate the natural logarithm of a double-double
+ * \param[in]       x: The argument, above 0
+ * \return          ln(x)
+ * \note            x = m 2^e with m in [sqrt(1/2), sqrt(2)), ln(m) is the logarithm of the high part corrected
+ *                  by a Newton step, m - 1 when m is close to 1 is passed to \ref dd_log1p
+ */
+static calc_dd_t
+dd_log(calc_dd_t x) {
+    calc_dd_t m, r;
+    int e;
+    if (x.hi <= 0 || !isfinite(x.hi)) {
+        return dd_make(log(x.hi), 0);
+    }
+    frexp(x.hi, &e);
+    m = dd_ldexp(x, -e);
+    if (m.hi < M_SQRT1_2) {
+        m = dd_ldexp(m, 1);
+        --e;
+    }
+    r = dd_add_d(m, -1);
+    if (fabs(r.hi) < DD_LOG1P_MAX) {
+        r = dd_log1p(r);
+    } else {                                    /* y + m e^-y - 1 */
+        double y = log(m.hi);
+        r = dd_add_d(dd_add_d(dd_mul(m, dd_exp(dd_make(-y, 0))), -1), y);
+    }
+    return e == 0 ? r : dd_add(r, dd_mul_d(dd_ln2, e));
+}
+
+/**
+ * \brief           A function used to calculate the sine and the cosine of a double-double
+ * \param[in]       x: The argument
+ * \param[out]      sine: sin(x)
+ * \param[out]      cosine: cos(x)
+ * \note            The argument is reduced by a multiple of pi/2 exactly, then by a multiple of pi/16 whose sine and cosine
+ *                  are tabulated, the rest is at most pi/32 and is summed as the Taylor series. The multiple of pi/2
+ *                  is corrected when the rounded quotient leaves more than pi/4. Arguments above
+ *                  \ref DD_REDUCE_MAX are calculated in double precision.
+ */
+static void
+dd_sincos(calc_dd_t x, calc_dd_t* sine, calc_dd_t* cosine) {
+    double k;
+    int j;
+    calc_dd_t r, p, t, t2, s, c;
+    if (!(fabs(x.hi) <= DD_REDUCE_MAX)) {
+        *sine = dd_make(sin(x.hi), 0);
+        *cosine = dd_make(cos(x.hi), 0);
+        return;
+    }
+    k = round(x.hi / dd_pi_2.hi);
+    p.hi = two_product(k, dd_pi_2_parts[0], &p.lo);    /* Exact multiples of the parts of pi/2 */
+    r = dd_sub(x, p);
+    p.hi = two_product(k, dd_pi_2_parts[1], &p.lo);
+    r = dd_add_d(dd_sub(r, p), -k * dd_pi_2_parts[2]);
+    if (fabs(r.hi) > 4 * dd_pi_16.hi) {         /* The quotient is rounded, so a large k may be off by one */
+        double step = r.hi > 0 ? 1 : -1;
+        k += step;
+        r = dd_sub(r, dd_mul_d(dd_pi_2, step));
+    }
+    j = (int)round(r.hi / dd_pi_16.hi);         /* From -4 to 4 */
+    t = dd_sub(r, dd_mul_d(dd_pi_16, j));
+    t2 = dd_sqr(t);
+    p = t;
+    s = t;
+    for (size_t n = 0; n < DD_FACTORIALS; n += 2) {    /* t - t^3/3! + t^5/5! - ... */
+        calc_dd_t term;
+        p = dd_neg(dd_mul(p, t2));
+        term = dd_mul(p, dd_inverse_factorials[n]);
+        s = dd_add(s, term);
+        if (fabs(term.hi) <= DD_EPSILON * fabs(s.hi)) {
+            break;
+        }
+    }
+    c = dd_sqrt(dd_add_d(dd_neg(dd_sqr(s)), 1));   /* The cosine of at most pi/32 is close to 1 */
+    if (j != 0) {                               /* sin(t + a) and cos(t + a) */
+        calc_dd_t sa = dd_sin_table[abs(j) - 1], ca = dd_cos_table[abs(j) - 1];
+        calc_dd_t st = s;
+        if (j < 0) {
+            sa = dd_neg(sa);
+        }
+        s = dd_add(dd_mul(st, ca), dd_mul(c, sa));
+        c = dd_sub(dd_mul(c, ca), dd_mul(st, sa));
+    }
+    switch ((int64_t)k & 3) {                   /* The quadrant */
+        case 0:
+            *sine = s;
+            *cosine = c;
+            break;
+        case 1:
+            *sine = c;
+            *cosine = dd_neg(s);
+            break;
+        case 2:
+            *sine = dd_neg(s);
+            *cosine = dd_neg(c);
+            break;
+        default:
+            *sine = dd_neg(c);
+            *cosine = s;
+            break;
+    }
+}
+
+/**
+ * \brief           A function used to calculate the angle of a point as atan2
+ * \param[in]       y: The ordinate
+ * \param[in]       x: The abscissa
+ * \return          The angle from -pi to pi
+ * \note            The angle of the high parts is corrected by a Newton step on the sine or the cosine, whichever is smaller
+ */
+static calc_dd_t
+dd_atan2(calc_dd_t y, calc_dd_t x) {
+    calc_dd_t z, r, sz, cz;
+    int e;
+    if (x.hi == 0) {
+        return y.hi == 0 ? dd_make(0, 0) : y.hi > 0 ? dd_pi_2 : dd_neg(dd_pi_2);
+    } else if (y.hi == 0) {
+        return x.hi > 0 ? dd_make(0, 0) : dd_pi;
+    } else if (!isfinite(x.hi) || !isfinite(y.hi)) {
+        return dd_make(atan2(y.hi, x.hi), 0);
+    }
+    frexp(fabs(x.hi) > fabs(y.hi) ? x.hi : y.hi, &e);   /* Scale so that the squares neither overflow nor underflow */
+    x = dd_ldexp(x, -e);
+    y = dd_ldexp(y, -e);
+    r = dd_sqrt(dd_add(dd_sqr(x), dd_sqr(y)));
+    x = dd_div(x, r);
+    y = dd_div(y, r);
+    z = dd_make(atan2(y.hi, x.hi), 0);
+    dd_sincos(z, &sz, &cz);
+    if (fabs(x.hi) > fabs(y.hi)) {              /* z + (y - sin z) / cos z */
+        return dd_add(z, dd_div(dd_sub(y, sz), cz));
+    }
+    return dd_sub(z, dd_div(dd_sub(x, cz), sz)); /* z - (x - cos z) / sin z */
+}
+
+/**
+ * \brief           A function used to calculate the hyperbolic sine of a double-double
+ * \param[in]       x: The argument
+ * \return          sinh(x)
+ * \note            A small argument is summed as the Taylor series, where (e^x - e^-x) / 2 would cancel
+ */
+static calc_dd_t
+dd_sinh(calc_dd_t x) {
+    calc_dd_t p, x2, s, e;
+    if (fabs(x.hi) > DD_SINH_SERIES) {
+        e = dd_exp(x);
+        return dd_ldexp(dd_sub(e, dd_div(dd_make(1, 0), e)), -1);
+    }
+    x2 = dd_sqr(x);
+    p = x;
+    s = x;
+    for (size_t n = 0; n < DD_FACTORIALS; n += 2) {    /* x + x^3/3! + x^5/5! + ... */
+        calc_dd_t term;
+        p = dd_mul(p, x2);
+        term = dd_mul(p, dd_inverse_factorials[n]);
+        s = dd_add(s, term);
+        if (fabs(term.hi) <= DD_EPSILON * fabs(s.hi)) {
+            break;
+        }
+    }
+    return s;
+}
+
+/**
+ * \brief           A function used to calculate the hyperbolic tangent of a double-double
+ * \param[in]       x: The argument
+ * \return          tanh(x)
+ */
+static calc_dd_t
+dd_tanh(calc_dd_t x) {
+    calc_dd_t t;
+    if (fabs(x.hi) <= DD_SINH_SERIES) {         /* sinh(x) / sqrt(1 + sinh(x)^2) */
+        calc_dd_t s = dd_sinh(x);
+        return dd_div(s, dd_sqrt(dd_add_d(dd_sqr(s), 1)));
+    }
+    t = dd_exp(dd_ldexp(x.hi < 0 ? x : dd_neg(x), 1));  /* e^-2|x| never overflows */
+    t = dd_div(dd_sub(dd_make(1, 0), t), dd_add_d(t, 1));
+    return x.hi < 0 ? dd_neg(t) : t;
+}
+
+/**
+ * \brief           A function used to raise a double-double to an integer power by squaring
+ * \param[in]       x: The base
+ * \param[in]       n: The exponent
+ * \return          x raised to the power n
+ */
+static calc_dd_t
+dd_powi(calc_dd_t x, int32_t n) {
+    uint32_t m = n < 0 ? -(uint32_t)n : (uint32_t)n;
+    calc_dd_t result = {1, 0};
+    while (m != 0) {
+        if (m & 1) {
+            result = dd_mul(result, x);
+        }
+        m >>= 1;
+        if (m != 0) {
+            x = dd_sqr(x);
+        }
+    }
+    return n < 0 ? dd_div(dd_make(1, 0), result) : result;
+}
+
+/**
+ * \brief           A function used to calculate the factorial of a double-double
+ * \param[in]       x: The argument, not below 0
+ * \return          x!, the product of the integers up to x for an integer, the gamma function of x + 1 in double precision otherwise
+ */
+static calc_dd_t
+dd_fact(calc_dd_t x) {
+    calc_dd_t result = {1, 0};
+    if (x.lo != 0 || x.hi != floor(x.hi)) {
+        return dd_make(tgamma(x.hi + 1), 0);    /* Overflows to infinity above 171.62 */
+    } else if (x.hi > DD_FACT_MAX) {
+        return dd_make(INFINITY, 0);
+    }
+    double chunk = 1;                           /* A product of factors, exact below 2^53 */
+    for (int k = 2; k <= (int)x.hi; ++k) {
+        if (chunk * k >= 0x1p53) {
+            result = dd_mul_d(result, chunk);
+            chunk = 1;
+        }
+        chunk *= k;
+    }
+    return dd_mul_d(result, chunk);
+}
+
+/**
+ * \brief           A function used to convert a literal to double-double
+ * \param[in]       literal: The literal
+ * \param[in]       value: The literal as a double, the result if the digits overflow
+ * \return          The literal rounded to double-double
+ * \note            The digits are exact up to 2^106, a division by a power of 10 up to 10^45 is rounded once.
+ *                  A literal of a few digits is the division of two exact doubles.
+ */
+static calc_dd_t
+dd_from_literal(const calc_literal_t* literal, double value) {
+    calc_dd_t x = {0, 0};
+    if (literal->scale < DD_EXACT_POWERS && strlen(literal->digits) <= DD_EXACT_DIGITS) {  /* The digits are in the integer */
+        x = dd_make((double)literal->integer, 0);
+        return literal->scale == 0 ? x : dd_div_d(x, dd_powers_of_ten[literal->scale]);
+    }
+    for (const char* digit = literal->digits; *digit != '\0'; ++digit) {
+        x = dd_add_d(dd_mul_d(x, 10), *digit - '0');
+    }
+    if (literal->scale > 0) {
+        x = dd_div(x, dd_powi(dd_make(10, 0), literal->scale));
+    }
+    return isfinite(x.hi) && x.hi != 0 ? x : dd_make(value, 0);
+}
+
+/**
+ * \brief           A function used to check if double-doubles are in the domain of a math function
+ * \param[in]       domain: The domain
+ * \param[in]       x: The first argument
+ * \param[in]       y: The second argument
+ * \return          1 if the arguments are in the domain, 0 otherwise
+ * \note            The bounds at 1 and -1 are compared with the low part too, the other domains are checked on the high parts
+ *                  by \ref calc_domain_contains
+ */
+static uint8_t
+dd_domain_contains(calc_domain_t domain, calc_dd_t x, calc_dd_t y) {
+    double args[2] = {x.hi, y.hi};
+    switch (domain) {
+        case CALC_DOMAIN_UNIT_CLOSED:
+            return (x.hi > -1 || (x.hi == -1 && x.lo >= 0)) && (x.hi < 1 || (x.hi == 1 && x.lo <= 0));
+        case CALC_DOMAIN_UNIT_OPEN:
+            return (x.hi > -1 || (x.hi == -1 && x.lo > 0)) && (x.hi < 1 || (x.hi == 1 && x.lo < 0));
+        case CALC_DOMAIN_AT_LEAST_ONE:
+            return x.hi > 1 || (x.hi == 1 && x.lo >= 0);
+        case CALC_DOMAIN_NON_NEGATIVE_INTEGER:
+            return x.hi >= 0 && x.hi == floor(x.hi) && x.lo == floor(x.lo);
+        case CALC_DOMAIN_LOG_BASE:
+            return x.hi > 0 && (x.hi != 1 || x.lo != 0) && y.hi > 0;   /* The base is the first argument */
+        default:
+            return calc_domain_contains(domain, args);
+    }
+}
+
+/**
+ * \brief           A function used to calculate a math function in double-double precision
+ * \param[in]       fn: The function, its arguments are in its domain
+ * \param[in]       x: The first argument
+ * \param[in]       y: The second argument
+ * \return          The result
+ */
+static calc_dd_t
+dd_call(calc_function_id_t fn, calc_dd_t x, calc_dd_t y) {
+    calc_dd_t s, c, one = {1, 0};
+    switch (fn) {
+        case CALC_FN_SQRT:
+            return dd_sqrt(x);
+        case CALC_FN_LN:
+            return dd_log(x);
+        case CALC_FN_EXP:
+            return dd_exp(x);
+        case CALC_FN_SIN:
+            dd_sincos(x, &s, &c);
+            return s;
+        case CALC_FN_COS:
+            dd_sincos(x, &s, &c);
+            return c;
+        case CALC_FN_TAN:
+            dd_sincos(x, &s, &c);
+            return dd_div(s, c);
+        case CALC_FN_CTAN:
+            dd_sincos(x, &s, &c);
+            return dd_div(c, s);
+        case CALC_FN_ASIN:                      /* atan2(x, sqrt((1 - x)(1 + x))) */
+            return dd_atan2(x, dd_sqrt(dd_mul(dd_sub(one, x), dd_add_d(x, 1))));
+        case CALC_FN_ACOS:
+            return dd_atan2(dd_sqrt(dd_mul(dd_sub(one, x), dd_add_d(x, 1))), x);
+        case CALC_FN_ATAN:
+            return dd_atan2(x, one);
+        case CALC_FN_ACTAN:                     /* pi/2 - atan(x), from 0 to pi */
+            return dd_atan2(one, x);
+        case CALC_FN_SINH:
+            return dd_sinh(x);
+        case CALC_FN_COSH:
+            s = dd_exp(x.hi < 0 ? dd_neg(x) : x);
+            return dd_ldexp(dd_add(s, dd_div(one, s)), -1);
+        case CALC_FN_TANH:
+            return dd_tanh(x);
+        case CALC_FN_CTANH:
+            return dd_div(one, dd_tanh(x));
+        case CALC_FN_ASINH:                     /* ln1p(|x| + x^2 / (1 + sqrt(1 + x^2))) */
+            s = x.hi < 0 ? dd_neg(x) : x;
+            if (s.hi > DD_HUGE) {
+                s = dd_add(dd_log(s), dd_ln2);
+            } else {
+                c = dd_sqr(s);
+                s = dd_log1p(dd_add(s, dd_div(c, dd_add_d(dd_sqrt(dd_add_d(c, 1)), 1))));
+            }
+            return x.hi < 0 ? dd_neg(s) : s;
+        case CALC_FN_ACOSH:                     /* ln1p(u + sqrt(u (u + 2))) with u = x - 1 */
+            if (x.hi > DD_HUGE) {
+                return dd_add(dd_log(x), dd_ln2);
+            }
+            s = dd_add_d(x, -1);
+            return dd_log1p(dd_add(s, dd_sqrt(dd_mul(s, dd_add_d(s, 2)))));
+        case CALC_FN_ATANH:
+        case CALC_FN_ACTANH:                    /* ln1p(2x / (1 - x)) / 2, as the double version */
+            return dd_ldexp(dd_log1p(dd_div(dd_ldexp(x, 1), dd_sub(one, x))), -1);
+        case CALC_FN_FABS:
+            return x.hi < 0 ? dd_neg(x) : x;
+        case CALC_FN_CEIL:
+            return dd_ceil(x);
+        case CALC_FN_FLOOR:
+            return dd_floor(x);
+        case CALC_FN_ROUND:
+            return dd_round(x);
+        case CALC_FN_TRUNC:
+            return dd_trunc(x);
+        case CALC_FN_SIGN:
+            return dd_make((x.hi > 0) - (x.hi < 0), 0);
+        case CALC_FN_RAD:
+            return dd_div_d(dd_mul(x, dd_pi), 180);
+        case CALC_FN_DEG:
+            return dd_div(dd_mul_d(x, 180), dd_pi);
+        case CALC_FN_FACT:
+            return dd_fact(x);
+        case CALC_FN_LOG:                       /* The base is the first argument */
+            return dd_div(dd_log(y), dd_log(x));
+        case CALC_FN_LOG10:
+            return dd_div(dd_log(x), dd_ln10);
+        case CALC_FN_MIN:
+            return dd_less(y, x) ? y : x;
+        case CALC_FN_MAX:
+            return dd_less(x, y) ? y : x;
+        default:
+            return dd_make(nan(""), 0);
+    }
+}
+
+/**
+ * \brief           A function used to calculate the value of a node from the values of its operands in double-double precision
+ * \param[in]       expr: The expression
+ * \param[in]       node: The node
+ * \param[in]       x: Value of the first operand
+ * \param[in]       y: Value of the second operand
+ * \param[in]       vars: Values of the variables
+ * \param[in]       functions: The registry to dispatch the calls calculated in double precision through
+ * \param[out]      code: Set to an error code if the operation fails
+ * \return          The value of the node
+ * \note            An operation whose result is not finite is calculated again by \ref calc_apply_node on the high parts,
+ *                  so infinities, NaN and the errors are the same as of the double evaluation. A zero result takes
+ *                  the sign of a zero result of the double evaluation, so that e.g. an underflow keeps its sign.
+ */
+static calc_dd_t
+apply_dd(const calc_expr_t* expr, const calc_node_t* node, calc_dd_t x, calc_dd_t y, const calc_dd_t* vars,
+         const calc_function_t* functions, calc_error_code_t* code) {
+    calc_dd_t r;
+    switch (node->op) {
+        case CALC_OP_CONST:
+            return dd_from_literal(&expr->literals[node->a], node->value);
+        case CALC_OP_VAR:
+            return vars[node->a];
+        case CALC_OP_NEG:
+            return dd_neg(x);
+        case CALC_OP_ADD:
+            r = dd_add(x, y);
+            break;
+        case CALC_OP_SUB:
+            r = dd_sub(x, y);
+            break;
+        case CALC_OP_MUL:
+            r = dd_mul(x, y);
+            break;
+        case CALC_OP_DIV:
+            r = dd_div(x, y);
+            break;
+        case CALC_OP_MOD: {                     /* x - trunc(x / y) y, with the sign of x like fmod */
+            calc_dd_t q = dd_trunc(dd_div(x, y));
+            if (y.hi == 0 || !(fabs(q.hi) < 1 / DD_EPSILON)) {     /* The quotient has no fractional digits left */
+                r = dd_make(nan(""), 0);
+                break;
+            }
+            r = x;                              /* The products of the parts of q and y are exact, so the difference is too */
+            for (size_t i = 0; i < 4; ++i) {    /* The largest products first, they cancel most of x */
+                calc_dd_t p;
+                p.hi = two_product(i < 2 ? q.hi : q.lo, i % 2 == 0 ? y.hi : y.lo, &p.lo);
+                r = dd_sub(r, p);
+            }
+            if (r.hi != 0 && (r.hi < 0) != (x.hi < 0)) {           /* The quotient has been rounded up */
+                r = (r.hi < 0) == (y.hi < 0) ? dd_sub(r, y) : dd_add(r, y);
+            } else if (r.hi != 0) {
+                calc_dd_t t = (r.hi < 0) == (y.hi < 0) ? dd_sub(r, y) : dd_add(r, y);
+                if (t.hi == 0) {                                   /* The quotient has been rounded down, by a whole y */
+                    r = dd_make(copysign(0.0, x.hi), 0);
+                } else if ((t.hi < 0) == (r.hi < 0)) {             /* The quotient has been rounded down */
+                    r = t;
+                }
+            }
+            break;
+        }
+        case CALC_OP_POW:
+            if (y.lo == 0 && y.hi == floor(y.hi) && fabs(y.hi) < DD_POWI_MAX) {
+                r = dd_powi(x, (int32_t)y.hi);
+            } else if (x.hi > 0) {              /* e^(y ln x) */
+                r = dd_exp(dd_mul(y, dd_log(x)));
+            } else {                            /* A negative or zero base, left to pow */
+                r = dd_make(nan(""), 0);
+            }
+            break;
+        case CALC_OP_POWI:
+            r = dd_powi(x, (int32_t)node->value);
+            break;
+        case CALC_OP_CALL:
+            if (!dd_domain_contains(functions[node->fn].domain, x, y)) {
+                *code = CALC_ERROR_UNDEFINED_FUNCTION;
+                return dd_make(0, 0);
+            }
+            r = dd_call((calc_function_id_t)node->fn, x, y);
+            break;
+        case CALC_OP_GUARD:
+            return x;
+        default:
+            *code = CALC_ERROR_UNKNOWN;
+            return dd_make(0, 0);
+    }
+    if (!isfinite(r.hi) || !isfinite(r.lo) || (r.hi != 0 && fabs(r.hi) < 0x1p-969)) {  /* The low part would be inexact */
+        r = dd_make(calc_apply_node(node, x.hi, y.hi, NULL, functions, code), 0);
+    } else if (r.hi == 0) {                     /* The parts of a zero may have lost its sign */
+        calc_error_code_t rounded_code = CALC_OK;
+        double rounded = calc_apply_node(node, x.hi, y.hi, NULL, functions, &rounded_code);
+        r = dd_make(rounded == 0 ? rounded : 0.0, 0);
+    }
+    return r;
+}
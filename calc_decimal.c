@@ -0,0 +1,713 @@
+/**
+ * \file            calc_decimal.c
+ * \brief           Fixed-point decimal evaluation with 128-bit scaled integers
+ */
+
+/*
+ * Copyright (c) 2024 Daniil VERES
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * Author:          Daniil VERES <daniaveres@gmail.com>
+ * Version:         v1.0.0
+ */
+
+#include <math.h>           /* frexp, ldexp, nan, isfinite, trunc, fabs */
+#include <stdatomic.h>      /* atomic_load_explicit */
+#include <stdio.h>          /* snprintf */
+#include <stdlib.h>         /* malloc, free */
+#include <string.h>         /* strlen */
+#include "calc_internal.h"
+
+                                        /* Constants used: */
+#define CALC_DECIMAL_STACK_NODES 128    /*!< Number of node values kept on the stack by \ref calc_eval_decimal before falling back to the heap */
+#define DECIMAL_POW_LIMIT 100000        /*!< A decimal exponent of a power beyond which the power overflows or rounds to 0 */
+
+#ifdef __SIZEOF_INT128__
+typedef uint64_t decimal_half_t;        /*!< Half of \ref calc_uint_t, a digit of the wide division */
+#define DECIMAL_HALF_BITS 64            /*!< Bits of \ref decimal_half_t */
+#define DECIMAL_HALF_DIGITS 19          /*!< The largest power of 10 fitting into \ref decimal_half_t */
+#define DECIMAL_DIGITS 38               /*!< Digits of the largest power of 10 fitting into \ref calc_int_t, the largest scale */
+#define DECIMAL_POWER_19(low) ((calc_uint_t)10000000000000000000ULL * (low))    /*!< A power of 10 above 2^64 */
+#else
+typedef uint32_t decimal_half_t;        /*!< Half of \ref calc_uint_t, a digit of the wide division */
+#define DECIMAL_HALF_BITS 32            /*!< Bits of \ref decimal_half_t */
+#define DECIMAL_HALF_DIGITS 9           /*!< The largest power of 10 fitting into \ref decimal_half_t */
+#define DECIMAL_DIGITS 18               /*!< Digits of the largest power of 10 fitting into \ref calc_int_t, the largest scale */
+#endif /* __SIZEOF_INT128__ */
+#define DECIMAL_BITS (2 * DECIMAL_HALF_BITS)                    /*!< Bits of \ref calc_uint_t */
+#define DECIMAL_MAX ((calc_int_t)(~(calc_uint_t)0 >> 1))        /*!< The largest scaled integer */
+#define DECIMAL_POW_DIGITS (DECIMAL_DIGITS - 1)                 /*!< Significant digits kept by the powers, a product of two fits into \ref decimal_wide_t */
+
+/**
+ * \brief           Powers of 10 fitting into \ref calc_uint_t, the scaled integers of 1
+ */
+static const calc_uint_t decimal_powers[DECIMAL_DIGITS + 1] = {
+#ifdef __SIZEOF_INT128__
+    1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL,
+    100000ULL, 1000000ULL, 10000000ULL, 100000000ULL, 1000000000ULL,
+    10000000000ULL, 100000000000ULL, 1000000000000ULL, 10000000000000ULL, 100000000000000ULL,
+    1000000000000000ULL, 10000000000000000ULL, 100000000000000000ULL, 1000000000000000000ULL, 10000000000000000000ULL,
+    DECIMAL_POWER_19(10ULL), DECIMAL_POWER_19(100ULL), DECIMAL_POWER_19(1000ULL),
+    DECIMAL_POWER_19(10000ULL), DECIMAL_POWER_19(100000ULL), DECIMAL_POWER_19(1000000ULL),
+    DECIMAL_POWER_19(10000000ULL), DECIMAL_POWER_19(100000000ULL), DECIMAL_POWER_19(1000000000ULL),
+    DECIMAL_POWER_19(10000000000ULL), DECIMAL_POWER_19(100000000000ULL), DECIMAL_POWER_19(1000000000000ULL),
+    DECIMAL_POWER_19(10000000000000ULL), DECIMAL_POWER_19(100000000000000ULL), DECIMAL_POWER_19(1000000000000000ULL),
+    DECIMAL_POWER_19(10000000000000000ULL), DECIMAL_POWER_19(100000000000000000ULL), DECIMAL_POWER_19(1000000000000000000ULL),
+    DECIMAL_POWER_19(10000000000000000000ULL),
+#else
+    1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL,
+    100000ULL, 1000000ULL, 10000000ULL, 100000000ULL, 1000000000ULL,
+    10000000000ULL, 100000000000ULL, 1000000000000ULL, 10000000000000ULL, 100000000000000ULL,
+    1000000000000000ULL, 10000000000000000ULL, 100000000000000000ULL, 1000000000000000000ULL,
+#endif /* __SIZEOF_INT128__ */
+};
+
+/**
+ * \brief           An unsigned integer of twice the bits of \ref calc_uint_t, a product of two scaled integers
+ */
+typedef struct {
+    calc_uint_t high;           /*!< The high half */
+    calc_uint_t low;            /*!< The low half */
+} decimal_wide_t;
+
+/**
+ * \brief           A value of a node, a scaled integer or a double
+ */
+typedef struct {
+    calc_int_t integer;         /*!< The value multiplied by 10^scale, valid when \ref is_decimal is set */
+    double value;               /*!< The value, valid when \ref is_decimal is not set */
+    uint8_t is_decimal;         /*!< Set to `1` when the value is the scaled integer */
+} decimal_value_t;
+
+static calc_uint_t magnitude(calc_int_t x);                                                     /* A function used to get the absolute value of an integer */
+static uint32_t uint_bits(calc_uint_t x);                                                       /* A function used to count the significant bits of an integer */
+static decimal_wide_t wide_mul(calc_uint_t a, calc_uint_t b);                                   /* A function used to multiply integers into a wide product */
+static calc_uint_t wide_div_half(decimal_wide_t* w, decimal_half_t divisor);                    /* A function used to divide a wide integer by a short divisor */
+static calc_uint_t wide_div_power(decimal_wide_t* w, uint32_t digits);                          /* A function used to divide a wide integer by a power of 10 */
+static calc_uint_t wide_div(decimal_wide_t* w, calc_uint_t divisor);                            /* A function used to divide a wide integer by an integer */
+static uint8_t decimal_round(decimal_wide_t q, calc_uint_t remainder, calc_uint_t divisor, uint8_t negative, calc_int_t* result); /* A function used to round a quotient half to even */
+static uint8_t decimal_from_literal(const calc_literal_t* literal, uint32_t scale, calc_int_t* result);  /* A function used to convert a literal */
+static uint8_t decimal_from_double(double value, uint32_t scale, calc_int_t* result);           /* A function used to convert a double */
+static double decimal_to_double(calc_int_t integer, uint32_t scale);                            /* A function used to convert a scaled integer to a double */
+static uint8_t decimal_mul(calc_int_t x, calc_int_t y, uint32_t scale, calc_int_t* result);     /* A function used to multiply scaled integers */
+static uint8_t decimal_div(calc_int_t x, calc_int_t y, uint32_t scale, calc_int_t* result);     /* A function used to divide scaled integers */
+static void decimal_normalize(decimal_wide_t w, calc_uint_t* mantissa, int64_t* exponent);      /* A function used to round a wide integer to the digits of a power */
+static uint8_t decimal_pow(calc_int_t base, int64_t exponent, uint32_t scale, calc_int_t* result);  /* A function used to raise a scaled integer to an integer power */
+static uint8_t decimal_to_integer(calc_function_id_t fn, calc_int_t x, uint32_t scale, calc_int_t* result);  /* A function used to round a scaled integer to an integer */
+static uint8_t apply_decimal(const calc_node_t* node, calc_int_t x, calc_int_t y, uint32_t scale, calc_int_t* result, calc_error_code_t* code);  /* A function used to calculate an operation on scaled integers */
+
+/**
+ * \brief           A function used to evaluate an expression in fixed-point decimal arithmetic
+ * \param[in]       expr: A compiled expression
+ * \param[in]       vars: Values of the variables, NULL if the expression has none
+ * \param[in]       scale: A number of digits after the point, at most 38 (18 where the compiler has no 128-bit integers)
+ * \param[out]      result: The result, may be NULL
+ * \param[out]      error: An error report, may be NULL
+ * \return          The result as a double, NaN in case of an error
+ * \note            Every value is an integer multiple of 10^-scale held in a native 128-bit integer. Literals are converted
+ *                  from their digits and variables from their exact binary values. +, -, % and the rounding functions are exact,
+ *                  *, / and integer powers are rounded to the scale half to even. abs, ceil, floor, round (half away from zero),
+ *                  trunc, sign, fact of an integer, min and max are decimal too. Any other operation, a division by zero or a
+ *                  result out of the range is calculated in double precision from there on. Powers keep 37 significant digits
+ *                  (17 without 128-bit integers) until they are rounded, so longer results may be off in the last digit.
+ */
+double
+calc_eval_decimal(const calc_expr_t* expr, const double* vars, uint32_t scale, calc_decimal_t* result, calc_error_t* error) {
+    decimal_value_t stack_values[CALC_DECIMAL_STACK_NODES];     /* Values of the nodes for small expressions */
+    decimal_value_t* values = stack_values;
+    calc_error_code_t code = CALC_OK;
+    calc_decimal_t root = {nan(""), 0, 0, 0, scale};
+
+    if (expr == NULL || expr->node_count == 0) {
+        code = CALC_ERROR_UNKNOWN;
+    } else if ((expr->var_count > 0 && vars == NULL) || scale > DECIMAL_DIGITS) {
+        code = CALC_ERROR_INVALID_INPUT;
+    } else if (expr->node_count > CALC_DECIMAL_STACK_NODES
+               && (values = (decimal_value_t*)malloc(expr->node_count * sizeof(decimal_value_t))) == NULL) {
+        code = CALC_ERROR_FAILED_TO_ALLOCATE_MEMORY;
+    } else {
+        const calc_function_t* functions = atomic_load_explicit(&calc_dispatch, memory_order_acquire);
+        for (size_t i = 0; code == CALC_OK && i < expr->node_count; ++i) {     /* Loop through all nodes in postfix order */
+            const calc_node_t* node = &expr->nodes[i];
+            const decimal_value_t* x = node->op > CALC_OP_VAR ? &values[node->a] : NULL;
+            const decimal_value_t* y = node->op > CALC_OP_VAR && node->b >= 0 ? &values[node->b] : NULL;
+            decimal_value_t* value = &values[i];
+            if (node->op == CALC_OP_CONST) {
+                value->is_decimal = decimal_from_literal(&expr->literals[node->a], scale, &value->integer);
+            } else if (node->op == CALC_OP_VAR) {
+                value->is_decimal = decimal_from_double(vars[node->a], scale, &value->integer);
+            } else if (node->op == CALC_OP_POW && x->is_decimal && !y->is_decimal) {   /* An exponent out of the range of the scale */
+                value->is_decimal = y->value == trunc(y->value) && fabs(y->value) < 0x1p63
+                                    && decimal_pow(x->integer, (int64_t)y->value, scale, &value->integer);
+            } else {
+                value->is_decimal = x->is_decimal && (y == NULL || y->is_decimal || node->op == CALC_OP_GUARD)
+                                    && apply_decimal(node, x->integer, y != NULL ? y->integer : 0, scale, &value->integer, &code);
+            }
+            if (!value->is_decimal && code == CALC_OK) {
+                double a = x == NULL ? 0 : x->is_decimal ? decimal_to_double(x->integer, scale) : x->value;
+                double b = y == NULL ? 0 : y->is_decimal ? decimal_to_double(y->integer, scale) : y->value;
+                value->value = calc_apply_node(node, a, b, vars, functions, &code);
+            }
+        }
+        if (code == CALC_OK) {
+            const decimal_value_t* value = &values[expr->node_count - 1];   /* The last node is the root */
+            root.is_decimal = value->is_decimal;
+            root.value = value->is_decimal ? decimal_to_double(value->integer, scale) : value->value;
+            if (value->is_decimal) {
+#ifdef __SIZEOF_INT128__
+                root.high = (int64_t)(value->integer >> 64);
+#else
+                root.high = value->integer < 0 ? -1 : 0;
+#endif /* __SIZEOF_INT128__ */
+                root.low = (uint64_t)value->integer;
+            }
+        }
+        if (values != stack_values) {
+            free(values);
+        }
+    }
+    if (code != CALC_OK) {
+        root.value = nan("");
+        root.is_decimal = 0;
+    }
+    if (result != NULL) {
+        *result = root;
+    }
+    if (error != NULL) {
+        error->code = code;
+        error->position = 0;
+    }
+    return root.value;
+}
+
+/**
+ * \brief           A function used to format a result of a decimal evaluation
+ * \param[in]       result: The result
+ * \param[out]      buffer: A buffer for the text
+ * \param[in]       size: Size of the buffer
+ * \return          Length of the text, as returned by snprintf
+ * \note            A decimal result is printed with all the digits of its scale, e.g. `0.30` for the scale 2, any other result
+ *                  as by \ref calc_format
+ */
+int
+calc_format_decimal(const calc_decimal_t* result, char* buffer, size_t size) {
+    char digits[48];                            /* Digits in reverse order, 2^127 has 39 of them */
+    size_t count = 0, scale = result->scale;
+    calc_uint_t value;
+    if (!result->is_decimal || scale > DECIMAL_DIGITS) {
+        return calc_format(result->value, buffer, size);
+    }
+#ifdef __SIZEOF_INT128__
+    value = ((calc_uint_t)(uint64_t)result->high << 64) | result->low;
+#else
+    value = result->low;
+#endif /* __SIZEOF_INT128__ */
+    if (result->high < 0) {
+        value = -value;                         /* Unsigned negation is well defined for the smallest value too */
+    }
+    do {                                        /* At least one digit before the point */
+        digits[count++] = (char)('0' + (int)(value % 10));
+        value /= 10;
+    } while (value > 0 || count <= scale);
+    for (size_t i = 0; i < count / 2; ++i) {
+        char digit = digits[i];
+        digits[i] = digits[count - 1 - i];
+        digits[count - 1 - i] = digit;
+    }
+    return snprintf(buffer, size, "%s%.*s%s%.*s", result->high < 0 ? "-" : "", (int)(count - scale), digits, scale > 0 ? "." : "",
+                    (int)scale, digits + count - scale);
+}
+
+/**
+ * \brief           A function used to get the absolute value of an integer
+ * \param[in]       x: The integer
+ * \return          The absolute value, correct for the smallest integer too
+ */
+static calc_uint_t
+magnitude(calc_int_t x) {
+    return x < 0 ? -(calc_uint_t)x : (calc_uint_t)x;
+}
+
+/**
+ * \brief           A function used to count the significant bits of an integer
+ * \param[in]       x: The integer
+ * \return          A number of bits, 0 for 0
+ */
+static uint32_t
+uint_bits(calc_uint_t x) {
+    uint32_t bits = 0;
+#ifdef __SIZEOF_INT128__
+    if (x >> 64 != 0) {
+        bits = 64;
+        x >>= 64;
+    }
+#endif /* __SIZEOF_INT128__ */
+    return x == 0 ? bits : bits + 64 - (uint32_t)__builtin_clzll((unsigned long long)x);
+}
+
+/**
+ * \brief           A function used to multiply integers into a wide product
+ * \param[in]       a: The first factor
+ * \param[in]       b: The second factor
+ * \return          The product
+ * \note            The factors are split into halves, so the four partial products fit into \ref calc_uint_t
+ */
+static decimal_wide_t
+wide_mul(calc_uint_t a, calc_uint_t b) {
+    calc_uint_t mask = ((calc_uint_t)1 << DECIMAL_HALF_BITS) - 1;
+    calc_uint_t a0 = a & mask, a1 = a >> DECIMAL_HALF_BITS, b0 = b & mask, b1 = b >> DECIMAL_HALF_BITS;
+    calc_uint_t low = a0 * b0, cross = a0 * b1, middle = cross + a1 * b0;
+    decimal_wide_t w;
+    w.low = low + (middle << DECIMAL_HALF_BITS);
+    w.high = a1 * b1 + (middle >> DECIMAL_HALF_BITS) + (middle < cross ? (calc_uint_t)1 << DECIMAL_HALF_BITS : 0) + (w.low < low);
+    return w;
+}
+
+/**
+ * \brief           A function used to divide a wide integer by a short divisor
+ * \param[in,out]   w: The dividend, replaced by the quotient
+ * \param[in]       divisor: The divisor, not zero
+ * \return          The remainder
+ */
+static calc_uint_t
+wide_div_half(decimal_wide_t* w, decimal_half_t divisor) {
+    calc_uint_t mask = ((calc_uint_t)1 << DECIMAL_HALF_BITS) - 1, remainder = 0, quotient[4];
+    calc_uint_t digits[4] = {w->high >> DECIMAL_HALF_BITS, w->high & mask, w->low >> DECIMAL_HALF_BITS, w->low & mask};
+    for (size_t i = 0; i < 4; ++i) {            /* Long division by digits of half the bits */
+        calc_uint_t part = remainder << DECIMAL_HALF_BITS | digits[i];
+        quotient[i] = part / divisor;
+        remainder = part % divisor;
+    }
+    w->high = quotient[0] << DECIMAL_HALF_BITS | quotient[1];
+    w->low = quotient[2] << DECIMAL_HALF_BITS | quotient[3];
+    return remainder;
+}
+
+/**
+ * \brief           A function used to divide a wide integer by a power of 10
+ * \param[in,out]   w: The dividend, replaced by the quotient
+ * \param[in]       digits: The exponent of the divisor, at most \ref DECIMAL_DIGITS
+ * \return          The remainder
+ */
+static calc_uint_t
+wide_div_power(decimal_wide_t* w, uint32_t digits) {
+    calc_uint_t remainder = 0, divided = 1;     /* The remainder of the divisions so far, and their divisor */
+    while (digits > 0) {
+        uint32_t step = digits < DECIMAL_HALF_DIGITS ? digits : DECIMAL_HALF_DIGITS;
+        remainder += wide_div_half(w, (decimal_half_t)decimal_powers[step]) * divided;
+        divided *= decimal_powers[step];
+        digits -= step;
+    }
+    return remainder;
+}
+
+/**
+ * \brief           A function used to divide a wide integer by an integer
+ * \param[in,out]   w: The dividend, replaced by the quotient
+ * \param[in]       divisor: The divisor, not zero and at most 2^127 (2^63)
+ * \return          The remainder
+ * \note            A dividend which fits into \ref calc_uint_t takes the native division, any other the long division by bits
+ */
+static calc_uint_t
+wide_div(decimal_wide_t* w, calc_uint_t divisor) {
+    calc_uint_t remainder = 0;
+    if (w->high == 0) {
+        remainder = w->low % divisor;
+        w->low /= divisor;
+        return remainder;
+    }
+    for (uint32_t i = 0; i < 2 * DECIMAL_BITS; ++i) {   /* The quotient is shifted in from the right as the dividend leaves */
+        remainder = remainder << 1 | w->high >> (DECIMAL_BITS - 1);
+        w->high = w->high << 1 | w->low >> (DECIMAL_BITS - 1);
+        w->low <<= 1;
+        if (remainder >= divisor) {
+            remainder -= divisor;
+            w->low |= 1;
+        }
+    }
+    return remainder;
+}
+
+/**
+ * \brief           A function used to round a quotient half to even
+ * \param[in]       q: The magnitude of the truncated quotient
+ * \param[in]       remainder: The remainder of the division
+ * \param[in]       divisor: The divisor
+ * \param[in]       negative: Set to `1` when the quotient is negative
+ * \param[out]      result: The rounded quotient
+ * \return          1 on success, 0 if the quotient does not fit into \ref calc_int_t
+ */
+static uint8_t
+decimal_round(decimal_wide_t q, calc_uint_t remainder, calc_uint_t divisor, uint8_t negative, calc_int_t* result) {
+    if (remainder > divisor - remainder || (remainder == divisor - remainder && (q.low & 1))) {
+        q.high += ++q.low == 0;
+    }
+    if (q.high != 0 || q.low > (calc_uint_t)DECIMAL_MAX) {
+        return 0;
+    }
+    *result = negative ? -(calc_int_t)q.low : (calc_int_t)q.low;
+    return 1;
+}
+
+/**
+ * \brief           A function used to convert a literal to a scaled integer
+ * \param[in]       literal: The literal
+ * \param[in]       scale: A number of digits after the point
+ * \param[out]      result: The scaled integer
+ * \return          1 on success, 0 if the literal does not fit
+ * \note            Digits beyond the scale round the value half to even, compared as text so that any number of them is exact
+ */
+static uint8_t
+decimal_from_literal(const calc_literal_t* literal, uint32_t scale, calc_int_t* result) {
+    const char* digits = literal->digits;
+    int64_t length = (int64_t)strlen(digits), kept = length - literal->scale + (int64_t)scale;    /* Digits of the scaled integer */
+    calc_uint_t value = 0;
+    for (int64_t i = 0; i < kept; ++i) {
+        if (__builtin_mul_overflow(value, 10, &value) || __builtin_add_overflow(value, i < length ? digits[i] - '0' : 0, &value)) {
+            return 0;
+        }
+    }
+    if (kept >= 0 && kept < length) {           /* Round on the dropped digits */
+        int64_t i = kept + 1;
+        while (i < length && digits[i] == '0') {
+            ++i;
+        }
+        if (digits[kept] > '5' || (digits[kept] == '5' && (i < length || (value & 1)))) {
+            ++value;
+        }
+    }
+    if (value > (calc_uint_t)DECIMAL_MAX) {
+        return 0;
+    }
+    *result = (calc_int_t)value;
+    return 1;
+}
+
+/**
+ * \brief           A function used to convert a double to a scaled integer
+ * \param[in]       value: The double
+ * \param[in]       scale: A number of digits after the point
+ * \param[out]      result: The scaled integer
+ * \return          1 on success, 0 if the value is not finite or does not fit
+ * \note            The exact binary value is rounded half to even, so 0.1 gives 0.10 for the scale 2 but
+ *                  0.1000000000000000055511151231257827 for the scale 34
+ */
+static uint8_t
+decimal_from_double(double value, uint32_t scale, calc_int_t* result) {
+    int exponent;
+    double fraction = frexp(value, &exponent);  /* value = fraction 2^exponent with 1/2 <= |fraction| < 1 */
+    int64_t mantissa = (int64_t)ldexp(fraction, 53);
+    decimal_wide_t w;
+    uint32_t shift;
+    uint8_t half, sticky;
+    if (!isfinite(value)) {
+        return 0;
+    } else if (value == 0) {
+        *result = 0;
+        return 1;
+    }
+    w = wide_mul(magnitude(mantissa), decimal_powers[scale]);  /* value 10^scale = w 2^(exponent - 53) */
+    exponent -= 53;
+    if (exponent >= 0) {
+        if (w.high != 0 || exponent >= DECIMAL_BITS - 1 || w.low > (calc_uint_t)DECIMAL_MAX >> exponent) {
+            return 0;
+        }
+        *result = mantissa < 0 ? -(calc_int_t)(w.low << exponent) : (calc_int_t)(w.low << exponent);
+        return 1;
+    } else if (-exponent >= 2 * DECIMAL_BITS) { /* Far below half of the last digit */
+        *result = 0;
+        return 1;
+    }
+    shift = (uint32_t)-exponent - 1;            /* The bit worth half of the last digit */
+    if (shift >= DECIMAL_BITS) {
+        half = (uint8_t)(w.high >> (shift - DECIMAL_BITS) & 1);
+        sticky = w.low != 0 || (w.high & (((calc_uint_t)1 << (shift - DECIMAL_BITS)) - 1)) != 0;
+        w.low = shift + 1 < 2 * DECIMAL_BITS ? w.high >> (shift + 1 - DECIMAL_BITS) : 0;
+        w.high = 0;
+    } else {
+        half = (uint8_t)(w.low >> shift & 1);
+        sticky = (w.low & (((calc_uint_t)1 << shift) - 1)) != 0;
+        w.low = shift + 1 < DECIMAL_BITS ? w.low >> (shift + 1) | w.high << (DECIMAL_BITS - shift - 1) : w.high;
+        w.high = shift + 1 < DECIMAL_BITS ? w.high >> (shift + 1) : 0;
+    }
+    return decimal_round(w, half ? (sticky ? 3 : 2) : sticky, 4, mantissa < 0, result);   /* The dropped bits as quarters */
+}
+
+/**
+ * \brief           A function used to convert a scaled integer to a double
+ * \param[in]       integer: The scaled integer
+ * \param[in]       scale: A number of digits after the point
+ * \return          A double close to the value, the nearest one while the integer and 10^scale are exact doubles
+ */
+static double
+decimal_to_double(calc_int_t integer, uint32_t scale) {
+    return (double)integer / (double)decimal_powers[scale];
+}
+
+/**
+ * \brief           A function used to multiply scaled integers
+ * \param[in]       x: The first factor
+ * \param[in]       y: The second factor
+ * \param[in]       scale: A number of digits after the point
+ * \param[out]      result: The product rounded half to even
+ * \return          1 on success, 0 if the product does not fit
+ * \note            A product of the factors fitting into \ref calc_int_t takes the native division by 10^scale
+ */
+static uint8_t
+decimal_mul(calc_int_t x, calc_int_t y, uint32_t scale, calc_int_t* result) {
+    calc_int_t product, unit = (calc_int_t)decimal_powers[scale];
+    decimal_wide_t w;
+    if (!__builtin_mul_overflow(x, y, &product)) {
+        calc_int_t q = product / unit;
+        calc_uint_t remainder = magnitude(product % unit);
+        if (remainder > (calc_uint_t)unit - remainder || (remainder == (calc_uint_t)unit - remainder && (q & 1))) {
+            q += product < 0 ? -1 : 1;
+        }
+        *result = q;
+        return 1;
+    }
+    w = wide_mul(magnitude(x), magnitude(y));
+    return decimal_round(w, wide_div_power(&w, scale), (calc_uint_t)unit, (x < 0) != (y < 0), result);
+}
+
+/**
+ * \brief           A function used to divide scaled integers
+ * \param[in]       x: The dividend
+ * \param[in]       y: The divisor, not zero
+ * \param[in]       scale: A number of digits after the point
+ * \param[out]      result: The quotient rounded half to even
+ * \return          1 on success, 0 if the quotient does not fit
+ * \note            A dividend times 10^scale fitting into \ref calc_int_t takes the native division
+ */
+static uint8_t
+decimal_div(calc_int_t x, calc_int_t y, uint32_t scale, calc_int_t* result) {
+    calc_int_t numerator;
+    decimal_wide_t w;
+    if (!__builtin_mul_overflow(x, (calc_int_t)decimal_powers[scale], &numerator) && (y != -1 || numerator != -DECIMAL_MAX - 1)) {
+        calc_int_t q = numerator / y;
+        calc_uint_t remainder = magnitude(numerator % y), divisor = magnitude(y);
+        if (remainder > divisor - remainder || (remainder == divisor - remainder && (q & 1))) {
+            q += (numerator < 0) != (y < 0) ? -1 : 1;
+        }
+        *result = q;
+        return 1;
+    }
+    w = wide_mul(magnitude(x), decimal_powers[scale]);
+    return decimal_round(w, wide_div(&w, magnitude(y)), magnitude(y), (x < 0) != (y < 0), result);
+}
+
+/**
+ * \brief           A function used to round a wide integer to the significant digits of a power
+ * \param[in]       w: The integer
+ * \param[out]      mantissa: The integer truncated to \ref DECIMAL_POW_DIGITS digits, with a sticky last digit
+ * \param[in,out]   exponent: The decimal exponent of the integer, increased by the dropped digits
+ */
+static void
+decimal_normalize(decimal_wide_t w, calc_uint_t* mantissa, int64_t* exponent) {
+    uint32_t bits = w.high != 0 ? DECIMAL_BITS + uint_bits(w.high) : uint_bits(w.low), drop;
+    calc_uint_t remainder;
+    if (w.high == 0 && w.low < decimal_powers[DECIMAL_POW_DIGITS]) {
+        *mantissa = w.low;
+        return;
+    }
+    drop = (uint32_t)((double)bits * 0.30102999566398120) + 1 - DECIMAL_POW_DIGITS;  /* bits log10(2) + 1 digits at most */
+    remainder = wide_div_power(&w, drop);
+    if (remainder != 0 && w.low % 5 == 0) {    /* An inexact last digit is never 0 or 5, so it cannot look like a tie */
+        ++w.low;
+    }
+    *mantissa = w.low;
+    *exponent += drop;
+}
+
+/**
+ * \brief           A function used to raise a scaled integer to an integer power
+ * \param[in]       base: The base
+ * \param[in]       exponent: The exponent
+ * \param[in]       scale: A number of digits after the point
+ * \param[out]      result: The power rounded half to even
+ * \return          1 on success, 0 if the power does not fit or the base is 0 with a negative exponent
+ * \note            Square and multiply on numbers of \ref DECIMAL_POW_DIGITS significant digits and a decimal exponent, so
+ *                  that only the last step rounds to the scale, e.g. 1.05^10 is 1.63 for the scale 2. A power of more significant
+ *                  digits than about \ref DECIMAL_POW_DIGITS - 2 may be off by one in the last of them.
+ */
+static uint8_t
+decimal_pow(calc_int_t base, int64_t exponent, uint32_t scale, calc_int_t* result) {
+    calc_uint_t mantissa = 1, square;           /* The power so far is mantissa 10^power, the square is square 10^shift */
+    int64_t power = 0, shift = -(int64_t)scale;
+    uint64_t count = exponent < 0 ? -(uint64_t)exponent : (uint64_t)exponent;
+    uint8_t negative = base < 0 && (count & 1);
+    decimal_wide_t w;
+    if (base == 0) {
+        *result = exponent == 0 ? (calc_int_t)decimal_powers[scale] : 0;
+        return exponent >= 0;                   /* 0^-n is an infinity */
+    }
+    decimal_normalize((decimal_wide_t){0, magnitude(base)}, &square, &shift);
+    while (count > 0) {
+        if (count & 1) {
+            power += shift;
+            decimal_normalize(wide_mul(mantissa, square), &mantissa, &power);
+        }
+        count >>= 1;
+        if (count > 0) {
+            shift *= 2;
+            decimal_normalize(wide_mul(square, square), &square, &shift);
+        }
+        if (shift > DECIMAL_POW_LIMIT || shift < -DECIMAL_POW_LIMIT || power > DECIMAL_POW_LIMIT || power < -DECIMAL_POW_LIMIT) {
+            if ((shift > 0 || power > 0) == (exponent > 0)) {
+                return 0;                       /* Far beyond the largest value */
+            }
+            *result = 0;                        /* Far below the last digit */
+            return 1;
+        }
+    }
+    if (exponent >= 0) {                        /* mantissa 10^(power + scale) */
+        power += scale;
+        if (power > DECIMAL_DIGITS) {
+            return 0;
+        } else if (power >= 0) {
+            w = wide_mul(mantissa, decimal_powers[power]);
+            return decimal_round(w, 0, 1, negative, result);
+        } else if (power < -DECIMAL_DIGITS) {   /* Below a tenth of the last digit */
+            *result = 0;
+            return 1;
+        }
+        w = (decimal_wide_t){0, mantissa};
+        return decimal_round(w, wide_div_power(&w, (uint32_t)-power), decimal_powers[-power], negative, result);
+    }
+    power = scale - power;                      /* 10^(scale - power) / mantissa */
+    if (power > 2 * DECIMAL_DIGITS) {
+        return 0;
+    } else if (power < 0) {
+        *result = 0;
+        return 1;
+    }
+    w = wide_mul(decimal_powers[power < DECIMAL_DIGITS ? power : DECIMAL_DIGITS], decimal_powers[power < DECIMAL_DIGITS ? 0 : power - DECIMAL_DIGITS]);
+    return decimal_round(w, wide_div(&w, mantissa), mantissa, negative, result);
+}
+
+/**
+ * \brief           A function used to round a scaled integer to an integer
+ * \param[in]       fn: \ref CALC_FN_CEIL, \ref CALC_FN_FLOOR, \ref CALC_FN_ROUND (half away from zero) or \ref CALC_FN_TRUNC
+ * \param[in]       x: The scaled integer
+ * \param[in]       scale: A number of digits after the point
+ * \param[out]      result: The rounded scaled integer
+ * \return          1 on success, 0 if the result does not fit
+ */
+static uint8_t
+decimal_to_integer(calc_function_id_t fn, calc_int_t x, uint32_t scale, calc_int_t* result) {
+    calc_int_t unit = (calc_int_t)decimal_powers[scale], q = x / unit, remainder = x % unit;
+    switch (fn) {
+        case CALC_FN_CEIL:
+            q += remainder > 0;
+            break;
+        case CALC_FN_FLOOR:
+            q -= remainder < 0;
+            break;
+        case CALC_FN_ROUND:
+            if (magnitude(remainder) >= (calc_uint_t)unit - magnitude(remainder)) {
+                q += x < 0 ? -1 : 1;
+            }
+            break;
+        default:
+            break;
+    }
+    return !__builtin_mul_overflow(q, unit, result);
+}
+
+/**
+ * \brief           A function used to calculate an operation on scaled integers
+ * \param[in]       node: The node of the operation
+ * \param[in]       x: The first operand
+ * \param[in]       y: The second operand, 0 for unary operations
+ * \param[in]       scale: A number of digits after the point
+ * \param[out]      result: The scaled result
+ * \param[out]      code: Set to an error code if the arguments are out of the domain of a math function
+ * \return          1 if the result is a scaled integer, 0 if the operation has to be calculated in double precision
+ */
+static uint8_t
+apply_decimal(const calc_node_t* node, calc_int_t x, calc_int_t y, uint32_t scale, calc_int_t* result, calc_error_code_t* code) {
+    calc_int_t unit = (calc_int_t)decimal_powers[scale], n;
+    switch (node->op) {
+        case CALC_OP_NEG:
+            return !__builtin_sub_overflow(0, x, result);
+        case CALC_OP_ADD:
+            return !__builtin_add_overflow(x, y, result);
+        case CALC_OP_SUB:
+            return !__builtin_sub_overflow(x, y, result);
+        case CALC_OP_MUL:
+            return decimal_mul(x, y, scale, result);
+        case CALC_OP_DIV:
+            return y != 0 && decimal_div(x, y, scale, result);     /* A division by zero gives an infinity or NaN */
+        case CALC_OP_MOD:
+            if (y == 0) {
+                return 0;                       /* NaN */
+            }
+            *result = y == -1 ? 0 : x % y;      /* The sign follows the dividend, like fmod */
+            return 1;
+        case CALC_OP_POW:
+            n = y / unit;
+            return y % unit == 0 && n == (int64_t)n && decimal_pow(x, (int64_t)n, scale, result);  /* A fraction is left to pow */
+        case CALC_OP_POWI:
+            return decimal_pow(x, (int64_t)node->value, scale, result);
+        case CALC_OP_GUARD:
+            *result = x;
+            return 1;
+        case CALC_OP_CALL:
+            switch (node->fn) {
+                case CALC_FN_FABS:
+                    return x >= 0 ? (*result = x, 1) : !__builtin_sub_overflow(0, x, result);
+                case CALC_FN_SIGN:
+                    *result = x > 0 ? unit : x < 0 ? -unit : 0;
+                    return 1;
+                case CALC_FN_CEIL:
+                case CALC_FN_FLOOR:
+                case CALC_FN_ROUND:
+                case CALC_FN_TRUNC:
+                    return decimal_to_integer((calc_function_id_t)node->fn, x, scale, result);
+                case CALC_FN_MIN:
+                    *result = x < y ? x : y;
+                    return 1;
+                case CALC_FN_MAX:
+                    *result = x > y ? x : y;
+                    return 1;
+                case CALC_FN_FACT:
+                    if (x < 0) {
+                        *code = CALC_ERROR_UNDEFINED_FUNCTION;
+                        return 0;
+                    } else if (x % unit != 0) {
+                        return 0;               /* The gamma function of a fraction */
+                    }
+                    n = unit;
+                    for (calc_int_t i = 2; i <= x / unit; ++i) {    /* Overflows within 34 steps (20 with 64-bit integers) */
+                        if (__builtin_mul_overflow(n, i, &n)) {
+                            return 0;
+                        }
+                    }
+                    *result = n;
+                    return 1;
+                default:
+                    return 0;
+            }
+        default:
+            return 0;
+    }
+}
@@ -0,0 +1,745 @@
+/**
+ * \file            calc_diff.c
+ * \brief           Symbolic differentiation of compiled expressions into new compiled expressions
+ */
+
+/*
+ * Copyright (c) 2024 Daniil VERES
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * Author:          Daniil VERES <daniaveres@gmail.com>
+ * Version:         v1.0.0
+ */
+
+                            /* Functions used: */
+#include <stdint.h>         /* int32_t, int64_t, uint8_t, uint64_t */
+#include <stdio.h>          /* snprintf */
+#include <stdlib.h>         /* malloc, calloc, realloc, free */
+#include <string.h>         /* memcpy, memcmp, strcmp, strlen */
+#include "calc_internal.h"
+
+                                        /* Constants used: */
+#define DIFF_MAX_INTEGER 9007199254740992   /*!< 2^53, the largest folded integer, so that a double holds it exactly */
+#define DIFF_TABLE_MIN 64                   /*!< The initial number of buckets of the table of nodes */
+
+/**
+ * \brief           State of a single differentiation, the derivative being built
+ */
+typedef struct {
+    calc_expr_t* expr;          /*!< The expression being built */
+    size_t node_capacity;       /*!< Capacity of the node array */
+    size_t literal_capacity;    /*!< Capacity of the literal array */
+    int32_t* table;             /*!< Indices of the nodes by hash, -1 in an empty bucket, so that equal nodes are built once */
+    size_t table_size;          /*!< A number of buckets, a power of 2 at least twice the number of nodes */
+    calc_error_code_t code;     /*!< The first error met while building */
+    uint8_t values;             /*!< Set while the values of the expression are built, whose operations by 0 are kept */
+} diff_builder_t;
+
+static int32_t derivative(diff_builder_t* builder, const calc_node_t* node, int32_t u, int32_t v, int32_t w, int32_t du, int32_t dv);   /* A function used to apply the rule of a node */
+static int32_t emit(diff_builder_t* builder, calc_op_t op, calc_function_id_t fn, int32_t a, int32_t b, double value);   /* A function used to add a simplified node */
+static int32_t emit_integer(diff_builder_t* builder, int64_t value);                           /* A function used to add an integer constant */
+static int32_t emit_literal(diff_builder_t* builder, const calc_literal_t* literal, double value, uint8_t exact);    /* A function used to add a constant */
+static int32_t emit_power(diff_builder_t* builder, int32_t base, int64_t exponent);             /* A function used to add a power with an integer exponent */
+static int32_t fold(diff_builder_t* builder, calc_op_t op, int32_t a, int32_t b, double value); /* A function used to fold an integer operation */
+static uint8_t integer_value(const diff_builder_t* builder, int32_t index, int64_t* value);     /* A function used to get the value of an integer constant */
+static int32_t find_or_append(diff_builder_t* builder, const calc_node_t* node, const calc_literal_t* literal);  /* A function used to reuse or append a node */
+static uint64_t node_hash(const calc_expr_t* expr, const calc_node_t* node, const calc_literal_t* literal);     /* A function used to hash a node */
+static uint8_t grow_table(diff_builder_t* builder);                                             /* A function used to double the table of nodes */
+static int32_t guard(diff_builder_t* builder, const calc_expr_t* expr, const int32_t* primal, int32_t root);   /* A function used to keep the domain of the expression */
+static calc_expr_t* compact(diff_builder_t* builder, const calc_expr_t* expr, int32_t root);    /* A function used to drop the nodes the root does not use */
+
+/**
+ * \brief           A function used to differentiate a compiled expression symbolically
+ * \param[in]       expr: A compiled expression
+ * \param[in]       name: A name of the variable, the derivative with respect to a name the expression does not use is 0
+ * \param[out]      error: An error report, may be NULL
+ * \return          The derivative, a compiled expression to be released with \ref calc_free, NULL in case of an error
+ * \note            The derivative has the variables of the expression in the same slots, so it takes the same array of values,
+ *                  and is evaluated by every engine as any other expression. It is built by the rules of \ref calc_node_partials
+ *                  out of the operations and functions of the language, then simplified as it is built: `0` and `1` operands
+ *                  vanish, negations move outwards, operations on integer constants are folded while the result is exact,
+ *                  and an operation equal to an earlier one is not built again, which merges the common subexpressions
+ *                  of the expression and its derivative. The simplifications take `0*x` as 0 in the terms of the derivative,
+ *                  as the numeric modes do, but not in the values of the expression, where a NaN `x` fails the calls it reaches.
+ *                  The derivative of `fact` of an argument depending on the variable has no closed form and is reported
+ *                  as \ref CALC_ERROR_UNDEFINED_FUNCTION. The derivative is defined where the expression is: a call the
+ *                  derivative does not use, e.g. `ln(x)` whose derivative is `1/x`, is kept by a \ref CALC_OP_GUARD node,
+ *                  so the derivative of `ln(x)` at -1 fails like \ref calc_eval_dual does.
+ */
+calc_expr_t*
+calc_diff(const calc_expr_t* expr, const char* name, calc_error_t* error) {
+    diff_builder_t builder = {0};               /* The state of this differentiation */
+    int32_t* primal = NULL;                     /* The node of the value of every node of the expression */
+    int32_t* tangent = NULL;                    /* The node of the derivative of every node of the expression */
+    calc_expr_t* result = NULL;
+    int64_t slot = -1;                          /* The slot of the variable, -1 if the expression does not use it */
+    int32_t root;                               /* The root of the derivative */
+
+    if (expr == NULL || expr->node_count == 0 || name == NULL) {
+        builder.code = CALC_ERROR_UNKNOWN;
+    } else if ((builder.expr = (calc_expr_t*)calloc(1, sizeof(calc_expr_t))) == NULL
+               || (primal = (int32_t*)malloc(expr->node_count * sizeof(int32_t))) == NULL
+               || (tangent = (int32_t*)malloc(expr->node_count * sizeof(int32_t))) == NULL
+               || (builder.table = (int32_t*)malloc(DIFF_TABLE_MIN * sizeof(int32_t))) == NULL) {
+        builder.code = CALC_ERROR_FAILED_TO_ALLOCATE_MEMORY;
+    } else {
+        builder.table_size = DIFF_TABLE_MIN;
+        memset(builder.table, -1, builder.table_size * sizeof(int32_t));
+        for (size_t k = 0; k < expr->var_count; ++k) {
+            if (strcmp(expr->var_names[k], name) == 0) {
+                slot = (int64_t)k;
+            }
+        }
+        for (size_t i = 0; builder.code == CALC_OK && i < expr->node_count; ++i) {  /* Loop through all nodes in postfix order */
+            const calc_node_t* node = &expr->nodes[i];
+            if (node->op == CALC_OP_CONST) {
+                primal[i] = emit_literal(&builder, &expr->literals[node->a], node->value, node->exact);
+                tangent[i] = emit_integer(&builder, 0);
+            } else if (node->op == CALC_OP_VAR) {
+                primal[i] = emit(&builder, CALC_OP_VAR, 0, node->a, -1, 0);
+                tangent[i] = emit_integer(&builder, node->a == slot);
+            } else {
+                int32_t u = primal[node->a], v = node->b >= 0 ? primal[node->b] : -1;
+                int32_t du = tangent[node->a], dv = node->b >= 0 ? tangent[node->b] : -1;
+                int64_t zero;
+                builder.values = 1;
+                primal[i] = emit(&builder, (calc_op_t)node->op, (calc_function_id_t)node->fn, u, v, node->value);
+                builder.values = 0;
+                if (integer_value(&builder, du, &zero) && zero == 0
+                    && (dv < 0 || (integer_value(&builder, dv, &zero) && zero == 0))) {
+                    tangent[i] = du;                /* The node does not depend on the variable */
+                } else {
+                    tangent[i] = derivative(&builder, node, u, v, primal[i], du, dv);
+                }
+            }
+        }
+        root = builder.code == CALC_OK ? guard(&builder, expr, primal, tangent[expr->node_count - 1]) : -1;
+        if (builder.code == CALC_OK) {
+            result = compact(&builder, expr, root);
+        }
+    }
+    free(primal);
+    free(tangent);
+    free(builder.table);
+    calc_free(builder.expr);
+    if (error != NULL) {
+        error->code = builder.code;
+        error->position = 0;
+    }
+    return result;
+}
+
+/**
+ * \brief           A function used to build the derivative of a node from the values and the derivatives of its operands
+ * \param[in]       builder: The state of the differentiation
+ * \param[in]       node: The node of the expression, not a constant or a variable
+ * \param[in]       u: The node of the value of the first operand
+ * \param[in]       v: The node of the value of the second operand, -1 for unary operations
+ * \param[in]       w: The node of the value of the node itself
+ * \param[in]       du: The node of the derivative of the first operand
+ * \param[in]       dv: The node of the derivative of the second operand, -1 for unary operations
+ * \return          The node of the derivative, -1 in case of an error
+ * \note            A function of one argument is the chain rule, the derivative of the argument multiplied by `factor`
+ *                  or divided by `divisor`, negated for the decreasing functions
+ */
+static int32_t
+derivative(diff_builder_t* builder, const calc_node_t* node, int32_t u, int32_t v, int32_t w, int32_t du, int32_t dv) {
+    int32_t factor = -1, divisor = -1, one = emit_integer(builder, 1), result;
+    uint8_t negate = 0;
+    switch (node->op) {
+        case CALC_OP_NEG:
+            return emit(builder, CALC_OP_NEG, 0, du, -1, 0);
+        case CALC_OP_ADD:
+        case CALC_OP_SUB:
+            return emit(builder, (calc_op_t)node->op, 0, du, dv, 0);
+        case CALC_OP_MUL:                       /* u'v + uv' */
+            return emit(builder, CALC_OP_ADD, 0, emit(builder, CALC_OP_MUL, 0, du, v, 0), emit(builder, CALC_OP_MUL, 0, u, dv, 0), 0);
+        case CALC_OP_DIV:                       /* (u' - wv') / v */
+            return emit(builder, CALC_OP_DIV, 0, emit(builder, CALC_OP_SUB, 0, du, emit(builder, CALC_OP_MUL, 0, w, dv, 0), 0), v, 0);
+        case CALC_OP_MOD:                       /* u' - nv' for the integer quotient n = (u - w) / v */
+            return emit(builder, CALC_OP_SUB, 0, du, emit(builder, CALC_OP_MUL, 0, emit(builder, CALC_OP_CALL, CALC_FN_ROUND,
+                        emit(builder, CALC_OP_DIV, 0, emit(builder, CALC_OP_SUB, 0, u, w, 0), v, 0), -1, 0), dv, 0), 0);
+        case CALC_OP_POW:                       /* v u^(v - 1) u' + w ln(u) v' */
+            return emit(builder, CALC_OP_ADD, 0,
+                        emit(builder, CALC_OP_MUL, 0, emit(builder, CALC_OP_MUL, 0, v, emit(builder, CALC_OP_POW, 0, u,
+                             emit(builder, CALC_OP_SUB, 0, v, one, 0), 0), 0), du, 0),
+                        emit(builder, CALC_OP_MUL, 0, emit(builder, CALC_OP_MUL, 0, w, emit(builder, CALC_OP_CALL, CALC_FN_LN, u, -1, 0), 0), dv, 0), 0);
+        case CALC_OP_POWI:                      /* n u^(n - 1) u' */
+            return emit(builder, CALC_OP_MUL, 0, emit(builder, CALC_OP_MUL, 0, emit_integer(builder, (int64_t)node->value),
+                        emit_power(builder, u, (int64_t)node->value - 1), 0), du, 0);
+        case CALC_OP_GUARD:                     /* The guarded call is a call of the expression, guarded again by \ref guard */
+            return du;
+        default:
+            break;
+    }
+    switch (node->fn) {
+        case CALC_FN_SQRT:   divisor = emit(builder, CALC_OP_MUL, 0, emit_integer(builder, 2), w, 0);   break;
+        case CALC_FN_LN:     divisor = u;                                                               break;
+        case CALC_FN_EXP:    factor = w;                                                                break;
+        case CALC_FN_SIN:    factor = emit(builder, CALC_OP_CALL, CALC_FN_COS, u, -1, 0);               break;
+        case CALC_FN_COS:    factor = emit(builder, CALC_OP_CALL, CALC_FN_SIN, u, -1, 0); negate = 1;   break;
+        case CALC_FN_CTAN:   negate = 1;                                                                /* fallthrough */
+        case CALC_FN_TAN:    factor = emit(builder, CALC_OP_ADD, 0, one, emit_power(builder, w, 2), 0); break;
+        case CALC_FN_ACOS:   negate = 1;                                                                /* fallthrough */
+        case CALC_FN_ASIN:
+            divisor = emit(builder, CALC_OP_CALL, CALC_FN_SQRT, emit(builder, CALC_OP_MUL, 0, emit(builder, CALC_OP_SUB, 0, one, u, 0),
+                                                                     emit(builder, CALC_OP_ADD, 0, one, u, 0), 0), -1, 0);
+            break;
+        case CALC_FN_ACTAN:  negate = 1;                                                                /* fallthrough */
+        case CALC_FN_ATAN:   divisor = emit(builder, CALC_OP_ADD, 0, one, emit_power(builder, u, 2), 0);    break;
+        case CALC_FN_SINH:   factor = emit(builder, CALC_OP_CALL, CALC_FN_COSH, u, -1, 0);              break;
+        case CALC_FN_COSH:   factor = emit(builder, CALC_OP_CALL, CALC_FN_SINH, u, -1, 0);              break;
+        case CALC_FN_TANH:
+        case CALC_FN_CTANH:  factor = emit(builder, CALC_OP_SUB, 0, one, emit_power(builder, w, 2), 0); break;
+        case CALC_FN_ASINH:  divisor = emit(builder, CALC_OP_CALL, CALC_FN_COSH, w, -1, 0);              break;  /* sqrt(u^2 + 1), without overflow */
+        case CALC_FN_ACOSH:
+            divisor = emit(builder, CALC_OP_CALL, CALC_FN_SQRT, emit(builder, CALC_OP_MUL, 0, emit(builder, CALC_OP_SUB, 0, u, one, 0),
+                                                                     emit(builder, CALC_OP_ADD, 0, u, one, 0), 0), -1, 0);
+            break;
+        case CALC_FN_ATANH:
+        case CALC_FN_ACTANH:
+            divisor = emit(builder, CALC_OP_MUL, 0, emit(builder, CALC_OP_SUB, 0, one, u, 0), emit(builder, CALC_OP_ADD, 0, one, u, 0), 0);
+            break;
+        case CALC_FN_FABS:   factor = emit(builder, CALC_OP_CALL, CALC_FN_SIGN, u, -1, 0);              break;
+        case CALC_FN_RAD:                       /* The conversions are linear */
+        case CALC_FN_DEG:    return emit(builder, CALC_OP_CALL, (calc_function_id_t)node->fn, du, -1, 0);
+        case CALC_FN_FACT:                      /* The derivative takes the digamma function, which is not in the language */
+            if (builder->code == CALC_OK) {
+                builder->code = CALC_ERROR_UNDEFINED_FUNCTION;
+            }
+            return -1;
+        case CALC_FN_LOG:                       /* log(u, v) = ln(v) / ln(u): (v'/v - w u'/u) / ln(u) */
+            return emit(builder, CALC_OP_DIV, 0, emit(builder, CALC_OP_SUB, 0, emit(builder, CALC_OP_DIV, 0, dv, v, 0),
+                        emit(builder, CALC_OP_DIV, 0, emit(builder, CALC_OP_MUL, 0, w, du, 0), u, 0), 0),
+                        emit(builder, CALC_OP_CALL, CALC_FN_LN, u, -1, 0), 0);
+        case CALC_FN_LOG10:
+            divisor = emit(builder, CALC_OP_MUL, 0, u, emit(builder, CALC_OP_CALL, CALC_FN_LN, emit_integer(builder, 10), -1, 0), 0);
+            break;
+        case CALC_FN_MIN:                       /* u' + k (v' - u'), where k = sign(abs(w - u)) is 0 when u is returned */
+        case CALC_FN_MAX:
+            return emit(builder, CALC_OP_ADD, 0, du, emit(builder, CALC_OP_MUL, 0, emit(builder, CALC_OP_CALL, CALC_FN_SIGN,
+                        emit(builder, CALC_OP_CALL, CALC_FN_FABS, emit(builder, CALC_OP_SUB, 0, w, u, 0), -1, 0), -1, 0),
+                        emit(builder, CALC_OP_SUB, 0, dv, du, 0), 0), 0);
+        default:                                /* Rounding functions and the sign are piecewise constant */
+            return emit_integer(builder, 0);
+    }
+    result = divisor >= 0 ? emit(builder, CALC_OP_DIV, 0, du, divisor, 0) : emit(builder, CALC_OP_MUL, 0, factor, du, 0);
+    return negate ? emit(builder, CALC_OP_NEG, 0, result, -1, 0) : result;
+}
+
+/**
+ * \brief           A function used to add a node to the derivative, simplified
+ * \param[in]       builder: The state of the differentiation
+ * \param[in]       op: An operation, not a constant
+ * \param[in]       fn: The function of a call
+ * \param[in]       a: An index of the first operand or a variable slot
+ * \param[in]       b: An index of the second operand, -1 if there is none
+ * \param[in]       value: The exponent of a \ref CALC_OP_POWI node
+ * \return          An index of the node giving the value, -1 in case of an error
+ * \note            Every simplification holds in every mode, as it only drops operations by 0 and 1 or moves signs;
+ *                  a negation moves outwards so that it meets the constants and the other negations. A product or
+ *                  a quotient by 0 is 0, and a sum with 0 the other operand, only in the terms of the derivative: in
+ *                  a value of the expression the other operand may be NaN, as `x%0` is, or a zero whose sign makes
+ *                  a quotient infinite, either of which fails a call the derivative keeps by \ref guard.
+ */
+static int32_t
+emit(diff_builder_t* builder, calc_op_t op, calc_function_id_t fn, int32_t a, int32_t b, double value) {
+    const calc_node_t* nodes;
+    calc_node_t node = {0};
+    int64_t x = 2, y = 2;                       /* The integer operands, 2 stands for anything else */
+    int32_t folded;
+    if (builder->code != CALC_OK) {             /* An operand has failed */
+        return -1;
+    }
+    if (op > CALC_OP_VAR && (folded = fold(builder, op, a, b, value)) != -2) {
+        return folded;
+    }
+    nodes = builder->expr->nodes;
+    if (op > CALC_OP_VAR && !integer_value(builder, a, &x)) {
+        x = 2;
+    }
+    if (b >= 0 && !integer_value(builder, b, &y)) {
+        y = 2;
+    }
+    switch (op) {
+        case CALC_OP_NEG:
+            if (nodes[a].op == CALC_OP_NEG) {   /* -(-u) */
+                return nodes[a].a;
+            }
+            break;
+        case CALC_OP_ADD:
+            if ((x == 0 || y == 0) && !builder->values) {   /* -0 + 0 is 0 */
+                return x == 0 ? b : a;
+            } else if (nodes[b].op == CALC_OP_NEG) {    /* u + (-v) */
+                return emit(builder, CALC_OP_SUB, 0, a, nodes[b].a, 0);
+            } else if (nodes[a].op == CALC_OP_NEG) {    /* (-u) + v */
+                return emit(builder, CALC_OP_SUB, 0, b, nodes[a].a, 0);
+            }
+            break;
+        case CALC_OP_SUB:
+            if (y == 0) {
+                return a;
+            } else if (x == 0 && !builder->values) {    /* 0 - 0 is 0 */
+                return emit(builder, CALC_OP_NEG, 0, b, -1, 0);
+            } else if (nodes[b].op == CALC_OP_NEG) {    /* u - (-v) */
+                return emit(builder, CALC_OP_ADD, 0, a, nodes[b].a, 0);
+            }
+            break;
+        case CALC_OP_MUL:
+        case CALC_OP_DIV:
+            if ((x == 0 || (op == CALC_OP_MUL && y == 0)) && !builder->values) {
+                return emit_integer(builder, 0);
+            } else if (y == 1 || (op == CALC_OP_MUL && x == 1)) {
+                return y == 1 ? a : b;
+            } else if (y == -1 || (op == CALC_OP_MUL && x == -1)) {
+                return emit(builder, CALC_OP_NEG, 0, y == -1 ? a : b, -1, 0);
+            } else if (nodes[a].op == CALC_OP_NEG || nodes[b].op == CALC_OP_NEG) {  /* (-u) * v is -(u * v) */
+                int32_t p = nodes[a].op == CALC_OP_NEG ? nodes[a].a : a, q = nodes[b].op == CALC_OP_NEG ? nodes[b].a : b;
+                uint8_t negative = (nodes[a].op == CALC_OP_NEG) != (nodes[b].op == CALC_OP_NEG);
+                int32_t product = emit(builder, op, 0, p, q, 0);
+                return negative ? emit(builder, CALC_OP_NEG, 0, product, -1, 0) : product;
+            }
+            break;
+        case CALC_OP_POWI:
+            if (value == 0) {
+                return emit_integer(builder, 1);
+            } else if (value == 1) {
+                return a;
+            }
+            break;
+        default:
+            break;
+    }
+    node.op = (uint8_t)op;
+    node.fn = (uint8_t)fn;
+    node.a = a;
+    node.b = b;
+    node.value = value;
+    if (op == CALC_OP_VAR) {
+        node.exact = 1;
+    } else {
+        node.exact = nodes[a].exact && (b < 0 || op == CALC_OP_GUARD || nodes[b].exact) && (op != CALC_OP_CALL || calc_exact_function(fn))
+                     && (op != CALC_OP_POWI || value >= 0);     /* As the compiler marks the nodes */
+    }
+    return find_or_append(builder, &node, NULL);
+}
+
+/**
+ * \brief           A function used to add an integer constant to the derivative
+ * \param[in]       builder: The state of the differentiation
+ * \param[in]       value: The value, at most \ref DIFF_MAX_INTEGER in absolute value
+ * \return          An index of the node giving the value, a negation of a constant for a negative value, -1 in case of an error
+ */
+static int32_t
+emit_integer(diff_builder_t* builder, int64_t value) {
+    char digits[24];
+    calc_literal_t literal;
+    calc_node_t negation = {0};
+    snprintf(digits, sizeof(digits), "%lld", (long long)(value < 0 ? -value : value));
+    literal.digits = digits;
+    literal.scale = 0;
+    literal.integer = value < 0 ? -value : value;
+    negation.op = CALC_OP_NEG;
+    negation.exact = 1;
+    negation.a = emit_literal(builder, &literal, (double)(value < 0 ? -value : value), 1);
+    negation.b = -1;
+    if (value >= 0 || negation.a < 0) {
+        return negation.a;
+    }
+    return find_or_append(builder, &negation, NULL);    /* Not \ref emit, which would fold the negation back */
+}
+
+/**
+ * \brief           A function used to add a constant to the derivative
+ * \param[in]       builder: The state of the differentiation
+ * \param[in]       literal: The literal of the constant, copied
+ * \param[in]       value: The value of the constant
+ * \param[in]       exact: Set to `1` when the literal is an integer fitting into \ref calc_int_t
+ * \return          An index of the node of the constant, -1 in case of an error
+ */
+static int32_t
+emit_literal(diff_builder_t* builder, const calc_literal_t* literal, double value, uint8_t exact) {
+    calc_node_t node = {0};
+    if (builder->code != CALC_OK) {
+        return -1;
+    }
+    node.op = CALC_OP_CONST;
+    node.exact = exact;
+    node.a = -1;                                /* Set when the literal is appended */
+    node.b = -1;
+    node.value = value;
+    return find_or_append(builder, &node, literal);
+}
+
+/**
+ * \brief           A function used to add a power with a constant integer exponent
+ * \param[in]       builder: The state of the differentiation
+ * \param[in]       base: An index of the base
+ * \param[in]       exponent: The exponent
+ * \return          An index of the node giving the power, -1 in case of an error
+ * \note            The exponent is folded into the node up to \ref CALC_POWI_MAX in absolute value, as the compiler does
+ */
+static int32_t
+emit_power(diff_builder_t* builder, int32_t base, int64_t exponent) {
+    if (exponent >= -CALC_POWI_MAX && exponent <= CALC_POWI_MAX) {
+        return emit(builder, CALC_OP_POWI, 0, base, -1, (double)exponent);
+    }
+    return emit(builder, CALC_OP_POW, 0, base, emit_integer(builder, exponent), 0);
+}
+
+/**
+ * \brief           A function used to fold an operation on integer constants
+ * \param[in]       builder: The state of the differentiation
+ * \param[in]       op: An operation
+ * \param[in]       a: An index of the first operand
+ * \param[in]       b: An index of the second operand, -1 if there is none
+ * \param[in]       value: The exponent of a \ref CALC_OP_POWI node
+ * \return          An index of the constant, -1 in case of an error, -2 when the operation is not folded
+ * \note            Only exact results up to \ref DIFF_MAX_INTEGER are folded, so the constant has the same value in every mode;
+ *                  a result of -0 in double precision is not folded, as the integer 0 would change the sign of a quotient
+ */
+static int32_t
+fold(diff_builder_t* builder, calc_op_t op, int32_t a, int32_t b, double value) {
+    int64_t x, y = 0, result = 1;
+    if (!integer_value(builder, a, &x) || (b >= 0 && !integer_value(builder, b, &y))) {
+        return -2;
+    }
+    switch (op) {
+        case CALC_OP_NEG:
+            if (x == 0) {                       /* -0, a divisor of the other sign */
+                return -2;
+            }
+            result = -x;
+            break;
+        case CALC_OP_ADD:
+            result = x + y;                     /* The operands are at most 2^53, so the sums do not overflow */
+            break;
+        case CALC_OP_SUB:
+            result = x - y;
+            break;
+        case CALC_OP_MUL:
+            if (__builtin_mul_overflow(x, y, &result) || (result == 0 && (x < 0 || y < 0))) {
+                return -2;
+            }
+            break;
+        case CALC_OP_DIV:
+        case CALC_OP_MOD:
+            if (y == 0 || (op == CALC_OP_DIV && x % y != 0) || (x == 0 && y < 0) || (op == CALC_OP_MOD && x < 0 && x % y == 0)) {
+                return -2;                      /* Not an integer, or -0 */
+            }
+            result = op == CALC_OP_DIV ? x / y : x % y;     /* The remainder has the sign of the dividend, as fmod */
+            break;
+        case CALC_OP_POWI:
+            if (value < 0) {
+                return -2;
+            }
+            for (int64_t n = 0; n < (int64_t)value; ++n) {
+                if (__builtin_mul_overflow(result, x, &result) || result > DIFF_MAX_INTEGER || result < -DIFF_MAX_INTEGER) {
+                    return -2;
+                }
+            }
+            break;
+        default:
+            return -2;
+    }
+    if (result > DIFF_MAX_INTEGER || result < -DIFF_MAX_INTEGER) {
+        return -2;
+    }
+    return emit_integer(builder, result);
+}
+
+/**
+ * \brief           A function used to get the value of an integer constant of the derivative
+ * \param[in]       builder: The state of the differentiation
+ * \param[in]       index: An index of a node
+ * \param[out]      value: The value
+ * \return          `1` when the node is an integer literal up to \ref DIFF_MAX_INTEGER or its negation, `0` otherwise
+ */
+static uint8_t
+integer_value(const diff_builder_t* builder, int32_t index, int64_t* value) {
+    const calc_expr_t* expr = builder->expr;
+    const calc_node_t* node;
+    uint8_t negative = 0;
+    if (index < 0) {
+        return 0;
+    }
+    node = &expr->nodes[index];
+    if (node->op == CALC_OP_NEG) {
+        node = &expr->nodes[node->a];
+        negative = 1;
+    }
+    if (node->op != CALC_OP_CONST || !node->exact || expr->literals[node->a].integer > DIFF_MAX_INTEGER
+        || (negative && expr->literals[node->a].integer == 0)) {
+        return 0;                               /* -0 is not the integer 0, e.g. as a divisor */
+    }
+    *value = negative ? -(int64_t)expr->literals[node->a].integer : (int64_t)expr->literals[node->a].integer;
+    return 1;
+}
+
+/**
+ * \brief           A function used to find a node equal to the given one, appending it to the derivative if there is none
+ * \param[in]       builder: The state of the differentiation
+ * \param[in]       node: The node
+ * \param[in]       literal: The literal of a constant, NULL for the other nodes
+ * \return          An index of the node, -1 in case of an error
+ * \note            Constants are equal when their literals are, so every mode reads the same value from either.
+ *                  Calls of a function which is not pure are never merged.
+ */
+static int32_t
+find_or_append(diff_builder_t* builder, const calc_node_t* node, const calc_literal_t* literal) {
+    calc_expr_t* expr = builder->expr;
+    uint8_t pure = node->op != CALC_OP_CALL || calc_functions[node->fn].pure;
+    size_t bucket = (size_t)node_hash(expr, node, literal) & (builder->table_size - 1);
+    size_t length = literal != NULL ? strlen(literal->digits) + 1 : 0;
+    calc_node_t* added;
+    while (builder->table[bucket] >= 0) {       /* Linear probing until an equal node or an empty bucket */
+        const calc_node_t* other = &expr->nodes[builder->table[bucket]];
+        if (pure && other->op == node->op && (literal != NULL
+                ? expr->literals[other->a].scale == literal->scale && strcmp(expr->literals[other->a].digits, literal->digits) == 0
+                : other->fn == node->fn && other->a == node->a && other->b == node->b
+                  && memcmp(&other->value, &node->value, sizeof(double)) == 0)) {
+            return builder->table[bucket];
+        }
+        bucket = (bucket + 1) & (builder->table_size - 1);
+    }
+    if (expr->node_count == builder->node_capacity) {           /* Check if the node array is full */
+        size_t capacity = builder->node_capacity > 0 ? builder->node_capacity * 2 : 16;
+        calc_node_t* nodes = (calc_node_t*)realloc(expr->nodes, capacity * sizeof(calc_node_t));
+        if (nodes == NULL || capacity > INT32_MAX) {
+            if (nodes != NULL) {
+                expr->nodes = nodes;
+            }
+            builder->code = CALC_ERROR_FAILED_TO_ALLOCATE_MEMORY;
+            return -1;
+        }
+        expr->nodes = nodes;
+        builder->node_capacity = capacity;
+    }
+    if (literal != NULL && expr->literal_count == builder->literal_capacity) {  /* Check if the literal array is full */
+        size_t capacity = builder->literal_capacity > 0 ? builder->literal_capacity * 2 : 8;
+        calc_literal_t* literals = (calc_literal_t*)realloc(expr->literals, capacity * sizeof(calc_literal_t));
+        if (literals == NULL) {
+            builder->code = CALC_ERROR_FAILED_TO_ALLOCATE_MEMORY;
+            return -1;
+        }
+        expr->literals = literals;
+        builder->literal_capacity = capacity;
+    }
+    added = &expr->nodes[expr->node_count];
+    *added = *node;
+    if (literal != NULL) {
+        calc_literal_t* copy = &expr->literals[expr->literal_count];
+        if ((copy->digits = (char*)malloc(length * sizeof(char))) == NULL) {
+            builder->code = CALC_ERROR_FAILED_TO_ALLOCATE_MEMORY;
+            return -1;
+        }
+        memcpy(copy->digits, literal->digits, length);
+        copy->scale = literal->scale;
+        copy->integer = literal->integer;
+        added->a = (int32_t)expr->literal_count++;
+    }
+    expr->has_exact |= added->op > CALC_OP_VAR && added->exact;
+    builder->table[bucket] = (int32_t)expr->node_count++;
+    if (2 * expr->node_count > builder->table_size && !grow_table(builder)) {
+        return -1;
+    }
+    return (int32_t)expr->node_count - 1;
+}
+
+/**
+ * \brief           A function used to hash a node
+ * \param[in]       expr: The derivative being built
+ * \param[in]       node: The node
+ * \param[in]       literal: The literal of a constant, NULL for the other nodes, taken from the expression then
+ * \return          The hash, equal for the nodes merged by \ref find_or_append
+ */
+static uint64_t
+node_hash(const calc_expr_t* expr, const calc_node_t* node, const calc_literal_t* literal) {
+    uint64_t hash = 14695981039346656037ULL;    /* FNV-1a over the fields which make nodes equal */
+    uint64_t fields[4] = {node->op, node->fn, 0, 0};
+    if (node->op == CALC_OP_CONST) {
+        if (literal == NULL) {
+            literal = &expr->literals[node->a];
+        }
+        for (const char* digit = literal->digits; *digit != '\0'; ++digit) {
+            hash = (hash ^ (uint8_t)*digit) * 1099511628211ULL;
+        }
+        fields[2] = (uint64_t)literal->scale;
+    } else {
+        fields[2] = (uint64_t)(uint32_t)node->a << 32 | (uint32_t)node->b;
+        memcpy(&fields[3], &node->value, sizeof(double));
+    }
+    for (size_t i = 0; i < sizeof(fields) / sizeof(fields[0]); ++i) {
+        hash = (hash ^ fields[i]) * 1099511628211ULL;
+        hash ^= hash >> 29;
+    }
+    return hash;
+}
+
+/**
+ * \brief           A function used to double the table of nodes
+ * \param[in]       builder: The state of the differentiation
+ * \return          `1` on success, `0` if the memory has not been allocated
+ */
+static uint8_t
+grow_table(diff_builder_t* builder) {
+    size_t size = builder->table_size * 2;
+    int32_t* table = (int32_t*)malloc(size * sizeof(int32_t));
+    if (table == NULL) {
+        builder->code = CALC_ERROR_FAILED_TO_ALLOCATE_MEMORY;
+        return 0;
+    }
+    memset(table, -1, size * sizeof(int32_t));
+    for (size_t i = 0; i < builder->expr->node_count; ++i) {    /* Every node is distinct, so it only needs an empty bucket */
+        const calc_node_t* node = &builder->expr->nodes[i];
+        size_t bucket = (size_t)node_hash(builder->expr, node, NULL) & (size - 1);
+        while (table[bucket] >= 0) {
+            bucket = (bucket + 1) & (size - 1);
+        }
+        table[bucket] = (int32_t)i;
+    }
+    free(builder->table);
+    builder->table = table;
+    builder->table_size = size;
+    return 1;
+}
+
+/**
+ * \brief           A function used to keep the domain of the expression in its derivative
+ * \param[in]       builder: The state of the differentiation
+ * \param[in]       expr: The differentiated expression
+ * \param[in]       primal: The node of the value of every node of the expression
+ * \param[in]       root: An index of the root of the derivative
+ * \return          An index of the new root, -1 in case of an error
+ * \note            Every call with a restricted domain the root does not use is attached to the root by a \ref CALC_OP_GUARD
+ *                  node, the calls of the expression last first, so that a call used by a guarded one is not guarded twice
+ */
+static int32_t
+guard(diff_builder_t* builder, const calc_expr_t* expr, const int32_t* primal, int32_t root) {
+    size_t capacity = builder->expr->node_count + expr->node_count, top = 0;   /* At most a guard for every node */
+    uint8_t* used = (uint8_t*)calloc(capacity, sizeof(uint8_t));       /* Nodes the root uses */
+    int32_t* stack = (int32_t*)malloc(capacity * sizeof(int32_t));      /* Used nodes whose operands are still to be marked */
+    if (used == NULL || stack == NULL) {
+        builder->code = CALC_ERROR_FAILED_TO_ALLOCATE_MEMORY;
+        root = -1;
+    } else {
+        used[root] = 1;
+        stack[top++] = root;
+    }
+    for (size_t i = expr->node_count; builder->code == CALC_OK && i-- > 0;) {   /* Loop through all nodes, last first */
+        const calc_node_t* node = &expr->nodes[i];
+        while (top > 0) {                       /* Mark the operands of the used nodes, each node once */
+            const calc_node_t* marked = &builder->expr->nodes[stack[--top]];
+            if (marked->op > CALC_OP_VAR && !used[marked->a]) {
+                used[marked->a] = 1;
+                stack[top++] = marked->a;
+            }
+            if (marked->op > CALC_OP_VAR && marked->b >= 0 && !used[marked->b]) {
+                used[marked->b] = 1;
+                stack[top++] = marked->b;
+            }
+        }
+        if (node->op == CALC_OP_CALL && calc_functions[node->fn].domain != CALC_DOMAIN_ALL && !used[primal[i]]) {
+            root = emit(builder, CALC_OP_GUARD, 0, root, primal[i], 0);
+            if (root >= 0) {
+                used[root] = 1;
+                used[primal[i]] = 1;
+                stack[top++] = primal[i];
+            }
+        }
+    }
+    free(used);
+    free(stack);
+    return root;
+}
+
+/**
+ * \brief           A function used to make the derivative of the nodes the root uses
+ * \param[in]       builder: The state of the differentiation, its expression gives up the kept literals
+ * \param[in]       expr: The differentiated expression, whose variables are copied
+ * \param[in]       root: An index of the root of the derivative
+ * \return          The derivative, NULL if the memory has not been allocated
+ * \note            Every operand precedes the node using it, so the root is the last node kept and the order stays postfix
+ */
+static calc_expr_t*
+compact(diff_builder_t* builder, const calc_expr_t* expr, int32_t root) {
+    calc_expr_t* built = builder->expr;
+    calc_expr_t* result = (calc_expr_t*)calloc(1, sizeof(calc_expr_t));
+    int32_t* index = (int32_t*)malloc((size_t)(root + 1) * sizeof(int32_t));  /* The new index of a kept node, -1 for the others */
+    uint8_t ok = result != NULL && index != NULL;
+    size_t count = 0, literals = 0;
+    if (ok) {
+        memset(index, -1, (size_t)(root + 1) * sizeof(int32_t));
+        index[root] = 0;
+        for (int32_t i = root; i >= 0; --i) {   /* Mark the operands of the kept nodes */
+            const calc_node_t* node = &built->nodes[i];
+            if (index[i] >= 0) {
+                ++count;
+                literals += node->op == CALC_OP_CONST;
+                if (node->op > CALC_OP_VAR) {
+                    index[node->a] = 0;
+                    if (node->b >= 0) {
+                        index[node->b] = 0;
+                    }
+                }
+            }
+        }
+        result->nodes = (calc_node_t*)malloc(count * sizeof(calc_node_t));
+        result->literals = (calc_literal_t*)malloc((literals > 0 ? literals : 1) * sizeof(calc_literal_t));
+        result->var_names = (char**)calloc(expr->var_count > 0 ? expr->var_count : 1, sizeof(char*));
+        ok = result->nodes != NULL && result->literals != NULL && result->var_names != NULL;
+    }
+    for (size_t k = 0; ok && k < expr->var_count; ++k) {    /* The variables keep their slots */
+        size_t length = strlen(expr->var_names[k]) + 1;
+        if ((result->var_names[k] = (char*)malloc(length * sizeof(char))) == NULL) {
+            ok = 0;
+            break;
+        }
+        memcpy(result->var_names[k], expr->var_names[k], length);
+        ++result->var_count;
+    }
+    for (int32_t i = 0; ok && i <= root; ++i) {
+        calc_node_t* node;
+        if (index[i] < 0) {
+            continue;
+        }
+        index[i] = (int32_t)result->node_count;
+        node = &result->nodes[result->node_count++];
+        *node = built->nodes[i];
+        if (node->op == CALC_OP_CONST) {        /* The literal moves to the derivative */
+            result->literals[result->literal_count] = built->literals[node->a];
+            built->literals[node->a].digits = NULL;
+            node->a = (int32_t)result->literal_count++;
+        } else if (node->op > CALC_OP_VAR) {
+            node->a = index[node->a];
+            node->b = node->b >= 0 ? index[node->b] : -1;
+            result->has_exact |= node->exact;
+        }
+    }
+    free(index);
+    if (!ok) {
+        builder->code = CALC_ERROR_FAILED_TO_ALLOCATE_MEMORY;
+        calc_free(result);
+        return NULL;
+    }
+    return result;
+}
@@ -0,0 +1,470 @@
+/**
+ * \file            calc_dual.c
+ * \brief           Forward-mode automatic differentiation with dual numbers, a row at a time and over columns
+ */
+
+/*
+ * Copyright (c) 2024 Daniil VERES
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * Author:          Daniil VERES <daniaveres@gmail.com>
+ * Version:         v1.0.0
+ */
+
+                            /* Functions used: */
+#include <math.h>           /* sqrt, log, sin, cos, sinh, cosh, hypot, round, pow, nan */
+#include <stdatomic.h>      /* atomic_load_explicit */
+#include <stdlib.h>         /* malloc, free, aligned_alloc */
+#include "calc_internal.h"
+
+                                        /* Constants used: */
+#define CALC_DUAL_STACK_VALUES 1024     /*!< Values and partials kept on the stack by \ref calc_eval_dual before falling back to the heap */
+#define CALC_DUAL_LANES 4               /*!< Rows held in one vector of the columnar evaluator */
+#define CALC_DUAL_BLOCK 64              /*!< Rows calculated together by the columnar evaluator, a multiple of \ref CALC_DUAL_LANES */
+#define DUAL_VECTORS (CALC_DUAL_BLOCK / CALC_DUAL_LANES)   /*!< Vectors of a column of a block */
+#define DUAL_DIGAMMA_SHIFT 10           /*!< Arguments of the digamma function are raised to at least this before its asymptotic series */
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846     /*!< Pi number */
+#endif /* M_PI */
+#ifndef M_LN10
+#define M_LN10 2.30258509299404568402   /*!< Natural logarithm of 10 */
+#endif /* M_LN10 */
+
+typedef double dual_vector_t __attribute__((vector_size(CALC_DUAL_LANES * sizeof(double))));    /*!< Values of \ref CALC_DUAL_LANES rows */
+typedef int64_t dual_mask_t __attribute__((vector_size(CALC_DUAL_LANES * sizeof(double))));     /*!< A comparison of vectors, -1 in the lanes where it holds */
+
+/**
+ * \brief           A column of a node for a block of rows, its values or its partial derivatives with respect to a variable
+ */
+typedef struct {
+    dual_vector_t v[DUAL_VECTORS];      /*!< The rows, \ref CALC_DUAL_LANES per vector */
+} dual_block_t;
+
+static double dual_digamma(double x);                                           /* A function used to calculate the digamma function */
+static inline double dual_term(double partial, double tangent);                 /* A function used to apply the chain rule to an operand */
+static void dual_node(const calc_expr_t* expr, size_t index, dual_block_t* blocks, size_t stride, const int32_t* tangents,
+                      const double* const* vars, size_t start, size_t count, const calc_function_t* functions,
+                      calc_error_code_t* codes);                                /* A function used to calculate a node and its partials for a block of rows */
+
+/**
+ * \brief           A function used to evaluate an expression and its gradient in forward mode
+ * \param[in]       expr: A compiled expression
+ * \param[in]       vars: Values of the variables indexed by slot, NULL if there are none
+ * \param[out]      gradient: Partial derivatives of the result with respect to the variables indexed by slot, may be NULL
+ * \param[out]      error: An error report, may be NULL
+ * \return          The result, as of \ref calc_eval, NaN in case of an error
+ * \note            Every node carries its value and its partials with respect to all variables, dual numbers with
+ *                  one tangent per variable, so a single pass gives the whole gradient. Values, errors and profile
+ *                  counts are those of \ref calc_eval. A partial is exact up to the rounding of the rules of
+ *                  \ref calc_node_partials; where the derivative does not exist, e.g. `sqrt` at 0 or `abs` at 0,
+ *                  it is infinite, NaN or the one-sided value given by the rule. The gradient is NaN on an error.
+ */
+double
+calc_eval_dual(const calc_expr_t* expr, const double* vars, double* gradient, calc_error_t* error) {
+    double stack_values[CALC_DUAL_STACK_VALUES];    /* Values and partials of the nodes for small expressions */
+    double* values = stack_values;
+    calc_error_code_t code = CALC_OK;
+    double root = nan("");
+    size_t stride = expr != NULL ? expr->var_count + 1 : 1;    /* A value and the partials of a node */
+
+    if (expr == NULL || expr->node_count == 0) {
+        code = CALC_ERROR_UNKNOWN;
+    } else if (expr->var_count > 0 && vars == NULL) {
+        code = CALC_ERROR_INVALID_INPUT;
+    } else if (expr->node_count * stride > CALC_DUAL_STACK_VALUES
+               && (values = (double*)malloc(expr->node_count * stride * sizeof(double))) == NULL) {
+        code = CALC_ERROR_FAILED_TO_ALLOCATE_MEMORY;
+    } else {
+        const calc_function_t* functions = atomic_load_explicit(&calc_dispatch, memory_order_acquire);
+        for (size_t i = 0; code == CALC_OK && i < expr->node_count; ++i) {     /* Loop through all nodes in postfix order */
+            const calc_node_t* node = &expr->nodes[i];
+            double* out = &values[i * stride];
+            if (node->op == CALC_OP_CONST || node->op == CALC_OP_VAR) {
+                out[0] = calc_apply_node(node, 0, 0, vars, functions, &code);
+                for (size_t k = 0; k < expr->var_count; ++k) {
+                    out[k + 1] = node->op == CALC_OP_VAR && (size_t)node->a == k;
+                }
+            } else {
+                const double* x = &values[node->a * stride];
+                const double* y = node->b >= 0 ? &values[node->b * stride] : NULL;
+                double dx, dy = 0;
+                out[0] = calc_apply_node(node, x[0], y != NULL ? y[0] : 0, vars, functions, &code);
+                if (code != CALC_OK) {          /* The rules hold in the domain only, the evaluation stops here */
+                    break;
+                }
+                calc_node_partials(node, x[0], y != NULL ? y[0] : 0, out[0], &dx, &dy);
+                for (size_t k = 1; k < stride; ++k) {
+                    out[k] = dual_term(dx, x[k]) + (y != NULL ? dual_term(dy, y[k]) : 0);
+                }
+            }
+        }
+        if (code == CALC_OK) {
+            root = values[(expr->node_count - 1) * stride] + 0.0;  /* The last node is the root, -0 is printed as 0 */
+        }
+        for (size_t k = 0; code == CALC_OK && gradient != NULL && k < expr->var_count; ++k) {
+            gradient[k] = values[(expr->node_count - 1) * stride + k + 1] + 0.0;
+        }
+        if (values != stack_values) {
+            free(values);
+        }
+    }
+    for (size_t k = 0; code != CALC_OK && expr != NULL && gradient != NULL && k < expr->var_count; ++k) {
+        gradient[k] = nan("");
+    }
+    if (error != NULL) {
+        error->code = code;
+        error->position = 0;
+    }
+    return root;
+}
+
+/**
+ * \brief           A function used to evaluate an expression and its gradient in forward mode for many rows of variables at once
+ * \param[in]       expr: A compiled expression
+ * \param[in]       rows: A number of rows
+ * \param[in]       vars: Columns of the variables indexed by slot, `rows` values each, NULL if there are none
+ * \param[out]      result: The results, `rows` values
+ * \param[out]      gradient: Columns of the partial derivatives indexed by slot, `rows` values each, may be NULL.
+ *                      A partial whose column is NULL is not calculated
+ * \param[out]      error: An error report with the error of the first failed row, may be NULL
+ * \return          A number of rows calculated without an error, the results and the partials of the other rows are NaN
+ * \note            Every row gives the same result and partials as \ref calc_eval_dual. The rows are calculated in blocks
+ *                  of \ref CALC_DUAL_BLOCK, a node at a time: the values of arithmetic operations and the chain rule
+ *                  for every requested partial take \ref CALC_DUAL_LANES rows per instruction, the values of the other
+ *                  operations and their local derivatives are calculated row by row.
+ */
+size_t
+calc_eval_dual_columns(const calc_expr_t* expr, size_t rows, const double* const* vars, double* result,
+                       double* const* gradient, calc_error_t* error) {
+    dual_block_t* blocks = NULL;                /* Values and partials of the nodes for the current block of rows */
+    int32_t* tangents = NULL;                   /* The partial of every variable, -1 if it is not requested */
+    calc_error_code_t code = CALC_OK;           /* The error of the first failed row */
+    size_t succeeded = 0, filled = 0;           /* Rows without an error, rows with results */
+    size_t stride = 1;                          /* Columns of a node, the values and the requested partials */
+
+    for (size_t k = 0; expr != NULL && gradient != NULL && k < expr->var_count; ++k) {
+        stride += gradient[k] != NULL;
+    }
+    if (expr == NULL || expr->node_count == 0 || result == NULL) {
+        code = CALC_ERROR_UNKNOWN;
+    } else if (expr->var_count > 0 && vars == NULL) {
+        code = CALC_ERROR_INVALID_INPUT;
+    } else if (rows > 0 && ((tangents = (int32_t*)malloc((expr->var_count + 1) * sizeof(int32_t))) == NULL
+                            || (blocks = (dual_block_t*)aligned_alloc(_Alignof(dual_block_t),
+                                                                       expr->node_count * stride * sizeof(dual_block_t))) == NULL)) {
+        code = CALC_ERROR_FAILED_TO_ALLOCATE_MEMORY;
+    } else {
+        const calc_function_t* functions = atomic_load_explicit(&calc_dispatch, memory_order_acquire);
+        for (size_t k = 0, t = 0; k < expr->var_count; ++k) {
+            tangents[k] = gradient != NULL && gradient[k] != NULL ? (int32_t)t++ : -1;
+        }
+        for (size_t start = 0; start < rows; start += CALC_DUAL_BLOCK) {       /* Loop through the blocks of rows */
+            size_t count = rows - start < CALC_DUAL_BLOCK ? rows - start : CALC_DUAL_BLOCK;
+            calc_error_code_t codes[CALC_DUAL_BLOCK] = {CALC_OK};              /* Errors of the rows of the block */
+            const dual_block_t* root = &blocks[(expr->node_count - 1) * stride];   /* The last node is the root */
+            for (size_t i = 0; i < expr->node_count; ++i) {                   /* Loop through all nodes in postfix order */
+                dual_node(expr, i, blocks, stride, tangents, vars, start, count, functions, codes);
+            }
+            for (size_t r = 0; r < count; ++r) {
+                uint8_t failed = codes[r] != CALC_OK;
+                if (failed) {
+                    code = code == CALC_OK ? codes[r] : code;
+                } else {
+                    ++succeeded;
+                }
+                result[start + r] = failed ? nan("") : root[0].v[r / CALC_DUAL_LANES][r % CALC_DUAL_LANES] + 0.0;  /* -0 is printed as 0 */
+                for (size_t k = 0; k < expr->var_count; ++k) {
+                    if (tangents[k] >= 0) {
+                        const dual_block_t* partial = &root[tangents[k] + 1];
+                        gradient[k][start + r] = failed ? nan("") : partial->v[r / CALC_DUAL_LANES][r % CALC_DUAL_LANES] + 0.0;
+                    }
+                }
+            }
+            filled += count;
+        }
+    }
+    for (size_t r = filled; result != NULL && r < rows; ++r) {     /* Nothing has been calculated after an error of the arguments */
+        result[r] = nan("");
+        for (size_t k = 0; expr != NULL && gradient != NULL && k < expr->var_count; ++k) {
+            if (gradient[k] != NULL) {
+                gradient[k][r] = nan("");
+            }
+        }
+    }
+    free(blocks);
+    free(tangents);
+    if (error != NULL) {
+        error->code = code;
+        error->position = 0;
+    }
+    return succeeded;
+}
+
+/**
+ * \brief           A function used to calculate the partial derivatives of a node with respect to its operands
+ * \param[in]       node: The node, not a constant or a variable
+ * \param[in]       x: Value of the first operand, in the domain of the node
+ * \param[in]       y: Value of the second operand, in the domain of the node
+ * \param[in]       value: Value of the node, as calculated by \ref calc_apply_node without an error
+ * \param[out]      dx: The partial derivative with respect to the first operand
+ * \param[out]      dy: The partial derivative with respect to the second operand, 0 for unary operations
+ * \note            The rules follow the double functions: `ctan` is `1/tan`, `actan` is `pi/2 - atan`, `fact(x)` is
+ *                  Γ(x + 1) with the derivative Γ(x + 1)·ψ(x + 1), `log` takes the base first, `min` and `max` are
+ *                  differentiated along the operand they return. The rounding functions and `sign` have the derivative 0,
+ *                  `abs` has the derivative `sign(x)`, a remainder is `x - n*y` for the integer quotient `n`.
+ *                  Forward and reverse mode share these rules, so they agree to the rounding of the chain rule.
+ */
+void
+calc_node_partials(const calc_node_t* node, double x, double y, double value, double* dx, double* dy) {
+    double v = value;
+    *dy = 0;
+    switch (node->op) {
+        case CALC_OP_NEG:
+            *dx = -1;
+            return;
+        case CALC_OP_ADD:
+            *dx = 1;
+            *dy = 1;
+            return;
+        case CALC_OP_SUB:
+            *dx = 1;
+            *dy = -1;
+            return;
+        case CALC_OP_MUL:
+            *dx = y;
+            *dy = x;
+            return;
+        case CALC_OP_DIV:
+            *dx = 1 / y;
+            *dy = -v / y;
+            return;
+        case CALC_OP_MOD:
+            *dx = 1;
+            *dy = -round((x - v) / y);          /* The quotient is an integer, rounding removes the error of the division */
+            return;
+        case CALC_OP_POW:
+            *dx = y == 0 ? 0 : y * pow(x, y - 1);
+            *dy = x > 0 ? v * log(x) : x == 0 && y > 0 ? 0 : nan("");
+            return;
+        case CALC_OP_POWI:
+            *dx = node->value == 0 ? 0 : node->value * pow(x, node->value - 1);
+            return;
+        case CALC_OP_CALL:
+            break;
+        case CALC_OP_GUARD:
+            *dx = 1;
+            return;
+        default:
+            *dx = nan("");
+            return;
+    }
+    switch (node->fn) {
+        case CALC_FN_SQRT:   *dx = 0.5 / v;                             break;
+        case CALC_FN_LN:     *dx = 1 / x;                               break;
+        case CALC_FN_EXP:    *dx = v;                                   break;
+        case CALC_FN_SIN:    *dx = cos(x);                              break;
+        case CALC_FN_COS:    *dx = -sin(x);                             break;
+        case CALC_FN_TAN:    *dx = 1 + v * v;                           break;
+        case CALC_FN_CTAN:   *dx = -(1 + v * v);                        break;
+        case CALC_FN_ASIN:   *dx = 1 / sqrt((1 - x) * (1 + x));         break;
+        case CALC_FN_ACOS:   *dx = -1 / sqrt((1 - x) * (1 + x));        break;
+        case CALC_FN_ATAN:   *dx = 1 / (1 + x * x);                     break;
+        case CALC_FN_ACTAN:  *dx = -1 / (1 + x * x);                    break;
+        case CALC_FN_SINH:   *dx = cosh(x);                             break;
+        case CALC_FN_COSH:   *dx = sinh(x);                             break;
+        case CALC_FN_TANH:   *dx = 1 - v * v;                           break;
+        case CALC_FN_CTANH:  *dx = 1 - v * v;                           break;
+        case CALC_FN_ASINH:  *dx = 1 / hypot(x, 1);                     break;
+        case CALC_FN_ACOSH:  *dx = 1 / sqrt((x - 1) * (x + 1));         break;
+        case CALC_FN_ATANH:  *dx = 1 / ((1 - x) * (1 + x));             break;
+        case CALC_FN_ACTANH: *dx = 1 / ((1 - x) * (1 + x));             break;
+        case CALC_FN_FABS:   *dx = x > 0 ? 1 : x < 0 ? -1 : 0;          break;
+        case CALC_FN_RAD:    *dx = M_PI / 180;                          break;
+        case CALC_FN_DEG:    *dx = 180 / M_PI;                          break;
+        case CALC_FN_FACT:   *dx = v * dual_digamma(x + 1);             break;
+        case CALC_FN_LOG:                                               /* log(x, y) = ln(y) / ln(x), the base is the first argument */
+            *dx = -v / (x * log(x));
+            *dy = 1 / (y * log(x));
+            break;
+        case CALC_FN_LOG10:  *dx = 1 / (x * M_LN10);                    break;
+        case CALC_FN_MIN:                                               /* The same comparison as the double function */
+            *dx = y < x ? 0 : 1;
+            *dy = y < x ? 1 : 0;
+            break;
+        case CALC_FN_MAX:
+            *dx = y > x ? 0 : 1;
+            *dy = y > x ? 1 : 0;
+            break;
+        default:                                                        /* Rounding functions and the sign are piecewise constant */
+            *dx = 0;
+            break;
+    }
+}
+
+/**
+ * \brief           A function used to calculate the digamma function, the derivative of the logarithm of the gamma function
+ * \param[in]       x: The argument, at least 1
+ * \return          ψ(x) with about 15 significant digits
+ * \note            The argument is raised to at least \ref DUAL_DIGAMMA_SHIFT by the recurrence ψ(x) = ψ(x + 1) - 1/x,
+ *                  then the asymptotic series is summed up to the term of x^-14
+ */
+static double
+dual_digamma(double x) {
+    double result = 0, inverse, square;
+    while (x < DUAL_DIGAMMA_SHIFT) {
+        result -= 1 / x;
+        x += 1;
+    }
+    inverse = 1 / x;
+    square = inverse * inverse;
+    return result + log(x) - 0.5 * inverse
+           - square * (1.0 / 12 - square * (1.0 / 120 - square * (1.0 / 252 - square * (1.0 / 240 - square * (1.0 / 132
+           - square * (691.0 / 32760 - square / 12))))));
+}
+
+/**
+ * \brief           A function used to apply the chain rule to an operand
+ * \param[in]       partial: The partial derivative of a node with respect to the operand
+ * \param[in]       tangent: The partial derivative of the operand with respect to a variable
+ * \return          The product, 0 if either factor is 0
+ * \note            An infinite or undefined partial, as of `sqrt` at 0, does not spread to the variables the operand
+ *                  does not depend on. The reverse mode takes 0 times anything as 0 too, so both modes agree.
+ */
+static inline double
+dual_term(double partial, double tangent) {
+    return partial == 0 || tangent == 0 ? 0 : partial * tangent;
+}
+
+/**
+ * \brief           A function used to calculate a node and its partials for a block of rows
+ * \param[in]       expr: A compiled expression
+ * \param[in]       index: An index of the node
+ * \param[in,out]   blocks: Columns of all nodes for the block, `stride` per node, the columns of the node are written
+ * \param[in]       stride: Columns of a node, the values and then the requested partials
+ * \param[in]       tangents: The column of the partial of every variable, -1 if it is not requested
+ * \param[in]       vars: Columns of the variables
+ * \param[in]       start: The first row of the block
+ * \param[in]       count: A number of rows in the block, the variables of the rest of the block are 0
+ * \param[in]       functions: The registry to dispatch calls through
+ * \param[in,out]   codes: Errors of the rows, only the first error of a row is kept
+ */
+static void
+dual_node(const calc_expr_t* expr, size_t index, dual_block_t* blocks, size_t stride, const int32_t* tangents,
+          const double* const* vars, size_t start, size_t count, const calc_function_t* functions, calc_error_code_t* codes) {
+    const calc_node_t* node = &expr->nodes[index];
+    dual_block_t* out = &blocks[index * stride];
+    const dual_block_t* x = node->op > CALC_OP_VAR ? &blocks[node->a * stride] : NULL;
+    const dual_block_t* y = node->op > CALC_OP_VAR && node->b >= 0 ? &blocks[node->b * stride] : NULL;
+    dual_block_t dx, dy;                        /* Partials of the node with respect to its operands */
+
+    switch (node->op) {
+        case CALC_OP_CONST:
+        case CALC_OP_VAR:
+            if (node->op == CALC_OP_CONST) {
+                for (size_t v = 0; v < DUAL_VECTORS; ++v) {
+                    out[0].v[v] = (dual_vector_t){0} + node->value;
+                }
+            } else {
+                const double* column = vars[node->a] + start;
+                for (size_t r = 0; r < CALC_DUAL_BLOCK; ++r) {
+                    out[0].v[r / CALC_DUAL_LANES][r % CALC_DUAL_LANES] = r < count ? column[r] : 0;
+                }
+            }
+            for (size_t t = 1; t < stride; ++t) {
+                double seed = node->op == CALC_OP_VAR && tangents[node->a] + 1 == (int32_t)t;
+                for (size_t v = 0; v < DUAL_VECTORS; ++v) {
+                    out[t].v[v] = (dual_vector_t){0} + seed;
+                }
+            }
+            return;
+        case CALC_OP_NEG:
+            for (size_t v = 0; v < DUAL_VECTORS; ++v) {
+                out[0].v[v] = -x[0].v[v];
+            }
+            for (size_t t = 1; t < stride; ++t) {
+                for (size_t v = 0; v < DUAL_VECTORS; ++v) {
+                    out[t].v[v] = -x[t].v[v];
+                }
+            }
+            return;
+        case CALC_OP_ADD:
+        case CALC_OP_SUB:
+            for (size_t t = 0; t < stride; ++t) {   /* The values and the partials alike */
+                for (size_t v = 0; v < DUAL_VECTORS; ++v) {
+                    out[t].v[v] = node->op == CALC_OP_ADD ? x[t].v[v] + y[t].v[v] : x[t].v[v] - y[t].v[v];
+                }
+            }
+            return;
+        case CALC_OP_MUL:
+            for (size_t v = 0; v < DUAL_VECTORS; ++v) {
+                dx.v[v] = y[0].v[v];
+                dy.v[v] = x[0].v[v];
+                out[0].v[v] = x[0].v[v] * y[0].v[v];
+            }
+            break;
+        case CALC_OP_DIV:
+            for (size_t v = 0; v < DUAL_VECTORS; ++v) {
+                out[0].v[v] = x[0].v[v] / y[0].v[v];
+                dx.v[v] = 1 / y[0].v[v];
+                dy.v[v] = -out[0].v[v] / y[0].v[v];
+            }
+            break;
+        case CALC_OP_POWI:
+            if (node->value == 2) {             /* Squares, the most frequent power, the same product as the double evaluation */
+                for (size_t v = 0; v < DUAL_VECTORS; ++v) {
+                    out[0].v[v] = x[0].v[v] * x[0].v[v];
+                    dx.v[v] = 2 * x[0].v[v];
+                }
+                break;
+            }
+            /* fallthrough */
+        default:                                /* Powers, remainders and calls, row by row */
+            for (size_t r = 0; r < CALC_DUAL_BLOCK; ++r) {
+                calc_error_code_t code = CALC_OK;
+                double a = x[0].v[r / CALC_DUAL_LANES][r % CALC_DUAL_LANES];
+                double b = y != NULL ? y[0].v[r / CALC_DUAL_LANES][r % CALC_DUAL_LANES] : 0;
+                double value = 0, da = 0, db = 0;
+                if (r < count) {                /* The rest of the block is not calculated, so it is not profiled */
+                    value = calc_apply_node(node, a, b, NULL, functions, &code);
+                    if (code == CALC_OK) {      /* The rules hold in the domain only, a failed row is NaN anyway */
+                        calc_node_partials(node, a, b, value, &da, &db);
+                    } else if (codes[r] == CALC_OK) {
+                        codes[r] = code;
+                    }
+                }
+                out[0].v[r / CALC_DUAL_LANES][r % CALC_DUAL_LANES] = value;
+                dx.v[r / CALC_DUAL_LANES][r % CALC_DUAL_LANES] = da;
+                dy.v[r / CALC_DUAL_LANES][r % CALC_DUAL_LANES] = db;
+            }
+            break;
+    }
+    for (size_t t = 1; t < stride; ++t) {       /* The chain rule for every requested partial, as \ref dual_term */
+        for (size_t v = 0; v < DUAL_VECTORS; ++v) {
+            dual_vector_t tangent = (dual_vector_t)((dual_mask_t)(dx.v[v] * x[t].v[v]) & (dx.v[v] != 0) & (x[t].v[v] != 0));
+            if (y != NULL) {
+                tangent += (dual_vector_t)((dual_mask_t)(dy.v[v] * y[t].v[v]) & (dy.v[v] != 0) & (y[t].v[v] != 0));
+            }
+            out[t].v[v] = tangent;
+        }
+    }
+}
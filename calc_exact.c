@@ -0,0 +1,350 @@
+/**
+ * \file            calc_exact.c
+ * \brief           Exact evaluation of integer operations with native 64-bit and 128-bit integers
+ */
+
+/*
+ * Copyright (c) 2024 Daniil VERES
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * Author:          Daniil VERES <daniaveres@gmail.com>
+ * Version:         v1.0.0
+ */
+
+#include <math.h>           /* copysign, fabs, trunc */
+#include <stdatomic.h>      /* atomic_load_explicit */
+#include <stdio.h>          /* snprintf */
+#include <stdlib.h>         /* malloc, free */
+#include "calc_internal.h"
+
+                                        /* Constants used: */
+#define CALC_EXACT_STACK_NODES 128      /*!< Number of node values kept on the stack by \ref calc_eval_exact before falling back to the heap */
+
+#ifdef __SIZEOF_INT128__
+#define CALC_FACT_EXACT_MAX 33          /*!< The largest integer whose factorial fits into \ref calc_int_t */
+#else
+#define CALC_FACT_EXACT_MAX 20          /*!< The largest integer whose factorial fits into \ref calc_int_t */
+#endif /* __SIZEOF_INT128__ */
+
+/**
+ * \brief           Factorials of 0 to 20, the largest one fitting into 64 bits
+ */
+static const int64_t fact_table[21] = {
+    1, 1, 2, 6, 24, 120, 720, 5040, 40320, 362880, 3628800, 39916800, 479001600, 6227020800, 87178291200,
+    1307674368000, 20922789888000, 355687428096000, 6402373705728000, 121645100408832000, 2432902008176640000,
+};
+
+/**
+ * \brief           A value of a node, an exact integer or a double
+ */
+typedef struct {
+    calc_int_t integer;         /*!< The exact value, valid when \ref is_integer is set */
+    double value;               /*!< The value, the nearest double for an integer */
+    uint8_t is_integer;         /*!< Set to `1` when the value is the exact integer */
+} exact_value_t;
+
+/**
+ * \brief           Generates an overflow-checked operation on exact integers
+ * \note            Operands fitting into 64 bits take a native 64-bit operation, only the rest take the 128-bit one
+ */
+#define EXACT_OPERATION(name, builtin)                                                      \
+    static uint8_t                                                                          \
+    name(calc_int_t x, calc_int_t y, calc_int_t* result) {                                  \
+        int64_t narrow;                                                                     \
+        if (x == (int64_t)x && y == (int64_t)y && !builtin((int64_t)x, (int64_t)y, &narrow)) { \
+            *result = narrow;                                                               \
+            return 1;                                                                       \
+        }                                                                                   \
+        return !builtin(x, y, result);                                                      \
+    }
+
+EXACT_OPERATION(exact_add, __builtin_add_overflow)
+EXACT_OPERATION(exact_sub, __builtin_sub_overflow)
+EXACT_OPERATION(exact_mul, __builtin_mul_overflow)
+
+static uint8_t exact_pow(calc_int_t base, calc_int_t exponent, calc_int_t* result);    /* A function used to raise an integer to a non-negative integer power */
+static uint8_t apply_exact(const calc_node_t* node, const exact_value_t* x, const exact_value_t* y, calc_int_t* result, calc_error_code_t* code);  /* A function used to calculate an operation on exact integers */
+
+/**
+ * \brief           A function used to check if a math function keeps integer arguments exact
+ * \param[in]       fn: The function
+ * \return          1 if an integer result of integer arguments can be calculated exactly, 0 otherwise
+ */
+uint8_t
+calc_exact_function(calc_function_id_t fn) {
+    switch (fn) {
+        case CALC_FN_FABS:
+        case CALC_FN_CEIL:
+        case CALC_FN_FLOOR:
+        case CALC_FN_ROUND:
+        case CALC_FN_TRUNC:
+        case CALC_FN_SIGN:
+        case CALC_FN_FACT:
+        case CALC_FN_MIN:
+        case CALC_FN_MAX:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+/**
+ * \brief           A function used to evaluate an expression keeping integer operations exact
+ * \param[in]       context: An evaluation context, or NULL to evaluate without one
+ * \param[in]       expr: A compiled expression
+ * \param[in]       vars: Values of the variables, NULL if the expression has none
+ * \param[out]      result: The result, may be NULL
+ * \param[out]      error: An error report, may be NULL
+ * \return          The result as a double, NaN in case of an error
+ * \note            Integer literals, integral variables and the operations on them which give integers (+, -, *, %, a division
+ *                  without a remainder, a non-negative integer power, fabs, ceil, floor, round, trunc, sign, fact, min and max)
+ *                  are calculated with native 64-bit or 128-bit integers. An operation which would overflow, or give a fraction,
+ *                  is calculated in double precision from there on. Expressions without exact operations are evaluated by
+ *                  \ref calc_eval_ctx. Calls calculated exactly are not counted by the function profile.
+ */
+double
+calc_eval_exact(calc_context_t* context, const calc_expr_t* expr, const double* vars, calc_result_t* result, calc_error_t* error) {
+    exact_value_t stack_values[CALC_EXACT_STACK_NODES]; /* Values of the nodes for small expressions */
+    exact_value_t* values = stack_values;
+    calc_error_code_t code = CALC_OK;
+    calc_result_t root = {nan(""), 0, 0, 0};
+
+    if (expr == NULL || expr->node_count == 0) {
+        code = CALC_ERROR_UNKNOWN;
+    } else if (expr->var_count > 0 && vars == NULL) {
+        code = CALC_ERROR_INVALID_INPUT;
+    } else if (!expr->has_exact) {              /* Nothing to keep exact */
+        calc_error_t inner;
+        root.value = context != NULL ? calc_eval_ctx(context, expr, vars, &inner) : calc_eval(expr, vars, &inner);
+        code = inner.code;
+    } else if (expr->node_count > CALC_EXACT_STACK_NODES
+               && (values = (exact_value_t*)malloc(expr->node_count * sizeof(exact_value_t))) == NULL) {
+        code = CALC_ERROR_FAILED_TO_ALLOCATE_MEMORY;
+    } else {
+        const calc_function_t* functions = atomic_load_explicit(&calc_dispatch, memory_order_acquire);
+        for (size_t i = 0; code == CALC_OK && i < expr->node_count; ++i) {     /* Loop through all nodes in postfix order */
+            const calc_node_t* node = &expr->nodes[i];
+            const exact_value_t* x = node->op > CALC_OP_VAR ? &values[node->a] : NULL;
+            const exact_value_t* y = node->op > CALC_OP_VAR && node->b >= 0 ? &values[node->b] : NULL;
+            exact_value_t* value = &values[i];
+            value->is_integer = 0;
+            if (!node->exact) {                 /* Not an integer operation */
+            } else if (node->op == CALC_OP_CONST) {
+                value->integer = expr->literals[node->a].integer;
+                value->value = node->value;     /* Already rounded by the compiler */
+                value->is_integer = 1;
+                continue;
+            } else if (node->op == CALC_OP_VAR) {
+                double var = vars[node->a];
+                if (var == trunc(var) && fabs(var) < 0x1p63) {  /* An integral double converts exactly */
+                    value->integer = (int64_t)var;
+                    value->is_integer = 1;
+                }
+            } else if (x->is_integer && (y == NULL || y->is_integer || node->op == CALC_OP_GUARD)) {
+                value->is_integer = apply_exact(node, x, y, &value->integer, &code);
+            }
+            if (value->is_integer && value->integer != 0) {
+                value->value = value->integer == (int64_t)value->integer ? (double)(int64_t)value->integer : (double)value->integer;
+            } else if (value->is_integer) {     /* An exact zero takes only its sign from double precision, e.g. for 1/(-0) */
+                calc_error_code_t rounded_code = CALC_OK;   /* The rounded operands may differ from the exact ones */
+                value->value = copysign(0.0, calc_apply_node(node, x != NULL ? x->value : 0, y != NULL ? y->value : 0,
+                                                             vars, functions, &rounded_code));
+            } else if (code == CALC_OK) {
+                value->value = calc_apply_node(node, x != NULL ? x->value : 0, y != NULL ? y->value : 0, vars, functions, &code);
+            }
+        }
+        if (code == CALC_OK) {
+            const exact_value_t* value = &values[expr->node_count - 1];     /* The last node is the root */
+            root.value = value->value;
+            root.is_integer = value->is_integer;
+            if (value->is_integer) {
+#ifdef __SIZEOF_INT128__
+                root.high = (int64_t)(value->integer >> 64);
+#else
+                root.high = value->integer < 0 ? -1 : 0;
+#endif /* __SIZEOF_INT128__ */
+                root.low = (uint64_t)value->integer;
+            }
+        }
+        if (values != stack_values) {
+            free(values);
+        }
+    }
+    if (code != CALC_OK) {
+        root.value = nan("");
+        root.is_integer = 0;
+    }
+    if (result != NULL) {
+        *result = root;
+    }
+    if (error != NULL) {
+        error->code = code;
+        error->position = 0;
+    }
+    return root.value;
+}
+
+/**
+ * \brief           A function used to format a result of an exact evaluation
+ * \param[in]       result: The result
+ * \param[out]      buffer: A buffer for the text
+ * \param[in]       size: Size of the buffer
+ * \return          Length of the text, as returned by snprintf
+ * \note            An integer result is printed with all of its digits, any other result as by \ref calc_format
+ */
+int
+calc_format_result(const calc_result_t* result, char* buffer, size_t size) {
+    char digits[48];                            /* Digits in reverse order, 2^127 has 39 of them */
+    size_t count = 0;
+    calc_uint_t magnitude;
+    if (!result->is_integer) {
+        return calc_format(result->value, buffer, size);
+    }
+#ifdef __SIZEOF_INT128__
+    magnitude = ((calc_uint_t)(uint64_t)result->high << 64) | result->low;
+#else
+    magnitude = result->low;
+#endif /* __SIZEOF_INT128__ */
+    if (result->high < 0) {
+        magnitude = -magnitude;                 /* Unsigned negation is well defined for the smallest value too */
+    }
+    do {
+        digits[count++] = (char)('0' + (int)(magnitude % 10));
+        magnitude /= 10;
+    } while (magnitude > 0);
+    for (size_t i = 0; i < count / 2; ++i) {
+        char digit = digits[i];
+        digits[i] = digits[count - 1 - i];
+        digits[count - 1 - i] = digit;
+    }
+    return snprintf(buffer, size, "%s%.*s", result->high < 0 ? "-" : "", (int)count, digits);
+}
+
+/**
+ * \brief           A function used to raise an integer to a non-negative integer power
+ * \param[in]       base: The base
+ * \param[in]       exponent: The exponent
+ * \param[out]      result: The power
+ * \return          1 on success, 0 if the exponent is negative or the power overflows
+ */
+static uint8_t
+exact_pow(calc_int_t base, calc_int_t exponent, calc_int_t* result) {
+    calc_int_t power = 1;
+    if (exponent < 0) {
+        return 0;
+    } else if (base == 0 || base == 1) {
+        *result = exponent == 0 ? 1 : base;
+        return 1;
+    } else if (base == -1) {
+        *result = exponent % 2 ? -1 : 1;
+        return 1;
+    }
+    for (;;) {                                  /* Square and multiply, any base above 1 overflows within 127 squarings */
+        if ((exponent & 1) && !exact_mul(power, base, &power)) {
+            return 0;
+        }
+        exponent >>= 1;
+        if (exponent == 0) {
+            break;
+        } else if (!exact_mul(base, base, &base)) {
+            return 0;
+        }
+    }
+    *result = power;
+    return 1;
+}
+
+/**
+ * \brief           A function used to calculate an operation on exact integers
+ * \param[in]       node: The node of the operation
+ * \param[in]       x: The first operand, an integer
+ * \param[in]       y: The second operand, an integer, NULL for unary operations
+ * \param[out]      result: The exact result
+ * \param[out]      code: Set to an error code if the arguments are out of the domain of a math function
+ * \return          1 if the result is an exact integer, 0 if the operation has to be calculated in double precision
+ */
+static uint8_t
+apply_exact(const calc_node_t* node, const exact_value_t* x, const exact_value_t* y, calc_int_t* result, calc_error_code_t* code) {
+    switch (node->op) {
+        case CALC_OP_NEG:
+            return exact_sub(0, x->integer, result);
+        case CALC_OP_ADD:
+            return exact_add(x->integer, y->integer, result);
+        case CALC_OP_SUB:
+            return exact_sub(x->integer, y->integer, result);
+        case CALC_OP_MUL:
+            return exact_mul(x->integer, y->integer, result);
+        case CALC_OP_DIV:
+            if (y->integer == 0 || (y->integer == -1 && !exact_sub(0, x->integer, result)) || x->integer % y->integer != 0) {
+                return 0;                       /* Infinity, NaN, an overflow or a fraction */
+            }
+            *result = x->integer / y->integer;
+            return 1;
+        case CALC_OP_MOD:
+            if (y->integer == 0) {
+                return 0;                       /* NaN */
+            }
+            *result = y->integer == -1 ? 0 : x->integer % y->integer;  /* The sign follows the dividend, like fmod */
+            return 1;
+        case CALC_OP_POW:
+            return exact_pow(x->integer, y->integer, result);
+        case CALC_OP_POWI:
+            return exact_pow(x->integer, (calc_int_t)node->value, result);
+        case CALC_OP_GUARD:
+            *result = x->integer;
+            return 1;
+        case CALC_OP_CALL: {
+            double args[2] = {x->value, y != NULL ? y->value : 0};
+            if (!calc_domain_contains(calc_functions[node->fn].domain, args)) {
+                *code = CALC_ERROR_UNDEFINED_FUNCTION;
+                return 0;
+            }
+            switch (node->fn) {
+                case CALC_FN_FABS:
+                    return x->integer >= 0 ? (*result = x->integer, 1) : exact_sub(0, x->integer, result);
+                case CALC_FN_SIGN:
+                    *result = (x->integer > 0) - (x->integer < 0);
+                    return 1;
+                case CALC_FN_FACT:
+                    if (x->integer > CALC_FACT_EXACT_MAX) {
+                        return 0;               /* A double approximation */
+                    }
+                    *result = fact_table[x->integer < 20 ? x->integer : 20];
+                    for (calc_int_t i = 21; i <= x->integer; ++i) {
+                        *result *= i;           /* Only with 128-bit integers */
+                    }
+                    return 1;
+                case CALC_FN_MIN:
+                    *result = x->integer < y->integer ? x->integer : y->integer;
+                    return 1;
+                case CALC_FN_MAX:
+                    *result = x->integer > y->integer ? x->integer : y->integer;
+                    return 1;
+                default:                        /* Rounding an integer keeps it */
+                    *result = x->integer;
+                    return 1;
+            }
+        }
+        default:
+            return 0;
+    }
+}
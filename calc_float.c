@@ -0,0 +1,855 @@
+/**
+ * \file            calc_float.c
+ * \brief           Evaluation in single precision over columns of rows, with vector kernels of the math functions
+ */
+
+/*
+ * Copyright (c) 2024 Daniil VERES
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * Author:          Daniil VERES <daniaveres@gmail.com>
+ * Version:         v1.0.0
+ */
+
+                            /* Functions used: */
+#include <float.h>          /* FLT_MIN */
+#include <math.h>           /* sin, cos, fmodf, nanf, INFINITY */
+#include <stdlib.h>         /* aligned_alloc, free */
+#include "calc_internal.h"
+
+                                        /* Constants used: */
+#define CALC_FLOAT_LANES 4              /*!< Rows held in one vector, twice the doubles of a vector of the same width */
+#define CALC_FLOAT_BLOCK 64             /*!< Rows calculated together, a multiple of \ref CALC_FLOAT_LANES */
+#define FLOAT_VECTORS (CALC_FLOAT_BLOCK / CALC_FLOAT_LANES)     /*!< Vectors of a column of a block */
+#define FLOAT_POWI_MAX 64               /*!< The largest absolute integer exponent raised by squaring, like the double evaluation */
+#define FLOAT_EXP_MAX 88.72283905f      /*!< The largest argument whose exponential is a finite float */
+#define FLOAT_EXP_MIN -103.97208f       /*!< The smallest argument whose exponential is not rounded to zero */
+#define FLOAT_REDUCE_MAX 65536.0f       /*!< The largest argument of the sine and the cosine reduced in vectors */
+#define FLOAT_INTEGRAL 8388608.0f       /*!< 2^23, floats at least as large are integers */
+#define FLOAT_HUGE 1e18f                /*!< Arguments above which the hyperbolic arc functions do not square their argument */
+#define FLOAT_FACT_MAX 35.0f            /*!< The smallest argument whose factorial overflows a float */
+#define FLOAT_PI 3.14159265358979323846f        /*!< Pi number */
+#define FLOAT_PI_2 1.57079632679489661923f      /*!< Pi divided by 2 */
+#define FLOAT_PI_4 0.78539816339744830962f      /*!< Pi divided by 4 */
+#define FLOAT_LN2 0.69314718055994530942f       /*!< Natural logarithm of 2 */
+#define FLOAT_LN2_WIDE 0.69314718055994530942   /*!< Natural logarithm of 2 for the double lanes */
+#define FLOAT_LOG10_E 0.43429448190325182765f   /*!< Decimal logarithm of e */
+
+typedef float float_vector_t __attribute__((vector_size(CALC_FLOAT_LANES * sizeof(float))));    /*!< Values of \ref CALC_FLOAT_LANES rows */
+typedef int32_t float_mask_t __attribute__((vector_size(CALC_FLOAT_LANES * sizeof(float))));    /*!< A comparison of vectors, -1 in the lanes where it holds */
+typedef double float_wide_t __attribute__((vector_size(CALC_FLOAT_LANES * sizeof(double))));    /*!< The rows of a vector widened to doubles */
+typedef int64_t float_wide_mask_t __attribute__((vector_size(CALC_FLOAT_LANES * sizeof(double))));  /*!< A comparison of widened vectors */
+
+/**
+ * \brief           Values of a node for a block of rows
+ */
+typedef struct {
+    float_vector_t v[FLOAT_VECTORS];    /*!< The rows, \ref CALC_FLOAT_LANES per vector */
+} float_block_t;
+
+/**
+ * \brief           Coefficients of the numerator of Γ(2 + f) for 0 <= f < 1, the highest power first
+ */
+static const double float_gamma_p[] = {
+    1.60119522476751861407e-4, 1.19135147006586384913e-3, 1.04213797561761569935e-2, 4.76367800457137231464e-2,
+    2.07448227648435975150e-1, 4.94214826801497100753e-1, 9.99999999999999996796e-1,
+};
+
+/**
+ * \brief           Coefficients of the denominator of Γ(2 + f) for 0 <= f < 1, the highest power first
+ */
+static const double float_gamma_q[] = {
+    -2.31581873324120129819e-5, 5.39605580493303397842e-4, -4.45641913851797240494e-3, 1.18139785222060435552e-2,
+    3.58236398605498653373e-2, -2.34591795718243348568e-1, 7.14304917030273074085e-2, 1.00000000000000000320e0,
+};
+
+static float_vector_t float_select(float_mask_t mask, float_vector_t x, float_vector_t y);  /* A function used to pick lanes of two vectors */
+static float_vector_t float_abs(float_vector_t x);                              /* A function used to calculate absolute values */
+static float_vector_t float_copysign(float_vector_t x, float_vector_t sign);   /* A function used to copy signs */
+static uint8_t float_any(float_mask_t mask);                                    /* A function used to check if a comparison holds in any lane */
+static float_vector_t float_trunc(float_vector_t x);                            /* A function used to truncate values */
+static float_vector_t float_floor(float_vector_t x);                            /* A function used to calculate floors */
+static float_vector_t float_ceil(float_vector_t x);                             /* A function used to calculate ceilings */
+static float_vector_t float_round(float_vector_t x);                            /* A function used to round values */
+static float_vector_t float_sqrt(float_vector_t x);                             /* A function used to calculate square roots */
+static float_vector_t float_exp_reduced(float_vector_t r, float_mask_t k);     /* A function used to calculate exponentials of reduced arguments */
+static float_vector_t float_exp(float_vector_t x);                              /* A function used to calculate exponentials */
+static float_vector_t float_half_exp(float_vector_t x);                         /* A function used to calculate halves of exponentials */
+static float_vector_t float_log_parts(float_vector_t x, float_vector_t* m, float_vector_t* e);  /* A function used to split arguments for their logarithms */
+static float_vector_t float_log(float_vector_t x);                              /* A function used to calculate natural logarithms */
+static float_vector_t float_log1p(float_vector_t x);                            /* A function used to calculate logarithms of 1 + x */
+static void float_sincos(float_vector_t x, float_vector_t* s, float_vector_t* c);  /* A function used to calculate sines and cosines */
+static float_vector_t float_atan(float_vector_t x);                             /* A function used to calculate arc tangents */
+static float_vector_t float_asin_poly(float_vector_t x, float_vector_t z);     /* A function used to calculate arc sines of small values */
+static float_vector_t float_asin(float_vector_t x);                             /* A function used to calculate arc sines */
+static float_vector_t float_acos(float_vector_t x);                             /* A function used to calculate arc cosines */
+static float_vector_t float_tanh(float_vector_t x);                             /* A function used to calculate hyperbolic tangents */
+static float_vector_t float_fact(float_vector_t x);                             /* A function used to calculate factorials */
+static float_vector_t float_powi(float_vector_t x, float_mask_t n);             /* A function used to raise values to integer powers */
+static float_vector_t float_pow(float_vector_t x, float_vector_t y);           /* A function used to raise values to powers */
+static float_mask_t float_domain(calc_domain_t domain, float_vector_t x, float_vector_t y);    /* A function used to check arguments against a domain */
+static float_vector_t float_call(calc_function_id_t fn, float_vector_t x, float_vector_t y, float_mask_t* inside);  /* A function used to calculate a math function */
+static void float_node(const calc_expr_t* expr, size_t index, float_block_t* blocks, const float* const* vars,
+                       size_t start, size_t count, float_mask_t* failed);       /* A function used to calculate a node for a block of rows */
+
+/**
+ * \brief           A function used to evaluate an expression in single precision for many rows of variables at once
+ * \param[in]       expr: A compiled expression
+ * \param[in]       rows: A number of rows
+ * \param[in]       vars: Columns of the variables indexed by slot, `rows` values each, NULL if there are none
+ * \param[out]      result: The results, `rows` values
+ * \param[out]      error: An error report with the error of the first failed row, may be NULL
+ * \return          A number of rows calculated without an error, the results of the other rows are NaN
+ * \note            The rows are calculated in blocks of \ref CALC_FLOAT_BLOCK, a node at a time, \ref CALC_FLOAT_LANES rows
+ *                  per instruction, math functions included. Arithmetic and square roots are correctly rounded floats;
+ *                  the other functions are polynomial approximations within a few units in the last place of the
+ *                  float nearest to the double result, powers with a non-integer exponent lose about one more unit
+ *                  for every unit of |y·ln x|. Integer powers and factorials are calculated in double lanes and are
+ *                  correctly rounded but for rare double rounding. A row fails with \ref CALC_ERROR_UNDEFINED_FUNCTION
+ *                  when a call leaves the domain of its function, as checked on the float arguments. Calls are not
+ *                  counted by the function profile.
+ */
+size_t
+calc_eval_float_columns(const calc_expr_t* expr, size_t rows, const float* const* vars, float* result, calc_error_t* error) {
+    float_block_t* blocks = NULL;               /* Values of the nodes for the current block of rows */
+    calc_error_code_t code = CALC_OK;           /* The error of the first failed row */
+    size_t succeeded = 0, filled = 0;           /* Rows without an error, rows with results */
+
+    if (expr == NULL || expr->node_count == 0 || result == NULL) {
+        code = CALC_ERROR_UNKNOWN;
+    } else if (expr->var_count > 0 && vars == NULL) {
+        code = CALC_ERROR_INVALID_INPUT;
+    } else if (rows > 0 && (blocks = (float_block_t*)aligned_alloc(_Alignof(float_block_t),
+                                                                    expr->node_count * sizeof(float_block_t))) == NULL) {
+        code = CALC_ERROR_FAILED_TO_ALLOCATE_MEMORY;
+    } else {
+        for (size_t start = 0; start < rows; start += CALC_FLOAT_BLOCK) {  /* Loop through the blocks of rows */
+            size_t count = rows - start < CALC_FLOAT_BLOCK ? rows - start : CALC_FLOAT_BLOCK;
+            float_mask_t failed[FLOAT_VECTORS] = {{0}};                     /* Rows of the block which left a domain */
+            const float_block_t* root = &blocks[expr->node_count - 1];     /* The last node is the root */
+            for (size_t i = 0; i < expr->node_count; ++i) {                /* Loop through all nodes in postfix order */
+                float_node(expr, i, blocks, vars, start, count, failed);
+            }
+            for (size_t r = 0; r < count; ++r) {
+                if (failed[r / CALC_FLOAT_LANES][r % CALC_FLOAT_LANES]) {
+                    result[start + r] = nanf("");
+                    code = code == CALC_OK ? CALC_ERROR_UNDEFINED_FUNCTION : code;
+                } else {
+                    result[start + r] = root->v[r / CALC_FLOAT_LANES][r % CALC_FLOAT_LANES] + 0.0f;    /* -0 is printed as 0 */
+                    ++succeeded;
+                }
+            }
+            filled += count;
+        }
+        free(blocks);
+    }
+    for (size_t r = filled; result != NULL && r < rows; ++r) {  /* Nothing has been calculated after an error of the arguments */
+        result[r] = nanf("");
+    }
+    if (error != NULL) {
+        error->code = code;
+        error->position = 0;
+    }
+    return succeeded;
+}
+
+/**
+ * \brief           A function used to pick lanes of two vectors
+ * \param[in]       mask: A comparison, -1 in the lanes taken from `x`
+ * \param[in]       x: Values of the lanes where the mask is set
+ * \param[in]       y: Values of the other lanes
+ * \return          The picked lanes
+ */
+static inline float_vector_t
+float_select(float_mask_t mask, float_vector_t x, float_vector_t y) {
+    return (float_vector_t)((mask & (float_mask_t)x) | (~mask & (float_mask_t)y));
+}
+
+/**
+ * \brief           A function used to calculate absolute values
+ * \param[in]       x: Arguments
+ * \return          The absolute values
+ */
+static inline float_vector_t
+float_abs(float_vector_t x) {
+    return (float_vector_t)((float_mask_t)x & INT32_MAX);
+}
+
+/**
+ * \brief           A function used to give values the signs of other values
+ * \param[in]       x: Values
+ * \param[in]       sign: Values of the signs
+ * \return          |x| with the sign of `sign`, lane by lane
+ */
+static inline float_vector_t
+float_copysign(float_vector_t x, float_vector_t sign) {
+    return (float_vector_t)(((float_mask_t)x & INT32_MAX) | ((float_mask_t)sign & INT32_MIN));
+}
+
+/**
+ * \brief           A function used to check if a comparison of vectors holds in any lane
+ * \param[in]       mask: The comparison
+ * \return          1 if any lane is set, 0 otherwise
+ */
+static inline uint8_t
+float_any(float_mask_t mask) {
+    int32_t any = 0;
+    for (size_t k = 0; k < CALC_FLOAT_LANES; ++k) {
+        any |= mask[k];
+    }
+    return any != 0;
+}
+
+/**
+ * \brief           A function used to truncate values toward zero
+ * \param[in]       x: Arguments
+ * \return          The truncated values
+ * \note            Values from \ref FLOAT_INTEGRAL up are integers already and are not converted, so they cannot overflow
+ */
+static inline float_vector_t
+float_trunc(float_vector_t x) {
+    float_mask_t small = float_abs(x) < FLOAT_INTEGRAL;
+    float_vector_t t = __builtin_convertvector(__builtin_convertvector(float_select(small, x, (float_vector_t){0}), float_mask_t), float_vector_t);
+    return float_select(small, float_copysign(t, x), x);   /* -0.5 is truncated to -0 */
+}
+
+/**
+ * \brief           A function used to calculate floors
+ * \param[in]       x: Arguments
+ * \return          The largest integers not above the arguments
+ */
+static inline float_vector_t
+float_floor(float_vector_t x) {
+    float_vector_t t = float_trunc(x);
+    return t - (float_vector_t)((t > x) & (float_mask_t)((float_vector_t){0} + 1.0f));
+}
+
+/**
+ * \brief           A function used to calculate ceilings
+ * \param[in]       x: Arguments
+ * \return          The smallest integers not below the arguments
+ */
+static inline float_vector_t
+float_ceil(float_vector_t x) {
+    float_vector_t t = float_trunc(x);
+    return t + (float_vector_t)((t < x) & (float_mask_t)((float_vector_t){0} + 1.0f));
+}
+
+/**
+ * \brief           A function used to round values to the nearest integers, halfway cases away from zero
+ * \param[in]       x: Arguments
+ * \return          The rounded values
+ * \note            The fraction is exact, so 0.49999997 is not rounded up as `floor(x + 0.5)` would
+ */
+static inline float_vector_t
+float_round(float_vector_t x) {
+    float_vector_t t = float_trunc(x);
+    float_mask_t up = float_abs(x - t) >= 0.5f;
+    return t + float_copysign((float_vector_t)(up & (float_mask_t)((float_vector_t){0} + 1.0f)), x);
+}
+
+/**
+ * \brief           A function used to calculate square roots
+ * \param[in]       x: Arguments
+ * \return          The square roots, correctly rounded
+ * \note            The loop becomes one vector instruction as the file is built without errno for math functions
+ */
+static inline float_vector_t
+float_sqrt(float_vector_t x) {
+    float_vector_t r;
+    for (size_t k = 0; k < CALC_FLOAT_LANES; ++k) {
+        r[k] = __builtin_sqrtf(x[k]);
+    }
+    return r;
+}
+
+/**
+ * \brief           A function used to calculate exponentials of reduced arguments
+ * \param[in]       r: Arguments, at most about ln(2)/2 in absolute value
+ * \param[in]       k: Powers of 2 to scale the results by, between -150 and 128
+ * \return          e raised to the power r, times 2 raised to the power k
+ * \note            The result is scaled by two powers of 2, so that subnormal results need no special case
+ */
+static inline float_vector_t
+float_exp_reduced(float_vector_t r, float_mask_t k) {
+    float_mask_t half = k >> 1;
+    float_vector_t p = ((((1.9875691500e-4f * r + 1.3981999507e-3f) * r + 8.3334519073e-3f) * r + 4.1665795894e-2f) * r
+                        + 1.6666665459e-1f) * r + 5.0000001201e-1f;
+    p = p * r * r + r + 1.0f;
+    return p * (float_vector_t)((half + 127) << 23) * (float_vector_t)((k - half + 127) << 23);
+}
+
+/**
+ * \brief           A function used to calculate exponentials
+ * \param[in]       x: Arguments
+ * \return          e raised to the power of the arguments
+ * \note            The argument is reduced by a multiple of ln(2) split in two parts, so that the product is exact
+ */
+static float_vector_t
+float_exp(float_vector_t x) {
+    float_mask_t over = x > FLOAT_EXP_MAX, under = x < FLOAT_EXP_MIN, nan = x != x;
+    float_vector_t n, r, p;
+    r = float_select(over | under | nan, (float_vector_t){0}, x);
+    n = float_floor(r * 1.44269504088896341f + 0.5f);
+    r = r - n * 0.693359375f - n * -2.12194440e-4f;
+    p = float_exp_reduced(r, __builtin_convertvector(n, float_mask_t));
+    p = float_select(over, (float_vector_t){0} + INFINITY, p);
+    p = float_select(under, (float_vector_t){0}, p);
+    return float_select(nan, x, p);
+}
+
+/**
+ * \brief           A function used to calculate halves of exponentials
+ * \param[in]       x: Arguments
+ * \return          e raised to the power of the arguments, divided by 2
+ * \note            Arguments up to about 89.4 have a finite result, whose exponential alone overflows
+ */
+static float_vector_t
+float_half_exp(float_vector_t x) {
+    float_vector_t r = 0.5f * float_exp(x);
+    float_mask_t big = x > FLOAT_EXP_MAX;
+    if (float_any(big)) {
+        float_vector_t h = float_exp(0.5f * x);
+        r = float_select(big, 0.5f * h * h, r);
+    }
+    return r;
+}
+
+/**
+ * \brief           A function used to split arguments for their natural logarithms
+ * \param[in]       x: Arguments, positive and finite
+ * \param[out]      m: Mantissas minus 1, between sqrt(0.5) - 1 and sqrt(2) - 1
+ * \param[out]      e: Exponents, so that the arguments are (m + 1)·2^e
+ * \return          ln(m + 1) - m, a polynomial of m
+ */
+static inline float_vector_t
+float_log_parts(float_vector_t x, float_vector_t* m, float_vector_t* e) {
+    float_mask_t tiny = x < FLT_MIN;            /* Subnormal arguments are scaled up by 2^23 first */
+    float_mask_t bits = (float_mask_t)float_select(tiny, x * FLOAT_INTEGRAL, x), low;
+    float_vector_t z, y;
+    *e = __builtin_convertvector(((bits >> 23) & 0xff) - 126, float_vector_t) - (float_vector_t)(tiny & (float_mask_t)((float_vector_t){0} + 23.0f));
+    *m = (float_vector_t)((bits & 0x807fffff) | 0x3f000000);   /* 0.5 <= m < 1 */
+    low = *m < 0.707106781186547524f;
+    *e = *e - (float_vector_t)(low & (float_mask_t)((float_vector_t){0} + 1.0f));
+    *m = *m + float_select(low, *m, (float_vector_t){0}) - 1.0f;
+    z = *m * *m;
+    y = (((((((7.0376836292e-2f * *m - 1.1514610310e-1f) * *m + 1.1676998740e-1f) * *m - 1.2420140846e-1f) * *m
+        + 1.4249322787e-1f) * *m - 1.6668057665e-1f) * *m + 2.0000714765e-1f) * *m - 2.4999993993e-1f) * *m + 3.3333331174e-1f;
+    return y * *m * z - 0.5f * z;
+}
+
+/**
+ * \brief           A function used to calculate natural logarithms
+ * \param[in]       x: Arguments
+ * \return          The logarithms, -inf for 0, NaN for negative arguments
+ * \note            The argument is split into a power of 2 and a mantissa between sqrt(0.5) and sqrt(2),
+ *                  whose logarithm is a polynomial of the mantissa minus 1
+ */
+static float_vector_t
+float_log(float_vector_t x) {
+    float_vector_t m, e, y = float_log_parts(x, &m, &e);
+    y = m + (y + e * -2.12194440e-4f) + e * 0.693359375f;
+    y = float_select(x == 0, (float_vector_t){0} - INFINITY, y);
+    y = float_select((x < 0) | (x != x), (float_vector_t){0} + nanf(""), y);
+    return float_select(x == INFINITY, x, y);
+}
+
+/**
+ * \brief           A function used to calculate logarithms of 1 + x
+ * \param[in]       x: Arguments, above -1
+ * \return          The logarithms, accurate for small arguments too
+ * \note            The rounding error of 1 + x is cancelled by the ratio of x to the rounded value minus 1
+ */
+static float_vector_t
+float_log1p(float_vector_t x) {
+    float_vector_t u = x + 1.0f;
+    return float_select(u == 1.0f, x, float_log(u) * (x / (u - 1.0f)));
+}
+
+/**
+ * \brief           A function used to calculate sines and cosines
+ * \param[in]       x: Arguments
+ * \param[out]      s: The sines
+ * \param[out]      c: The cosines
+ * \note            The argument is reduced by a multiple of pi/4 split in three parts, in double lanes so that results
+ *                  near a multiple of pi keep their precision; the rare arguments above \ref FLOAT_REDUCE_MAX
+ *                  or not finite are calculated in double precision one by one
+ */
+static void
+float_sincos(float_vector_t x, float_vector_t* s, float_vector_t* c) {
+    float_vector_t a = float_abs(x), r, z, ps, pc;
+    float_wide_t y;
+    float_mask_t far = ~(a <= FLOAT_REDUCE_MAX), j, swap, sin_neg, cos_neg;
+    a = float_select(far, (float_vector_t){0}, a);
+    j = __builtin_convertvector(a * 1.27323954473516f, float_mask_t);
+    j = (j + 1) & ~1;                           /* The octant rounded to an even one */
+    y = __builtin_convertvector(j, float_wide_t);
+    r = __builtin_convertvector(((__builtin_convertvector(a, float_wide_t) - y * 7.85398125648498535156e-1)
+                                 - y * 3.77489470793079817668e-8) - y * 2.69515142907905952645e-15, float_vector_t);
+    z = r * r;
+    ps = ((-1.9515295891e-4f * z + 8.3321608736e-3f) * z - 1.6666654611e-1f) * z * r + r;
+    pc = ((2.443315711809948e-5f * z - 1.388731625493765e-3f) * z + 4.166664568298827e-2f) * z * z - 0.5f * z + 1.0f;
+    swap = (j & 2) != 0;
+    sin_neg = ((j & 4) != 0) ^ (x < 0);
+    cos_neg = ((j & 4) != 0) ^ swap;
+    *s = (float_vector_t)((float_mask_t)float_select(swap, pc, ps) ^ (sin_neg & INT32_MIN));
+    *c = (float_vector_t)((float_mask_t)float_select(swap, ps, pc) ^ (cos_neg & INT32_MIN));
+    if (float_any(far)) {
+        for (size_t k = 0; k < CALC_FLOAT_LANES; ++k) {
+            if (far[k]) {
+                (*s)[k] = (float)sin(x[k]);
+                (*c)[k] = (float)cos(x[k]);
+            }
+        }
+    }
+}
+
+/**
+ * \brief           A function used to calculate arc tangents
+ * \param[in]       x: Arguments
+ * \return          The arc tangents
+ * \note            The argument is reduced below tan(pi/8) with the tangents of pi/4 and pi/2
+ */
+static float_vector_t
+float_atan(float_vector_t x) {
+    float_vector_t a = float_abs(x), t, base, z, p;
+    float_mask_t big = a > 2.414213562373095f, mid = ~big & (a > 0.4142135623730950f);
+    t = float_select(big, -1.0f / a, float_select(mid, (a - 1.0f) / (a + 1.0f), a));
+    base = float_select(big, (float_vector_t){0} + FLOAT_PI_2, float_select(mid, (float_vector_t){0} + FLOAT_PI_4, (float_vector_t){0}));
+    z = t * t;
+    p = (((8.05374449538e-2f * z - 1.38776856032e-1f) * z + 1.99777106478e-1f) * z - 3.33329491539e-1f) * z * t + t;
+    return float_copysign(base + p, x);
+}
+
+/**
+ * \brief           A function used to calculate arc sines of small values
+ * \param[in]       x: Arguments, at most 0.5 in absolute value
+ * \param[in]       z: Squares of the arguments
+ * \return          The arc sines
+ */
+static inline float_vector_t
+float_asin_poly(float_vector_t x, float_vector_t z) {
+    return ((((4.2163199048e-2f * z + 2.4181311049e-2f) * z + 4.5470025998e-2f) * z + 7.4953002686e-2f) * z + 1.6666752422e-1f) * z * x + x;
+}
+
+/**
+ * \brief           A function used to calculate arc sines
+ * \param[in]       x: Arguments, between -1 and 1
+ * \return          The arc sines
+ * \note            Above 0.5, asin(x) is pi/2 - 2 asin(sqrt((1 - x) / 2))
+ */
+static float_vector_t
+float_asin(float_vector_t x) {
+    float_vector_t a = float_abs(x), z, t, p;
+    float_mask_t big = a > 0.5f;
+    z = float_select(big, 0.5f * (1.0f - a), a * a);
+    t = float_select(big, float_sqrt(z), a);
+    p = float_asin_poly(t, z);
+    return float_copysign(float_select(big, FLOAT_PI_2 - (p + p), p), x);
+}
+
+/**
+ * \brief           A function used to calculate arc cosines
+ * \param[in]       x: Arguments, between -1 and 1
+ * \return          The arc cosines
+ * \note            Beyond 0.5 in absolute value the result is taken from the arc sine of sqrt((1 - |x|) / 2),
+ *                  so that it is not the difference of close numbers
+ */
+static float_vector_t
+float_acos(float_vector_t x) {
+    float_vector_t a = float_abs(x), z, t, p;
+    float_mask_t big = a > 0.5f;
+    z = float_select(big, 0.5f * (1.0f - a), x * x);
+    t = float_select(big, float_sqrt(z), x);
+    p = float_asin_poly(t, z);
+    return float_select(big, float_select(x < 0, FLOAT_PI - (p + p), p + p), FLOAT_PI_2 - p);
+}
+
+/**
+ * \brief           A function used to calculate hyperbolic tangents
+ * \param[in]       x: Arguments
+ * \return          The hyperbolic tangents
+ */
+static float_vector_t
+float_tanh(float_vector_t x) {
+    float_vector_t a = float_abs(x), z = x * x, small, big;
+    small = ((((-5.70498872745e-3f * z + 2.06390887954e-2f) * z - 5.37397155531e-2f) * z + 1.33314422036e-1f) * z - 3.33332819422e-1f) * z * a + a;
+    big = 1.0f - 2.0f / (float_exp(a + a) + 1.0f);
+    return float_copysign(float_select(a < 0.625f, small, big), x);
+}
+
+/**
+ * \brief           A function used to calculate factorials
+ * \param[in]       x: Arguments, not negative
+ * \return          Γ(x + 1) of the arguments
+ * \note            The argument is split into an integer n and a fraction f, and the result is Γ(f + 1) times
+ *                  (f + 1)(f + 2)...(f + n), in double lanes: every factor is exact and the product far more
+ *                  accurate than a float, so integer arguments give the same factorials as the double evaluation
+ */
+static float_vector_t
+float_fact(float_vector_t x) {
+    float_mask_t over = ~(x < FLOAT_FACT_MAX);
+    float_vector_t n = float_floor(float_select(over, (float_vector_t){0}, x));
+    float_wide_t f = __builtin_convertvector(float_select(over, (float_vector_t){0}, x) - n, float_wide_t);
+    float_wide_t wide_n = __builtin_convertvector(n, float_wide_t);
+    float_wide_t p = (float_wide_t){0} + float_gamma_p[0], q = (float_wide_t){0} + float_gamma_q[0];
+    int32_t most = 0;
+    for (size_t i = 1; i < sizeof(float_gamma_p) / sizeof(float_gamma_p[0]); ++i) {
+        p = p * f + float_gamma_p[i];
+    }
+    for (size_t i = 1; i < sizeof(float_gamma_q) / sizeof(float_gamma_q[0]); ++i) {
+        q = q * f + float_gamma_q[i];
+    }
+    p = p / q / (f + 1);                        /* Γ(f + 1) */
+    for (size_t k = 0; k < CALC_FLOAT_LANES; ++k) {
+        most = (int32_t)n[k] > most ? (int32_t)n[k] : most;
+    }
+    for (int32_t i = 1; i <= most; ++i) {
+        float_wide_mask_t take = (float_wide_t){0} + i <= wide_n;
+        p = (float_wide_t)((take & (float_wide_mask_t)(p * (f + i))) | (~take & (float_wide_mask_t)p));
+    }
+    return float_select(over, (float_vector_t){0} + INFINITY, __builtin_convertvector(p, float_vector_t));
+}
+
+/**
+ * \brief           A function used to raise values to integer powers by squaring
+ * \param[in]       x: The bases
+ * \param[in]       n: The exponents, at most \ref FLOAT_POWI_MAX in absolute value
+ * \return          x raised to the power n, lane by lane
+ * \note            The squares are taken in double lanes, whose error stays far below the rounding to float
+ */
+static float_vector_t
+float_powi(float_vector_t x, float_mask_t n) {
+    float_wide_t base = __builtin_convertvector(x, float_wide_t), p = (float_wide_t){0} + 1;
+    float_mask_t m = (n ^ (n >> 31)) - (n >> 31);   /* |n| */
+    int32_t bits = 0;                           /* Bits of the largest exponent */
+    float_wide_mask_t negative;
+    for (size_t k = 0; k < CALC_FLOAT_LANES; ++k) {
+        bits |= m[k];
+    }
+    for (int32_t bit = 0; (bits >> bit) != 0; ++bit) {
+        float_wide_mask_t take = -__builtin_convertvector((m >> bit) & 1, float_wide_mask_t);
+        p = (float_wide_t)((take & (float_wide_mask_t)(p * base)) | (~take & (float_wide_mask_t)p));
+        base = base * base;
+    }
+    negative = __builtin_convertvector(n < 0, float_wide_mask_t);
+    p = (float_wide_t)((negative & (float_wide_mask_t)(1 / p)) | (~negative & (float_wide_mask_t)p));
+    return __builtin_convertvector(p, float_vector_t);
+}
+
+/**
+ * \brief           A function used to raise values to powers
+ * \param[in]       x: The bases
+ * \param[in]       y: The exponents
+ * \return          x raised to the power y, lane by lane
+ * \note            Integer exponents up to \ref FLOAT_POWI_MAX are raised by squaring like the double evaluation does,
+ *                  the others through exp(y ln|x|), with the sign of an odd integer power of a negative base. The product
+ *                  y ln|x| is formed in double lanes of the exponent and the mantissa of x, so that its error does not
+ *                  grow with ln|x|, only the logarithm of the mantissa is rounded to float
+ */
+static float_vector_t
+float_pow(float_vector_t x, float_vector_t y) {
+    float_mask_t integer = float_trunc(y) == y;
+    float_mask_t small = integer & (float_abs(y) <= FLOAT_POWI_MAX);
+    float_vector_t r = float_powi(x, __builtin_convertvector(float_select(small, y, (float_vector_t){0}), float_mask_t));
+    if (float_any(~small)) {
+        float_vector_t a = float_abs(x), m, e, lm = float_log_parts(a, &m, &e), tf, g;
+        float_wide_t t = __builtin_convertvector(y, float_wide_t) * (__builtin_convertvector(e, float_wide_t) * FLOAT_LN2_WIDE
+                                                                     + __builtin_convertvector(m, float_wide_t) + __builtin_convertvector(lm, float_wide_t));
+        float_mask_t odd = integer & (float_trunc(y * 0.5f) * 2.0f != y), over, under, nan;
+        float_vector_t k;
+        tf = __builtin_convertvector(t, float_vector_t);
+        over = tf > FLOAT_EXP_MAX;
+        under = tf < FLOAT_EXP_MIN;
+        nan = tf != tf;
+        k = float_floor(float_select(over | under | nan, (float_vector_t){0}, tf) * 1.44269504088896341f + 0.5f);
+        g = float_exp_reduced(__builtin_convertvector(t - __builtin_convertvector(k, float_wide_t) * FLOAT_LN2_WIDE, float_vector_t),
+                              __builtin_convertvector(k, float_mask_t));
+        g = float_select(over, (float_vector_t){0} + INFINITY, float_select(under, (float_vector_t){0}, g));
+        g = float_select(a == 0, float_select(y < 0, (float_vector_t){0} + INFINITY, (float_vector_t){0}), g);
+        g = float_select(a == INFINITY, float_select(y < 0, (float_vector_t){0}, (float_vector_t){0} + INFINITY), g);
+        g = (float_vector_t)((float_mask_t)g ^ (odd & (x < 0) & INT32_MIN));
+        g = float_select(((x < 0) & ~integer) | (x != x) | (y != y), (float_vector_t){0} + nanf(""), g);
+        g = float_select(x == 1.0f, x, g);      /* 1 raised to any power, NaN included */
+        r = float_select(small, r, g);
+    }
+    return r;
+}
+
+/**
+ * \brief           A function used to check arguments against the domain of a function
+ * \param[in]       domain: The domain
+ * \param[in]       x: The first arguments
+ * \param[in]       y: The second arguments
+ * \return          A mask of the lanes inside the domain, every lane for the domains checked on the result
+ *                  by \ref float_call
+ */
+static float_mask_t
+float_domain(calc_domain_t domain, float_vector_t x, float_vector_t y) {
+    switch (domain) {
+        case CALC_DOMAIN_NON_NEGATIVE:
+            return x >= 0;
+        case CALC_DOMAIN_POSITIVE:
+            return x > 0;
+        case CALC_DOMAIN_UNIT_CLOSED:
+            return (x >= -1.0f) & (x <= 1.0f);
+        case CALC_DOMAIN_UNIT_OPEN:
+            return (x > -1.0f) & (x < 1.0f);
+        case CALC_DOMAIN_AT_LEAST_ONE:
+            return x >= 1.0f;
+        case CALC_DOMAIN_NON_NEGATIVE_INTEGER:
+            return (x >= 0) & (float_trunc(x) == x);
+        case CALC_DOMAIN_LOG_BASE:
+            return (x > 0) & (x != 1.0f) & (y > 0);    /* The base is the first argument */
+        default:
+            return (float_mask_t){0} - 1;
+    }
+}
+
+/**
+ * \brief           A function used to calculate a math function
+ * \param[in]       fn: The function
+ * \param[in]       x: The first arguments
+ * \param[in]       y: The second arguments, for the functions of two arguments
+ * \param[out]      inside: A mask of the lanes inside the domain of the function
+ * \return          The results, NaN in the lanes outside the domain
+ * \note            The tangents need a cosine and the cotangents a sine or a hyperbolic tangent other than 0,
+ *                  which are checked on the values the results are calculated of
+ */
+static float_vector_t
+float_call(calc_function_id_t fn, float_vector_t x, float_vector_t y, float_mask_t* inside) {
+    float_vector_t r, s, c;
+    *inside = float_domain(calc_functions[fn].domain, x, y);
+    switch (fn) {
+        case CALC_FN_SQRT:
+            r = float_sqrt(x);
+            break;
+        case CALC_FN_LN:
+            r = float_log(x);
+            break;
+        case CALC_FN_EXP:
+            r = float_exp(x);
+            break;
+        case CALC_FN_SIN:
+            float_sincos(x, &r, &c);
+            break;
+        case CALC_FN_COS:
+            float_sincos(x, &s, &r);
+            break;
+        case CALC_FN_TAN:
+            float_sincos(x, &s, &c);
+            *inside &= c != 0;
+            r = s / c;
+            break;
+        case CALC_FN_CTAN:
+            float_sincos(x, &s, &c);
+            *inside &= s != 0;
+            r = c / s;
+            break;
+        case CALC_FN_ASIN:
+            r = float_asin(x);
+            break;
+        case CALC_FN_ACOS:
+            r = float_acos(x);
+            break;
+        case CALC_FN_ATAN:
+            r = float_atan(x);
+            break;
+        case CALC_FN_ACTAN: {                   /* atan(1 / x) beyond 1, where pi/2 - atan(x) would cancel */
+            float_mask_t above = x > 1.0f, below = x < -1.0f;
+            r = float_atan(float_select(above | below, 1.0f / x, x));
+            r = float_select(above, r, float_select(below, FLOAT_PI + r, FLOAT_PI_2 - r));
+            break;
+        }
+        case CALC_FN_SINH: {
+            float_vector_t a = float_abs(x), z = x * x, h = float_half_exp(a);
+            float_vector_t small = ((2.03721912945e-4f * z + 8.33028376239e-3f) * z + 1.66667160211e-1f) * z * a + a;
+            r = float_copysign(float_select(a < 1.0f, small, h - 0.25f / h), x);
+            break;
+        }
+        case CALC_FN_COSH: {
+            float_vector_t h = float_half_exp(float_abs(x));
+            r = h + 0.25f / h;
+            break;
+        }
+        case CALC_FN_TANH:
+            r = float_tanh(x);
+            break;
+        case CALC_FN_CTANH:
+            r = float_tanh(x);
+            *inside &= r != 0;
+            r = 1.0f / r;
+            break;
+        case CALC_FN_ASINH: {
+            float_vector_t a = float_abs(x), z = a * a;
+            r = float_log1p(a + z / (1.0f + float_sqrt(z + 1.0f)));
+            r = float_copysign(float_select(a > FLOAT_HUGE, float_log(a) + FLOAT_LN2, r), x);
+            break;
+        }
+        case CALC_FN_ACOSH: {
+            float_vector_t t = x - 1.0f;
+            r = float_log1p(t + float_sqrt(t * (x + 1.0f)));
+            r = float_select(x > FLOAT_HUGE, float_log(x) + FLOAT_LN2, r);
+            break;
+        }
+        case CALC_FN_ATANH:
+        case CALC_FN_ACTANH: {                  /* The hyperbolic arc cotangent is defined as the arc tangent */
+            float_vector_t a = float_abs(x);
+            r = float_copysign(0.5f * float_log1p((a + a) / (1.0f - a)), x);
+            break;
+        }
+        case CALC_FN_FABS:
+            r = float_abs(x);
+            break;
+        case CALC_FN_CEIL:
+            r = float_ceil(x);
+            break;
+        case CALC_FN_FLOOR:
+            r = float_floor(x);
+            break;
+        case CALC_FN_ROUND:
+            r = float_round(x);
+            break;
+        case CALC_FN_TRUNC:
+            r = float_trunc(x);
+            break;
+        case CALC_FN_SIGN:
+            r = (float_vector_t)(((x > 0) & (float_mask_t)((float_vector_t){0} + 1.0f)) | ((x < 0) & (float_mask_t)((float_vector_t){0} - 1.0f)));
+            break;
+        case CALC_FN_RAD:
+            r = x * (FLOAT_PI / 180);
+            break;
+        case CALC_FN_DEG:
+            r = x * (180 / FLOAT_PI);
+            break;
+        case CALC_FN_FACT:
+            r = float_fact(x);
+            break;
+        case CALC_FN_LOG:
+            r = float_log(y) / float_log(x);
+            break;
+        case CALC_FN_LOG10:
+            r = float_log(x) * FLOAT_LOG10_E;
+            break;
+        case CALC_FN_MIN:
+            r = float_select(y < x, y, x);
+            break;
+        case CALC_FN_MAX:
+            r = float_select(y > x, y, x);
+            break;
+        default:
+            *inside = (float_mask_t){0};
+            r = (float_vector_t){0};
+            break;
+    }
+    return float_select(*inside, r, (float_vector_t){0} + nanf(""));
+}
+
+/**
+ * \brief           A function used to calculate a node for a block of rows
+ * \param[in]       expr: A compiled expression
+ * \param[in]       index: An index of the node
+ * \param[in,out]   blocks: Values of all nodes for the block, the value of the node is written
+ * \param[in]       vars: Columns of the variables
+ * \param[in]       start: The first row of the block
+ * \param[in]       count: A number of rows in the block, the rest of the block is filled with zeros
+ * \param[in,out]   failed: Rows of the block which left the domain of a function
+ */
+static void
+float_node(const calc_expr_t* expr, size_t index, float_block_t* blocks, const float* const* vars,
+           size_t start, size_t count, float_mask_t* failed) {
+    const calc_node_t* node = &expr->nodes[index];
+    float_block_t* out = &blocks[index];
+    const float_block_t* x = node->op > CALC_OP_VAR ? &blocks[node->a] : NULL;
+    const float_block_t* y = node->op > CALC_OP_VAR && node->b >= 0 ? &blocks[node->b] : NULL;
+    switch (node->op) {
+        case CALC_OP_CONST:
+            for (size_t v = 0; v < FLOAT_VECTORS; ++v) {
+                out->v[v] = (float_vector_t){0} + (float)node->value;
+            }
+            return;
+        case CALC_OP_VAR:
+            for (size_t r = 0; r < CALC_FLOAT_BLOCK; ++r) {
+                out->v[r / CALC_FLOAT_LANES][r % CALC_FLOAT_LANES] = r < count ? vars[node->a][start + r] : 0;
+            }
+            return;
+        case CALC_OP_NEG:
+            for (size_t v = 0; v < FLOAT_VECTORS; ++v) {
+                out->v[v] = -x->v[v];
+            }
+            return;
+        case CALC_OP_ADD:
+            for (size_t v = 0; v < FLOAT_VECTORS; ++v) {
+                out->v[v] = x->v[v] + y->v[v];
+            }
+            return;
+        case CALC_OP_SUB:
+            for (size_t v = 0; v < FLOAT_VECTORS; ++v) {
+                out->v[v] = x->v[v] - y->v[v];
+            }
+            return;
+        case CALC_OP_MUL:
+            for (size_t v = 0; v < FLOAT_VECTORS; ++v) {
+                out->v[v] = x->v[v] * y->v[v];
+            }
+            return;
+        case CALC_OP_DIV:
+            for (size_t v = 0; v < FLOAT_VECTORS; ++v) {
+                out->v[v] = x->v[v] / y->v[v];
+            }
+            return;
+        case CALC_OP_MOD:                               /* Remainders are exact, one by one */
+            for (size_t r = 0; r < CALC_FLOAT_BLOCK; ++r) {
+                out->v[r / CALC_FLOAT_LANES][r % CALC_FLOAT_LANES] = fmodf(x->v[r / CALC_FLOAT_LANES][r % CALC_FLOAT_LANES],
+                                                                           y->v[r / CALC_FLOAT_LANES][r % CALC_FLOAT_LANES]);
+            }
+            return;
+        case CALC_OP_POW:
+            for (size_t v = 0; v < FLOAT_VECTORS; ++v) {
+                out->v[v] = float_pow(x->v[v], y->v[v]);
+            }
+            return;
+        case CALC_OP_POWI:
+            for (size_t v = 0; v < FLOAT_VECTORS; ++v) {
+                out->v[v] = float_powi(x->v[v], (float_mask_t){0} + (int32_t)node->value);
+            }
+            return;
+        case CALC_OP_CALL:
+            for (size_t v = 0; v < FLOAT_VECTORS; ++v) {
+                float_mask_t inside;
+                out->v[v] = float_call((calc_function_id_t)node->fn, x->v[v], y != NULL ? y->v[v] : (float_vector_t){0}, &inside);
+                failed[v] |= ~inside;
+            }
+            return;
+        case CALC_OP_GUARD:
+            for (size_t v = 0; v < FLOAT_VECTORS; ++v) {
+                out->v[v] = x->v[v];
+            }
+            return;
+        default:
+            for (size_t v = 0; v < FLOAT_VECTORS; ++v) {
+                out->v[v] = (float_vector_t){0} + nanf("");
+                failed[v] = (float_mask_t){0} - 1;
+            }
+            return;
+    }
+}
@@ -0,0 +1,618 @@
+/**
+ * \file            calc_functions.c
+ * \brief           Registry of the math functions: names, implementations, arity, purity and domains
+ */
+
+/*
+ * Copyright (c) 2024 Daniil VERES
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * Author:          Daniil VERES <daniaveres@gmail.com>
+ * Version:         v1.0.0
+ */
+
+#include <math.h>   /* sqrt, exp, sin, cos, tan, asin, acos, atan, sinh, cosh, tanh, asinh, acosh, atanh, fabs, ceil, floor, round, trunc, log, log10, tgamma, INFINITY */
+#include <stdint.h> /* uint8_t, int32_t */
+#include <string.h> /* strlen */
+#include "calc_internal.h"
+
+#ifdef _WIN32
+#define calc_strnicmp _strnicmp     /*!< Case-insensitive comparison of a string prefix */
+#else
+#include <strings.h>                /* strncasecmp */
+#define calc_strnicmp strncasecmp   /*!< Case-insensitive comparison of a string prefix */
+#endif /* _WIN32 */
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846     /*!< Pi number */
+#endif /* M_PI */
+
+#define CALC_FACT_TABLE_MAX 170         /*!< The largest integer whose factorial is a finite double */
+
+/**
+ * \brief           A name under which a math function can be called
+ */
+typedef struct {
+    const char* name;           /*!< The name, compared case-insensitively */
+    uint8_t id;                 /*!< The function, one of \ref calc_function_id_t */
+} calc_alias_t;
+
+static double sqrt_s(const double* args);   /* A function used to calculate a square root */
+static double ln_s(const double* args);     /* A function used to calculate a natural logarithm */
+static double exp_s(const double* args);    /* A function used to calculate an exponential function */
+static double sin_s(const double* args);    /* A function used to calculate a sine */
+static double cos_s(const double* args);    /* A function used to calculate a cosine */
+static double tan_s(const double* args);    /* A function used to calculate a tangent */
+static double ctan_s(const double* args);   /* A function used to calculate a cotangent */
+static double asin_s(const double* args);   /* A function used to calculate an arcsine */
+static double acos_s(const double* args);   /* A function used to calculate an arccosine */
+static double atan_s(const double* args);   /* A function used to calculate an arctangent */
+static double actan_s(const double* args);  /* A function used to calculate an arccotangent */
+static double sinh_s(const double* args);   /* A function used to calculate a hyperbolic sine */
+static double cosh_s(const double* args);   /* A function used to calculate a hyperbolic cosine */
+static double tanh_s(const double* args);   /* A function used to calculate a hyperbolic tangent */
+static double ctanh_s(const double* args);  /* A function used to calculate a hyperbolic cotangent */
+static double asinh_s(const double* args);  /* A function used to calculate a hyperbolic arcsine */
+static double acosh_s(const double* args);  /* A function used to calculate a hyperbolic arccosine */
+static double atanh_s(const double* args);  /* A function used to calculate a hyperbolic arctangent */
+static double actanh_s(const double* args); /* A function used to calculate a hyperbolic arccotangent */
+static double fabs_s(const double* args);   /* A function used to calculate an absolute value */
+static double ceil_s(const double* args);   /* A function used to calculate a ceiling value */
+static double floor_s(const double* args);  /* A function used to calculate a floor value */
+static double round_s(const double* args);  /* A function used to calculate a rounded value */
+static double trunc_s(const double* args);  /* A function used to calculate a truncated value */
+static double sign_s(const double* args);   /* A function used to calculate a sign */
+static double rad_s(const double* args);    /* A function used to convert degrees to radians */
+static double deg_s(const double* args);    /* A function used to convert radians to degrees */
+static double fact_s(const double* args);   /* A function used to calculate a factorial */
+static double log_s(const double* args);    /* A function used to calculate a logarithm */
+static double log10_s(const double* args);  /* A function used to calculate a decimal logarithm */
+static double min_s(const double* args);    /* A function used to calculate a minimum value */
+static double max_s(const double* args);    /* A function used to calculate a maximum value */
+
+/**
+ * \brief           Expands an entry of \ref CALC_FUNCTION_LIST into an initializer of the registry
+ */
+#define CALC_FUNCTION_ENTRY(id, name, impl, arity, variadic, pure, domain) \
+    [CALC_FN_##id] = {name, impl, arity, variadic, pure, domain},
+
+/**
+ * \brief           The registry of math functions
+ * \note            The table is constant and fully initialized at compile time, so nothing is allocated at startup
+ */
+const calc_function_t calc_functions[CALC_FN_COUNT] = {
+    CALC_FUNCTION_LIST(CALC_FUNCTION_ENTRY)
+};
+
+/**
+ * \brief           An array of names of the math functions
+ * \note            Some of the functions are repeated with different names, e.g. tg and tan
+ */
+static const calc_alias_t calc_aliases[] = {
+    {"sqrt", CALC_FN_SQRT}, {"ln", CALC_FN_LN}, {"exp", CALC_FN_EXP}, {"sin", CALC_FN_SIN}, {"cos", CALC_FN_COS},
+    {"tan", CALC_FN_TAN}, {"tg", CALC_FN_TAN},
+    {"ctan", CALC_FN_CTAN}, {"ctg", CALC_FN_CTAN}, {"cotan", CALC_FN_CTAN}, {"cot", CALC_FN_CTAN}, {"cotg", CALC_FN_CTAN},
+    {"arcsin", CALC_FN_ASIN}, {"asin", CALC_FN_ASIN}, {"arccos", CALC_FN_ACOS}, {"acos", CALC_FN_ACOS},
+    {"arctan", CALC_FN_ATAN}, {"arctg", CALC_FN_ATAN}, {"atan", CALC_FN_ATAN}, {"atg", CALC_FN_ATAN},
+    {"arcctan", CALC_FN_ACTAN}, {"arcctg", CALC_FN_ACTAN}, {"arccotan", CALC_FN_ACTAN}, {"arccot", CALC_FN_ACTAN},
+    {"arccotg", CALC_FN_ACTAN}, {"acotan", CALC_FN_ACTAN}, {"acot", CALC_FN_ACTAN}, {"acotg", CALC_FN_ACTAN},
+    {"sinh", CALC_FN_SINH}, {"sh", CALC_FN_SINH}, {"cosh", CALC_FN_COSH}, {"ch", CALC_FN_COSH},
+    {"tanh", CALC_FN_TANH}, {"tgh", CALC_FN_TANH}, {"th", CALC_FN_TANH},
+    {"ctanh", CALC_FN_CTANH}, {"ctgh", CALC_FN_CTANH}, {"coth", CALC_FN_CTANH}, {"cth", CALC_FN_CTANH},
+    {"arcsinh", CALC_FN_ASINH}, {"arsinh", CALC_FN_ASINH}, {"asinh", CALC_FN_ASINH}, {"arcsh", CALC_FN_ASINH},
+    {"arccosh", CALC_FN_ACOSH}, {"arcosh", CALC_FN_ACOSH}, {"acosh", CALC_FN_ACOSH}, {"arcch", CALC_FN_ACOSH},
+    {"arctanh", CALC_FN_ATANH}, {"arctgh", CALC_FN_ATANH}, {"arcth", CALC_FN_ATANH}, {"artgh", CALC_FN_ATANH}, {"atanh", CALC_FN_ATANH},
+    {"arccoth", CALC_FN_ACTANH}, {"arccth", CALC_FN_ACTANH}, {"arcoth", CALC_FN_ACTANH},
+    {"abs", CALC_FN_FABS}, {"ceil", CALC_FN_CEIL}, {"floor", CALC_FN_FLOOR}, {"round", CALC_FN_ROUND},
+    {"trunc", CALC_FN_TRUNC}, {"sign", CALC_FN_SIGN}, {"rad", CALC_FN_RAD}, {"deg", CALC_FN_DEG},
+    {"fact", CALC_FN_FACT}, {"log", CALC_FN_LOG}, {"lg", CALC_FN_LOG10}, {"min", CALC_FN_MIN}, {"max", CALC_FN_MAX}
+};
+
+#define CALC_ALIAS_COUNT (sizeof(calc_aliases) / sizeof(calc_aliases[0]))  /*!< A number of names of the math functions */
+
+/**
+ * \brief           A function used to get the number of math functions in the registry
+ * \return          The number of functions
+ */
+size_t
+calc_function_count(void) {
+    return CALC_FN_COUNT;
+}
+
+/**
+ * \brief           A function used to get a math function from the registry
+ * \param[in]       index: An index of the function, below \ref calc_function_count
+ * \return          The function, NULL if the index is out of range
+ */
+const calc_function_t*
+calc_function_get(size_t index) {
+    return index < CALC_FN_COUNT ? &calc_functions[index] : NULL;
+}
+
+/**
+ * \brief           A function used to find a math function by any of its names
+ * \param[in]       name: A name of the function, not NUL-terminated
+ * \param[in]       len: Length of the name
+ * \return          The function, NULL if there is no such function
+ */
+const calc_function_t*
+calc_function_find(const char* name, size_t len) {
+    int32_t index = calc_function_index(name, len);
+    return index >= 0 ? &calc_functions[index] : NULL;
+}
+
+/**
+ * \brief           A function used to get the number of names the math functions can be called with
+ * \return          The number of names
+ */
+size_t
+calc_alias_count(void) {
+    return CALC_ALIAS_COUNT;
+}
+
+/**
+ * \brief           A function used to get a name a math function can be called with
+ * \param[in]       index: An index of the name, below \ref calc_alias_count
+ * \return          The name, NULL if the index is out of range
+ */
+const char*
+calc_alias_name(size_t index) {
+    return index < CALC_ALIAS_COUNT ? calc_aliases[index].name : NULL;
+}
+
+/**
+ * \brief           A function used to find an index of a math function in the registry
+ * \param[in]       name: A name of the function, not NUL-terminated
+ * \param[in]       length: Length of the name
+ * \return          One of \ref calc_function_id_t, -1 if there is no such function
+ */
+int32_t
+calc_function_index(const char* name, size_t length) {
+    for (size_t i = 0; i < CALC_ALIAS_COUNT; ++i) {     /* Loop through all names of the math functions */
+        if (strlen(calc_aliases[i].name) == length && calc_strnicmp(name, calc_aliases[i].name, length) == 0) {
+            return calc_aliases[i].id;
+        }
+    }
+    return -1;
+}
+
+/**
+ * \brief           A function used to check if arguments belong to the domain of a function
+ * \param[in]       domain: The domain
+ * \param[in]       args: Arguments of the call
+ * \return          1 if the function is defined for the arguments, 0 otherwise
+ */
+uint8_t
+calc_domain_contains(calc_domain_t domain, const double* args) {
+    double x = args[0];
+    switch (domain) {
+        case CALC_DOMAIN_ALL:
+            return 1;
+        case CALC_DOMAIN_NON_NEGATIVE:
+            return x >= 0;
+        case CALC_DOMAIN_POSITIVE:
+            return x > 0;
+        case CALC_DOMAIN_UNIT_CLOSED:
+            return x >= -1 && x <= 1;
+        case CALC_DOMAIN_UNIT_OPEN:
+            return x > -1 && x < 1;
+        case CALC_DOMAIN_AT_LEAST_ONE:
+            return x >= 1;
+        case CALC_DOMAIN_NON_ZERO:
+            return tanh(x) != 0;                        /* The hyperbolic cotangent is 1 / tanh(x) */
+        case CALC_DOMAIN_COS_NON_ZERO:
+            return cos(x) != 0;
+        case CALC_DOMAIN_SIN_NON_ZERO:
+            return sin(x) != 0;
+        case CALC_DOMAIN_NON_NEGATIVE_INTEGER:
+            return x >= 0 && x == floor(x);
+        case CALC_DOMAIN_LOG_BASE:
+            return x > 0 && x != 1 && args[1] > 0;      /* The base is the first argument */
+        default:
+            return 0;
+    }
+}
+
+/**
+ * \brief           A function used to calculate the square root of a number
+ * \param[in]       args: An argument, not below 0
+ * \return          The result of the calculation
+ */
+static double
+sqrt_s(const double* args) {
+    return sqrt(args[0]);
+}
+
+/**
+ * \brief           A function used to calculate the sine of a number
+ * \param[in]       args: An argument
+ * \return          The result of the calculation
+ */
+static double
+sin_s(const double* args) {
+    return sin(args[0]);
+}
+
+/**
+ * \brief           A function used to calculate the cosine of a number
+ * \param[in]       args: An argument
+ * \return          The result of the calculation
+ */
+static double
+cos_s(const double* args) {
+    return cos(args[0]);
+}
+
+/**
+ * \brief           A function used to calculate the tangent of a number
+ * \param[in]       args: An argument, cos(x) is not 0
+ * \return          The result of the calculation
+ */
+static double
+tan_s(const double* args) {
+    return tan(args[0]);
+}
+
+/**
+ * \brief           A function used to calculate the cotangent of a number
+ * \param[in]       args: An argument, sin(x) is not 0
+ * \return          The result of the calculation
+ * \note            The function is calculated as 1 / tan(x)
+ */
+static double
+ctan_s(const double* args) {
+    return 1 / tan(args[0]);
+}
+
+/**
+ * \brief           A function used to calculate the arc sine of a number
+ * \param[in]       args: An argument, between -1 and 1
+ * \return          The result of the calculation
+ */
+static double
+asin_s(const double* args) {
+    return asin(args[0]);
+}
+
+/**
+ * \brief           A function used to calculate the arc cosine of a number
+ * \param[in]       args: An argument, between -1 and 1
+ * \return          The result of the calculation
+ */
+static double
+acos_s(const double* args) {
+    return acos(args[0]);
+}
+
+/**
+ * \brief           A function used to calculate the arc tangent of a number
+ * \param[in]       args: An argument
+ * \return          The result of the calculation
+ */
+static double
+atan_s(const double* args) {
+    return atan(args[0]);
+}
+
+/**
+ * \brief           A function used to calculate the arc cotangent of a number
+ * \param[in]       args: An argument
+ * \return          The result of the calculation
+ */
+static double
+actan_s(const double* args) {
+    return M_PI / 2 - atan(args[0]);
+}
+
+/**
+ * \brief           A function used to calculate the hyperbolic sine of a number
+ * \param[in]       args: An argument
+ * \return          The result of the calculation
+ */
+static double
+sinh_s(const double* args) {
+    return sinh(args[0]);
+}
+
+/**
+ * \brief           A function used to calculate the hyperbolic cosine of a number
+ * \param[in]       args: An argument
+ * \return          The result of the calculation
+ */
+static double
+cosh_s(const double* args) {
+    return cosh(args[0]);
+}
+
+/**
+ * \brief           A function used to calculate the hyperbolic tangent of a number
+ * \param[in]       args: An argument
+ * \return          The result of the calculation
+ */
+static double
+tanh_s(const double* args) {
+    return tanh(args[0]);
+}
+
+/**
+ * \brief           A function used to calculate the hyperbolic cotangent of a number
+ * \param[in]       args: An argument, tanh(x) is not 0
+ * \return          The result of the calculation
+ * \note            The function is calculated as 1 / tanh(x)
+ */
+static double
+ctanh_s(const double* args) {
+    return 1 / tanh(args[0]);
+}
+
+/**
+ * \brief           A function used to calculate the hyperbolic arc sine of a number
+ * \param[in]       args: An argument
+ * \return          The result of the calculation
+ */
+static double
+asinh_s(const double* args) {
+    return asinh(args[0]);
+}
+
+/**
+ * \brief           A function used to calculate the hyperbolic arc cosine of a number
+ * \param[in]       args: An argument, not below 1
+ * \return          The result of the calculation
+ */
+static double
+acosh_s(const double* args) {
+    return acosh(args[0]);
+}
+
+/**
+ * \brief           A function used to calculate the hyperbolic arc tangent of a number
+ * \param[in]       args: An argument, strictly between -1 and 1
+ * \return          The result of the calculation
+ */
+static double
+atanh_s(const double* args) {
+    return atanh(args[0]);
+}
+
+/**
+ * \brief           A function used to calculate the exponential function of a number
+ * \param[in]       args: An argument
+ * \return          The result of the calculation
+ */
+static double
+exp_s(const double* args) {
+    return exp(args[0]);
+}
+
+/**
+ * \brief           A function used to calculate the hyperbolic arc cotangent of a number
+ * \param[in]       args: An argument, strictly between -1 and 1
+ * \return          The result of the calculation
+ */
+static double
+actanh_s(const double* args) {
+    return atanh(args[0]);                      /* The same as ln((1 + x) / (1 - x)) / 2, but accurate near 0 */
+}
+
+/**
+ * \brief           A function used to calculate the absolute value of a number
+ * \param[in]       args: An argument
+ * \return          The absolute value of a number
+ */
+static double
+fabs_s(const double* args) {
+    return fabs(args[0]);
+}
+
+/**
+ * \brief           A function used to calculate the ceiling of a number
+ * \param[in]       args: An argument
+ * \return          The ceiling of a number
+ */
+static double
+ceil_s(const double* args) {
+    return ceil(args[0]);
+}
+
+/**
+ * \brief           A function used to calculate the floor of a number
+ * \param[in]       args: An argument
+ * \return          The floor of a number
+ */
+static double
+floor_s(const double* args) {
+    return floor(args[0]);
+}
+
+/**
+ * \brief           A function used to calculate the round of a number
+ * \param[in]       args: An argument
+ * \return          The round of a number
+ */
+static double
+round_s(const double* args) {
+    return round(args[0]);
+}
+
+/**
+ * \brief           A function used to calculate the truncation of a number
+ * \param[in]       args: An argument
+ * \return          The truncation of a number
+ */
+static double
+trunc_s(const double* args) {
+    return trunc(args[0]);
+}
+
+/**
+ * \brief           A function used to calculate the sign of a number
+ * \param[in]       args: An argument
+ * \return          1 if the number is positive, -1 if the number is negative, 0 otherwise
+ */
+static double
+sign_s(const double* args) {
+    if (args[0] > 0) {
+        return 1;
+    } else if (args[0] < 0) {
+        return -1;
+    } else {
+        return 0;
+    }
+}
+
+/**
+ * \brief           A function used to calculate the radian of a number
+ * \param[in]       args: An argument
+ * \return          The radian of a number
+ */
+static double
+rad_s(const double* args) {
+    return args[0] * M_PI / 180;
+}
+
+/**
+ * \brief           A function used to calculate the degree of a number
+ * \param[in]       args: An argument
+ * \return          The degree of a number
+ */
+static double
+deg_s(const double* args) {
+    return args[0] * 180 / M_PI;
+}
+
+/**
+ * \brief           Factorials of 0 to \ref CALC_FACT_TABLE_MAX, correctly rounded to doubles
+ * \note            171! overflows a double, so every integer argument with a finite factorial is served from the table
+ */
+static const double fact_table[CALC_FACT_TABLE_MAX + 1] = {
+    1.0, 1.0, 2.0, 6.0,
+    24.0, 120.0, 720.0, 5040.0,
+    40320.0, 362880.0, 3628800.0, 39916800.0,
+    479001600.0, 6227020800.0, 87178291200.0, 1307674368000.0,
+    20922789888000.0, 355687428096000.0, 6402373705728000.0, 1.21645100408832e+17,
+    2.43290200817664e+18, 5.109094217170944e+19, 1.1240007277776077e+21, 2.585201673888498e+22,
+    6.204484017332394e+23, 1.5511210043330986e+25, 4.0329146112660565e+26, 1.0888869450418352e+28,
+    3.0488834461171387e+29, 8.841761993739702e+30, 2.6525285981219107e+32, 8.222838654177922e+33,
+    2.631308369336935e+35, 8.683317618811886e+36, 2.9523279903960416e+38, 1.0333147966386145e+40,
+    3.7199332678990125e+41, 1.3763753091226346e+43, 5.230226174666011e+44, 2.0397882081197444e+46,
+    8.159152832478977e+47, 3.345252661316381e+49, 1.40500611775288e+51, 6.041526306337383e+52,
+    2.658271574788449e+54, 1.1962222086548019e+56, 5.502622159812089e+57, 2.5862324151116818e+59,
+    1.2413915592536073e+61, 6.082818640342675e+62, 3.0414093201713376e+64, 1.5511187532873822e+66,
+    8.065817517094388e+67, 4.2748832840600255e+69, 2.308436973392414e+71, 1.2696403353658276e+73,
+    7.109985878048635e+74, 4.0526919504877214e+76, 2.3505613312828785e+78, 1.3868311854568984e+80,
+    8.32098711274139e+81, 5.075802138772248e+83, 3.146997326038794e+85, 1.98260831540444e+87,
+    1.2688693218588417e+89, 8.247650592082472e+90, 5.443449390774431e+92, 3.647111091818868e+94,
+    2.4800355424368305e+96, 1.711224524281413e+98, 1.1978571669969892e+100, 8.504785885678623e+101,
+    6.1234458376886085e+103, 4.4701154615126844e+105, 3.307885441519386e+107, 2.48091408113954e+109,
+    1.8854947016660504e+111, 1.4518309202828587e+113, 1.1324281178206297e+115, 8.946182130782976e+116,
+    7.156945704626381e+118, 5.797126020747368e+120, 4.753643337012842e+122, 3.945523969720659e+124,
+    3.314240134565353e+126, 2.81710411438055e+128, 2.4227095383672734e+130, 2.107757298379528e+132,
+    1.8548264225739844e+134, 1.650795516090846e+136, 1.4857159644817615e+138, 1.352001527678403e+140,
+    1.2438414054641308e+142, 1.1567725070816416e+144, 1.087366156656743e+146, 1.032997848823906e+148,
+    9.916779348709496e+149, 9.619275968248212e+151, 9.426890448883248e+153, 9.332621544394415e+155,
+    9.332621544394415e+157, 9.42594775983836e+159, 9.614466715035127e+161, 9.90290071648618e+163,
+    1.0299016745145628e+166, 1.081396758240291e+168, 1.1462805637347084e+170, 1.226520203196138e+172,
+    1.324641819451829e+174, 1.4438595832024937e+176, 1.588245541522743e+178, 1.7629525510902446e+180,
+    1.974506857221074e+182, 2.2311927486598138e+184, 2.5435597334721877e+186, 2.925093693493016e+188,
+    3.393108684451898e+190, 3.969937160808721e+192, 4.684525849754291e+194, 5.574585761207606e+196,
+    6.689502913449127e+198, 8.094298525273444e+200, 9.875044200833601e+202, 1.214630436702533e+205,
+    1.506141741511141e+207, 1.882677176888926e+209, 2.372173242880047e+211, 3.0126600184576594e+213,
+    3.856204823625804e+215, 4.974504222477287e+217, 6.466855489220474e+219, 8.47158069087882e+221,
+    1.1182486511960043e+224, 1.4872707060906857e+226, 1.9929427461615188e+228, 2.6904727073180504e+230,
+    3.659042881952549e+232, 5.012888748274992e+234, 6.917786472619489e+236, 9.615723196941089e+238,
+    1.3462012475717526e+241, 1.898143759076171e+243, 2.695364137888163e+245, 3.854370717180073e+247,
+    5.5502938327393044e+249, 8.047926057471992e+251, 1.1749972043909107e+254, 1.727245890454639e+256,
+    2.5563239178728654e+258, 3.80892263763057e+260, 5.713383956445855e+262, 8.62720977423324e+264,
+    1.3113358856834524e+267, 2.0063439050956823e+269, 3.0897696138473508e+271, 4.789142901463394e+273,
+    7.471062926282894e+275, 1.1729568794264145e+278, 1.853271869493735e+280, 2.9467022724950384e+282,
+    4.7147236359920616e+284, 7.590705053947219e+286, 1.2296942187394494e+289, 2.0044015765453026e+291,
+    3.287218585534296e+293, 5.423910666131589e+295, 9.003691705778438e+297, 1.503616514864999e+300,
+    2.5260757449731984e+302, 4.269068009004705e+304, 7.257415615307999e+306,
+};
+
+/**
+ * \brief           A function used to calculate the factorial of a number
+ * \param[in]       args: An argument, a non-negative number
+ * \return          The factorial of a number, Γ(x + 1) for a non-integer x
+ * \note            Integers up to \ref CALC_FACT_TABLE_MAX take one load, larger integers overflow to infinity
+ */
+static double
+fact_s(const double* args) {
+    double x = args[0];
+    if (x == floor(x)) {
+        return x <= CALC_FACT_TABLE_MAX ? fact_table[(size_t)x] : INFINITY;
+    }
+    return tgamma(x + 1);                       /* Overflows to infinity above 171.62 */
+}
+
+/**
+ * \brief           A function used to calculate the logarithm of a number with a base
+ * \param[in]       args: A base of the logarithm followed by an argument
+ * \return          The logarithm of a number with a base
+ */
+static double
+log_s(const double* args) {
+    return log(args[1]) / log(args[0]);
+}
+
+/**
+ * \brief           A function used to calculate the logarithm of a number with a base 10
+ * \param[in]       args: An argument, above 0
+ * \return          The logarithm of a number with a base 10
+ */
+static double
+log10_s(const double* args) {
+    return log10(args[0]);
+}
+
+/**
+ * \brief           A function used to calculate the natural logarithm of a number
+ * \param[in]       args: An argument, above 0
+ * \return          The result of the calculation
+ */
+static double
+ln_s(const double* args) {
+    return log(args[0]);
+}
+
+/**
+ * \brief           A function used to calculate the minimum of two numbers
+ * \param[in]       args: Two arguments
+ * \return          The minimum of two numbers
+ * \note            Longer argument lists are folded into a chain of calls by the compiler
+ */
+static double
+min_s(const double* args) {
+    return args[1] < args[0] ? args[1] : args[0];
+}
+
+/**
+ * \brief           A function used to calculate the maximum of two numbers
+ * \param[in]       args: Two arguments
+ * \return          The maximum of two numbers
+ * \note            Longer argument lists are folded into a chain of calls by the compiler
+ */
+static double
+max_s(const double* args) {
+    return args[1] > args[0] ? args[1] : args[0];
+}
@@ -0,0 +1,492 @@
+/**
+ * \file            calc_integrate.c
+ * \brief           Adaptive Gauss-Kronrod integration of compiled expressions with batched, threaded evaluation
+ */
+
+/*
+ * Copyright (c) 2024 Daniil VERES
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * Author:          Daniil VERES <daniaveres@gmail.com>
+ * Version:         v1.0.0
+ */
+
+                            /* Functions used: */
+#include <float.h>          /* DBL_EPSILON, DBL_MIN */
+#include <math.h>           /* fabs, fmax, fmin, pow, isfinite, nan */
+#include <pthread.h>        /* pthread_create, pthread_join, pthread_mutex_lock, pthread_cond_wait */
+#include <stdint.h>         /* int64_t */
+#include <stdlib.h>         /* malloc, free, qsort */
+#include <string.h>         /* memmove, strcmp */
+#include "calc_internal.h"
+
+                                        /* Constants used: */
+#define CALC_INTEGRATE_MAX_INTERVALS 2000   /*!< The largest number of subintervals of an integration */
+#define CALC_INTEGRATE_MAX_SPLITS 16        /*!< The largest number of subintervals bisected in one round */
+#define INTEGRATE_NODES 15                  /*!< Nodes of the 15-point Kronrod rule, a superset of the nodes of the 7-point Gauss rule */
+#define INTEGRATE_MAX_ROWS (2 * CALC_INTEGRATE_MAX_SPLITS * INTEGRATE_NODES)   /*!< Nodes of the largest round */
+#define INTEGRATE_ROUNDING (50 * DBL_EPSILON) /*!< The relative rounding error of a rule, the smallest error it estimates */
+#define INTEGRATE_THREAD_ROWS 64            /*!< The smallest share of a thread, a block of the columnar evaluator */
+#define INTEGRATE_MAX_SHARES (INTEGRATE_MAX_ROWS / INTEGRATE_THREAD_ROWS)      /*!< The largest number of shares of a round */
+
+/**
+ * \brief           A subinterval of an integration with the results of the rule
+ */
+typedef struct {
+    double a;               /*!< The lower bound */
+    double b;               /*!< The upper bound */
+    double result;          /*!< The integral by the Kronrod rule */
+    double error;           /*!< The estimated error of \ref result */
+    double absolute;        /*!< The integral of the absolute value by the Kronrod rule, the scale of the tolerance */
+} integrate_interval_t;
+
+/**
+ * \brief           A share of the rows of a round evaluated by one thread
+ */
+typedef struct {
+    const calc_expr_t* expr;        /*!< The integrand */
+    const double** columns;         /*!< Columns of the variables, offset to the first row of the share */
+    double* values;                 /*!< Values of the integrand, offset to the first row of the share */
+    size_t rows;                    /*!< A number of rows */
+    calc_error_t error;             /*!< The error of the first failed row */
+} integrate_share_t;
+
+/**
+ * \brief           A thread of \ref integrate_pool_t
+ */
+typedef struct {
+    struct integrate_pool* pool;    /*!< The pool */
+    size_t index;                   /*!< The share of every round this thread evaluates */
+} integrate_worker_t;
+
+/**
+ * \brief           Threads sharing the rounds of an integration, started once and handed the shares of every round
+ */
+typedef struct integrate_pool {
+    pthread_mutex_t mutex;          /*!< Guards the fields below but \ref shares, which the calling thread fills between rounds */
+    pthread_cond_t start;           /*!< Signalled when a round is handed out or the threads are stopped */
+    pthread_cond_t done;            /*!< Signalled when the last share of a round is done */
+    pthread_t ids[INTEGRATE_MAX_SHARES];        /*!< The threads, the first one is unused as the calling thread takes share 0 */
+    integrate_worker_t workers[INTEGRATE_MAX_SHARES];   /*!< Arguments of the threads */
+    integrate_share_t shares[INTEGRATE_MAX_SHARES]; /*!< The shares of the current round, share `s` goes to thread `s` */
+    size_t threads;                 /*!< The largest number of threads, the calling thread included */
+    size_t started;                 /*!< A number of threads started, the calling thread included, 0 before the first round that needs them */
+    size_t share_count;             /*!< A number of shares of the current round */
+    size_t pending;                 /*!< A number of shares of the current round the threads have not done */
+    uint64_t round;                 /*!< A number of the rounds handed out */
+    uint8_t stop;                   /*!< Set to `1` when the threads have to exit */
+} integrate_pool_t;
+
+/**
+ * \brief           Abscissas of the 15-point Gauss-Kronrod rule on [0, 1], the odd ones are those of the 7-point Gauss rule
+ */
+static const double integrate_nodes[8] = {
+    0.991455371120812639206854697526329, 0.949107912342758524526189684047851, 0.864864423359769072789712788640926,
+    0.741531185599394439863864773280788, 0.586087235467691130294144845693013, 0.405845151377397166906606412076961,
+    0.207784955007898467600689403773245, 0.000000000000000000000000000000000,
+};
+
+/**
+ * \brief           Weights of the 15-point Kronrod rule for the abscissas of \ref integrate_nodes
+ */
+static const double integrate_kronrod[8] = {
+    0.022935322010529224963732008058970, 0.063092092629978553290700663189204, 0.104790010322250183839876322541518,
+    0.140653259715525918745189590510238, 0.169004726639267902826583426598550, 0.190350578064785409913256402421014,
+    0.204432940075298892414161999234649, 0.209482141084727828012999174891714,
+};
+
+/**
+ * \brief           Weights of the 7-point Gauss rule for the odd abscissas of \ref integrate_nodes
+ */
+static const double integrate_gauss[4] = {
+    0.129484966168869693270611432679082, 0.279705391489276667901467771423780, 0.381830050505118944950369775488975,
+    0.417959183673469387755102040816327,
+};
+
+static calc_error_code_t integrate_round(const calc_expr_t* expr, integrate_interval_t* intervals, size_t count, int64_t slot,
+                                         double* memory, const double** columns, integrate_pool_t* pool);  /* A function used to apply the rule to subintervals */
+static void integrate_rule(integrate_interval_t* interval, const double* values);  /* A function used to apply the rule to the values of a subinterval */
+static void integrate_share(integrate_share_t* share);                             /* A function used to evaluate a share of the rows of a round */
+static void integrate_start(integrate_pool_t* pool);                                /* A function used to start the threads of an integration */
+static void integrate_stop(integrate_pool_t* pool);                                 /* A function used to stop the threads of an integration */
+static void* integrate_worker(void* argument);                                      /* A function used to run a thread of an integration */
+static int compare_error(const void* a, const void* b);                             /* A function used to sort subintervals by error */
+
+/**
+ * \brief           A function used to integrate an expression over an interval of one of its variables
+ * \param[in]       expr: A compiled expression, the integrand
+ * \param[in]       name: A name of the variable of integration, a variable the expression does not use makes the integrand constant
+ * \param[in]       vars: Values of the variables indexed by slot, the value of the variable of integration is ignored,
+ *                      NULL if there are no other variables
+ * \param[in]       a: The lower bound, finite
+ * \param[in]       b: The upper bound, finite, may be less than `a`
+ * \param[in]       tolerance: The requested error relative to the integral of the absolute value of the integrand
+ * \param[in]       threads: A number of threads evaluating the integrand, `1` to evaluate it on the calling thread only
+ * \param[out]      estimate: The estimated absolute error of the result, may be NULL
+ * \param[out]      error: An error report, may be NULL
+ * \return          The integral, NaN in case of an error other than \ref CALC_ERROR_NOT_CONVERGED
+ * \note            The integration is globally adaptive: every subinterval is integrated by the 15-point Gauss-Kronrod rule,
+ *                  whose difference with the embedded 7-point Gauss rule estimates the error, and every round bisects
+ *                  the subintervals of the largest errors, as many as would meet the tolerance if they were integrated
+ *                  exactly, at most \ref CALC_INTEGRATE_MAX_SPLITS. The nodes of all the rules of a round are evaluated
+ *                  as one batch by \ref calc_eval_dual_columns, shared by up to `threads` threads when the batch is large
+ *                  enough; the threads are started by the first such round and serve the later ones, and the result
+ *                  does not depend on their number. The integrand is never evaluated
+ *                  at the bounds, so integrable singularities there are handled. A tolerance below the rounding error
+ *                  of the rule, \ref INTEGRATE_ROUNDING, is raised to it. If the tolerance is not met with
+ *                  \ref CALC_INTEGRATE_MAX_INTERVALS subintervals or at the resolution of doubles, or an infinite value
+ *                  at a node, as 1/0 is infinite, leaves no finite estimate, the integration fails with
+ *                  \ref CALC_ERROR_NOT_CONVERGED and the best result is returned with its estimate, e.g. for 1/x
+ *                  from -1 to 1. Another error of the integrand at a node fails the integration.
+ */
+double
+calc_integrate(const calc_expr_t* expr, const char* name, const double* vars, double a, double b, double tolerance,
+               size_t threads, double* estimate, calc_error_t* error) {
+    integrate_interval_t* intervals = NULL;     /* The subintervals, the first `count` are in use */
+    double* memory = NULL;                      /* The abscissas, the values and the columns of the other variables */
+    const double** columns = NULL;              /* Columns of the variables of every share of a round */
+    integrate_pool_t pool;                      /* The threads, started by the first round that needs them */
+    size_t count = 1;
+    calc_error_code_t code = CALC_OK;
+    double result = nan(""), total_error = nan("");
+    int64_t slot = -1;                          /* The slot of the variable of integration, -1 if the expression does not use it */
+
+    for (size_t k = 0; expr != NULL && name != NULL && k < expr->var_count; ++k) {
+        if (strcmp(expr->var_names[k], name) == 0) {
+            slot = (int64_t)k;
+        }
+    }
+    if (expr == NULL || expr->node_count == 0 || name == NULL) {
+        code = CALC_ERROR_UNKNOWN;
+    } else if ((expr->var_count > (slot >= 0 ? 1u : 0u) && vars == NULL) || !isfinite(a) || !isfinite(b)
+               || !(tolerance >= 0) || threads == 0) {
+        code = CALC_ERROR_INVALID_INPUT;
+    } else if ((intervals = (integrate_interval_t*)malloc((CALC_INTEGRATE_MAX_INTERVALS + CALC_INTEGRATE_MAX_SPLITS)
+                                                          * sizeof(integrate_interval_t))) == NULL
+               || (memory = (double*)malloc((expr->var_count + 2) * INTEGRATE_MAX_ROWS * sizeof(double))) == NULL
+               || (columns = (const double**)malloc((expr->var_count + 1) * INTEGRATE_MAX_SHARES * sizeof(const double*))) == NULL) {
+        code = CALC_ERROR_FAILED_TO_ALLOCATE_MEMORY;
+    } else {
+        for (size_t k = 0; k < expr->var_count; ++k) {     /* The other variables are constant columns */
+            for (size_t r = 0; (int64_t)k != slot && r < INTEGRATE_MAX_ROWS; ++r) {
+                memory[(k + 2) * INTEGRATE_MAX_ROWS + r] = vars[k];
+            }
+        }
+        tolerance = fmax(tolerance, INTEGRATE_ROUNDING);
+        pool.threads = threads < INTEGRATE_MAX_SHARES ? threads : INTEGRATE_MAX_SHARES;
+        pool.started = 0;
+        intervals[0].a = a;
+        intervals[0].b = b;
+        code = integrate_round(expr, intervals, 1, slot, memory, columns, &pool);
+        while (code == CALC_OK) {               /* Loop through the rounds of bisections */
+            double absolute = 0, excess, removed = 0;
+            size_t splits = 0;
+            result = 0;
+            total_error = 0;
+            for (size_t i = 0; i < count; ++i) {
+                result += intervals[i].result;
+                total_error += intervals[i].error;
+                absolute += intervals[i].absolute;
+            }
+            excess = total_error - tolerance * absolute;   /* The error the round has to remove */
+            if (excess <= 0) {
+                break;
+            } else if (!isfinite(excess) || count == CALC_INTEGRATE_MAX_INTERVALS) {
+                code = CALC_ERROR_NOT_CONVERGED;    /* No finite estimate, or no subintervals left */
+                break;
+            }
+            qsort(intervals, count, sizeof(integrate_interval_t), compare_error);  /* The largest errors first */
+            while (splits < CALC_INTEGRATE_MAX_SPLITS && splits < count && count + splits < CALC_INTEGRATE_MAX_INTERVALS
+                   && (splits == 0 || removed < excess)) {
+                const integrate_interval_t* interval = &intervals[splits];
+                double middle = 0.5 * (interval->a + interval->b);
+                if (middle == interval->a || middle == interval->b) {
+                    break;                      /* No room for more nodes, at the resolution of doubles */
+                }
+                removed += interval->error;
+                intervals[count + 2 * splits].a = interval->a;  /* The halves go to the end, as one batch */
+                intervals[count + 2 * splits].b = middle;
+                intervals[count + 2 * splits + 1].a = middle;
+                intervals[count + 2 * splits + 1].b = interval->b;
+                ++splits;
+            }
+            if (splits == 0) {
+                code = CALC_ERROR_NOT_CONVERGED;
+                break;
+            }
+            memmove(intervals, &intervals[splits], (count + splits) * sizeof(integrate_interval_t));  /* Drop the bisected ones */
+            count += splits;
+            code = integrate_round(expr, &intervals[count - 2 * splits], 2 * splits, slot, memory, columns, &pool);
+        }
+        if (pool.started > 0) {
+            integrate_stop(&pool);
+        }
+    }
+    free(intervals);
+    free(memory);
+    free(columns);
+    if (code != CALC_OK && code != CALC_ERROR_NOT_CONVERGED) {
+        result = nan("");
+        total_error = nan("");
+    }
+    if (estimate != NULL) {
+        *estimate = total_error;
+    }
+    if (error != NULL) {
+        error->code = code;
+        error->position = 0;
+    }
+    return result + 0.0;                        /* -0 is printed as 0 */
+}
+
+/**
+ * \brief           A function used to apply the rule to subintervals
+ * \param[in]       expr: The integrand
+ * \param[in,out]   intervals: Subintervals with the bounds set, the results are filled
+ * \param[in]       count: A number of subintervals, at most 2 \ref CALC_INTEGRATE_MAX_SPLITS
+ * \param[in]       slot: The slot of the variable of integration, -1 if the expression does not use it
+ * \param[in,out]   memory: The nodes of the subintervals, \ref INTEGRATE_NODES each, the values of the integrand at the nodes
+ *                      and the constant columns of the other variables, \ref INTEGRATE_MAX_ROWS each
+ * \param[out]      columns: Columns of the variables for every share, \ref INTEGRATE_MAX_SHARES times the number of variables
+ * \param[in,out]   pool: The threads, started here by the first round with more than one share
+ * \return          \ref CALC_OK on success, the error of the first failed node otherwise
+ * \note            The rows are shared in contiguous runs of at least \ref INTEGRATE_THREAD_ROWS, the calling thread takes
+ *                  the first one; a round of one share, as every round of a small batch, runs on the calling thread
+ *                  without waking the threads, and the shares of threads that could not be started are left to it.
+ */
+static calc_error_code_t
+integrate_round(const calc_expr_t* expr, integrate_interval_t* intervals, size_t count, int64_t slot,
+                double* memory, const double** columns, integrate_pool_t* pool) {
+    integrate_share_t* shares = pool->shares;
+    size_t handed = 0;                          /* Shares handed to the threads, from share 1 */
+    double* abscissas = memory;
+    double* values = &memory[INTEGRATE_MAX_ROWS];
+    size_t rows = count * INTEGRATE_NODES, share_count = rows / INTEGRATE_THREAD_ROWS;
+    calc_error_code_t code = CALC_OK;
+
+    for (size_t i = 0; i < count; ++i) {        /* Lay out the nodes, the centre in the middle */
+        double centre = 0.5 * (intervals[i].a + intervals[i].b);
+        double half = 0.5 * (intervals[i].b - intervals[i].a);
+        for (size_t j = 0; j < 7; ++j) {
+            abscissas[i * INTEGRATE_NODES + j] = centre - half * integrate_nodes[j];
+            abscissas[i * INTEGRATE_NODES + 14 - j] = centre + half * integrate_nodes[j];
+        }
+        abscissas[i * INTEGRATE_NODES + 7] = centre;
+    }
+    if (share_count > pool->threads) {
+        share_count = pool->threads;
+    }
+    if (share_count == 0) {
+        share_count = 1;
+    }
+    for (size_t s = 0; s < share_count; ++s) {
+        size_t first = rows * s / share_count, last = rows * (s + 1) / share_count;
+        shares[s].expr = expr;
+        shares[s].columns = &columns[s * expr->var_count];
+        shares[s].values = &values[first];
+        shares[s].rows = last - first;
+        shares[s].error.code = CALC_OK;
+        for (size_t k = 0; k < expr->var_count; ++k) {
+            shares[s].columns[k] = &((int64_t)k == slot ? abscissas : &memory[(k + 2) * INTEGRATE_MAX_ROWS])[first];
+        }
+    }
+    if (share_count > 1 && pool->started == 0) {
+        integrate_start(pool);
+    }
+    if (share_count > 1 && pool->started > 1) {
+        handed = (share_count < pool->started ? share_count : pool->started) - 1;
+        pthread_mutex_lock(&pool->mutex);
+        pool->share_count = share_count;
+        pool->pending = handed;
+        ++pool->round;
+        pthread_cond_broadcast(&pool->start);
+        pthread_mutex_unlock(&pool->mutex);
+    }
+    for (size_t s = 0; s < share_count; ++s) {
+        if (s == 0 || s > handed) {
+            integrate_share(&shares[s]);
+        }
+    }
+    if (handed > 0) {
+        pthread_mutex_lock(&pool->mutex);
+        while (pool->pending > 0) {             /* Loop until the threads are done with the round */
+            pthread_cond_wait(&pool->done, &pool->mutex);
+        }
+        pthread_mutex_unlock(&pool->mutex);
+    }
+    for (size_t s = 0; s < share_count; ++s) {
+        if (code == CALC_OK) {
+            code = shares[s].error.code;
+        }
+    }
+    for (size_t i = 0; code == CALC_OK && i < count; ++i) {
+        integrate_rule(&intervals[i], &values[i * INTEGRATE_NODES]);
+    }
+    return code;
+}
+
+/**
+ * \brief           A function used to apply the rule to the values of a subinterval
+ * \param[in,out]   interval: A subinterval with the bounds set, the results are filled
+ * \param[in]       values: Values of the integrand at the nodes of the subinterval, from the lower bound to the upper one
+ * \note            The error estimate is that of QUADPACK: the difference of the Kronrod and the Gauss results, scaled
+ *                  by the deviation of the integrand from its mean so that smooth integrands are not refined in vain,
+ *                  and not less than the rounding error of the sum
+ */
+static void
+integrate_rule(integrate_interval_t* interval, const double* values) {
+    double half = 0.5 * (interval->b - interval->a);
+    double centre = values[7];
+    double kronrod = centre * integrate_kronrod[7], gauss = centre * integrate_gauss[3];
+    double absolute = fabs(kronrod), deviation, mean, error;
+
+    for (size_t j = 0; j < 7; ++j) {
+        double sum = values[j] + values[14 - j];
+        kronrod += integrate_kronrod[j] * sum;
+        absolute += integrate_kronrod[j] * (fabs(values[j]) + fabs(values[14 - j]));
+        if (j % 2 == 1) {                       /* The odd abscissas are the Gauss nodes */
+            gauss += integrate_gauss[j / 2] * sum;
+        }
+    }
+    mean = 0.5 * kronrod;
+    deviation = integrate_kronrod[7] * fabs(centre - mean);
+    for (size_t j = 0; j < 7; ++j) {
+        deviation += integrate_kronrod[j] * (fabs(values[j] - mean) + fabs(values[14 - j] - mean));
+    }
+    absolute *= fabs(half);
+    deviation *= fabs(half);
+    error = fabs((kronrod - gauss) * half);
+    if (deviation != 0 && error != 0) {
+        error = deviation * fmin(1, pow(200 * error / deviation, 1.5));
+    }
+    if (absolute > DBL_MIN / INTEGRATE_ROUNDING) {
+        error = fmax(INTEGRATE_ROUNDING * absolute, error);
+    }
+    interval->result = kronrod * half;
+    interval->error = error;
+    interval->absolute = absolute;
+}
+
+/**
+ * \brief           A function used to evaluate a share of the rows of a round
+ * \param[in,out]   share: The share
+ */
+static void
+integrate_share(integrate_share_t* share) {
+    calc_eval_dual_columns(share->expr, share->rows, share->columns, share->values, NULL, &share->error);
+}
+
+/**
+ * \brief           A function used to start the threads of an integration
+ * \param[in,out]   pool: The threads, \ref integrate_pool_t.threads set, the others are initialized here
+ * \note            A thread that cannot be created ends the starting, its share and the following ones are left
+ *                  to the calling thread; \ref integrate_pool_t.started is at least 1 afterwards.
+ */
+static void
+integrate_start(integrate_pool_t* pool) {
+    pool->started = 1;
+    pool->share_count = 0;
+    pool->pending = 0;
+    pool->round = 0;
+    pool->stop = 0;
+    pthread_mutex_init(&pool->mutex, NULL);
+    pthread_cond_init(&pool->start, NULL);
+    pthread_cond_init(&pool->done, NULL);
+    while (pool->started < pool->threads) {
+        pool->workers[pool->started].pool = pool;
+        pool->workers[pool->started].index = pool->started;
+        if (pthread_create(&pool->ids[pool->started], NULL, integrate_worker, &pool->workers[pool->started]) != 0) {
+            break;
+        }
+        ++pool->started;
+    }
+}
+
+/**
+ * \brief           A function used to stop the threads of an integration
+ * \param[in,out]   pool: The threads started by \ref integrate_start
+ */
+static void
+integrate_stop(integrate_pool_t* pool) {
+    pthread_mutex_lock(&pool->mutex);
+    pool->stop = 1;
+    pthread_cond_broadcast(&pool->start);
+    pthread_mutex_unlock(&pool->mutex);
+    for (size_t t = 1; t < pool->started; ++t) {
+        pthread_join(pool->ids[t], NULL);
+    }
+    pthread_mutex_destroy(&pool->mutex);
+    pthread_cond_destroy(&pool->start);
+    pthread_cond_destroy(&pool->done);
+}
+
+/**
+ * \brief           A function used to run a thread of an integration
+ * \param[in]       argument: The thread, \ref integrate_worker_t
+ * \return          NULL
+ * \note            The thread waits for every round and evaluates its share if the round has one
+ */
+static void*
+integrate_worker(void* argument) {
+    const integrate_worker_t* worker = (const integrate_worker_t*)argument;
+    integrate_pool_t* pool = worker->pool;
+    uint64_t round = 0;
+
+    pthread_mutex_lock(&pool->mutex);
+    for (;;) {                                  /* Loop through the rounds until the threads are stopped */
+        while (!pool->stop && pool->round == round) {
+            pthread_cond_wait(&pool->start, &pool->mutex);
+        }
+        if (pool->stop) {
+            break;
+        }
+        round = pool->round;
+        if (worker->index < pool->share_count) {
+            pthread_mutex_unlock(&pool->mutex);
+            integrate_share(&pool->shares[worker->index]);
+            pthread_mutex_lock(&pool->mutex);
+            if (--pool->pending == 0) {
+                pthread_cond_signal(&pool->done);
+            }
+        }
+    }
+    pthread_mutex_unlock(&pool->mutex);
+    return NULL;
+}
+
+/**
+ * \brief           A function used to sort subintervals by error
+ * \param[in]       a: A subinterval
+ * \param[in]       b: A subinterval
+ * \return          A negative value if `a` has the larger error, a positive one if `b` has, otherwise by the lower bound
+ * \note            The lower bounds of the subintervals differ, so the order does not depend on the sort
+ */
+static int
+compare_error(const void* a, const void* b) {
+    const integrate_interval_t* x = (const integrate_interval_t*)a;
+    const integrate_interval_t* y = (const integrate_interval_t*)b;
+
+    if (x->error != y->error) {
+        return x->error > y->error ? -1 : 1;
+    }
+    return (x->a > y->a) - (x->a < y->a);
+}
@@ -0,0 +1,200 @@
+/**
+ * \file            calc_internal.h
+ * \brief           Internal definitions shared by the modules of the calculator library
+ */
+
+/*
+ * Copyright (c) 2024 Daniil VERES
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * Author:          Daniil VERES <daniaveres@gmail.com>
+ * Version:         v1.0.0
+ */
+
+#ifndef CALC_INTERNAL_HDR_H
+#define CALC_INTERNAL_HDR_H
+
+#include <stddef.h> /* size_t */
+#include <stdint.h> /* uint8_t, int32_t, int64_t */
+#include "calc.h"
+
+#define CALC_POWI_MAX 64                /*!< The largest absolute integer exponent of a \ref CALC_OP_POWI node, raised by squaring */
+
+/**
+ * \brief           Enumeration representing the math functions, the index into \ref calc_functions
+ */
+typedef enum {
+    CALC_FN_SQRT = 0,   /*!< Square root */
+    CALC_FN_LN,         /*!< Natural logarithm */
+    CALC_FN_EXP,        /*!< Exponential function */
+    CALC_FN_SIN,        /*!< Sine */
+    CALC_FN_COS,        /*!< Cosine */
+    CALC_FN_TAN,        /*!< Tangent */
+    CALC_FN_CTAN,       /*!< Cotangent */
+    CALC_FN_ASIN,       /*!< Arc sine */
+    CALC_FN_ACOS,       /*!< Arc cosine */
+    CALC_FN_ATAN,       /*!< Arc tangent */
+    CALC_FN_ACTAN,      /*!< Arc cotangent */
+    CALC_FN_SINH,       /*!< Hyperbolic sine */
+    CALC_FN_COSH,       /*!< Hyperbolic cosine */
+    CALC_FN_TANH,       /*!< Hyperbolic tangent */
+    CALC_FN_CTANH,      /*!< Hyperbolic cotangent */
+    CALC_FN_ASINH,      /*!< Hyperbolic arc sine */
+    CALC_FN_ACOSH,      /*!< Hyperbolic arc cosine */
+    CALC_FN_ATANH,      /*!< Hyperbolic arc tangent */
+    CALC_FN_ACTANH,     /*!< Hyperbolic arc cotangent */
+    CALC_FN_FABS,       /*!< Absolute value */
+    CALC_FN_CEIL,       /*!< Ceiling value */
+    CALC_FN_FLOOR,      /*!< Floor value */
+    CALC_FN_ROUND,      /*!< Rounded value */
+    CALC_FN_TRUNC,      /*!< Truncated value */
+    CALC_FN_SIGN,       /*!< Sign */
+    CALC_FN_RAD,        /*!< Degrees to radians */
+    CALC_FN_DEG,        /*!< Radians to degrees */
+    CALC_FN_FACT,       /*!< Factorial */
+    CALC_FN_LOG,        /*!< Logarithm with a base, the base is the first argument */
+    CALC_FN_LOG10,      /*!< Decimal logarithm */
+    CALC_FN_MIN,        /*!< Minimum value */
+    CALC_FN_MAX,        /*!< Maximum value */
+    CALC_FN_COUNT       /*!< A number of math functions */
+} calc_function_id_t;
+
+/**
+ * \brief           Enumeration representing operations of a compiled expression
+ */
+typedef enum {
+    CALC_OP_CONST = 0,  /*!< A numeric literal */
+    CALC_OP_VAR,        /*!< A variable, read from the array passed to \ref calc_eval */
+    CALC_OP_NEG,        /*!< Unary minus */
+    CALC_OP_ADD,        /*!< Addition */
+    CALC_OP_SUB,        /*!< Subtraction */
+    CALC_OP_MUL,        /*!< Multiplication */
+    CALC_OP_DIV,        /*!< Division ('/' or ':') */
+    CALC_OP_MOD,        /*!< Division remainder */
+    CALC_OP_POW,        /*!< Raising to the power */
+    CALC_OP_CALL,       /*!< A call of the math function \ref calc_node_t::fn with one or two operands */
+    CALC_OP_POWI,       /*!< Raising to a constant integer power, the exponent is \ref calc_node_t::value */
+    CALC_OP_GUARD       /*!< The value of the first operand, calculated only where the second one is, built by \ref calc_diff */
+} calc_op_t;
+
+#ifdef __SIZEOF_INT128__
+typedef __int128 calc_int_t;            /*!< The widest native integer, the type of exact integer values */
+typedef unsigned __int128 calc_uint_t;  /*!< The unsigned counterpart of \ref calc_int_t */
+#else
+typedef int64_t calc_int_t;             /*!< The widest native integer, the type of exact integer values */
+typedef uint64_t calc_uint_t;           /*!< The unsigned counterpart of \ref calc_int_t */
+#endif /* __SIZEOF_INT128__ */
+
+/**
+ * \brief           A numeric literal as written in the source, its value is \ref digits divided by 10 to the power of \ref scale
+ */
+typedef struct {
+    char* digits;           /*!< A NUL-terminated string of the decimal digits, without the point */
+    int32_t scale;          /*!< A number of digits after the point */
+    calc_int_t integer;     /*!< The value of an integer literal, valid when the node of the literal is exact */
+} calc_literal_t;
+
+/**
+ * \brief           A node of a compiled expression
+ * \note            Nodes are stored in postfix order: operands always precede the node using them, the last node is the root
+ */
+typedef struct {
+    uint8_t op;         /*!< Operation, one of \ref calc_op_t */
+    uint8_t fn;         /*!< Math function of a \ref CALC_OP_CALL node, one of \ref calc_function_id_t */
+    uint8_t exact;      /*!< Set to `1` when the node is an integer operation on integer operands, see \ref calc_eval_exact */
+    int32_t a;          /*!< Index of the first operand node, a variable slot for \ref CALC_OP_VAR,
+                                or an index in \ref calc_expr::literals for \ref CALC_OP_CONST */
+    int32_t b;          /*!< Index of the second operand node, -1 for unary operations */
+    double value;       /*!< Value of a \ref CALC_OP_CONST node, the exponent of a \ref CALC_OP_POWI node */
+} calc_node_t;
+
+/**
+ * \brief           A compiled expression
+ */
+struct calc_expr {
+    calc_node_t* nodes;     /*!< Nodes in postfix order */
+    size_t node_count;      /*!< A number of nodes */
+    char** var_names;       /*!< Names of the variables, the index is the variable slot */
+    size_t var_count;       /*!< A number of variables */
+    calc_literal_t* literals;   /*!< The literals in the order of their nodes */
+    size_t literal_count;   /*!< A number of literals */
+    uint8_t has_exact;      /*!< Set to `1` when an operation is exact, so \ref calc_eval_exact has work to do */
+};
+
+/**
+ * \brief           An entry of the tape of a reverse-mode evaluation, the partial derivatives of a node with respect to its operands
+ * \note            The operands are not recorded, they are read from the node of the same index
+ */
+typedef struct {
+    double dx;              /*!< The partial derivative with respect to the first operand */
+    double dy;              /*!< The partial derivative with respect to the second operand, 0 for unary operations */
+} calc_tape_entry_t;
+
+/**
+ * \brief           The registry of math functions as a list of `X(id, name, impl, arity, variadic, pure, domain)` entries
+ * \note            Both \ref calc_functions and the profiled registry are built from it at compile time, so they cannot drift apart
+ */
+#define CALC_FUNCTION_LIST(X)                                        \
+    X(SQRT,   "sqrt",   sqrt_s,   1, 0, 1, CALC_DOMAIN_NON_NEGATIVE) \
+    X(LN,     "ln",     ln_s,     1, 0, 1, CALC_DOMAIN_POSITIVE)     \
+    X(EXP,    "exp",    exp_s,    1, 0, 1, CALC_DOMAIN_ALL)          \
+    X(SIN,    "sin",    sin_s,    1, 0, 1, CALC_DOMAIN_ALL)          \
+    X(COS,    "cos",    cos_s,    1, 0, 1, CALC_DOMAIN_ALL)          \
+    X(TAN,    "tan",    tan_s,    1, 0, 1, CALC_DOMAIN_COS_NON_ZERO) \
+    X(CTAN,   "ctan",   ctan_s,   1, 0, 1, CALC_DOMAIN_SIN_NON_ZERO) \
+    X(ASIN,   "asin",   asin_s,   1, 0, 1, CALC_DOMAIN_UNIT_CLOSED)  \
+    X(ACOS,   "acos",   acos_s,   1, 0, 1, CALC_DOMAIN_UNIT_CLOSED)  \
+    X(ATAN,   "atan",   atan_s,   1, 0, 1, CALC_DOMAIN_ALL)          \
+    X(ACTAN,  "actan",  actan_s,  1, 0, 1, CALC_DOMAIN_ALL)          \
+    X(SINH,   "sinh",   sinh_s,   1, 0, 1, CALC_DOMAIN_ALL)          \
+    X(COSH,   "cosh",   cosh_s,   1, 0, 1, CALC_DOMAIN_ALL)          \
+    X(TANH,   "tanh",   tanh_s,   1, 0, 1, CALC_DOMAIN_ALL)          \
+    X(CTANH,  "ctanh",  ctanh_s,  1, 0, 1, CALC_DOMAIN_NON_ZERO)     \
+    X(ASINH,  "asinh",  asinh_s,  1, 0, 1, CALC_DOMAIN_ALL)          \
+    X(ACOSH,  "acosh",  acosh_s,  1, 0, 1, CALC_DOMAIN_AT_LEAST_ONE) \
+    X(ATANH,  "atanh",  atanh_s,  1, 0, 1, CALC_DOMAIN_UNIT_OPEN)    \
+    X(ACTANH, "actanh", actanh_s, 1, 0, 1, CALC_DOMAIN_UNIT_OPEN)    \
+    X(FABS,   "abs",    fabs_s,   1, 0, 1, CALC_DOMAIN_ALL)          \
+    X(CEIL,   "ceil",   ceil_s,   1, 0, 1, CALC_DOMAIN_ALL)          \
+    X(FLOOR,  "floor",  floor_s,  1, 0, 1, CALC_DOMAIN_ALL)          \
+    X(ROUND,  "round",  round_s,  1, 0, 1, CALC_DOMAIN_ALL)          \
+    X(TRUNC,  "trunc",  trunc_s,  1, 0, 1, CALC_DOMAIN_ALL)          \
+    X(SIGN,   "sign",   sign_s,   1, 0, 1, CALC_DOMAIN_ALL)          \
+    X(RAD,    "rad",    rad_s,    1, 0, 1, CALC_DOMAIN_ALL)          \
+    X(DEG,    "deg",    deg_s,    1, 0, 1, CALC_DOMAIN_ALL)          \
+    X(FACT,   "fact",   fact_s,   1, 0, 1, CALC_DOMAIN_NON_NEGATIVE) \
+    X(LOG,    "log",    log_s,    2, 0, 1, CALC_DOMAIN_LOG_BASE)     \
+    X(LOG10,  "lg",     log10_s,  1, 0, 1, CALC_DOMAIN_POSITIVE)     \
+    X(MIN,    "min",    min_s,    2, 1, 1, CALC_DOMAIN_ALL)          \
+    X(MAX,    "max",    max_s,    2, 1, 1, CALC_DOMAIN_ALL)
+
+extern const calc_function_t calc_functions[CALC_FN_COUNT];    /*!< The registry of math functions, indexed by \ref calc_function_id_t */
+extern const calc_function_t* _Atomic calc_dispatch;            /*!< The registry used by the evaluator, swapped while profiling */
+
+int32_t calc_function_index(const char* name, size_t length);
+uint8_t calc_domain_contains(calc_domain_t domain, const double* args);
+double  calc_apply_node(const calc_node_t* node, double x, double y, const double* vars, const calc_function_t* functions, calc_error_code_t* code);
+uint8_t calc_exact_function(calc_function_id_t fn);
+void    calc_node_partials(const calc_node_t* node, double x, double y, double value, double* dx, double* dy);
+uint8_t calc_context_reserve_tape(calc_context_t* context, size_t count, double** values, calc_tape_entry_t** tape);
+
+#endif /* CALC_INTERNAL_HDR_H */
@@ -0,0 +1,860 @@
+/**
+ * \file            calc_interval.c
+ * \brief           Interval evaluation with outward rounding, both bounds in one SSE2 register
+ */
+
+/*
+ * Copyright (c) 2024 Daniil VERES
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * Author:          Daniil VERES <daniaveres@gmail.com>
+ * Version:         v1.0.0
+ */
+
+                            /* Functions used: */
+#include <fenv.h>           /* fegetround, fesetround, FE_UPWARD, FE_DOWNWARD, FE_TONEAREST */
+#include <float.h>          /* DBL_MAX */
+#include <math.h>           /* sqrt, log, exp, sin, cos, tan, atan, pow, fmod, floor, ceil, trunc, fabs, isnan, isfinite, INFINITY, NAN */
+#include <stdio.h>          /* snprintf */
+#include <stdlib.h>         /* malloc, free */
+#ifdef __SSE2__
+#include <emmintrin.h>      /* __m128d, _mm_add_pd, _mm_mul_pd, _mm_div_pd, _mm_max_pd, _mm_getcsr, _mm_setcsr */
+#endif /* __SSE2__ */
+#include "calc_internal.h"
+
+                                        /* Constants used: */
+#define CALC_INTERVAL_STACK_NODES 128   /*!< Number of node values kept on the stack by \ref calc_eval_interval before falling back to the heap */
+#define INTERVAL_LIBM_ERROR 0x1p-50     /*!< A relative bound of the error of the math library, 4 units in the last place */
+#define INTERVAL_GAMMA_ERROR 0x1p-40    /*!< A relative bound of the error of tgamma, the least accurate function used */
+#define INTERVAL_TINY 0x1p-1070         /*!< An absolute bound of the error of a subnormal result */
+#define INTERVAL_POWI_MAX 64            /*!< The largest absolute integer exponent raised by squaring intervals, like \ref powi */
+#define INTERVAL_REDUCE_MAX 0x1p50      /*!< The largest argument whose multiples of pi are located, beyond it sin and cos span [-1, 1] */
+#define INTERVAL_PI_LO 0x1.921fb54442d18p+1 /*!< pi rounded down */
+#define INTERVAL_PI_HI 0x1.921fb54442d19p+1 /*!< pi rounded up */
+#define INTERVAL_GAMMA_MIN 0.885603194410888    /*!< A bound below the smallest factorial of a non-negative number, Γ(1.4616...) */
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846     /*!< Pi number */
+#endif /* M_PI */
+
+#ifdef __SSE2__
+#define INTERVAL_MXCSR_ROUNDING 0x6000u /*!< Rounding control bits of MXCSR */
+#define INTERVAL_MXCSR_UPWARD 0x4000u   /*!< Rounding towards +infinity in MXCSR */
+
+typedef unsigned int interval_rounding_t;   /*!< A saved rounding mode, the whole MXCSR */
+typedef __m128d interval_t;                 /*!< An interval held as the pair (-lo, hi) in one register, lo in the low lane */
+
+/**
+ * \brief           Keeps the compiler from moving the calculation of a value across a change of the rounding mode
+ */
+#define INTERVAL_BARRIER(v) __asm__ volatile("" : "+x"(v))
+#else
+typedef int interval_rounding_t;            /*!< A saved rounding mode, as returned by fegetround */
+
+/**
+ * \brief           An interval held as the pair (-lo, hi), so that rounding upwards rounds both bounds outwards
+ */
+typedef struct {
+    double neg_lo;                  /*!< The lower bound negated */
+    double hi;                      /*!< The upper bound */
+} interval_t;
+
+/**
+ * \brief           Keeps the compiler from moving the calculation of a value across a change of the rounding mode
+ */
+#define INTERVAL_BARRIER(v) __asm__ volatile("" : "+m"(v))
+#endif /* __SSE2__ */
+
+static interval_rounding_t rounding_save(void);                             /* A function used to get the current rounding mode */
+static void rounding_set(interval_rounding_t saved, uint8_t upward);        /* A function used to round upwards or to nearest */
+static void rounding_restore(interval_rounding_t saved);                    /* A function used to restore a saved rounding mode */
+static interval_t interval_make(double lo, double hi);                      /* A function used to make an interval of its bounds */
+static double interval_lo(interval_t x);                                    /* A function used to get the lower bound */
+static double interval_hi(interval_t x);                                    /* A function used to get the upper bound */
+static interval_t interval_neg(interval_t x);                               /* A function used to negate an interval */
+static interval_t interval_add(interval_t x, interval_t y);                 /* A function used to add intervals */
+static interval_t interval_mul(interval_t x, interval_t y);                 /* A function used to multiply intervals */
+static interval_t interval_div(interval_t x, interval_t y);                 /* A function used to divide intervals */
+static interval_t interval_widen(double lo, double hi, double error);       /* A function used to enclose bounds calculated with an error */
+static interval_t interval_libm(double (*f)(double), double lo, double hi, uint8_t decreasing, double error, interval_rounding_t saved);  /* A function used to enclose a monotonic function */
+static interval_t interval_literal(const calc_literal_t* literal, double value);    /* A function used to enclose a literal */
+static interval_t interval_powi(interval_t x, double n);                    /* A function used to raise an interval to an integer power */
+static interval_t interval_pow(interval_t x, interval_t y, interval_rounding_t saved);  /* A function used to raise an interval to an interval power */
+static interval_t interval_mod(interval_t x, interval_t y);                 /* A function used to calculate a division remainder of intervals */
+static int interval_side(double x, double k, double offset);                /* A function used to compare a number with a multiple of pi */
+static uint8_t interval_multiples(double lo, double hi, double offset);     /* A function used to find multiples of pi in an interval */
+static interval_t interval_call(calc_function_id_t fn, interval_t x, interval_t y, interval_rounding_t saved, calc_error_code_t* code);  /* A function used to enclose a math function */
+static interval_t apply_interval(const calc_node_t* node, interval_t x, interval_t y, interval_rounding_t saved, calc_error_code_t* code);  /* A function used to calculate an operation on intervals */
+
+/**
+ * \brief           A function used to evaluate an expression in interval arithmetic
+ * \param[in]       expr: A compiled expression
+ * \param[in]       vars: Intervals of the variables, NULL if the expression has none
+ * \param[out]      result: An interval enclosing the exact result, may be NULL
+ * \param[out]      error: An error report, may be NULL
+ * \return          The midpoint of the result, NaN in case of an error
+ * \note            Every value is an interval [lo, hi] held as (-lo, hi) in one SSE2 register. The evaluation rounds upwards,
+ *                  so a single instruction rounds both bounds outwards. Math functions take the bounds from the math library
+ *                  in rounding to nearest and widen them by a bound of its error, non-monotonic ones also check their extrema.
+ *                  Literals are enclosed in their neighbouring doubles unless a double holds them exactly. An argument partly
+ *                  out of the domain of a function is cut to the domain, one entirely out of it is an error. A division by
+ *                  an interval containing 0 gives an unbounded interval, a power of a negative base counts only for an integer
+ *                  exponent, and a result which is NaN in double precision is [NaN, NaN]. Calls are not counted by the function profile.
+ */
+double
+calc_eval_interval(const calc_expr_t* expr, const calc_interval_t* vars, calc_interval_t* result, calc_error_t* error) {
+    interval_t stack_values[CALC_INTERVAL_STACK_NODES];    /* Values of the nodes for small expressions */
+    interval_t* values = stack_values;
+    calc_error_code_t code = CALC_OK;
+    calc_interval_t root = {nan(""), nan("")};
+
+    if (expr == NULL || expr->node_count == 0) {
+        code = CALC_ERROR_UNKNOWN;
+    } else if (expr->var_count > 0 && vars == NULL) {
+        code = CALC_ERROR_INVALID_INPUT;
+    } else if (expr->node_count > CALC_INTERVAL_STACK_NODES
+               && (values = (interval_t*)malloc(expr->node_count * sizeof(interval_t))) == NULL) {
+        code = CALC_ERROR_FAILED_TO_ALLOCATE_MEMORY;
+    } else {
+        interval_rounding_t saved = rounding_save();
+        for (size_t i = 0; i < expr->var_count; ++i) {
+            if (!(vars[i].lo <= vars[i].hi)) {  /* Also NaN bounds */
+                code = CALC_ERROR_INVALID_INPUT;
+            }
+        }
+        rounding_set(saved, 1);                 /* Every operation rounds outwards from here on */
+        for (size_t i = 0; code == CALC_OK && i < expr->node_count; ++i) {     /* Loop through all nodes in postfix order */
+            const calc_node_t* node = &expr->nodes[i];
+            interval_t x, y = interval_make(0, 0);
+            if (node->op == CALC_OP_CONST) {
+                values[i] = interval_literal(&expr->literals[node->a], node->value);
+                continue;
+            } else if (node->op == CALC_OP_VAR) {
+                values[i] = interval_make(vars[node->a].lo, vars[node->a].hi);
+                continue;
+            }
+            x = values[node->a];
+            INTERVAL_BARRIER(x);
+            if (node->b >= 0) {
+                y = values[node->b];
+                INTERVAL_BARRIER(y);
+            }
+            values[i] = apply_interval(node, x, y, saved, &code);
+            INTERVAL_BARRIER(values[i]);
+        }
+        rounding_restore(saved);
+        if (code == CALC_OK) {
+            root.lo = interval_lo(values[expr->node_count - 1]);   /* The last node is the root */
+            root.hi = interval_hi(values[expr->node_count - 1]);
+        }
+        if (values != stack_values) {
+            free(values);
+        }
+    }
+    if (code != CALC_OK) {
+        root.lo = root.hi = nan("");
+    }
+    if (result != NULL) {
+        *result = root;
+    }
+    if (error != NULL) {
+        error->code = code;
+        error->position = 0;
+    }
+    if (isfinite(root.lo) && isfinite(root.hi)) {
+        return root.lo + (root.hi - root.lo) / 2;
+    }
+    return root.lo == root.hi ? root.lo : nan("");     /* An infinity, or no single midpoint */
+}
+
+/**
+ * \brief           A function used to format a result of an interval evaluation
+ * \param[in]       result: The result
+ * \param[out]      buffer: A buffer for the text
+ * \param[in]       size: Size of the buffer
+ * \return          Length of the text, as returned by snprintf
+ * \note            The bounds are printed as `[lo, hi]` with 17 significant digits, which tell every double apart.
+ *                  They are printed rounding outwards, where the C library follows the rounding mode (glibc does)
+ */
+int
+calc_format_interval(const calc_interval_t* result, char* buffer, size_t size) {
+    int saved = fegetround();
+    int len, hi_len;
+    fesetround(FE_DOWNWARD);
+    len = snprintf(buffer, size, "[%.17g, ", result->lo);
+    fesetround(FE_UPWARD);
+    hi_len = snprintf(len >= 0 && (size_t)len < size ? buffer + len : NULL, len >= 0 && (size_t)len < size ? size - (size_t)len : 0,
+                      "%.17g]", result->hi);
+    fesetround(saved);
+    return len < 0 || hi_len < 0 ? -1 : len + hi_len;
+}
+
+/**
+ * \brief           A function used to get the current rounding mode
+ * \return          The rounding mode, to be passed to \ref rounding_set and \ref rounding_restore
+ */
+static inline interval_rounding_t
+rounding_save(void) {
+#ifdef __SSE2__
+    return _mm_getcsr();
+#else
+    return fegetround();
+#endif /* __SSE2__ */
+}
+
+/**
+ * \brief           A function used to round upwards or to nearest
+ * \param[in]       saved: The rounding mode saved by \ref rounding_save
+ * \param[in]       upward: Set to `1` to round towards +infinity, `0` to round to nearest
+ * \note            Only the rounding bits of MXCSR are changed, so the math library keeps its exception masks
+ */
+static inline void
+rounding_set(interval_rounding_t saved, uint8_t upward) {
+#ifdef __SSE2__
+    _mm_setcsr((saved & ~INTERVAL_MXCSR_ROUNDING) | (upward ? INTERVAL_MXCSR_UPWARD : 0));
+#else
+    (void)saved;
+    fesetround(upward ? FE_UPWARD : FE_TONEAREST);
+#endif /* __SSE2__ */
+}
+
+/**
+ * \brief           A function used to restore a saved rounding mode
+ * \param[in]       saved: The rounding mode saved by \ref rounding_save
+ */
+static inline void
+rounding_restore(interval_rounding_t saved) {
+#ifdef __SSE2__
+    _mm_setcsr(saved);
+#else
+    fesetround(saved);
+#endif /* __SSE2__ */
+}
+
+/**
+ * \brief           A function used to make an interval of its bounds
+ * \param[in]       lo: The lower bound
+ * \param[in]       hi: The upper bound
+ * \return          The interval
+ */
+static inline interval_t
+interval_make(double lo, double hi) {
+#ifdef __SSE2__
+    return _mm_set_pd(hi, -lo);
+#else
+    interval_t x = {-lo, hi};
+    return x;
+#endif /* __SSE2__ */
+}
+
+/**
+ * \brief           A function used to get the lower bound of an interval
+ * \param[in]       x: The interval
+ * \return          The lower bound
+ */
+static inline double
+interval_lo(interval_t x) {
+#ifdef __SSE2__
+    return -_mm_cvtsd_f64(x);
+#else
+    return -x.neg_lo;
+#endif /* __SSE2__ */
+}
+
+/**
+ * \brief           A function used to get the upper bound of an interval
+ * \param[in]       x: The interval
+ * \return          The upper bound
+ */
+static inline double
+interval_hi(interval_t x) {
+#ifdef __SSE2__
+    return _mm_cvtsd_f64(_mm_unpackhi_pd(x, x));
+#else
+    return x.hi;
+#endif /* __SSE2__ */
+}
+
+/**
+ * \brief           A function used to negate an interval
+ * \param[in]       x: The interval
+ * \return          The interval [-hi, -lo], exact as it swaps the lanes
+ */
+static inline interval_t
+interval_neg(interval_t x) {
+#ifdef __SSE2__
+    return _mm_shuffle_pd(x, x, 1);
+#else
+    interval_t r = {x.hi, x.neg_lo};
+    return r;
+#endif /* __SSE2__ */
+}
+
+/**
+ * \brief           A function used to add intervals
+ * \param[in]       x: The first interval
+ * \param[in]       y: The second interval
+ * \return          The sum [lo_x + lo_y, hi_x + hi_y], both bounds in one addition rounding upwards
+ */
+static inline interval_t
+interval_add(interval_t x, interval_t y) {
+#ifdef __SSE2__
+    return _mm_add_pd(x, y);
+#else
+    interval_t r = {x.neg_lo + y.neg_lo, x.hi + y.hi};
+    return r;
+#endif /* __SSE2__ */
+}
+
+/**
+ * \brief           A function used to multiply intervals
+ * \param[in]       x: The first interval
+ * \param[in]       y: The second interval
+ * \return          The product, the smallest and the largest of the products of the bounds
+ * \note            The four products are calculated with their negations in the other lane, so that rounding upwards gives
+ *                  both bounds rounded outwards without branches on the signs. A product of 0 and an infinity is NaN and skipped,
+ *                  when all of them are, as for [0, 0] times [-inf, inf], the product is NaN as in double precision.
+ */
+static interval_t
+interval_mul(interval_t x, interval_t y) {
+#ifdef __SSE2__
+    const __m128d flip_lo = _mm_set_pd(0.0, -0.0), flip_hi = _mm_set_pd(-0.0, 0.0);
+    __m128d x0 = _mm_unpacklo_pd(x, x), x1 = _mm_unpackhi_pd(x, x);     /* (-a, -a) and (b, b) of x = [a, b] */
+    __m128d y0 = _mm_unpacklo_pd(y, y), y1 = _mm_unpackhi_pd(y, y);     /* (-c, -c) and (d, d) of y = [c, d] */
+    __m128d r = _mm_set1_pd(-INFINITY);
+    if (_mm_movemask_pd(_mm_cmpunord_pd(x, y)) != 0) {
+        return _mm_set1_pd(NAN);
+    }
+    r = _mm_max_pd(_mm_mul_pd(x0, _mm_xor_pd(y0, flip_lo)), r);        /* (-ac, ac), a NaN in the first operand is skipped */
+    r = _mm_max_pd(_mm_mul_pd(x0, _mm_xor_pd(y1, flip_hi)), r);        /* (-ad, ad) */
+    r = _mm_max_pd(_mm_mul_pd(x1, _mm_xor_pd(y0, flip_hi)), r);        /* (-bc, bc) */
+    r = _mm_max_pd(_mm_mul_pd(x1, _mm_xor_pd(y1, flip_lo)), r);        /* (-bd, bd) */
+    if (_mm_movemask_pd(_mm_cmpeq_pd(r, _mm_set1_pd(-INFINITY))) == 3) {  /* Every product has been skipped */
+        return _mm_set1_pd(NAN);
+    }
+    return r;
+#else
+    interval_t r;
+    if (isnan(x.neg_lo) || isnan(x.hi) || isnan(y.neg_lo) || isnan(y.hi)) {
+        r.neg_lo = r.hi = NAN;
+        return r;
+    }
+    r.neg_lo = fmax(fmax(x.neg_lo * -y.neg_lo, x.neg_lo * y.hi), fmax(x.hi * y.neg_lo, x.hi * -y.hi));
+    r.hi = fmax(fmax(x.neg_lo * y.neg_lo, x.neg_lo * -y.hi), fmax(x.hi * -y.neg_lo, x.hi * y.hi));
+    if (isnan(r.neg_lo) || isnan(r.hi)) {       /* Every product has been skipped */
+        r.neg_lo = r.hi = NAN;
+    }
+    return r;
+#endif /* __SSE2__ */
+}
+
+/**
+ * \brief           A function used to divide intervals
+ * \param[in]       x: The dividend
+ * \param[in]       y: The divisor
+ * \return          The quotient, unbounded on a side where the divisor reaches 0
+ */
+static interval_t
+interval_div(interval_t x, interval_t y) {
+    double a = interval_lo(x), b = interval_hi(x), c = interval_lo(y), d = interval_hi(y);
+    if (isnan(a) || isnan(b) || isnan(c) || isnan(d)) {
+        return interval_make(NAN, NAN);
+    } else if (c > 0 || d < 0) {                /* The quotients of the bounds, as the products */
+#ifdef __SSE2__
+        const __m128d flip_lo = _mm_set_pd(0.0, -0.0), flip_hi = _mm_set_pd(-0.0, 0.0);
+        __m128d x0 = _mm_unpacklo_pd(x, x), x1 = _mm_unpackhi_pd(x, x);
+        __m128d y0 = _mm_unpacklo_pd(y, y), y1 = _mm_unpackhi_pd(y, y);
+        __m128d r = _mm_set1_pd(-INFINITY);
+        r = _mm_max_pd(_mm_div_pd(x0, _mm_xor_pd(y0, flip_lo)), r);    /* (-a/c, a/c), infinity by infinity is skipped */
+        r = _mm_max_pd(_mm_div_pd(x0, _mm_xor_pd(y1, flip_hi)), r);
+        r = _mm_max_pd(_mm_div_pd(x1, _mm_xor_pd(y0, flip_hi)), r);
+        r = _mm_max_pd(_mm_div_pd(x1, _mm_xor_pd(y1, flip_lo)), r);
+        return r;
+#else
+        interval_t r;
+        r.neg_lo = fmax(fmax(x.neg_lo / -y.neg_lo, x.neg_lo / y.hi), fmax(x.hi / y.neg_lo, x.hi / -y.hi));
+        r.hi = fmax(fmax(x.neg_lo / y.neg_lo, x.neg_lo / -y.hi), fmax(x.hi / -y.neg_lo, x.hi / y.hi));
+        return r;
+#endif /* __SSE2__ */
+    } else if (c == 0 && d > 0 && a >= 0 && b > 0) {    /* Rounding upwards, -((-a) / d) is a / d rounded downwards */
+        return interval_make(-(-a / d), INFINITY);
+    } else if (c == 0 && d > 0 && b <= 0 && a < 0) {
+        return interval_make(-INFINITY, b / d);
+    } else if (c < 0 && d == 0 && a >= 0 && b > 0) {
+        return interval_make(-INFINITY, a / c);
+    } else if (c < 0 && d == 0 && b <= 0 && a < 0) {
+        return interval_make(-(-b / c), INFINITY);
+    }
+    return interval_make(-INFINITY, INFINITY);
+}
+
+/**
+ * \brief           A function used to enclose bounds calculated with an error
+ * \param[in]       lo: The lower bound, calculated with a relative error of at most `error`
+ * \param[in]       hi: The upper bound, calculated with a relative error of at most `error`
+ * \param[in]       error: The relative error
+ * \return          The interval widened by the error, rounding upwards
+ * \note            A lower bound overflowing to +infinity is a finite value above the largest double, and the same downwards
+ */
+static interval_t
+interval_widen(double lo, double hi, double error) {
+    interval_t r;
+    lo = lo == INFINITY ? DBL_MAX : lo;
+    hi = hi == -INFINITY ? -DBL_MAX : hi;
+    r = interval_make(lo, hi);
+#ifdef __SSE2__
+    r = _mm_add_pd(r, _mm_add_pd(_mm_mul_pd(_mm_andnot_pd(_mm_set1_pd(-0.0), r), _mm_set1_pd(error)), _mm_set1_pd(INTERVAL_TINY)));
+#else
+    r.neg_lo += fabs(r.neg_lo) * error + INTERVAL_TINY;
+    r.hi += fabs(r.hi) * error + INTERVAL_TINY;
+#endif /* __SSE2__ */
+    INTERVAL_BARRIER(r);
+    return r;
+}
+
+/**
+ * \brief           A function used to enclose a monotonic function of the math library
+ * \param[in]       f: The function
+ * \param[in]       lo: The lower bound of the argument, in the domain
+ * \param[in]       hi: The upper bound of the argument, in the domain
+ * \param[in]       decreasing: Set to `1` if the function decreases
+ * \param[in]       error: A relative bound of the error of the function
+ * \param[in]       saved: The rounding mode of the caller
+ * \return          The interval of the function, rounding upwards again
+ */
+static interval_t
+interval_libm(double (*f)(double), double lo, double hi, uint8_t decreasing, double error, interval_rounding_t saved) {
+    double f_lo, f_hi;
+    rounding_set(saved, 0);                     /* The math library is accurate in rounding to nearest only */
+    f_lo = f(lo);
+    f_hi = lo == hi ? f_lo : f(hi);
+    rounding_set(saved, 1);
+    return decreasing ? interval_widen(f_hi, f_lo, error) : interval_widen(f_lo, f_hi, error);
+}
+
+/**
+ * \brief           A function used to enclose a literal
+ * \param[in]       literal: The literal as written in the source
+ * \param[in]       value: The literal rounded to the nearest double
+ * \return          The point interval of the value if the literal is exactly a double, otherwise the neighbouring doubles
+ * \note            A literal d / 10^s with s digits after the point, none of them trailing zeros, is a double exactly
+ *                  if 5^s divides d and the quotient fits into the 53 bits of the significand
+ */
+static interval_t
+interval_literal(const calc_literal_t* literal, double value) {
+    uint64_t digits = 0, power = 1;
+    int32_t scale = literal->scale;
+    size_t count = 0;
+    while (literal->digits[count] != '\0') {
+        ++count;
+    }
+    while (scale > 0 && count > 0 && literal->digits[count - 1] == '0') {   /* 1.50 is 1.5 */
+        --count;
+        --scale;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        if (digits > (UINT64_MAX - 9) / 10) {
+            return interval_make(nextafter(value, -INFINITY), nextafter(value, INFINITY));
+        }
+        digits = digits * 10 + (uint64_t)(literal->digits[i] - '0');
+    }
+    for (int32_t i = 0; i < scale && scale <= 27; ++i) {   /* 5^27 is the largest power of 5 fitting into 64 bits */
+        power *= 5;
+    }
+    if (scale <= 27 && digits % power == 0 && digits / power < (1ULL << 53)) {
+        return interval_make(value, value);
+    }
+    return interval_make(nextafter(value, -INFINITY), nextafter(value, INFINITY));
+}
+
+/**
+ * \brief           A function used to raise an interval to an integer power
+ * \param[in]       x: The base
+ * \param[in]       n: The exponent, a finite integer, every double from 2^53 up is even
+ * \return          The power, of the bounds by squaring up to \ref INTERVAL_POWI_MAX and by pow beyond
+ * \note            An odd power increases, an even one is a power of the absolute value. A negative power is the reciprocal.
+ */
+static interval_t
+interval_powi(interval_t x, double n) {
+    double m = fabs(n);
+    double lo = interval_lo(x), hi = interval_hi(x);
+    interval_t r;
+    if (n == 0) {
+        return interval_make(1, 1);             /* Like pow, even of NaN */
+    } else if (isnan(lo) || isnan(hi)) {
+        return interval_make(NAN, NAN);         /* Not a bound of the absolute value below */
+    } else if (fmod(m, 2) == 0) {               /* The bounds of the absolute value */
+        double a = lo >= 0 ? lo : hi <= 0 ? -hi : 0;
+        hi = fmax(-lo, hi);
+        lo = a;
+    }
+    if (m <= INTERVAL_POWI_MAX) {
+        interval_t low = interval_make(1, 1), high = low, base_low = interval_make(lo, lo), base_high = interval_make(hi, hi);
+        for (uint32_t k = (uint32_t)m;;) {      /* Square and multiply the points of both bounds, exact while exact */
+            if (k & 1) {
+                low = interval_mul(low, base_low);
+                high = interval_mul(high, base_high);
+            }
+            k >>= 1;
+            if (k == 0) {
+                break;
+            }
+            base_low = interval_mul(base_low, base_low);
+            base_high = interval_mul(base_high, base_high);
+        }
+        r = interval_make(interval_lo(low), interval_hi(high));
+    } else {
+        double p_lo, p_hi;
+        interval_rounding_t saved = rounding_save();    /* Rounding upwards, as everywhere in the evaluation */
+        rounding_set(saved, 0);
+        p_lo = pow(lo, m);
+        p_hi = pow(hi, m);
+        rounding_restore(saved);
+        r = interval_widen(p_lo, p_hi, INTERVAL_LIBM_ERROR);
+    }
+    return n < 0 ? interval_div(interval_make(1, 1), r) : r;
+}
+
+/**
+ * \brief           A function used to raise an interval to an interval power
+ * \param[in]       x: The base
+ * \param[in]       y: The exponent
+ * \param[in]       saved: The rounding mode of the caller
+ * \return          The power
+ * \note            A point integer exponent takes \ref interval_powi. A negative base has a power only at the integers
+ *                  of the exponent: one integer takes \ref interval_powi, several are bounded by the power of the absolute
+ *                  value with either sign. On the rest of the base the power is monotonic in both operands,
+ *                  so the bounds are among the corners.
+ */
+static interval_t
+interval_pow(interval_t x, interval_t y, interval_rounding_t saved) {
+    double x_lo = interval_lo(x), x_hi = interval_hi(x), y_lo = interval_lo(y), y_hi = interval_hi(y);
+    double corners[4], p_lo = INFINITY, p_hi = -INFINITY;
+    if (y_lo == y_hi && y_lo == trunc(y_lo) && isfinite(y_lo)) {
+        return interval_powi(x, y_lo);
+    } else if (isnan(x_lo) || isnan(y_lo)) {
+        return interval_make(NAN, NAN);
+    } else if (x_lo < 0 && ceil(y_lo) <= floor(y_hi)) {     /* The negative part of the base at the integers */
+        double n_lo = ceil(y_lo), n_hi = floor(y_hi);
+        interval_t r;
+        if (n_lo == n_hi && isfinite(n_lo)) {
+            r = interval_powi(interval_make(x_lo, fmin(x_hi, 0)), n_lo);
+        } else {
+            r = interval_pow(interval_make(fmax(-x_hi, 0), -x_lo), interval_make(n_lo, n_hi), saved);
+            r = interval_make(-interval_hi(r), interval_hi(r));
+        }
+        p_lo = interval_lo(r);
+        p_hi = interval_hi(r);
+    }
+    if (x_hi < 0) {
+        return p_lo <= p_hi ? interval_make(p_lo, p_hi) : interval_make(NAN, NAN);
+    }
+    x_lo = fmax(x_lo, 0);
+    rounding_set(saved, 0);
+    corners[0] = pow(x_lo, y_lo);
+    corners[1] = pow(x_lo, y_hi);
+    corners[2] = pow(x_hi, y_lo);
+    corners[3] = pow(x_hi, y_hi);
+    rounding_set(saved, 1);
+    for (size_t i = 0; i < 4; ++i) {
+        p_lo = fmin(p_lo, corners[i]);
+        p_hi = fmax(p_hi, corners[i]);
+    }
+    return interval_widen(p_lo, p_hi, INTERVAL_LIBM_ERROR);
+}
+
+/**
+ * \brief           A function used to calculate a division remainder of intervals
+ * \param[in]       x: The dividend
+ * \param[in]       y: The divisor
+ * \return          The remainder with the sign of the dividend, like fmod
+ * \note            A point divisor with the same truncated quotient over the whole dividend gives x - q * y. Otherwise the
+ *                  remainder is only known to be smaller than the divisor and than the dividend in absolute value.
+ *                  An infinite bound of the dividend is a limit of finite values, only a point infinity gives NaN.
+ */
+static interval_t
+interval_mod(interval_t x, interval_t y) {
+    double x_lo = interval_lo(x), x_hi = interval_hi(x), y_lo = interval_lo(y), y_hi = interval_hi(y);
+    double m = fmax(-y_lo, y_hi);               /* The largest absolute divisor */
+    if (isnan(x_lo) || isnan(y_lo) || (y_lo == 0 && y_hi == 0) || (isinf(x_lo) && x_lo == x_hi)) {
+        return interval_make(NAN, NAN);         /* fmod of infinity or by 0 is NaN */
+    } else if (y_lo == y_hi) {
+        interval_t q = interval_div(x, interval_make(m, m));
+        double q_lo = trunc(interval_lo(q)), q_hi = trunc(interval_hi(q));
+        if (q_lo == q_hi && fabs(q_lo) < 0x1p53) {
+            return interval_add(x, interval_neg(interval_mul(interval_make(q_lo, q_lo), interval_make(m, m))));
+        }
+    }
+    return interval_make(x_lo >= 0 ? 0 : fmax(x_lo, -m), x_hi <= 0 ? 0 : fmin(x_hi, m));
+}
+
+/**
+ * \brief           A function used to compare a number with a multiple of pi
+ * \param[in]       x: The number, close to the multiple
+ * \param[in]       k: The multiple, an integer
+ * \param[in]       offset: 0 for k * pi, 0.5 for (k + 1/2) * pi
+ * \return          The sign of x - (k + offset) * pi
+ * \note            Near k * pi, sin(x) is about (-1)^k (x - k * pi), and near (k + 1/2) * pi, cos(x) is about -(-1)^k (x - (k + 1/2) * pi).
+ *                  The math library reduces the argument exactly, so the sign is right however close x is.
+ */
+static int
+interval_side(double x, double k, double offset) {
+    double s = offset == 0 ? sin(x) : -cos(x);
+    if (fmod(k, 2) != 0) {
+        s = -s;
+    }
+    return (s > 0) - (s < 0);
+}
+
+/**
+ * \brief           A function used to find multiples of pi in an interval
+ * \param[in]       lo: The lower bound
+ * \param[in]       hi: The upper bound
+ * \param[in]       offset: 0 for the multiples k * pi, 0.5 for (k + 1/2) * pi
+ * \return          Bit 0 set if the interval contains a multiple with an even k, bit 1 if one with an odd k
+ * \note            Runs in rounding to nearest. k is estimated from x / pi with a margin, multiples within the margin
+ *                  of a bound are placed by \ref interval_side. Intervals too wide or too far to place them contain both.
+ */
+static uint8_t
+interval_multiples(double lo, double hi, double offset) {
+    double t_lo, t_hi, m_lo, m_hi;
+    uint8_t found = 0;
+    if (!(hi - lo < 2 * M_PI) || !(fabs(lo) < INTERVAL_REDUCE_MAX) || !(fabs(hi) < INTERVAL_REDUCE_MAX)) {
+        return 3;
+    }
+    t_lo = lo / M_PI - offset;
+    t_hi = hi / M_PI - offset;
+    m_lo = (fabs(t_lo) + 1) * 0x1p-48;         /* Far above the errors of pi and of the division */
+    m_hi = (fabs(t_hi) + 1) * 0x1p-48;
+    for (double k = ceil(t_lo - m_lo); k <= floor(t_hi + m_hi); ++k) {
+        if ((k - t_lo < m_lo && interval_side(lo, k, offset) > 0) || (t_hi - k < m_hi && interval_side(hi, k, offset) < 0)) {
+            continue;                           /* Just below the lower bound or just above the upper one */
+        }
+        found |= fmod(k, 2) == 0 ? 1 : 2;
+    }
+    return found;
+}
+
+/**
+ * \brief           A function used to enclose a math function of intervals
+ * \param[in]       fn: The function
+ * \param[in]       x: The first argument
+ * \param[in]       y: The second argument of a binary function
+ * \param[in]       saved: The rounding mode of the caller
+ * \param[out]      code: Set to \ref CALC_ERROR_UNDEFINED_FUNCTION if an argument is entirely out of the domain
+ * \return          The interval of the function, rounding upwards
+ */
+static interval_t
+interval_call(calc_function_id_t fn, interval_t x, interval_t y, interval_rounding_t saved, calc_error_code_t* code) {
+    double lo = interval_lo(x), hi = interval_hi(x);
+    if (isnan(lo) || (isnan(interval_lo(y)) && (fn == CALC_FN_LOG || fn == CALC_FN_MIN || fn == CALC_FN_MAX))) {
+        return interval_make(NAN, NAN);
+    }
+    switch (fn) {
+        case CALC_FN_SQRT:
+        case CALC_FN_LN:
+        case CALC_FN_LOG10:
+            if (hi < 0 || (hi == 0 && fn != CALC_FN_SQRT)) {
+                break;
+            }
+            return interval_libm(fn == CALC_FN_SQRT ? sqrt : fn == CALC_FN_LN ? log : log10, fmax(lo, 0), hi, 0, INTERVAL_LIBM_ERROR, saved);
+        case CALC_FN_EXP:
+            return interval_libm(exp, lo, hi, 0, INTERVAL_LIBM_ERROR, saved);
+        case CALC_FN_SINH:
+            return interval_libm(sinh, lo, hi, 0, INTERVAL_LIBM_ERROR, saved);
+        case CALC_FN_ASINH:
+            return interval_libm(asinh, lo, hi, 0, INTERVAL_LIBM_ERROR, saved);
+        case CALC_FN_ATAN:
+            return interval_libm(atan, lo, hi, 0, INTERVAL_LIBM_ERROR, saved);
+        case CALC_FN_ACTAN:                     /* pi / 2 - atan(x), subtracted in intervals as it cancels for large x */
+            return interval_add(interval_make(INTERVAL_PI_LO / 2, INTERVAL_PI_HI / 2),
+                                interval_neg(interval_libm(atan, lo, hi, 0, INTERVAL_LIBM_ERROR, saved)));
+        case CALC_FN_TANH: {
+            interval_t r = interval_libm(tanh, lo, hi, 0, INTERVAL_LIBM_ERROR, saved);
+            return interval_make(fmax(interval_lo(r), -1), fmin(interval_hi(r), 1));
+        }
+        case CALC_FN_ASIN:
+        case CALC_FN_ACOS:
+            if (hi < -1 || lo > 1) {
+                break;
+            }
+            return interval_libm(fn == CALC_FN_ASIN ? asin : acos, fmax(lo, -1), fmin(hi, 1), fn == CALC_FN_ACOS, INTERVAL_LIBM_ERROR, saved);
+        case CALC_FN_ACOSH:
+            if (hi < 1) {
+                break;
+            }
+            return interval_libm(acosh, fmax(lo, 1), hi, 0, INTERVAL_LIBM_ERROR, saved);
+        case CALC_FN_ATANH:
+        case CALC_FN_ACTANH:                    /* The same function, atanh keeps the accuracy near 0 */
+            if (hi <= -1 || lo >= 1) {
+                break;
+            }
+            return interval_libm(atanh, fmax(lo, -1), fmin(hi, 1), 0, INTERVAL_LIBM_ERROR, saved);
+        case CALC_FN_SIN:
+        case CALC_FN_COS: {
+            double offset = fn == CALC_FN_SIN ? 0.5 : 0;    /* The extrema of sin are at (k + 1/2) * pi, of cos at k * pi */
+            double (*f)(double) = fn == CALC_FN_SIN ? sin : cos;
+            double f_lo, f_hi;
+            uint8_t extrema = 0;
+            interval_t r;
+            rounding_set(saved, 0);
+            if (lo != hi) {
+                extrema = interval_multiples(lo, hi, offset);
+            }
+            f_lo = f(lo);
+            f_hi = f(hi);
+            rounding_set(saved, 1);
+            r = interval_widen(fmin(f_lo, f_hi), fmax(f_lo, f_hi), INTERVAL_LIBM_ERROR);
+            return interval_make((extrema & 2) ? -1 : fmax(interval_lo(r), -1), (extrema & 1) ? 1 : fmin(interval_hi(r), 1));
+        }
+        case CALC_FN_TAN:
+        case CALC_FN_CTAN: {                    /* Monotonic between the poles, at (k + 1/2) * pi for tan and k * pi for cot */
+            uint8_t pole;
+            double f_lo, f_hi;
+            rounding_set(saved, 0);
+            pole = lo == hi ? (fn == CALC_FN_TAN ? cos(lo) == 0 : sin(lo) == 0) : interval_multiples(lo, hi, fn == CALC_FN_TAN ? 0.5 : 0) != 0;
+            f_lo = fn == CALC_FN_TAN ? tan(lo) : 1 / tan(lo);
+            f_hi = fn == CALC_FN_TAN ? tan(hi) : 1 / tan(hi);
+            rounding_set(saved, 1);
+            if (pole && lo == hi) {
+                break;
+            } else if (pole) {
+                return interval_make(-INFINITY, INFINITY);
+            }
+            return fn == CALC_FN_TAN ? interval_widen(f_lo, f_hi, INTERVAL_LIBM_ERROR) : interval_widen(f_hi, f_lo, INTERVAL_LIBM_ERROR);
+        }
+        case CALC_FN_COSH:                      /* The smallest value is cosh(0) = 1 */
+            if (lo >= 0) {
+                return interval_libm(cosh, lo, hi, 0, INTERVAL_LIBM_ERROR, saved);
+            } else if (hi <= 0) {
+                return interval_libm(cosh, lo, hi, 1, INTERVAL_LIBM_ERROR, saved);
+            } else {
+                interval_t r = interval_libm(cosh, 0, fmax(-lo, hi), 0, INTERVAL_LIBM_ERROR, saved);
+                return interval_make(1, interval_hi(r));
+            }
+        case CALC_FN_CTANH: {                   /* Decreasing on both sides of the pole at 0 */
+            interval_t r;
+            if (lo == 0 && hi == 0) {
+                break;
+            } else if (lo < 0 && hi > 0) {
+                return interval_make(-INFINITY, INFINITY);
+            }
+            rounding_set(saved, 0);
+            r = interval_make(hi == 0 ? -INFINITY : 1 / tanh(hi), lo == 0 ? INFINITY : 1 / tanh(lo));
+            rounding_set(saved, 1);
+            return interval_widen(interval_lo(r), interval_hi(r), INTERVAL_LIBM_ERROR);
+        }
+        case CALC_FN_FABS:
+            return lo >= 0 ? x : hi <= 0 ? interval_neg(x) : interval_make(0, fmax(-lo, hi));
+        case CALC_FN_CEIL:
+            return interval_make(ceil(lo), ceil(hi));
+        case CALC_FN_FLOOR:
+            return interval_make(floor(lo), floor(hi));
+        case CALC_FN_ROUND:
+            return interval_make(round(lo), round(hi));
+        case CALC_FN_TRUNC:
+            return interval_make(trunc(lo), trunc(hi));
+        case CALC_FN_SIGN:
+            return interval_make((lo > 0) - (lo < 0), (hi > 0) - (hi < 0));
+        case CALC_FN_RAD:
+            return interval_div(interval_mul(x, interval_make(INTERVAL_PI_LO, INTERVAL_PI_HI)), interval_make(180, 180));
+        case CALC_FN_DEG:
+            return interval_div(interval_mul(x, interval_make(180, 180)), interval_make(INTERVAL_PI_LO, INTERVAL_PI_HI));
+        case CALC_FN_FACT: {                    /* Γ(x + 1) decreases below its minimum at x = 0.4616... and increases above */
+            double args[2] = {0, 0}, f_lo, f_hi;
+            const calc_function_t* fact = &calc_functions[CALC_FN_FACT];
+            interval_t r;
+            if (hi < 0) {
+                break;
+            }
+            lo = fmax(lo, 0);
+            rounding_set(saved, 0);
+            args[0] = lo;
+            f_lo = fact->impl(args);
+            args[0] = hi;
+            f_hi = fact->impl(args);
+            rounding_set(saved, 1);
+            if (lo == hi && lo == floor(lo)) {      /* From the table, correctly rounded, exact up to 22! */
+                return lo <= 22 ? interval_make(f_lo, f_lo) : interval_widen(f_lo, f_lo, INTERVAL_LIBM_ERROR);
+            }
+            r = interval_widen(fmin(f_lo, f_hi), fmax(f_lo, f_hi), INTERVAL_GAMMA_ERROR);
+            return hi <= 0.4616 || lo >= 0.4617 ? r : interval_make(INTERVAL_GAMMA_MIN, interval_hi(r));
+        }
+        case CALC_FN_LOG: {                     /* ln(x) / ln(base), the base is the first argument */
+            double y_lo = interval_lo(y), y_hi = interval_hi(y);
+            interval_t ln_base, ln_x;
+            if (hi <= 0 || y_hi <= 0 || (lo == 1 && hi == 1)) {
+                break;
+            }
+            ln_base = interval_libm(log, fmax(lo, 0), hi, 0, INTERVAL_LIBM_ERROR, saved);
+            ln_x = interval_libm(log, fmax(y_lo, 0), y_hi, 0, INTERVAL_LIBM_ERROR, saved);
+            return interval_div(ln_x, ln_base);
+        }
+        case CALC_FN_MIN:
+            return interval_make(fmin(lo, interval_lo(y)), fmin(hi, interval_hi(y)));
+        case CALC_FN_MAX:
+            return interval_make(fmax(lo, interval_lo(y)), fmax(hi, interval_hi(y)));
+        default:
+            *code = CALC_ERROR_UNKNOWN;
+            return x;
+    }
+    *code = CALC_ERROR_UNDEFINED_FUNCTION;
+    return x;
+}
+
+/**
+ * \brief           A function used to calculate an operation on intervals
+ * \param[in]       node: The node of the operation
+ * \param[in]       x: The first operand
+ * \param[in]       y: The second operand, unused for unary operations
+ * \param[in]       saved: The rounding mode of the caller
+ * \param[out]      code: Set to an error code if the operation fails
+ * \return          The interval of the operation, rounding upwards
+ */
+static interval_t
+apply_interval(const calc_node_t* node, interval_t x, interval_t y, interval_rounding_t saved, calc_error_code_t* code) {
+    switch (node->op) {
+        case CALC_OP_NEG:
+            return interval_neg(x);
+        case CALC_OP_ADD:
+            return interval_add(x, y);
+        case CALC_OP_SUB:
+            return interval_add(x, interval_neg(y));
+        case CALC_OP_MUL:
+            return interval_mul(x, y);
+        case CALC_OP_DIV:
+            return interval_div(x, y);
+        case CALC_OP_MOD:
+            return interval_mod(x, y);
+        case CALC_OP_POW:
+            return interval_pow(x, y, saved);
+        case CALC_OP_POWI:
+            return interval_powi(x, node->value);
+        case CALC_OP_CALL:
+            return interval_call((calc_function_id_t)node->fn, x, y, saved, code);
+        case CALC_OP_GUARD:
+            return x;
+        default:
+            *code = CALC_ERROR_UNKNOWN;
+            return x;
+    }
+}
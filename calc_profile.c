@@ -0,0 +1,139 @@
+/**
+ * \file            calc_profile.c
+ * \brief           Profiling of the math functions: call counts and cycles per builtin
+ */
+
+/*
+ * Copyright (c) 2024 Daniil VERES
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * Author:          Daniil VERES <daniaveres@gmail.com>
+ * Version:         v1.0.0
+ */
+
+#include <stdatomic.h>      /* atomic_load_explicit, atomic_store_explicit, atomic_fetch_add_explicit */
+#include "calc_internal.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>      /* __rdtsc */
+#define profile_cycles() __rdtsc()  /*!< Reads the time stamp counter, which ticks at a constant rate on current processors */
+#else
+#include <time.h>           /* clock_gettime */
+#define profile_cycles() profile_ns()   /*!< Without a cycle counter nanoseconds are reported instead */
+
+/**
+ * \brief           A function used to get a monotonic time in nanoseconds
+ * \return          The time
+ */
+static uint64_t
+profile_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+#endif /* defined(__x86_64__) || defined(__i386__) */
+
+/**
+ * \brief           Counters of a math function
+ */
+typedef struct {
+    atomic_uint_fast64_t calls;     /*!< A number of calls */
+    atomic_uint_fast64_t cycles;    /*!< Cycles spent in the calls */
+} profile_counter_t;
+
+static profile_counter_t counters[CALC_FN_COUNT];       /*!< Counters of every function of the registry */
+
+/**
+ * \brief           The registry used by the evaluator, \ref calc_functions unless profiling is enabled
+ * \note            Profiling swaps the whole table, so the disabled path has no check and no counting at all
+ */
+const calc_function_t* _Atomic calc_dispatch = calc_functions;
+
+/**
+ * \brief           Defines a wrapper counting the calls and the cycles of a math function
+ * \param[in]       id: The function without the CALC_FN_ prefix
+ * \note            The other fields of a \ref CALC_FUNCTION_LIST entry are ignored
+ */
+#define PROFILED_WRAPPER(id, ...)                                                                \
+    static double                                                                               \
+    profiled_##id(const double* args) {                                                         \
+        uint64_t start = profile_cycles();                                                      \
+        double result = calc_functions[CALC_FN_##id].impl(args);                               \
+        atomic_fetch_add_explicit(&counters[CALC_FN_##id].cycles, profile_cycles() - start, memory_order_relaxed); \
+        atomic_fetch_add_explicit(&counters[CALC_FN_##id].calls, 1, memory_order_relaxed);     \
+        return result;                                                                          \
+    }
+
+/**
+ * \brief           Expands an entry of \ref CALC_FUNCTION_LIST into an initializer of the profiled registry
+ */
+#define PROFILED_ENTRY(id, name, function, arity, variadic, pure, domain) \
+    [CALC_FN_##id] = {name, profiled_##id, arity, variadic, pure, domain},
+
+CALC_FUNCTION_LIST(PROFILED_WRAPPER)
+
+/**
+ * \brief           The registry with the profiling wrappers as implementations
+ * \note            The table is constant, so enabling profiling only swaps \ref calc_dispatch and never writes a table in use
+ */
+static const calc_function_t profiled_functions[CALC_FN_COUNT] = {
+    CALC_FUNCTION_LIST(PROFILED_ENTRY)
+};
+
+/**
+ * \brief           A function used to enable or disable profiling of the math functions
+ * \param[in]       enable: Set to `1` to count calls and cycles of every function called by the evaluator
+ * \note            Evaluations already running finish with the registry they have started with
+ */
+void
+calc_profile_enable(uint8_t enable) {
+    atomic_store_explicit(&calc_dispatch, enable ? profiled_functions : calc_functions, memory_order_release);
+}
+
+/**
+ * \brief           A function used to reset the counters of all math functions
+ */
+void
+calc_profile_reset(void) {
+    for (size_t i = 0; i < CALC_FN_COUNT; ++i) {
+        atomic_store_explicit(&counters[i].calls, 0, memory_order_relaxed);
+        atomic_store_explicit(&counters[i].cycles, 0, memory_order_relaxed);
+    }
+}
+
+/**
+ * \brief           A function used to read the counters of a math function
+ * \param[in]       index: An index of the function in the registry, below \ref calc_function_count
+ * \param[out]      entry: The counters
+ * \return          1 on success, 0 if the index is out of range
+ * \note            Cycles are time stamp counter ticks on x86, nanoseconds elsewhere
+ */
+uint8_t
+calc_profile_get(size_t index, calc_profile_entry_t* entry) {
+    if (index >= CALC_FN_COUNT) {
+        return 0;
+    }
+    entry->name = calc_functions[index].name;
+    entry->calls = atomic_load_explicit(&counters[index].calls, memory_order_relaxed);
+    entry->cycles = atomic_load_explicit(&counters[index].cycles, memory_order_relaxed);
+    return 1;
+}
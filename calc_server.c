@@ -0,0 +1,754 @@
+/**
+ * \file            calc_server.c
+ * \brief           Line protocol server of the calculator on a Unix domain socket with an epoll event loop
+ */
+
+/*
+ * Copyright (c) 2024 Daniil VERES
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * Author:          Daniil VERES <daniaveres@gmail.com>
+ * Version:         v1.0.0
+ */
+
+#define _GNU_SOURCE         /* accept4 */
+#include "calc_server.h"
+#include "calc_shm.h"
+#include "calc_stats.h"
+
+/**
+ * \brief           Enumeration representing the arithmetic the requests are calculated in
+ */
+typedef enum {
+    SERVER_MODE_EXACT = 0,      /*!< Integer operations exact, the others in double precision */
+    SERVER_MODE_INTERVAL,       /*!< Enclosing intervals */
+    SERVER_MODE_COMPLEX         /*!< Complex numbers */
+} server_mode_t;
+
+/**
+ * \brief           A result of a request in any mode
+ */
+typedef struct {
+    calc_result_t exact;        /*!< The result of \ref SERVER_MODE_EXACT, its value is set in every mode */
+    calc_interval_t interval;   /*!< The result of \ref SERVER_MODE_INTERVAL */
+    calc_complex_t number;      /*!< The result of \ref SERVER_MODE_COMPLEX */
+} answer_t;
+
+static server_mode_t mode;      /*!< The arithmetic of the requests */
+
+/**
+ * \brief           A function used to answer the requests with enclosing intervals instead of exact results
+ * \note            Every reply is "[lo, hi]", a shared memory client gets the midpoint as it only receives a double
+ */
+void
+calc_server_enable_interval(void) {
+    mode = SERVER_MODE_INTERVAL;
+}
+
+/**
+ * \brief           A function used to answer the requests over complex numbers, where `i` is the imaginary unit
+ * \note            Every reply is as "a+bi", a shared memory client gets the real part as it only receives a double
+ */
+void
+calc_server_enable_complex(void) {
+    mode = SERVER_MODE_COMPLEX;
+}
+
+#ifdef __linux__
+
+                            /* Functions used: */
+#include <errno.h>          /* errno, EAGAIN, EINTR */
+#include <signal.h>         /* sigaction, SIGINT, SIGTERM, SIGPIPE, SIGUSR1 */
+#include <stdint.h>         /* uint8_t, uint64_t */
+#include <stdio.h>          /* fprintf, perror, snprintf */
+#include <stdlib.h>         /* malloc, realloc, free */
+#include <string.h>         /* memchr, memcpy, memmove, strlen */
+#include <sys/epoll.h>      /* epoll_create1, epoll_ctl, epoll_wait */
+#include <sys/resource.h>   /* getrusage */
+#include <sys/socket.h>     /* socket, bind, listen, accept4 */
+#include <sys/un.h>         /* sockaddr_un */
+#include <unistd.h>         /* read, write, close, unlink */
+
+                                        /* Constants used: */
+#define SERVER_MAX_EVENTS 256           /*!< Maximum number of events handled per epoll_wait */
+#define SERVER_MAX_REPLY 128            /*!< Maximum length of a single reply */
+#define SERVER_MAX_PENDING (1 << 20)    /*!< Replies a client may leave unread before the server stops reading its requests */
+#define SERVER_MAX_READS 16             /*!< Maximum number of reads from one client before the other clients are served */
+#define SERVER_SHM_TIMEOUT_MS 100       /*!< Longest sleep of the shared memory server before it checks for a stop request */
+
+/**
+ * \brief           State of a client connection
+ */
+typedef struct {
+    int fd;                                 /*!< Socket of the connection */
+    char in[CALC_SERVER_MAX_LINE];          /*!< Received bytes not forming a complete line yet */
+    size_t in_len;                          /*!< A number of bytes in the input buffer */
+    uint8_t discarding;                     /*!< Set while the rest of a too long line is skipped */
+    uint8_t closing;                        /*!< Set once the client has closed its side, the connection is closed when the replies are sent */
+    char* out;                              /*!< Replies not sent yet */
+    size_t out_len;                         /*!< A number of bytes in the output buffer */
+    size_t out_sent;                        /*!< A number of bytes of the output buffer already sent */
+    size_t out_capacity;                    /*!< Capacity of the output buffer */
+    uint32_t events;                        /*!< Events the connection is registered for */
+} connection_t;
+
+/**
+ * \brief           State of the server
+ */
+typedef struct {
+    int epoll_fd;                           /*!< The epoll instance */
+    int listen_fd;                          /*!< The listening socket */
+    calc_context_t* context;                /*!< Evaluation context, the event loop is single threaded */
+    size_t connections;                     /*!< A number of open connections */
+    uint64_t requests;                      /*!< A number of requests answered */
+    uint64_t batches;                       /*!< A number of batches the requests have been answered in */
+} server_t;
+
+static volatile sig_atomic_t stop_requested;    /*!< Set by the signal handler to leave the event loop */
+static volatile sig_atomic_t dump_requested;    /*!< Set by the signal handler to print the statistics without stopping */
+
+static void on_signal(int signal);                                              /* A function used to request the server to stop */
+static void on_dump(int signal);                                                /* A function used to request the statistics */
+static void install_signals(void);                                              /* A function used to stop the server on SIGINT and SIGTERM */
+static calc_error_code_t calculate(calc_context_t* context, const char* line, size_t len, answer_t* answer);  /* A function used to calculate a request */
+static int format_reply(calc_error_code_t code, const answer_t* answer, char* reply, size_t size);  /* A function used to format a reply */
+static uint8_t answer_lines(server_t* server, connection_t* conn, size_t* answered);  /* A function used to answer the complete lines of the input buffer */
+static void accept_connections(server_t* server);                               /* A function used to accept all pending connections */
+static void close_connection(server_t* server, connection_t* conn);             /* A function used to close a connection */
+static uint8_t handle_readable(server_t* server, connection_t* conn);          /* A function used to read and answer requests */
+static uint8_t handle_line(server_t* server, connection_t* conn, char* line, size_t len);   /* A function used to answer a single request */
+static uint8_t append_reply(connection_t* conn, const char* reply, size_t len); /* A function used to queue a reply */
+static uint8_t flush_connection(server_t* server, connection_t* conn);         /* A function used to send queued replies */
+static uint8_t update_events(server_t* server, connection_t* conn);            /* A function used to update the events a connection waits for */
+static void print_statistics(const server_t* server);                           /* A function used to print the throughput of the server */
+static uint8_t write_all(int fd, const char* data, size_t len);                 /* A function used to write a whole buffer to a blocking descriptor */
+
+/**
+ * \brief           A function used to run the server until SIGINT or SIGTERM
+ * \param[in]       path: A path of the Unix domain socket, an existing file is replaced
+ * \return          0 in case of successful finish, 1 if the server could not be started
+ * \note            Every request is a line with an expression, every reply is a line with the result or "error: " followed by the reason.
+ *                  Replies come in the order of the requests.
+ */
+int
+calc_server_run(const char* path) {
+    server_t server = {0};                      /* State of the server */
+    struct sockaddr_un address = {0};           /* Address of the socket */
+    struct epoll_event event = {0};
+    struct epoll_event events[SERVER_MAX_EVENTS];
+
+    if (strlen(path) >= sizeof(address.sun_path)) {     /* Check if the path fits into the address */
+        fprintf(stderr, "socket path is too long: %s\n", path);
+        return 1;
+    }
+    install_signals();
+
+    address.sun_family = AF_UNIX;
+    memcpy(address.sun_path, path, strlen(path) + 1);
+    server.context = calc_context_create();
+    server.listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    server.epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (server.context == NULL || server.listen_fd < 0 || server.epoll_fd < 0) {
+        perror("calculator server");
+        return 1;
+    }
+    unlink(path);                               /* Replace a socket left by a previous run */
+    if (bind(server.listen_fd, (struct sockaddr*)&address, sizeof(address)) < 0
+        || listen(server.listen_fd, SOMAXCONN) < 0) {
+        perror(path);
+        return 1;
+    }
+    event.events = EPOLLIN;
+    event.data.ptr = NULL;                      /* The listening socket is the only one without a connection */
+    if (epoll_ctl(server.epoll_fd, EPOLL_CTL_ADD, server.listen_fd, &event) < 0) {
+        perror("epoll_ctl");
+        return 1;
+    }
+
+    while (!stop_requested) {                   /* The event loop */
+        int count = epoll_wait(server.epoll_fd, events, SERVER_MAX_EVENTS, -1);
+        if (dump_requested) {
+            dump_requested = 0;
+            print_statistics(&server);
+        }
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            perror("epoll_wait");
+            break;
+        }
+        for (int i = 0; i < count; ++i) {       /* Loop through the ready sockets */
+            connection_t* conn = (connection_t*)events[i].data.ptr;
+            if (conn == NULL) {
+                accept_connections(&server);
+                continue;
+            }
+            if ((events[i].events & (EPOLLERR | EPOLLHUP)) && !(events[i].events & EPOLLIN)) {
+                close_connection(&server, conn);
+                continue;
+            }
+            if ((events[i].events & EPOLLOUT) && !flush_connection(&server, conn)) {
+                close_connection(&server, conn);
+                continue;
+            }
+            if ((events[i].events & EPOLLIN) && !handle_readable(&server, conn)) {
+                close_connection(&server, conn);
+            }
+        }
+    }
+
+    close(server.listen_fd);
+    close(server.epoll_fd);                     /* Connections still open are closed by the exit of the process */
+    unlink(path);
+    calc_context_free(server.context);
+    print_statistics(&server);
+    return 0;
+}
+
+/**
+ * \brief           A function used to run the server of a shared memory ring until SIGINT or SIGTERM
+ * \param[in]       name: A name of the shared memory object, e.g. "/calc", an existing object is replaced
+ * \return          0 in case of successful finish, 1 if the server could not be started
+ * \note            The ring is served by a single client at a time, see calc_shm.h
+ */
+int
+calc_server_run_shm(const char* name) {
+    server_t server = {0};                      /* State of the server */
+    calc_shm_t* shm;
+    install_signals();
+    server.context = calc_context_create();
+    shm = calc_shm_create(name);
+    if (server.context == NULL || shm == NULL) {
+        perror(name);
+        calc_context_free(server.context);
+        return 1;
+    }
+    while (!stop_requested) {                   /* Loop through the requests */
+        size_t len;
+        answer_t answer = {0};
+        const char* request = calc_shm_next_request(shm, &len, SERVER_SHM_TIMEOUT_MS);
+        if (dump_requested) {
+            dump_requested = 0;
+            print_statistics(&server);
+        }
+        if (request != NULL) {
+            calc_error_code_t code = calculate(server.context, request, len, &answer);
+            calc_shm_complete(shm, answer.exact.value, code);
+            ++server.requests;
+            ++server.batches;
+        }
+    }
+    calc_shm_close(shm);
+    calc_context_free(server.context);
+    print_statistics(&server);
+    return 0;
+}
+
+/**
+ * \brief           A function used to answer expressions read from the standard input until its end, SIGINT or SIGTERM
+ * \return          0 in case of successful finish, 1 if the input or the output failed
+ * \note            Every line of the input gets a line of the output, as a request of the server.
+ *                  The replies of everything read at once are written at once, so piping a file is not limited by system calls.
+ */
+int
+calc_server_run_batch(void) {
+    server_t server = {0};                      /* State of the batch, the same as of a server with a single client */
+    connection_t conn = {0};                    /* The standard input and output */
+    int status = 0;
+    install_signals();
+    server.context = calc_context_create();
+    if (server.context == NULL) {
+        perror("calculator batch");
+        return 1;
+    }
+    conn.fd = STDOUT_FILENO;
+    while (!stop_requested) {                   /* Loop through the chunks of the input */
+        ssize_t received = read(STDIN_FILENO, conn.in + conn.in_len, sizeof(conn.in) - conn.in_len);
+        size_t answered = 0;
+        if (dump_requested) {
+            dump_requested = 0;
+            print_statistics(&server);
+        }
+        if (received < 0 && errno == EINTR) {
+            continue;
+        } else if (received < 0) {
+            perror("read");
+            status = 1;
+            break;
+        } else if (received == 0) {             /* The end of the input, a last line may miss the new line */
+            if (conn.in_len > 0 && !conn.discarding) {
+                conn.in[conn.in_len++] = '\n';
+                answer_lines(&server, &conn, &answered);
+                server.requests += answered;
+                ++server.batches;
+            }
+            break;
+        }
+        conn.in_len += (size_t)received;
+        if (!answer_lines(&server, &conn, &answered)) {
+            status = 1;
+            break;
+        }
+        if (answered > 0) {
+            server.requests += answered;
+            ++server.batches;
+        }
+        if (conn.out_len > 0) {
+            if (!write_all(conn.fd, conn.out, conn.out_len)) {
+                perror("write");
+                status = 1;
+                break;
+            }
+            conn.out_len = 0;
+        }
+    }
+    if (status == 0 && conn.out_len > 0 && !write_all(conn.fd, conn.out, conn.out_len)) {
+        perror("write");
+        status = 1;
+    }
+    free(conn.out);
+    calc_context_free(server.context);
+    print_statistics(&server);
+    return status;
+}
+
+/**
+ * \brief           A function used to request the server to stop
+ * \param[in]       signal: A number of the signal
+ */
+static void
+on_signal(int signal) {
+    (void)signal;
+    stop_requested = 1;
+}
+
+/**
+ * \brief           A function used to request the statistics to be printed
+ * \param[in]       signal: A number of the signal
+ */
+static void
+on_dump(int signal) {
+    (void)signal;
+    dump_requested = 1;
+}
+
+/**
+ * \brief           A function used to stop the server on SIGINT and SIGTERM and to print the statistics on SIGUSR1
+ */
+static void
+install_signals(void) {
+    struct sigaction action = {0};
+    action.sa_handler = on_signal;              /* Without SA_RESTART waiting system calls are interrupted by the signal */
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+    action.sa_handler = on_dump;
+    sigaction(SIGUSR1, &action, NULL);
+    signal(SIGPIPE, SIG_IGN);                   /* A client closing early must not kill the server */
+}
+
+/**
+ * \brief           A function used to calculate a request
+ * \param[in]       context: An evaluation context
+ * \param[in]       line: An expression without the new line
+ * \param[in]       len: Length of the expression
+ * \param[out]      answer: The result of the calculation in the mode of the server. The value of the exact result
+ *                      is set in every mode, to the midpoint of an interval and the real part of a complex number
+ * \return          \ref CALC_OK on success, an error code otherwise
+ * \note            The request passes the same checks as the input of the interactive calculator, which reject a NUL byte
+ */
+static calc_error_code_t
+calculate(calc_context_t* context, const char* line, size_t len, answer_t* answer) {
+    calc_error_t error = {CALC_ERROR_INVALID_INPUT, 0};
+    uint64_t lap = calc_stats_start();          /* The start of the current stage */
+    uint8_t valid = len > 0 && (mode == SERVER_MODE_COMPLEX ? calc_validate_complex(line, len) : calc_validate(line, len));
+    calc_stats_lap(CALC_STAGE_VALIDATE, &lap);
+    if (valid) {                                /* Check if the input is valid */
+        calc_expr_t* expr = calc_compile(line, len, &error);
+        calc_stats_lap(CALC_STAGE_PARSE, &lap);
+        if (expr != NULL) {
+            if (mode == SERVER_MODE_INTERVAL) {
+                answer->exact.value = calc_eval_interval(expr, NULL, &answer->interval, &error);
+            } else if (mode == SERVER_MODE_COMPLEX) {
+                answer->exact.value = calc_eval_complex(expr, NULL, &answer->number, &error);
+            } else {
+                calc_eval_exact(context, expr, NULL, &answer->exact, &error);
+            }
+            calc_stats_lap(CALC_STAGE_EVAL, &lap);
+            calc_free(expr);
+        }
+    }
+    return error.code;
+}
+
+/**
+ * \brief           A function used to format a reply
+ * \param[in]       code: An error code of the calculation
+ * \param[in]       answer: The result of the calculation
+ * \param[out]      reply: A buffer for the reply, the new line is not added
+ * \param[in]       size: Size of the buffer
+ * \return          Length of the reply
+ */
+static int
+format_reply(calc_error_code_t code, const answer_t* answer, char* reply, size_t size) {
+    uint64_t lap = calc_stats_start();
+    int len;
+    if (code == CALC_OK && mode == SERVER_MODE_INTERVAL) {
+        len = calc_format_interval(&answer->interval, reply, size);
+    } else if (code == CALC_OK && mode == SERVER_MODE_COMPLEX) {
+        len = calc_format_complex(&answer->number, reply, size);
+        if (len < 0 || (size_t)len >= size) {   /* A huge number does not fit, fall back to the exponent form */
+            len = snprintf(reply, size, "%.17g%+.17gi", answer->number.re, answer->number.im);
+        }
+    } else if (code == CALC_OK) {
+        len = calc_format_result(&answer->exact, reply, size);
+        if (len < 0 || (size_t)len >= size) {   /* A huge number does not fit, fall back to the exponent form */
+            len = snprintf(reply, size, "%.17g", answer->exact.value);
+        }
+    } else {
+        len = snprintf(reply, size, "error: %s", calc_error_string(code));
+    }
+    calc_stats_lap(CALC_STAGE_FORMAT, &lap);
+    return len;
+}
+
+/**
+ * \brief           A function used to accept all pending connections
+ * \param[in]       server: State of the server
+ */
+static void
+accept_connections(server_t* server) {
+    for (;;) {                                  /* Loop until there are no pending connections */
+        int fd = accept4(server->listen_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                perror("accept4");              /* E.g. out of file descriptors, the clients will wait in the backlog */
+            }
+            return;
+        }
+        connection_t* conn = (connection_t*)calloc(1, sizeof(connection_t));
+        struct epoll_event event = {0};
+        if (conn == NULL) {
+            close(fd);
+            continue;
+        }
+        conn->fd = fd;
+        conn->events = EPOLLIN;
+        event.events = conn->events;
+        event.data.ptr = conn;
+        if (epoll_ctl(server->epoll_fd, EPOLL_CTL_ADD, fd, &event) < 0) {
+            close(fd);
+            free(conn);
+            continue;
+        }
+        ++server->connections;
+    }
+}
+
+/**
+ * \brief           A function used to close a connection
+ * \param[in]       server: State of the server
+ * \param[in]       conn: A connection
+ */
+static void
+close_connection(server_t* server, connection_t* conn) {
+    epoll_ctl(server->epoll_fd, EPOLL_CTL_DEL, conn->fd, NULL);
+    close(conn->fd);
+    free(conn->out);
+    free(conn);
+    --server->connections;
+}
+
+/**
+ * \brief           A function used to read requests from a connection and answer complete lines
+ * \param[in]       server: State of the server
+ * \param[in]       conn: A connection
+ * \return          1 if the connection stays open, 0 if it has to be closed
+ * \note            Everything the client has pipelined is read and evaluated as one batch, the replies of the batch are sent with a single write
+ */
+static uint8_t
+handle_readable(server_t* server, connection_t* conn) {
+    size_t answered = 0;                            /* A number of requests answered in this batch */
+    for (size_t reads = 0; reads < SERVER_MAX_READS; ++reads) { /* Loop until the socket is drained, other clients get their turn after a few reads */
+        ssize_t received = read(conn->fd, conn->in + conn->in_len, sizeof(conn->in) - conn->in_len);
+        if (received == 0) {                        /* The client has closed its side, still answer what it has sent */
+            if (conn->in_len > 0 && !conn->discarding) {    /* A last line may miss the new line, as in the batch mode */
+                conn->in[conn->in_len++] = '\n';
+                if (!answer_lines(server, conn, &answered)) {
+                    return 0;
+                }
+            }
+            conn->closing = 1;
+            break;
+        } else if (received < 0) {
+            if (errno == EINTR) {
+                continue;
+            } else if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                return 0;
+            }
+            break;
+        }
+        conn->in_len += (size_t)received;
+        if (!answer_lines(server, conn, &answered)) {
+            return 0;
+        }
+        if (conn->out_len - conn->out_sent >= SERVER_MAX_PENDING) {
+            break;                                  /* Do not read more than the client is able to take back */
+        }
+    }
+    if (answered > 0) {
+        server->requests += answered;
+        ++server->batches;
+    }
+    return flush_connection(server, conn);
+}
+
+/**
+ * \brief           A function used to answer the complete lines of the input buffer of a connection
+ * \param[in]       server: State of the server
+ * \param[in]       conn: A connection
+ * \param[in,out]   answered: Incremented by the number of answered requests
+ * \return          1 on success, 0 if the memory has not been allocated
+ * \note            An incomplete line is kept for the next read, a line longer than the buffer is answered with an error and skipped
+ */
+static uint8_t
+answer_lines(server_t* server, connection_t* conn, size_t* answered) {
+    size_t start = 0;                               /* Start of the current line */
+    for (;;) {                                      /* Loop through complete lines */
+        char* end = (char*)memchr(conn->in + start, '\n', conn->in_len - start);
+        if (end == NULL) {
+            break;
+        }
+        size_t len = (size_t)(end - (conn->in + start));
+        if (conn->discarding) {                     /* The end of a too long line, already answered */
+            conn->discarding = 0;
+        } else if (!handle_line(server, conn, conn->in + start, len)) {
+            return 0;
+        } else {
+            ++*answered;
+        }
+        start += len + 1;
+    }
+    memmove(conn->in, conn->in + start, conn->in_len - start);  /* Keep the incomplete line */
+    conn->in_len -= start;
+    if (conn->in_len == sizeof(conn->in)) {         /* Check if the line is too long */
+        if (!conn->discarding && !append_reply(conn, "error: invalid input\n", 21)) {
+            return 0;
+        }
+        conn->discarding = 1;
+        conn->in_len = 0;
+        ++*answered;
+    }
+    return 1;
+}
+
+/**
+ * \brief           A function used to answer a single request
+ * \param[in]       server: State of the server
+ * \param[in]       conn: A connection
+ * \param[in]       line: A request without the new line
+ * \param[in]       len: Length of the request
+ * \return          1 on success, 0 if the connection has to be closed
+ */
+static uint8_t
+handle_line(server_t* server, connection_t* conn, char* line, size_t len) {
+    char reply[SERVER_MAX_REPLY];                   /* A buffer for the reply */
+    calc_error_code_t code;
+    int reply_len = 0;
+    answer_t answer = {0};
+    if (len > 0 && line[len - 1] == '\r') {         /* Accept lines ending with CR LF */
+        --len;
+    }
+    code = calculate(server->context, line, len, &answer);
+    reply_len = format_reply(code, &answer, reply, sizeof(reply) - 1);
+    reply[reply_len++] = '\n';
+    if (!append_reply(conn, reply, (size_t)reply_len)) {
+        return 0;
+    }
+    return 1;                                       /* The reply is sent together with the rest of the batch */
+}
+
+/**
+ * \brief           A function used to queue a reply
+ * \param[in]       conn: A connection
+ * \param[in]       reply: Text of the reply
+ * \param[in]       len: Length of the reply
+ * \return          1 on success, 0 if the memory has not been allocated
+ */
+static uint8_t
+append_reply(connection_t* conn, const char* reply, size_t len) {
+    if (conn->out_len + len > conn->out_capacity) { /* Check if the output buffer is full */
+        size_t capacity = conn->out_capacity > 0 ? conn->out_capacity * 2 : 4096;
+        while (capacity < conn->out_len + len) {
+            capacity *= 2;
+        }
+        char* out = (char*)realloc(conn->out, capacity);
+        if (out == NULL) {
+            return 0;
+        }
+        conn->out = out;
+        conn->out_capacity = capacity;
+    }
+    memcpy(conn->out + conn->out_len, reply, len);
+    conn->out_len += len;
+    return 1;
+}
+
+/**
+ * \brief           A function used to send queued replies
+ * \param[in]       server: State of the server
+ * \param[in]       conn: A connection
+ * \return          1 on success, 0 if the connection has to be closed
+ * \note            If the socket is full, the rest is sent when epoll reports it writable. A closing connection is closed once everything is sent
+ */
+static uint8_t
+flush_connection(server_t* server, connection_t* conn) {
+    while (conn->out_sent < conn->out_len) {        /* Loop until everything is sent or the socket is full */
+        ssize_t sent = write(conn->fd, conn->out + conn->out_sent, conn->out_len - conn->out_sent);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                break;
+            }
+            return 0;
+        }
+        conn->out_sent += (size_t)sent;
+    }
+    if (conn->out_sent == conn->out_len) {          /* Reuse the buffer once it has been sent */
+        conn->out_sent = 0;
+        conn->out_len = 0;
+        if (conn->closing) {                        /* The client has closed its side and has got every reply */
+            return 0;
+        }
+    }
+    return update_events(server, conn);
+}
+
+/**
+ * \brief           A function used to update the events a connection waits for
+ * \param[in]       server: State of the server
+ * \param[in]       conn: A connection
+ * \return          1 on success, 0 if the connection has to be closed
+ * \note            A client which does not read its replies is not read from either, so a single client cannot exhaust the memory
+ */
+static uint8_t
+update_events(server_t* server, connection_t* conn) {
+    size_t pending = conn->out_len - conn->out_sent;
+    uint32_t events = 0;
+    struct epoll_event event = {0};
+    if (pending < SERVER_MAX_PENDING && !conn->closing) {   /* Nothing more is read after the end of the requests */
+        events |= EPOLLIN;
+    }
+    if (pending > 0) {
+        events |= EPOLLOUT;
+    }
+    if (events == conn->events) {                   /* Avoid a system call if nothing changes */
+        return 1;
+    }
+    conn->events = events;
+    event.events = events;
+    event.data.ptr = conn;
+    return epoll_ctl(server->epoll_fd, EPOLL_CTL_MOD, conn->fd, &event) == 0;
+}
+
+/**
+ * \brief           A function used to print the throughput of the server
+ * \param[in]       server: State of the server
+ * \note            The event loop is single threaded, so requests per CPU second are the requests per second one core can serve
+ */
+static void
+print_statistics(const server_t* server) {
+    struct rusage usage;
+    double cpu;                                 /* CPU time used by the process in seconds */
+    getrusage(RUSAGE_SELF, &usage);
+    cpu = (double)usage.ru_utime.tv_sec + (double)usage.ru_utime.tv_usec * 1e-6
+        + (double)usage.ru_stime.tv_sec + (double)usage.ru_stime.tv_usec * 1e-6;
+    fprintf(stderr, "served %llu requests in %llu batches (%.1f requests per write), %.3f s of CPU, %.0f requests/s per core\n",
+            (unsigned long long)server->requests, (unsigned long long)server->batches,
+            server->batches > 0 ? (double)server->requests / (double)server->batches : 0.0,
+            cpu, cpu > 0 ? (double)server->requests / cpu : 0.0);
+    calc_stats_print(stderr);
+}
+
+/**
+ * \brief           A function used to write a whole buffer to a blocking descriptor
+ * \param[in]       fd: The descriptor
+ * \param[in]       data: The data
+ * \param[in]       len: Length of the data
+ * \return          1 on success, 0 if the write failed
+ */
+static uint8_t
+write_all(int fd, const char* data, size_t len) {
+    while (len > 0) {
+        ssize_t written = write(fd, data, len);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return 0;
+        }
+        data += written;
+        len -= (size_t)written;
+    }
+    return 1;
+}
+
+#else /* __linux__ */
+
+#include <stdio.h>  /* fprintf */
+
+/**
+ * \brief           A function used to run the server of a shared memory ring
+ * \param[in]       name: A name of the shared memory object
+ * \return          1, the ring relies on futexes which are only available on Linux
+ */
+int
+calc_server_run_shm(const char* name) {
+    (void)name;
+    fprintf(stderr, "shared memory mode is only supported on Linux\n");
+    return 1;
+}
+
+/**
+ * \brief           A function used to answer expressions read from the standard input
+ * \return          1, the batch mode shares the event loop code which is only available on Linux
+ */
+int
+calc_server_run_batch(void) {
+    fprintf(stderr, "batch mode is only supported on Linux\n");
+    return 1;
+}
+
+/**
+ * \brief           A function used to run the server
+ * \param[in]       path: A path of the Unix domain socket
+ * \return          1, the server relies on epoll which is only available on Linux
+ */
+int
+calc_server_run(const char* path) {
+    (void)path;
+    fprintf(stderr, "server mode is only supported on Linux\n");
+    return 1;
+}
+
+#endif /* __linux__ */
@@ -0,0 +1,367 @@
+/**
+ * \file            calc_shm.c
+ * \brief           Shared memory ring of calculation requests with lock-free indices and futex wakeups
+ */
+
+/*
+ * Copyright (c) 2024 Daniil VERES
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * Author:          Daniil VERES <daniaveres@gmail.com>
+ * Version:         v1.0.0
+ */
+
+#include "calc_shm.h"
+
+#ifdef __linux__
+
+                                /* Functions used: */
+#include <errno.h>              /* errno, EINTR */
+#include <fcntl.h>              /* O_CREAT, O_RDWR */
+#include <linux/futex.h>        /* FUTEX_WAIT, FUTEX_WAKE */
+#include <math.h>               /* nan */
+#include <stdatomic.h>          /* atomic_load_explicit, atomic_store_explicit */
+#include <stdlib.h>             /* calloc, free */
+#include <string.h>             /* memcpy, strlen */
+#include <sys/mman.h>           /* shm_open, shm_unlink, mmap, munmap */
+#include <sys/syscall.h>        /* SYS_futex */
+#include <time.h>               /* timespec */
+#include <unistd.h>             /* ftruncate, close, syscall, sysconf */
+
+                                        /* Constants used: */
+#define SHM_MAGIC 0x43414c43u           /*!< "CALC", written by the server once the ring is initialized */
+#define SHM_SPIN 4000                   /*!< A number of polls before a side goes to sleep on a futex */
+#define SHM_CACHE_LINE 64               /*!< Size of a cache line, indices written by different sides never share one */
+
+#if defined(__x86_64__) || defined(__i386__)
+#define shm_pause() __builtin_ia32_pause()  /*!< Tell the CPU the thread is spinning */
+#else
+#define shm_pause() ((void)0)               /*!< Tell the CPU the thread is spinning */
+#endif /* defined(__x86_64__) || defined(__i386__) */
+
+/**
+ * \brief           A request slot, the server writes the reply into the slot of the request
+ */
+typedef struct {
+    uint32_t length;                            /*!< Length of the expression */
+    int32_t code;                               /*!< Error code of the reply, one of \ref calc_error_code_t */
+    double result;                              /*!< Result of the reply */
+    char expression[CALC_SHM_EXPRESSION_SIZE];  /*!< The expression, not NUL-terminated */
+} shm_slot_t;
+
+/**
+ * \brief           Layout of the shared memory
+ * \note            Indices only grow and wrap around 2^32, slot i lives at i % \ref CALC_SHM_SLOTS
+ */
+typedef struct {
+    _Atomic uint32_t magic;                                 /*!< \ref SHM_MAGIC once the ring is ready */
+    _Alignas(SHM_CACHE_LINE) _Atomic uint32_t submitted;    /*!< Requests published by the client, the futex the server sleeps on */
+    _Atomic uint32_t server_sleeping;                       /*!< Set while the server sleeps, the client only wakes it then */
+    _Alignas(SHM_CACHE_LINE) _Atomic uint32_t completed;    /*!< Replies published by the server, the futex the client sleeps on */
+    _Atomic uint32_t client_sleeping;                       /*!< Set while the client sleeps, the server only wakes it then */
+    _Alignas(SHM_CACHE_LINE) shm_slot_t slots[CALC_SHM_SLOTS];  /*!< Request slots */
+} shm_ring_t;
+
+/**
+ * \brief           Process-local state of one side of a ring
+ */
+struct calc_shm {
+    shm_ring_t* ring;           /*!< The mapped ring */
+    char* name;                 /*!< Name of the shared memory object, set on the server side which removes it */
+    uint32_t next;              /*!< Client: the next request to submit; server: the next request to serve */
+    uint32_t collected;         /*!< Client: replies already collected */
+    uint64_t syscalls;          /*!< A number of futex calls done by this side */
+    uint32_t spin;              /*!< A number of polls before sleeping, 0 on a single CPU where the other side cannot run meanwhile */
+};
+
+static calc_shm_t* shm_map(const char* name, uint8_t create);                   /* A function used to map a ring */
+static uint8_t shm_wait(calc_shm_t* shm, _Atomic uint32_t* index, uint32_t seen, _Atomic uint32_t* sleeping, int32_t timeout_ms);  /* A function used to wait until an index moves */
+static void shm_wake(calc_shm_t* shm, _Atomic uint32_t* index, _Atomic uint32_t* sleeping);    /* A function used to wake the other side if it sleeps */
+
+/**
+ * \brief           A function used to open a ring created by a running server
+ * \param[in]       name: A name of the shared memory object, e.g. "/calc"
+ * \return          A client handle to be released with \ref calc_shm_close, NULL if there is no such ring
+ */
+calc_shm_t*
+calc_shm_open(const char* name) {
+    calc_shm_t* shm = shm_map(name, 0);
+    if (shm != NULL && atomic_load_explicit(&shm->ring->magic, memory_order_acquire) != SHM_MAGIC) {  /* Check if the server has initialized the ring */
+        calc_shm_close(shm);
+        return NULL;
+    }
+    if (shm != NULL) {                      /* Continue after whatever a previous client has left */
+        shm->next = atomic_load_explicit(&shm->ring->submitted, memory_order_relaxed);
+        shm->collected = shm->next;
+    }
+    return shm;
+}
+
+/**
+ * \brief           A function used to submit a request without waiting for the reply
+ * \param[in]       shm: A client handle
+ * \param[in]       str: An expression, it does not have to be NUL-terminated
+ * \param[in]       len: Length of the expression
+ * \return          1 on success, 0 if the ring is full or the expression is too long
+ * \note            No system call is made unless the server sleeps
+ */
+uint8_t
+calc_shm_submit(calc_shm_t* shm, const char* str, size_t len) {
+    shm_slot_t* slot;
+    if (len > CALC_SHM_EXPRESSION_SIZE || shm->next - shm->collected >= CALC_SHM_SLOTS) {
+        return 0;
+    }
+    slot = &shm->ring->slots[shm->next % CALC_SHM_SLOTS];
+    memcpy(slot->expression, str, len);
+    slot->length = (uint32_t)len;
+    atomic_store_explicit(&shm->ring->submitted, ++shm->next, memory_order_release);   /* Publish the slot */
+    shm_wake(shm, &shm->ring->submitted, &shm->ring->server_sleeping);
+    return 1;
+}
+
+/**
+ * \brief           A function used to wait for the reply to the oldest request in flight
+ * \param[in]       shm: A client handle
+ * \param[out]      error: An error report, may be NULL
+ * \return          The result of the calculation, NaN in case of an error
+ */
+double
+calc_shm_collect(calc_shm_t* shm, calc_error_t* error) {
+    const shm_slot_t* slot;
+    calc_error_code_t code = CALC_ERROR_UNKNOWN;
+    double result = nan("");
+    if (shm->collected != shm->next) {      /* Check if there is a request in flight */
+        while ((int32_t)(atomic_load_explicit(&shm->ring->completed, memory_order_acquire) - shm->collected) <= 0) {  /* Wait until the server has answered, the difference is signed as the server may still finish requests of a previous client */
+            shm_wait(shm, &shm->ring->completed, atomic_load_explicit(&shm->ring->completed, memory_order_relaxed), &shm->ring->client_sleeping, -1);
+        }
+        slot = &shm->ring->slots[shm->collected++ % CALC_SHM_SLOTS];
+        code = (calc_error_code_t)slot->code;
+        result = slot->result;
+    }
+    if (error != NULL) {
+        error->code = code;
+        error->position = 0;
+    }
+    return result;
+}
+
+/**
+ * \brief           A function used to calculate an expression by the server and wait for the result
+ * \param[in]       shm: A client handle
+ * \param[in]       str: An expression, it does not have to be NUL-terminated
+ * \param[in]       len: Length of the expression
+ * \param[out]      error: An error report, may be NULL
+ * \return          The result of the calculation, NaN in case of an error
+ * \note            Replies to requests submitted earlier are dropped
+ */
+double
+calc_shm_eval(calc_shm_t* shm, const char* str, size_t len, calc_error_t* error) {
+    while (shm->collected != shm->next) {   /* Drop the replies nobody has collected */
+        calc_shm_collect(shm, NULL);
+    }
+    if (!calc_shm_submit(shm, str, len)) {
+        if (error != NULL) {
+            error->code = CALC_ERROR_INVALID_INPUT;
+            error->position = 0;
+        }
+        return nan("");
+    }
+    return calc_shm_collect(shm, error);
+}
+
+/**
+ * \brief           A function used to get a number of requests waiting to be collected
+ * \param[in]       shm: A client handle
+ * \return          A number of requests submitted and not collected yet
+ */
+size_t
+calc_shm_in_flight(const calc_shm_t* shm) {
+    return shm->next - shm->collected;
+}
+
+/**
+ * \brief           A function used to get a number of system calls this side of the ring has made
+ * \param[in]       shm: A handle
+ * \return          A number of futex calls, it stays the same while the other side keeps up without sleeping
+ */
+uint64_t
+calc_shm_syscalls(const calc_shm_t* shm) {
+    return shm->syscalls;
+}
+
+/**
+ * \brief           A function used to create a ring to be served by this process
+ * \param[in]       name: A name of the shared memory object, e.g. "/calc", an existing object is replaced
+ * \return          A server handle to be released with \ref calc_shm_close, NULL in case of an error
+ */
+calc_shm_t*
+calc_shm_create(const char* name) {
+    calc_shm_t* shm;
+    shm_unlink(name);                       /* Replace a ring left by a previous run */
+    shm = shm_map(name, 1);
+    if (shm == NULL) {
+        return NULL;
+    }
+    shm->name = (char*)malloc(strlen(name) + 1);
+    if (shm->name == NULL) {
+        calc_shm_close(shm);
+        shm_unlink(name);
+        return NULL;
+    }
+    memcpy(shm->name, name, strlen(name) + 1);
+    atomic_store_explicit(&shm->ring->magic, SHM_MAGIC, memory_order_release);
+    return shm;
+}
+
+/**
+ * \brief           A function used to wait for the next request
+ * \param[in]       shm: A server handle
+ * \param[out]      len: Length of the expression
+ * \param[in]       timeout_ms: Maximum time to sleep, -1 to wait forever
+ * \return          The expression, not NUL-terminated, NULL if there has been no request in time
+ * \note            The reply has to be given by \ref calc_shm_complete before the next request is taken
+ */
+const char*
+calc_shm_next_request(calc_shm_t* shm, size_t* len, int32_t timeout_ms) {
+    const shm_slot_t* slot;
+    if (atomic_load_explicit(&shm->ring->submitted, memory_order_acquire) == shm->next
+        && (!shm_wait(shm, &shm->ring->submitted, shm->next, &shm->ring->server_sleeping, timeout_ms)
+            || atomic_load_explicit(&shm->ring->submitted, memory_order_acquire) == shm->next)) {
+        return NULL;
+    }
+    slot = &shm->ring->slots[shm->next % CALC_SHM_SLOTS];
+    *len = slot->length <= CALC_SHM_EXPRESSION_SIZE ? slot->length : CALC_SHM_EXPRESSION_SIZE;  /* The client is not trusted with the length */
+    return slot->expression;
+}
+
+/**
+ * \brief           A function used to reply to the request returned by \ref calc_shm_next_request
+ * \param[in]       shm: A server handle
+ * \param[in]       result: The result of the calculation
+ * \param[in]       code: An error code of the calculation
+ */
+void
+calc_shm_complete(calc_shm_t* shm, double result, calc_error_code_t code) {
+    shm_slot_t* slot = &shm->ring->slots[shm->next % CALC_SHM_SLOTS];
+    slot->result = result;
+    slot->code = (int32_t)code;
+    atomic_store_explicit(&shm->ring->completed, ++shm->next, memory_order_release);   /* Publish the reply */
+    shm_wake(shm, &shm->ring->completed, &shm->ring->client_sleeping);
+}
+
+/**
+ * \brief           A function used to unmap a ring
+ * \param[in]       shm: A handle, may be NULL
+ * \note            The server side also removes the shared memory object
+ */
+void
+calc_shm_close(calc_shm_t* shm) {
+    if (shm == NULL) {
+        return;
+    }
+    if (shm->name != NULL) {
+        shm_unlink(shm->name);
+        free(shm->name);
+    }
+    munmap(shm->ring, sizeof(shm_ring_t));
+    free(shm);
+}
+
+/**
+ * \brief           A function used to map a ring
+ * \param[in]       name: A name of the shared memory object
+ * \param[in]       create: 1 to create the object, 0 to open an existing one
+ * \return          A handle, NULL in case of an error
+ */
+static calc_shm_t*
+shm_map(const char* name, uint8_t create) {
+    calc_shm_t* shm = (calc_shm_t*)calloc(1, sizeof(calc_shm_t));
+    int fd;
+    if (shm == NULL) {
+        return NULL;
+    }
+    fd = shm_open(name, create ? O_RDWR | O_CREAT | O_EXCL : O_RDWR, 0600);
+    if (fd < 0 || (create && ftruncate(fd, sizeof(shm_ring_t)) < 0)) {
+        if (fd >= 0) {
+            close(fd);
+        }
+        free(shm);
+        return NULL;
+    }
+    shm->ring = (shm_ring_t*)mmap(NULL, sizeof(shm_ring_t), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);                              /* The mapping keeps the object alive */
+    if (shm->ring == MAP_FAILED) {
+        free(shm);
+        return NULL;
+    }
+    shm->spin = sysconf(_SC_NPROCESSORS_ONLN) > 1 ? SHM_SPIN : 0;
+    return shm;
+}
+
+/**
+ * \brief           A function used to wait until an index moves from a seen value
+ * \param[in]       shm: A handle, used to count system calls
+ * \param[in]       index: The index to watch
+ * \param[in]       seen: The value the index had
+ * \param[in]       sleeping: The flag telling the other side to wake this one
+ * \param[in]       timeout_ms: Maximum time to sleep, -1 to wait forever
+ * \return          1 if the index has moved, 0 if the time is out or the sleep has been interrupted
+ * \note            The index is polled for a while first, the futex is only used if the other side is slow
+ */
+static uint8_t
+shm_wait(calc_shm_t* shm, _Atomic uint32_t* index, uint32_t seen, _Atomic uint32_t* sleeping, int32_t timeout_ms) {
+    struct timespec timeout = {timeout_ms / 1000, (long)(timeout_ms % 1000) * 1000000L};
+    for (uint32_t i = 0; i < shm->spin; ++i) {  /* The fast path: the other side answers within the spin */
+        if (atomic_load_explicit(index, memory_order_acquire) != seen) {
+            return 1;
+        }
+        shm_pause();
+    }
+    atomic_store_explicit(sleeping, 1, memory_order_seq_cst);   /* Announce the sleep before the last check, so that a wake cannot be missed */
+    if (atomic_load_explicit(index, memory_order_seq_cst) == seen) {
+        ++shm->syscalls;
+        if (syscall(SYS_futex, (uint32_t*)index, FUTEX_WAIT, seen, timeout_ms < 0 ? NULL : &timeout, NULL, 0) < 0
+            && errno != EAGAIN) {
+            atomic_store_explicit(sleeping, 0, memory_order_relaxed);
+            return 0;                       /* Timed out or interrupted by a signal */
+        }
+    }
+    atomic_store_explicit(sleeping, 0, memory_order_relaxed);
+    return atomic_load_explicit(index, memory_order_acquire) != seen;
+}
+
+/**
+ * \brief           A function used to wake the other side if it sleeps on an index
+ * \param[in]       shm: A handle, used to count system calls
+ * \param[in]       index: The index which has just moved
+ * \param[in]       sleeping: The flag set by the other side before it sleeps
+ */
+static void
+shm_wake(calc_shm_t* shm, _Atomic uint32_t* index, _Atomic uint32_t* sleeping) {
+    atomic_thread_fence(memory_order_seq_cst);  /* Order the publication before the check of the flag */
+    if (atomic_load_explicit(sleeping, memory_order_relaxed)) {
+        ++shm->syscalls;
+        syscall(SYS_futex, (uint32_t*)index, FUTEX_WAKE, 1, NULL, NULL, 0);
+    }
+}
+
+#endif /* __linux__ */
@@ -0,0 +1,72 @@
+/**
+ * \file            calc_shm.h
+ * \brief           Shared memory transport of calculation requests between processes on the same host
+ */
+
+/*
+ * Copyright (c) 2024 Daniil VERES
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * Author:          Daniil VERES <daniaveres@gmail.com>
+ * Version:         v1.0.0
+ */
+
+#ifndef CALC_SHM_HDR_H
+#define CALC_SHM_HDR_H
+
+#include <stddef.h> /* size_t */
+#include <stdint.h> /* uint8_t, uint64_t */
+#include "calc.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+#define CALC_SHM_SLOTS 256              /*!< A number of request slots in the ring, a power of two */
+#define CALC_SHM_EXPRESSION_SIZE 240    /*!< Maximum length of an expression sent through the ring */
+
+/**
+ * \brief           Opaque handle of a mapped request ring
+ * \note            A ring connects one server with one client, the client side must not be used by several threads at once
+ */
+typedef struct calc_shm calc_shm_t;
+
+                                        /* Client side */
+calc_shm_t*     calc_shm_open(const char* name);
+uint8_t         calc_shm_submit(calc_shm_t* shm, const char* str, size_t len);
+double          calc_shm_collect(calc_shm_t* shm, calc_error_t* error);
+double          calc_shm_eval(calc_shm_t* shm, const char* str, size_t len, calc_error_t* error);
+size_t          calc_shm_in_flight(const calc_shm_t* shm);
+uint64_t        calc_shm_syscalls(const calc_shm_t* shm);
+
+                                        /* Server side */
+calc_shm_t*     calc_shm_create(const char* name);
+const char*     calc_shm_next_request(calc_shm_t* shm, size_t* len, int32_t timeout_ms);
+void            calc_shm_complete(calc_shm_t* shm, double result, calc_error_code_t code);
+
+void            calc_shm_close(calc_shm_t* shm);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* CALC_SHM_HDR_H */
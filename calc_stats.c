@@ -0,0 +1,166 @@
+/**
+ * \file            calc_stats.c
+ * \brief           Per-stage latency histograms of the batch and server modes
+ */
+
+/*
+ * Copyright (c) 2024 Daniil VERES
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * Author:          Daniil VERES <daniaveres@gmail.com>
+ * Version:         v1.0.0
+ */
+
+#include "calc_stats.h"
+
+                                        /* Constants used: */
+#define STATS_SUB_BITS 7                /*!< Bits of a value kept exactly, the relative error of a bucket is below 2^-(STATS_SUB_BITS - 1) */
+#define STATS_SUB_COUNT (1 << STATS_SUB_BITS)   /*!< Values below this have a bucket each */
+#define STATS_MAX_BITS 44               /*!< Values up to 2^44 ns (about 4.9 hours) are kept, longer ones are clamped */
+#define STATS_BUCKETS (STATS_SUB_COUNT + (STATS_MAX_BITS - STATS_SUB_BITS) * (STATS_SUB_COUNT / 2))    /*!< A number of buckets of a histogram */
+
+/**
+ * \brief           A histogram with logarithmic buckets of linear sub-buckets, as HDR histograms
+ * \note            Every power of two range is split into the same number of buckets, so the precision of percentiles is relative,
+ *                  recording is a few instructions and the memory does not depend on the number of values
+ */
+typedef struct {
+    uint64_t counts[STATS_BUCKETS];     /*!< Counts of the buckets */
+    uint64_t total;                     /*!< A number of recorded values */
+    uint64_t sum;                       /*!< Sum of the recorded values */
+    uint64_t max;                       /*!< The largest recorded value */
+} stats_histogram_t;
+
+uint8_t calc_stats_enabled;                                 /*!< Set when the stages are timed */
+static stats_histogram_t histograms[CALC_STAGE_COUNT];      /*!< A histogram per stage */
+static const char* const stage_names[CALC_STAGE_COUNT] = {"validation", "parsing", "evaluation", "formatting"};
+
+static size_t bucket_of(uint64_t value);                    /* A function used to find the bucket of a value */
+static uint64_t bucket_high(size_t bucket);                 /* A function used to get the largest value of a bucket */
+static uint64_t percentile(const stats_histogram_t* histogram, double fraction);  /* A function used to get a percentile */
+
+/**
+ * \brief           A function used to enable timing of the stages
+ */
+void
+calc_stats_enable(void) {
+    calc_stats_enabled = 1;
+}
+
+/**
+ * \brief           A function used to record the duration of a stage
+ * \param[in]       stage: The stage
+ * \param[in]       ns: The duration in nanoseconds
+ */
+void
+calc_stats_record(calc_stage_t stage, uint64_t ns) {
+    stats_histogram_t* histogram = &histograms[stage];
+    ++histogram->counts[bucket_of(ns)];
+    ++histogram->total;
+    histogram->sum += ns;
+    if (ns > histogram->max) {
+        histogram->max = ns;
+    }
+}
+
+/**
+ * \brief           A function used to print the percentiles of every stage
+ * \param[in]       out: A stream to print to
+ * \note            Percentiles are the upper bounds of their buckets, so they are never below the real value
+ */
+void
+calc_stats_print(FILE* out) {
+    if (!calc_stats_enabled) {
+        return;
+    }
+    fprintf(out, "%-12s %12s %10s %10s %10s %10s %10s %10s\n", "stage (ns)", "count", "mean", "p50", "p90", "p99", "p99.9", "max");
+    for (size_t i = 0; i < CALC_STAGE_COUNT; ++i) {
+        const stats_histogram_t* histogram = &histograms[i];
+        fprintf(out, "%-12s %12llu %10.0f %10llu %10llu %10llu %10llu %10llu\n", stage_names[i],
+                (unsigned long long)histogram->total,
+                histogram->total > 0 ? (double)histogram->sum / (double)histogram->total : 0.0,
+                (unsigned long long)percentile(histogram, 0.50), (unsigned long long)percentile(histogram, 0.90),
+                (unsigned long long)percentile(histogram, 0.99), (unsigned long long)percentile(histogram, 0.999),
+                (unsigned long long)histogram->max);
+    }
+    fflush(out);
+}
+
+/**
+ * \brief           A function used to find the bucket of a value
+ * \param[in]       value: The value
+ * \return          An index of the bucket
+ */
+static size_t
+bucket_of(uint64_t value) {
+    uint32_t magnitude;                         /* Index of the highest set bit */
+    if (value < STATS_SUB_COUNT) {
+        return (size_t)value;
+    }
+    if (value >= (1ULL << STATS_MAX_BITS)) {
+        value = (1ULL << STATS_MAX_BITS) - 1;
+    }
+    magnitude = 63 - (uint32_t)__builtin_clzll(value);
+    return STATS_SUB_COUNT + (magnitude - STATS_SUB_BITS) * (STATS_SUB_COUNT / 2)
+         + (size_t)((value >> (magnitude - STATS_SUB_BITS + 1)) - STATS_SUB_COUNT / 2);
+}
+
+/**
+ * \brief           A function used to get the largest value of a bucket
+ * \param[in]       bucket: An index of the bucket
+ * \return          The value
+ */
+static uint64_t
+bucket_high(size_t bucket) {
+    size_t range, sub;
+    if (bucket < STATS_SUB_COUNT) {
+        return (uint64_t)bucket;
+    }
+    range = (bucket - STATS_SUB_COUNT) / (STATS_SUB_COUNT / 2);     /* The power of two above STATS_SUB_BITS */
+    sub = (bucket - STATS_SUB_COUNT) % (STATS_SUB_COUNT / 2) + STATS_SUB_COUNT / 2;
+    return (((uint64_t)sub + 1) << (range + 1)) - 1;
+}
+
+/**
+ * \brief           A function used to get a percentile of a histogram
+ * \param[in]       histogram: The histogram
+ * \param[in]       fraction: The percentile as a fraction, e.g. 0.99
+ * \return          The value, 0 for an empty histogram
+ */
+static uint64_t
+percentile(const stats_histogram_t* histogram, double fraction) {
+    uint64_t rank = (uint64_t)(fraction * (double)histogram->total + 0.5), seen = 0;
+    if (histogram->total == 0) {
+        return 0;
+    }
+    if (rank == 0) {
+        rank = 1;
+    }
+    for (size_t i = 0; i < STATS_BUCKETS; ++i) {
+        seen += histogram->counts[i];
+        if (seen >= rank) {
+            uint64_t high = bucket_high(i);
+            return high < histogram->max ? high : histogram->max;
+        }
+    }
+    return histogram->max;
+}
@@ -0,0 +1,93 @@
+/**
+ * \file            calc_stats.h
+ * \brief           Per-stage latency histograms of the batch and server modes
+ */
+
+/*
+ * Copyright (c) 2024 Daniil VERES
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * Author:          Daniil VERES <daniaveres@gmail.com>
+ * Version:         v1.0.0
+ */
+
+#ifndef CALC_STATS_HDR_H
+#define CALC_STATS_HDR_H
+
+#include <stdint.h> /* uint8_t, uint64_t */
+#include <stdio.h>  /* FILE */
+#include <time.h>   /* clock_gettime */
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/**
+ * \brief           Enumeration representing stages of a calculation
+ */
+typedef enum {
+    CALC_STAGE_VALIDATE = 0,    /*!< Checks of the input, \ref calc_validate */
+    CALC_STAGE_PARSE,           /*!< Compilation, \ref calc_compile */
+    CALC_STAGE_EVAL,            /*!< Evaluation, \ref calc_eval_ctx */
+    CALC_STAGE_FORMAT,          /*!< Formatting of the reply */
+    CALC_STAGE_COUNT            /*!< A number of stages */
+} calc_stage_t;
+
+extern uint8_t calc_stats_enabled;  /*!< Set by \ref calc_stats_enable, the stages are not timed otherwise */
+
+void calc_stats_enable(void);
+void calc_stats_record(calc_stage_t stage, uint64_t ns);
+void calc_stats_print(FILE* out);
+
+/**
+ * \brief           A function used to start timing the stages of a calculation
+ * \return          The current monotonic time in nanoseconds, 0 if the statistics are disabled
+ */
+static inline uint64_t
+calc_stats_start(void) {
+    struct timespec ts;
+    if (!calc_stats_enabled) {
+        return 0;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * \brief           A function used to record the time of a stage which has just finished
+ * \param[in]       stage: The stage
+ * \param[in,out]   lap: The time the stage has started, set to the current time for the next stage
+ */
+static inline void
+calc_stats_lap(calc_stage_t stage, uint64_t* lap) {
+    if (calc_stats_enabled) {
+        uint64_t now = calc_stats_start();
+        calc_stats_record(stage, now - *lap);
+        *lap = now;
+    }
+}
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* CALC_STATS_HDR_H */
@@ -0,0 +1,1444 @@
+/**
+ * \file            calc_bench.c
+ * \brief           Microbenchmarks of the validation, parsing, evaluation and formatting stages and of every builtin
+ */
+
+/*
+ * Copyright (c) 2024 Daniil VERES
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * Author:          Daniil VERES <daniaveres@gmail.com>
+ * Version:         v1.0.0
+ */
+
+                    /* Functions used: */
+#include <errno.h>  /* errno */
+#include <math.h>   /* sqrt, NAN, isnan */
+#include <stdint.h> /* uint8_t, uint64_t */
+#include <stdio.h>  /* printf, fprintf, snprintf, fopen */
+#include <stdlib.h> /* strtoul, malloc, free */
+#include <string.h> /* strlen, strstr, strcmp, strerror */
+#include <time.h>   /* clock_gettime */
+#include "calc.h"
+
+#ifdef __linux__
+#include <linux/perf_event.h>   /* perf_event_attr, PERF_COUNT_HW_* */
+#include <sys/ioctl.h>          /* ioctl */
+#include <sys/syscall.h>        /* SYS_perf_event_open */
+#include <unistd.h>             /* syscall, read, close */
+#endif /* __linux__ */
+
+                                        /* Constants used: */
+#define BENCH_DEFAULT_SAMPLES 31        /*!< Default number of timed samples per benchmark */
+#define BENCH_DEFAULT_SAMPLE_MS 2       /*!< Default minimal duration of one sample in milliseconds */
+#define BENCH_DEFAULT_SEED 0x5eed       /*!< Default seed of the corpus generator, fixed so that runs are comparable */
+#define BENCH_MAX_SAMPLES 1000          /*!< Maximal number of samples per benchmark */
+#define BENCH_LINE_SIZE 4096            /*!< Maximal length of a generated line */
+#define BENCH_SHORT_LINES 256           /*!< A number of lines of the short arithmetic corpus */
+#define BENCH_NESTED_LINES 64           /*!< A number of lines of the deep nesting corpus */
+#define BENCH_NESTED_DEPTH 24           /*!< Nesting depth of the deep nesting corpus */
+#define BENCH_FLAT_LINES 16             /*!< A number of lines of the long flat sums corpus */
+#define BENCH_FLAT_TERMS 200            /*!< A number of terms in a line of the long flat sums corpus */
+#define BENCH_CALLS_PER_LINE 4          /*!< A number of function calls in a line of the function corpus */
+#define BENCH_FACTORIAL_LINES 64        /*!< A number of lines of the factorial corpus */
+#define BENCH_FACTORIAL_CALLS 4         /*!< A number of factorials in a line of the factorial corpus */
+#define BENCH_POWER_LINES 64            /*!< A number of lines of the power corpus */
+#define BENCH_POWER_TERMS 4             /*!< A number of powers in a line of the power corpus */
+#define BENCH_INTEGER_LINES 64          /*!< A number of lines of the integer corpus */
+#define BENCH_INTEGER_TERMS 6           /*!< A number of products in a line of the integer corpus */
+#define BENCH_MONEY_LINES 64            /*!< A number of lines of the money corpus */
+#define BENCH_MONEY_TERMS 4             /*!< A number of amounts in a line of the money corpus */
+#define BENCH_MONEY_SCALE 4             /*!< Digits after the point of the decimal evaluation of the money corpus */
+#define BENCH_MONEY_DIGITS 38           /*!< Significant digits of the arbitrary-precision evaluation of the money corpus */
+#define BENCH_MONEY_MODES 2             /*!< A number of evaluation modes compared on the money corpus */
+#define BENCH_CORPORA 8                 /*!< A number of stage corpora */
+#define BENCH_STAGES 8                  /*!< A number of stages benchmarked on every corpus */
+#define BENCH_ARGS 256                  /*!< A number of argument sets per builtin benchmark */
+#define BENCH_COUNTERS 5                /*!< A number of hardware counters */
+#define BENCH_BIG_CASES 4               /*!< A number of arbitrary-precision benchmarks */
+#define BENCH_COLUMN_CASES 4            /*!< A number of expressions evaluated over complex columns */
+#define BENCH_COLUMN_MODES 2            /*!< A number of evaluation modes compared on the complex columns, a row at a time and the columnar one */
+#define BENCH_COLUMN_ROWS 1024          /*!< Rows of the complex columns */
+#define BENCH_COLUMN_VARS 2             /*!< Variables of the complex columns, `z` and `w` */
+#define BENCH_SIGNAL_CASES 4            /*!< A number of expressions evaluated over signal columns */
+#define BENCH_SIGNAL_MODES 2            /*!< A number of evaluation modes compared on the signals, double rows and float columns */
+#define BENCH_SIGNAL_ROWS 1024          /*!< Rows of the signal columns */
+#define BENCH_SIGNAL_VARS 2             /*!< Variables of the signal columns, `x` and `y` */
+#define BENCH_GRADIENT_CASES 4          /*!< A number of expressions whose gradients are calculated */
+#define BENCH_GRADIENT_MODES 5          /*!< A number of evaluation modes compared on the gradients, the value alone, dual rows, dual columns,
+                                                 the tape and the symbolic derivatives */
+#define BENCH_GRADIENT_ROWS 1024        /*!< Rows of the gradient columns */
+#define BENCH_GRADIENT_VARS 4           /*!< Variables of the gradient expressions, at most */
+#define BENCH_INTEGRATE_CASES 4         /*!< A number of integrals */
+#define BENCH_INTEGRATE_MODES 2         /*!< A number of evaluation modes compared on the integrals, on the calling thread and shared */
+#define BENCH_INTEGRATE_THREADS 4       /*!< Threads of the shared integrals */
+#define BENCH_INTEGRATE_TOLERANCE 1e-10 /*!< The relative tolerance of the integrals */
+
+/**
+ * \brief           A set of generated expressions
+ */
+typedef struct {
+    const char* name;               /*!< Name of the corpus */
+    char** lines;                   /*!< The expressions */
+    size_t* lengths;                /*!< Lengths of the expressions */
+    calc_expr_t** exprs;            /*!< The expressions compiled once for the evaluation benchmarks */
+    size_t count;                   /*!< A number of expressions */
+} corpus_t;
+
+/**
+ * \brief           A single benchmark
+ */
+typedef struct bench {
+    char name[64];                                      /*!< Name of the benchmark, group and subject */
+    double (*run)(const struct bench* bench, uint64_t iterations);  /*!< The timed loop, returns a value to keep the work alive */
+    const corpus_t* corpus;                             /*!< The corpus of the stage benchmarks */
+    const calc_function_t* function;                    /*!< The function of the builtin benchmarks */
+    double* args;                                       /*!< Arguments of the builtin benchmarks, \ref BENCH_ARGS sets */
+    float* samples;                                     /*!< Columns of the float benchmarks, then their results */
+    calc_context_t* context;                            /*!< A context of the evaluation benchmarks */
+    calc_expr_t* expr;                                  /*!< The expression of the arbitrary-precision benchmarks */
+    calc_expr_t* derivatives[BENCH_GRADIENT_VARS];      /*!< The partial derivatives of the expression of the symbolic gradient benchmarks */
+    size_t digits;                                      /*!< Significant digits of the arbitrary-precision benchmarks, the scale of the decimal ones */
+} bench_t;
+
+/**
+ * \brief           An arbitrary-precision benchmark, with the length of its result checked before timing
+ */
+typedef struct {
+    const char* name;               /*!< Name of the benchmark */
+    const char* source;             /*!< The expression */
+    size_t digits;                  /*!< Significant digits of the evaluation */
+    size_t length;                  /*!< Length of the printed result */
+} big_case_t;
+
+/**
+ * \brief           The arbitrary-precision benchmarks, integers large enough to take the subquadratic multiplications
+ */
+static const big_case_t big_cases[BENCH_BIG_CASES] = {
+    {"fact5000", "fact(5000)", 20, 16326},
+    {"pow2_100000", "2^100000", 20, 30103},
+    {"pow3_200000", "3^200000-1", 20, 95425},
+    {"div_1000", "1/7", 1000, 1002},
+};
+
+/**
+ * \brief           Expressions of complex variables evaluated a row at a time and in columns
+ */
+static const char* const column_cases[BENCH_COLUMN_CASES][2] = {
+    {"poly", "z^3-2*z^2+z-1"},
+    {"mobius", "(2*z+i)/(z-3*i)"},
+    {"mixed", "z*w+z/w-w^2"},
+    {"sqrt", "sqrt(z)*i+z"},
+};
+
+/**
+ * \brief           Expressions of signals evaluated a row at a time in double precision and in float columns
+ */
+static const char* const signal_cases[BENCH_SIGNAL_CASES][2] = {
+    {"filter", "0.25*x+0.5*y-0.125*x*y+1"},
+    {"wave", "sin(x)*cos(y)+0.5*sin(2*x)"},
+    {"gauss", "exp(-x^2/2)/sqrt(2*3.1415926536)*y"},
+    {"decibel", "20*lg(abs(x)+1)-y^2"},
+};
+
+/**
+ * \brief           Model functions of calibration fits, differentiated with respect to every variable
+ */
+static const char* const gradient_cases[BENCH_GRADIENT_CASES][2] = {
+    {"decay", "a*exp(-b*x)+c"},
+    {"logistic", "a/(1+exp(-b*(x-c)))"},
+    {"wave", "a*sin(b*x+c)"},
+    {"rational", "(a*x^2+b*x+c)/(x^2+1)"},
+};
+
+/**
+ * \brief           Integrands over [0, 1] of the variable `x`, from a smooth one to costly ones that need many subintervals
+ */
+static const char* const integrate_cases[BENCH_INTEGRATE_CASES][2] = {
+    {"smooth", "exp(-(x^2))*cos(3*x)"},
+    {"peak", "1/(0.000001+(x-0.3)^2)"},
+    {"singular", "ln(x)*sqrt(x)"},
+    {"costly", "sin(50*x)*exp(cos(40*x))*atan(sinh(x)*cosh(x))+asinh(tan(x))*sqrt(1+x)"},
+};
+
+/**
+ * \brief           Statistics of a benchmark
+ */
+typedef struct {
+    double mean;                    /*!< Mean time of an operation in nanoseconds */
+    double ci95;                    /*!< Half-width of the 95 % confidence interval of the mean */
+    double median;                  /*!< Median time of an operation */
+    double min;                     /*!< Minimal time of an operation */
+    uint64_t iterations;            /*!< Operations per sample */
+    size_t samples;                 /*!< A number of samples */
+    double counters[BENCH_COUNTERS];    /*!< Hardware events per operation over all samples, NaN if a counter is not available */
+} result_t;
+
+/**
+ * \brief           Names of the hardware counters, as in the JSON output
+ */
+static const char* const counter_names[BENCH_COUNTERS] = {"instructions", "cycles", "branch_misses", "l1d_misses", "llc_misses"};
+static int counter_fds[BENCH_COUNTERS] = {-1, -1, -1, -1, -1};  /*!< Descriptors of the open counters, -1 if not available */
+
+static uint64_t seed = BENCH_DEFAULT_SEED;  /*!< State of the pseudo-random generator */
+static volatile double sink;                /*!< Values of the timed loops end here, so the compiler cannot drop the work */
+
+static uint64_t next_random(void);                                          /* A function used to get the next pseudo-random number */
+static double random_in(double low, double high);                           /* A function used to get a pseudo-random number in a range */
+static uint64_t now_ns(void);                                               /* A function used to get a monotonic time in nanoseconds */
+static int corpus_init(corpus_t* corpus, const char* name, size_t count, void (*generate)(char* line, size_t size)); /* A function used to generate and check a corpus */
+static void generate_short(char* line, size_t size);                        /* A function used to generate a short arithmetic line */
+static void generate_nested(char* line, size_t size);                       /* A function used to generate a deeply nested line */
+static void generate_flat(char* line, size_t size);                         /* A function used to generate a long flat sum */
+static void generate_functions(char* line, size_t size);                    /* A function used to generate a line of function calls */
+static void generate_factorial(char* line, size_t size);                    /* A function used to generate a line of factorials */
+static void generate_power(char* line, size_t size);                        /* A function used to generate a line of integer powers */
+static void generate_integer(char* line, size_t size);                      /* A function used to generate a line of integer arithmetic */
+static void generate_money(char* line, size_t size);                        /* A function used to generate a line of money arithmetic */
+static int format_argument(const calc_function_t* function, char* buffer, size_t size, double* args); /* A function used to pick arguments in the domain of a function */
+static double run_validate(const bench_t* bench, uint64_t iterations);     /* The timed loop of the validation benchmarks */
+static double run_compile(const bench_t* bench, uint64_t iterations);      /* The timed loop of the parsing benchmarks */
+static double run_eval(const bench_t* bench, uint64_t iterations);         /* The timed loop of the evaluation benchmarks */
+static double run_exact(const bench_t* bench, uint64_t iterations);        /* The timed loop of the exact evaluation benchmarks */
+static double run_interval(const bench_t* bench, uint64_t iterations);     /* The timed loop of the interval evaluation benchmarks */
+static double run_complex(const bench_t* bench, uint64_t iterations);      /* The timed loop of the complex evaluation benchmarks */
+static double run_dd(const bench_t* bench, uint64_t iterations);           /* The timed loop of the double-double evaluation benchmarks */
+static double run_complex_rows(const bench_t* bench, uint64_t iterations); /* The timed loop of the complex columns evaluated a row at a time */
+static double run_complex_columns(const bench_t* bench, uint64_t iterations);  /* The timed loop of the complex columns evaluated by the columnar evaluator */
+static double run_signal_rows(const bench_t* bench, uint64_t iterations);  /* The timed loop of the signals evaluated a row at a time in double precision */
+static double run_signal_columns(const bench_t* bench, uint64_t iterations);   /* The timed loop of the signals evaluated in float columns */
+static double run_gradient_eval(const bench_t* bench, uint64_t iterations);    /* The timed loop of the gradient expressions evaluated without partials */
+static double run_gradient_dual(const bench_t* bench, uint64_t iterations);    /* The timed loop of the gradients calculated a row at a time */
+static double run_gradient_columns(const bench_t* bench, uint64_t iterations); /* The timed loop of the gradients calculated in columns */
+static double run_gradient_tape(const bench_t* bench, uint64_t iterations);    /* The timed loop of the gradients calculated in reverse mode */
+static double run_gradient_diff(const bench_t* bench, uint64_t iterations);    /* The timed loop of the gradients evaluated as derivative expressions */
+static double run_integrate(const bench_t* bench, uint64_t iterations);    /* The timed loop of the integrals on the calling thread */
+static double run_integrate_threads(const bench_t* bench, uint64_t iterations);    /* The timed loop of the integrals shared by threads */
+static double run_format(const bench_t* bench, uint64_t iterations);       /* The timed loop of the formatting benchmarks */
+static double run_builtin(const bench_t* bench, uint64_t iterations);      /* The timed loop of the builtin benchmarks */
+static double run_big(const bench_t* bench, uint64_t iterations);          /* The timed loop of the arbitrary-precision benchmarks */
+static double run_decimal(const bench_t* bench, uint64_t iterations);      /* The timed loop of the decimal benchmarks on a corpus */
+static double run_big_corpus(const bench_t* bench, uint64_t iterations);   /* The timed loop of the arbitrary-precision benchmarks on a corpus */
+static void measure(const bench_t* bench, size_t samples, uint64_t sample_ns, result_t* result); /* A function used to time a benchmark */
+static int compare_doubles(const void* a, const void* b);                   /* A function used to sort samples */
+static void print_counter(double value, int width, int precision);         /* A function used to print a column of the counters */
+static size_t counters_open(void);                                          /* A function used to open the hardware counters */
+static void counters_start(void);                                           /* A function used to reset and start the counters */
+static void counters_stop(double* values);                                  /* A function used to stop and read the counters */
+
+/**
+ * \brief           Main function
+ * \param[in]       argc: A number of arguments
+ * \param[in]       argv: Arguments: [-s samples] [-t sample ms] [-f filter] [-r seed] [-j json file] [-c]
+ * \return          0 on success, 1 if the corpora could not be built
+ * \note            Every benchmark is run in samples of at least the given duration, the mean time of an operation
+ *                  is reported with a 95 % confidence interval over the samples. With `-j` the results are also written as JSON,
+ *                  `-j -` writes them to the standard output instead of the table. With `-c` the hardware counters are read over the samples
+ *                  and reported per operation, counters the kernel or the machine does not provide are reported as not available.
+ */
+int
+main(int argc, char** argv) {
+    size_t samples = BENCH_DEFAULT_SAMPLES;
+    uint64_t sample_ns = BENCH_DEFAULT_SAMPLE_MS * 1000000ULL;
+    const char* filter = NULL;                  /* Only benchmarks with the substring in their names are run */
+    const char* json_path = NULL;               /* Where to write the JSON results */
+    corpus_t corpora[BENCH_CORPORA];                        /* The stage corpora */
+    bench_t* benches;                           /* All benchmarks */
+    result_t* results;
+    size_t bench_count = 0, function_count = calc_function_count();
+    FILE* json = NULL;
+    uint8_t table = 1;                          /* Print the human-readable table */
+    uint8_t counters = 0;                       /* Read the hardware counters */
+    uint64_t initial_seed;
+
+    for (int i = 1; i < argc; ++i) {            /* Parse the options */
+        if (i + 1 < argc && strcmp(argv[i], "-s") == 0) {
+            samples = strtoul(argv[++i], NULL, 10);
+        } else if (i + 1 < argc && strcmp(argv[i], "-t") == 0) {
+            sample_ns = strtoul(argv[++i], NULL, 10) * 1000000ULL;
+        } else if (i + 1 < argc && strcmp(argv[i], "-f") == 0) {
+            filter = argv[++i];
+        } else if (i + 1 < argc && strcmp(argv[i], "-r") == 0) {
+            seed = strtoul(argv[++i], NULL, 0);
+        } else if (i + 1 < argc && strcmp(argv[i], "-j") == 0) {
+            json_path = argv[++i];
+        } else if (strcmp(argv[i], "-c") == 0) {
+            counters = 1;
+        } else {
+            samples = 0;
+            break;
+        }
+    }
+    if (samples < 2 || samples > BENCH_MAX_SAMPLES || sample_ns == 0 || seed == 0) {
+        fprintf(stderr, "usage: %s [-s samples] [-t sample ms] [-f filter] [-r seed] [-j json file] [-c]\n", argv[0]);
+        return 1;
+    }
+    initial_seed = seed;
+    if (!corpus_init(&corpora[0], "short", BENCH_SHORT_LINES, generate_short)
+        || !corpus_init(&corpora[1], "nested", BENCH_NESTED_LINES, generate_nested)
+        || !corpus_init(&corpora[2], "flat", BENCH_FLAT_LINES, generate_flat)
+        || !corpus_init(&corpora[3], "functions", (calc_alias_count() + BENCH_CALLS_PER_LINE - 1) / BENCH_CALLS_PER_LINE * 4, generate_functions)
+        || !corpus_init(&corpora[4], "factorial", BENCH_FACTORIAL_LINES, generate_factorial)
+        || !corpus_init(&corpora[5], "power", BENCH_POWER_LINES, generate_power)
+        || !corpus_init(&corpora[6], "integer", BENCH_INTEGER_LINES, generate_integer)
+        || !corpus_init(&corpora[7], "money", BENCH_MONEY_LINES, generate_money)) {
+        return 1;
+    }
+
+    benches = (bench_t*)calloc(BENCH_CORPORA * BENCH_STAGES + function_count + BENCH_BIG_CASES + BENCH_MONEY_MODES + BENCH_COLUMN_CASES * BENCH_COLUMN_MODES
+                                + BENCH_SIGNAL_CASES * BENCH_SIGNAL_MODES
+                                + BENCH_GRADIENT_CASES * BENCH_GRADIENT_MODES + BENCH_INTEGRATE_CASES * BENCH_INTEGRATE_MODES, sizeof(bench_t));
+    results = (result_t*)calloc(BENCH_CORPORA * BENCH_STAGES + function_count + BENCH_BIG_CASES + BENCH_MONEY_MODES + BENCH_COLUMN_CASES * BENCH_COLUMN_MODES
+                                + BENCH_SIGNAL_CASES * BENCH_SIGNAL_MODES
+                                + BENCH_GRADIENT_CASES * BENCH_GRADIENT_MODES + BENCH_INTEGRATE_CASES * BENCH_INTEGRATE_MODES, sizeof(result_t));
+    if (benches == NULL || results == NULL) {
+        fprintf(stderr, "failed to allocate memory\n");
+        return 1;
+    }
+    for (size_t c = 0; c < BENCH_CORPORA; ++c) {            /* Every stage on every corpus */
+        static const char* const stages[] = {"validate", "compile", "eval", "exact", "interval", "complex", "dd", "format"};
+        static double (*const runs[])(const bench_t*, uint64_t) = {run_validate, run_compile, run_eval, run_exact, run_interval, run_complex, run_dd,
+                                                                   run_format};
+        for (size_t s = 0; s < BENCH_STAGES; ++s) {
+            bench_t* bench = &benches[bench_count++];
+            snprintf(bench->name, sizeof(bench->name), "%s/%s", stages[s], corpora[c].name);
+            bench->run = runs[s];
+            bench->corpus = &corpora[c];
+            bench->context = calc_context_create();
+        }
+    }
+    for (size_t f = 0; f < function_count; ++f) {  /* Every builtin on its own */
+        bench_t* bench = &benches[bench_count++];
+        bench->function = calc_function_get(f);
+        snprintf(bench->name, sizeof(bench->name), "builtin/%s", bench->function->name);
+        bench->run = run_builtin;
+        bench->args = (double*)malloc(2 * BENCH_ARGS * sizeof(double));
+        if (bench->args == NULL) {
+            fprintf(stderr, "failed to allocate memory\n");
+            return 1;
+        }
+        for (size_t i = 0; i < BENCH_ARGS; ++i) {
+            char unused[64];
+            format_argument(bench->function, unused, sizeof(unused), &bench->args[2 * i]);
+        }
+    }
+    for (size_t c = 0; c < BENCH_BIG_CASES; ++c) { /* Arbitrary precision, with a check of the result */
+        bench_t* bench = &benches[bench_count++];
+        calc_error_t error;
+        char* text;
+        snprintf(bench->name, sizeof(bench->name), "big/%s", big_cases[c].name);
+        bench->run = run_big;
+        bench->digits = big_cases[c].digits;
+        bench->expr = calc_compile(big_cases[c].source, strlen(big_cases[c].source), &error);
+        text = bench->expr != NULL ? calc_eval_big(bench->expr, NULL, bench->digits, &error) : NULL;
+        if (text == NULL || strlen(text) != big_cases[c].length) {
+            fprintf(stderr, "%s: '%s' does not give %zu characters\n", bench->name, big_cases[c].source, big_cases[c].length);
+            return 1;
+        }
+        free(text);
+    }
+    for (size_t i = 0; i < corpora[7].count; ++i) {        /* The decimal mode must not fall back to double on the money corpus */
+        calc_decimal_t decimal;
+        calc_error_t error;
+        calc_eval_decimal(corpora[7].exprs[i], NULL, BENCH_MONEY_SCALE, &decimal, &error);
+        if (error.code != CALC_OK || !decimal.is_decimal) {
+            fprintf(stderr, "corpus money: '%s' is not evaluated in decimals\n", corpora[7].lines[i]);
+            return 1;
+        }
+    }
+    for (size_t m = 0; m < BENCH_MONEY_MODES; ++m) {        /* The decimal mode against the arbitrary precision on the same sums */
+        bench_t* bench = &benches[bench_count++];
+        snprintf(bench->name, sizeof(bench->name), "%s/money", m == 0 ? "decimal" : "big");
+        bench->run = m == 0 ? run_decimal : run_big_corpus;
+        bench->corpus = &corpora[7];
+        bench->digits = m == 0 ? BENCH_MONEY_SCALE : BENCH_MONEY_DIGITS;
+    }
+    for (size_t c = 0; c < BENCH_COLUMN_CASES * BENCH_COLUMN_MODES; ++c) {  /* Complex rows one by one against the columnar evaluator */
+        bench_t* bench = &benches[bench_count++];
+        calc_error_t error;
+        size_t m = c % BENCH_COLUMN_MODES;
+        snprintf(bench->name, sizeof(bench->name), "%s/%s", m == 0 ? "complex-rows" : "complex-columns", column_cases[c / BENCH_COLUMN_MODES][0]);
+        bench->run = m == 0 ? run_complex_rows : run_complex_columns;
+        bench->expr = calc_compile(column_cases[c / BENCH_COLUMN_MODES][1], strlen(column_cases[c / BENCH_COLUMN_MODES][1]), &error);
+        bench->args = (double*)malloc((2 * BENCH_COLUMN_VARS + 2) * BENCH_COLUMN_ROWS * sizeof(double));  /* Parts of the variables, then of the results */
+        if (bench->expr == NULL || bench->args == NULL) {
+            fprintf(stderr, "%s: failed to compile '%s'\n", bench->name, column_cases[c / BENCH_COLUMN_MODES][1]);
+            return 1;
+        }
+        for (size_t i = 0; i < 2 * BENCH_COLUMN_VARS * BENCH_COLUMN_ROWS; ++i) {
+            bench->args[i] = random_in(-4, 4);
+        }
+    }
+    for (size_t c = 0; c < BENCH_SIGNAL_CASES * BENCH_SIGNAL_MODES; ++c) {  /* Double rows one by one against float columns */
+        bench_t* bench = &benches[bench_count++];
+        calc_error_t error;
+        size_t m = c % BENCH_SIGNAL_MODES;
+        snprintf(bench->name, sizeof(bench->name), "%s/%s", m == 0 ? "signal-double" : "signal-float", signal_cases[c / BENCH_SIGNAL_MODES][0]);
+        bench->run = m == 0 ? run_signal_rows : run_signal_columns;
+        bench->expr = calc_compile(signal_cases[c / BENCH_SIGNAL_MODES][1], strlen(signal_cases[c / BENCH_SIGNAL_MODES][1]), &error);
+        bench->context = calc_context_create();
+        bench->args = (double*)malloc(BENCH_SIGNAL_VARS * BENCH_SIGNAL_ROWS * sizeof(double));
+        bench->samples = (float*)malloc((BENCH_SIGNAL_VARS + 1) * BENCH_SIGNAL_ROWS * sizeof(float));  /* The variables, then the results */
+        if (bench->expr == NULL || bench->context == NULL || bench->args == NULL || bench->samples == NULL) {
+            fprintf(stderr, "%s: failed to compile '%s'\n", bench->name, signal_cases[c / BENCH_SIGNAL_MODES][1]);
+            return 1;
+        }
+        for (size_t i = 0; i < BENCH_SIGNAL_VARS * BENCH_SIGNAL_ROWS; ++i) {
+            bench->samples[i] = (float)random_in(-4, 4);
+            bench->args[i] = bench->samples[i];             /* Both modes take the same values */
+        }
+    }
+    for (size_t c = 0; c < BENCH_GRADIENT_CASES * BENCH_GRADIENT_MODES; ++c) {  /* The value alone against the gradient: forward, reverse, symbolic */
+        static const char* const modes[] = {"gradient-eval", "gradient-dual", "gradient-columns", "gradient-tape", "gradient-diff"};
+        static double (*const runs[])(const bench_t*, uint64_t) = {run_gradient_eval, run_gradient_dual, run_gradient_columns,
+                                                                   run_gradient_tape, run_gradient_diff};
+        bench_t* bench = &benches[bench_count++];
+        calc_error_t error;
+        size_t m = c % BENCH_GRADIENT_MODES;
+        snprintf(bench->name, sizeof(bench->name), "%s/%s", modes[m], gradient_cases[c / BENCH_GRADIENT_MODES][0]);
+        bench->run = runs[m];
+        bench->expr = calc_compile(gradient_cases[c / BENCH_GRADIENT_MODES][1], strlen(gradient_cases[c / BENCH_GRADIENT_MODES][1]), &error);
+        bench->context = calc_context_create();
+        bench->args = (double*)malloc((2 * BENCH_GRADIENT_VARS + 1) * BENCH_GRADIENT_ROWS * sizeof(double));  /* The variables, the results, the partials */
+        if (bench->expr == NULL || bench->context == NULL || bench->args == NULL) {
+            fprintf(stderr, "%s: failed to compile '%s'\n", bench->name, gradient_cases[c / BENCH_GRADIENT_MODES][1]);
+            return 1;
+        }
+        for (size_t v = 0; runs[m] == run_gradient_diff && v < calc_var_count(bench->expr); ++v) {   /* Differentiated once, before timing */
+            bench->derivatives[v] = calc_diff(bench->expr, calc_var_name(bench->expr, v), &error);
+            if (bench->derivatives[v] == NULL) {
+                fprintf(stderr, "%s: failed to differentiate '%s'\n", bench->name, gradient_cases[c / BENCH_GRADIENT_MODES][1]);
+                return 1;
+            }
+        }
+        for (size_t i = 0; i < BENCH_GRADIENT_VARS * BENCH_GRADIENT_ROWS; ++i) {
+            bench->args[i] = random_in(0.1, 2);
+        }
+    }
+    for (size_t c = 0; c < BENCH_INTEGRATE_CASES * BENCH_INTEGRATE_MODES; ++c) {  /* One thread against several, the same subintervals */
+        bench_t* bench = &benches[bench_count++];
+        calc_error_t error;
+        size_t m = c % BENCH_INTEGRATE_MODES;
+        snprintf(bench->name, sizeof(bench->name), "%s/%s", m == 0 ? "integrate" : "integrate-mt", integrate_cases[c / BENCH_INTEGRATE_MODES][0]);
+        bench->run = m == 0 ? run_integrate : run_integrate_threads;
+        bench->expr = calc_compile(integrate_cases[c / BENCH_INTEGRATE_MODES][1], strlen(integrate_cases[c / BENCH_INTEGRATE_MODES][1]), &error);
+        if (bench->expr == NULL) {
+            fprintf(stderr, "%s: failed to compile '%s'\n", bench->name, integrate_cases[c / BENCH_INTEGRATE_MODES][1]);
+            return 1;
+        }
+        calc_integrate(bench->expr, "x", NULL, 0, 1, BENCH_INTEGRATE_TOLERANCE, 1, NULL, &error);
+        if (error.code != CALC_OK) {
+            fprintf(stderr, "%s: failed to integrate '%s'\n", bench->name, integrate_cases[c / BENCH_INTEGRATE_MODES][1]);
+            return 1;
+        }
+    }
+
+    if (json_path != NULL) {
+        if (strcmp(json_path, "-") == 0) {
+            json = stdout;
+            table = 0;
+        } else if ((json = fopen(json_path, "w")) == NULL) {
+            fprintf(stderr, "failed to open %s\n", json_path);
+            return 1;
+        }
+    }
+    if (counters && counters_open() == 0) {
+        counters = 0;                           /* Timing is still useful without the counters */
+    }
+    if (table) {
+        printf("%-24s %12s %10s %12s %12s %12s", "benchmark", "ns/op", "+-95%", "median", "min", "ops/sample");
+        if (counters) {
+            printf(" %10s %10s %6s %10s %10s %10s", "insn/op", "cycles/op", "IPC", "brmiss/op", "L1Dmiss/op", "LLCmiss/op");
+        }
+        printf("\n");
+    }
+    for (size_t b = 0; b < bench_count; ++b) {  /* Run the benchmarks */
+        if (filter != NULL && strstr(benches[b].name, filter) == NULL) {
+            continue;
+        }
+        measure(&benches[b], samples, sample_ns, &results[b]);
+        if (table) {
+            const double* events = results[b].counters;
+            printf("%-24s %12.1f %10.1f %12.1f %12.1f %12llu", benches[b].name, results[b].mean, results[b].ci95,
+                   results[b].median, results[b].min, (unsigned long long)results[b].iterations);
+            if (counters) {
+                print_counter(events[0], 10, 1);
+                print_counter(events[1], 10, 1);
+                print_counter(events[0] / events[1], 6, 2);
+                print_counter(events[2], 10, 3);
+                print_counter(events[3], 10, 3);
+                print_counter(events[4], 10, 3);
+            }
+            printf("\n");
+            fflush(stdout);
+        }
+    }
+    if (json != NULL) {
+        uint8_t first = 1;
+        fprintf(json, "{\n  \"seed\": %llu,\n  \"samples\": %zu,\n  \"benchmarks\": [", (unsigned long long)initial_seed, samples);
+        for (size_t b = 0; b < bench_count; ++b) {
+            if (results[b].samples == 0) {
+                continue;
+            }
+            fprintf(json, "%s\n    {\"name\": \"%s\", \"ns_per_op\": %.3f, \"ci95\": %.3f, \"median\": %.3f, \"min\": %.3f, \"iterations\": %llu",
+                    first ? "" : ",", benches[b].name, results[b].mean, results[b].ci95, results[b].median, results[b].min,
+                    (unsigned long long)results[b].iterations);
+            if (counters) {                     /* Counters per operation, null if not available */
+                fprintf(json, ", \"counters\": {");
+                for (size_t c = 0; c < BENCH_COUNTERS; ++c) {
+                    if (isnan(results[b].counters[c])) {
+                        fprintf(json, "%s\"%s\": null", c > 0 ? ", " : "", counter_names[c]);
+                    } else {
+                        fprintf(json, "%s\"%s\": %.4f", c > 0 ? ", " : "", counter_names[c], results[b].counters[c]);
+                    }
+                }
+                fprintf(json, "}");
+            }
+            fprintf(json, "}");
+            first = 0;
+        }
+        fprintf(json, "\n  ]\n}\n");
+        if (json != stdout) {
+            fclose(json);
+        }
+    }
+    return 0;
+}
+
+/**
+ * \brief           A function used to get the next pseudo-random number
+ * \return          The number
+ * \note            xorshift64*, so that the corpora are the same on every platform for the same seed
+ */
+static uint64_t
+next_random(void) {
+    seed ^= seed >> 12;
+    seed ^= seed << 25;
+    seed ^= seed >> 27;
+    return seed * 0x2545F4914F6CDD1DULL;
+}
+
+/**
+ * \brief           A function used to get a pseudo-random number in a range
+ * \param[in]       low: The lower bound
+ * \param[in]       high: The upper bound
+ * \return          The number
+ */
+static double
+random_in(double low, double high) {
+    return low + (high - low) * (double)(next_random() >> 11) / (double)(1ULL << 53);
+}
+
+/**
+ * \brief           A function used to get a monotonic time in nanoseconds
+ * \return          The time
+ */
+static uint64_t
+now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * \brief           A function used to generate a corpus and check that every line passes every stage
+ * \param[out]      corpus: The corpus
+ * \param[in]       name: Name of the corpus
+ * \param[in]       count: A number of lines
+ * \param[in]       generate: A generator of one line
+ * \return          1 on success, 0 otherwise
+ */
+static int
+corpus_init(corpus_t* corpus, const char* name, size_t count, void (*generate)(char* line, size_t size)) {
+    char line[BENCH_LINE_SIZE];
+    calc_context_t* context = calc_context_create();
+    corpus->name = name;
+    corpus->count = count;
+    corpus->lines = (char**)calloc(count, sizeof(char*));
+    corpus->lengths = (size_t*)calloc(count, sizeof(size_t));
+    corpus->exprs = (calc_expr_t**)calloc(count, sizeof(calc_expr_t*));
+    if (corpus->lines == NULL || corpus->lengths == NULL || corpus->exprs == NULL || context == NULL) {
+        fprintf(stderr, "failed to allocate memory\n");
+        return 0;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        calc_error_t error;
+        generate(line, sizeof(line));
+        corpus->lengths[i] = strlen(line);
+        corpus->lines[i] = (char*)malloc(corpus->lengths[i] + 1);
+        if (corpus->lines[i] == NULL) {
+            fprintf(stderr, "failed to allocate memory\n");
+            return 0;
+        }
+        memcpy(corpus->lines[i], line, corpus->lengths[i] + 1);
+        corpus->exprs[i] = calc_compile(line, corpus->lengths[i], &error);
+        if (!calc_validate(line, corpus->lengths[i]) || corpus->exprs[i] == NULL) {    /* Every stage must do the full work */
+            fprintf(stderr, "corpus %s: '%s' is not valid\n", name, line);
+            return 0;
+        }
+        calc_eval_ctx(context, corpus->exprs[i], NULL, &error);
+        if (error.code != CALC_OK) {
+            fprintf(stderr, "corpus %s: '%s': %s\n", name, line, calc_error_string(error.code));
+            return 0;
+        }
+    }
+    calc_context_free(context);
+    return 1;
+}
+
+/**
+ * \brief           A function used to generate a short arithmetic line, e.g. `12.5*3-7/2`
+ * \param[out]      line: The line
+ * \param[in]       size: Size of the line buffer
+ */
+static void
+generate_short(char* line, size_t size) {
+    static const char operators[] = "+-*/";
+    size_t terms = 3 + next_random() % 3, length = 0;
+    for (size_t i = 0; i < terms; ++i) {
+        if (i > 0) {
+            line[length++] = operators[next_random() % 4];
+        }
+        if (next_random() % 2) {
+            length += (size_t)snprintf(line + length, size - length, "%u", (unsigned)(1 + next_random() % 999));
+        } else {
+            length += (size_t)snprintf(line + length, size - length, "%.2f", random_in(1, 100));
+        }
+    }
+    line[length] = '\0';
+}
+
+/**
+ * \brief           A function used to generate a deeply nested line, e.g. `(((1+2)*3)-4)`
+ * \param[out]      line: The line
+ * \param[in]       size: Size of the line buffer
+ */
+static void
+generate_nested(char* line, size_t size) {
+    static const char operators[] = "+-*/";
+    size_t length = 0;
+    for (size_t i = 0; i < BENCH_NESTED_DEPTH; ++i) {
+        line[length++] = '(';
+    }
+    length += (size_t)snprintf(line + length, size - length, "%u", (unsigned)(1 + next_random() % 9));
+    for (size_t i = 0; i < BENCH_NESTED_DEPTH; ++i) {
+        length += (size_t)snprintf(line + length, size - length, "%c%u)", operators[next_random() % 4], (unsigned)(1 + next_random() % 9));
+    }
+    line[length] = '\0';
+}
+
+/**
+ * \brief           A function used to generate a long flat sum, e.g. `1+2.5-3+...`
+ * \param[out]      line: The line
+ * \param[in]       size: Size of the line buffer
+ */
+static void
+generate_flat(char* line, size_t size) {
+    size_t length = 0;
+    for (size_t i = 0; i < BENCH_FLAT_TERMS; ++i) {
+        if (i > 0) {
+            line[length++] = next_random() % 4 ? '+' : '-';
+        }
+        length += (size_t)snprintf(line + length, size - length, "%.1f", random_in(1, 1000));
+    }
+    line[length] = '\0';
+}
+
+/**
+ * \brief           A function used to generate a line of function calls, e.g. `sqrt(0.5)+tg(0.3)+...`
+ * \param[out]      line: The line
+ * \param[in]       size: Size of the line buffer
+ * \note            Lines take the names of the functions in turn, so every accepted name appears in the corpus
+ */
+static void
+generate_functions(char* line, size_t size) {
+    static size_t alias = 0;                    /* The next name to use */
+    size_t length = 0;
+    for (size_t i = 0; i < BENCH_CALLS_PER_LINE; ++i) {
+        const char* name = calc_alias_name(alias++ % calc_alias_count());
+        char argument[64];
+        double args[2];
+        format_argument(calc_function_find(name, strlen(name)), argument, sizeof(argument), args);
+        length += (size_t)snprintf(line + length, size - length, "%s%s(%s)", i > 0 ? "+" : "", name, argument);
+    }
+    line[length] = '\0';
+}
+
+/**
+ * \brief           A function used to generate a line of factorials of integers, e.g. `fact(170)/fact(168)+fact(12)`
+ * \param[out]      line: The line
+ * \param[in]       size: Size of the line buffer
+ */
+static void
+generate_factorial(char* line, size_t size) {
+    size_t length = 0;
+    for (size_t i = 0; i < BENCH_FACTORIAL_CALLS; ++i) {
+        if (i > 0) {
+            line[length++] = i % 2 ? '/' : '+';
+        }
+        length += (size_t)snprintf(line + length, size - length, "fact(%u)", (unsigned)(next_random() % 171));
+    }
+    line[length] = '\0';
+}
+
+/**
+ * \brief           A function used to generate a line of integer powers, e.g. `1.25^3+7^2-2.5^(0-1)`
+ * \param[out]      line: The line
+ * \param[in]       size: Size of the line buffer
+ * \note            Most exponents are literals, known at compile time, the rest are calculated
+ */
+static void
+generate_power(char* line, size_t size) {
+    size_t length = 0;
+    for (size_t i = 0; i < BENCH_POWER_TERMS; ++i) {
+        unsigned exponent = (unsigned)(1 + next_random() % 8);
+        if (i > 0) {
+            line[length++] = next_random() % 2 ? '+' : '-';
+        }
+        length += (size_t)snprintf(line + length, size - length, "%.2f^", random_in(1, 3));
+        switch (next_random() % 4) {
+            case 0:
+                length += (size_t)snprintf(line + length, size - length, "(0-%u)", exponent);
+                break;
+            case 1:
+                length += (size_t)snprintf(line + length, size - length, "(%u+1)", exponent);
+                break;
+            default:
+                length += (size_t)snprintf(line + length, size - length, "%u", exponent);
+                break;
+        }
+    }
+    line[length] = '\0';
+}
+
+/**
+ * \brief           A function used to generate a line of integer arithmetic, e.g. `912673*70241-8812*4096+...`
+ * \param[out]      line: The line
+ * \param[in]       size: Size of the line buffer
+ * \note            Products reach 2^60, beyond the integers a double holds exactly
+ */
+static void
+generate_integer(char* line, size_t size) {
+    size_t length = 0;
+    for (size_t i = 0; i < BENCH_INTEGER_TERMS; ++i) {
+        if (i > 0) {
+            line[length++] = next_random() % 2 ? '+' : '-';
+        }
+        length += (size_t)snprintf(line + length, size - length, "%u*%u", (unsigned)(1 + next_random() % 999999999),
+                                   (unsigned)(1 + next_random() % 999999999));
+    }
+    line[length] = '\0';
+}
+
+/**
+ * \brief           A function used to generate a line of money arithmetic, e.g. `1234.56*1.0825+19.99-350.40/3+...`
+ * \param[out]      line: The line
+ * \param[in]       size: Size of the line buffer
+ * \note            Amounts have cents and rates have four decimals, neither of them is exact in double
+ */
+static void
+generate_money(char* line, size_t size) {
+    size_t length = 0;
+    for (size_t i = 0; i < BENCH_MONEY_TERMS; ++i) {
+        if (i > 0) {
+            line[length++] = next_random() % 2 ? '+' : '-';
+        }
+        switch (next_random() % 3) {
+            case 0:
+                length += (size_t)snprintf(line + length, size - length, "%u.%02u*1.%04u", (unsigned)(next_random() % 100000),
+                                           (unsigned)(next_random() % 100), (unsigned)(next_random() % 10000));
+                break;
+            case 1:
+                length += (size_t)snprintf(line + length, size - length, "%u.%02u/%u", (unsigned)(next_random() % 100000),
+                                           (unsigned)(next_random() % 100), (unsigned)(1 + next_random() % 12));
+                break;
+            default:
+                length += (size_t)snprintf(line + length, size - length, "%u.%02u", (unsigned)(next_random() % 100000),
+                                           (unsigned)(next_random() % 100));
+                break;
+        }
+    }
+    line[length] = '\0';
+}
+
+/**
+ * \brief           A function used to pick arguments in the domain of a function
+ * \param[in]       function: The function
+ * \param[out]      buffer: The arguments as text, separated by commas
+ * \param[in]       size: Size of the buffer
+ * \param[out]      args: The arguments as numbers, the first two of them
+ * \return          A number of characters written
+ */
+static int
+format_argument(const calc_function_t* function, char* buffer, size_t size, double* args) {
+    if (strcmp(function->name, "fact") == 0) {  /* Integers are the common case, served from the table */
+        args[0] = (double)(next_random() % 171);
+        return snprintf(buffer, size, "%.0f", args[0]);
+    }
+    switch (function->domain) {
+        case CALC_DOMAIN_AT_LEAST_ONE:
+            args[0] = random_in(1, 10);
+            break;
+        case CALC_DOMAIN_LOG_BASE:
+            args[0] = (double)(2 + next_random() % 8);
+            args[1] = random_in(1, 1000);
+            return snprintf(buffer, size, "%.0f,%.3f", args[0], args[1]);
+        default:
+            args[0] = random_in(0.05, 0.95);  /* Inside every other domain */
+            break;
+    }
+    args[1] = random_in(0.05, 0.95);
+    if (function->variadic) {                   /* The validator keeps a decimal point active across commas, so only the first argument has one */
+        return snprintf(buffer, size, "%.3f,%u,%u", args[0], (unsigned)(next_random() % 10), (unsigned)(next_random() % 10));
+    } else if (function->arity == 2) {
+        return snprintf(buffer, size, "%.3f,%.3f", args[0], args[1]);
+    }
+    return snprintf(buffer, size, "%.3f", args[0]);
+}
+
+/**
+ * \brief           The timed loop of the validation benchmarks
+ * \param[in]       bench: The benchmark
+ * \param[in]       iterations: A number of operations
+ * \return          A value depending on the work done
+ */
+static double
+run_validate(const bench_t* bench, uint64_t iterations) {
+    const corpus_t* corpus = bench->corpus;
+    double valid = 0;
+    for (uint64_t n = 0; n < iterations; ++n) {
+        size_t i = n % corpus->count;
+        valid += calc_validate(corpus->lines[i], corpus->lengths[i]);
+    }
+    return valid;
+}
+
+/**
+ * \brief           The timed loop of the parsing benchmarks, a compilation and a release per operation
+ * \param[in]       bench: The benchmark
+ * \param[in]       iterations: A number of operations
+ * \return          A value depending on the work done
+ */
+static double
+run_compile(const bench_t* bench, uint64_t iterations) {
+    const corpus_t* corpus = bench->corpus;
+    double nodes = 0;
+    for (uint64_t n = 0; n < iterations; ++n) {
+        size_t i = n % corpus->count;
+        calc_expr_t* expr = calc_compile(corpus->lines[i], corpus->lengths[i], NULL);
+        nodes += (double)(expr != NULL);
+        calc_free(expr);
+    }
+    return nodes;
+}
+
+/**
+ * \brief           The timed loop of the evaluation benchmarks
+ * \param[in]       bench: The benchmark
+ * \param[in]       iterations: A number of operations
+ * \return          A value depending on the work done
+ */
+static double
+run_eval(const bench_t* bench, uint64_t iterations) {
+    const corpus_t* corpus = bench->corpus;
+    double sum = 0;
+    for (uint64_t n = 0; n < iterations; ++n) {
+        sum += calc_eval_ctx(bench->context, corpus->exprs[n % corpus->count], NULL, NULL);
+    }
+    return sum;
+}
+
+/**
+ * \brief           The timed loop of the exact evaluation benchmarks
+ * \param[in]       bench: The benchmark
+ * \param[in]       iterations: A number of operations
+ * \return          A value depending on the work done
+ */
+static double
+run_exact(const bench_t* bench, uint64_t iterations) {
+    const corpus_t* corpus = bench->corpus;
+    double sum = 0;
+    for (uint64_t n = 0; n < iterations; ++n) {
+        sum += calc_eval_exact(bench->context, corpus->exprs[n % corpus->count], NULL, NULL, NULL);
+    }
+    return sum;
+}
+
+/**
+ * \brief           The timed loop of the interval evaluation benchmarks
+ * \param[in]       bench: The benchmark
+ * \param[in]       iterations: A number of operations
+ * \return          A value depending on the work done
+ */
+static double
+run_interval(const bench_t* bench, uint64_t iterations) {
+    const corpus_t* corpus = bench->corpus;
+    double sum = 0;
+    for (uint64_t n = 0; n < iterations; ++n) {
+        sum += calc_eval_interval(corpus->exprs[n % corpus->count], NULL, NULL, NULL);
+    }
+    return sum;
+}
+
+/**
+ * \brief           The timed loop of the complex evaluation benchmarks
+ * \param[in]       bench: The benchmark
+ * \param[in]       iterations: A number of operations
+ * \return          A value depending on the work done
+ */
+static double
+run_complex(const bench_t* bench, uint64_t iterations) {
+    const corpus_t* corpus = bench->corpus;
+    double sum = 0;
+    for (uint64_t n = 0; n < iterations; ++n) {
+        sum += calc_eval_complex(corpus->exprs[n % corpus->count], NULL, NULL, NULL);
+    }
+    return sum;
+}
+
+/**
+ * \brief           The timed loop of the double-double evaluation benchmarks
+ * \param[in]       bench: The benchmark
+ * \param[in]       iterations: A number of operations
+ * \return          A value depending on the work done
+ */
+static double
+run_dd(const bench_t* bench, uint64_t iterations) {
+    const corpus_t* corpus = bench->corpus;
+    double sum = 0;
+    for (uint64_t n = 0; n < iterations; ++n) {
+        sum += calc_eval_dd(corpus->exprs[n % corpus->count], NULL, NULL, NULL);
+    }
+    return sum;
+}
+
+/**
+ * \brief           The timed loop of the complex columns evaluated a row at a time
+ * \param[in]       bench: The benchmark
+ * \param[in]       iterations: A number of rows
+ * \return          A value depending on the work done
+ * \note            The variables of the expression take the columns of \ref bench_t::args in the order of their slots
+ */
+static double
+run_complex_rows(const bench_t* bench, uint64_t iterations) {
+    size_t count = calc_var_count(bench->expr);
+    double sum = 0;
+    for (uint64_t n = 0; n < iterations; ++n) {
+        calc_complex_t vars[BENCH_COLUMN_VARS + 1] = {{0, 0}};
+        size_t row = n % BENCH_COLUMN_ROWS;
+        for (size_t v = 0, column = 0; v < count && column < BENCH_COLUMN_VARS; ++v) {
+            if (strcmp(calc_var_name(bench->expr, v), "i") != 0) {     /* The imaginary unit has no column */
+                vars[v].re = bench->args[column * BENCH_COLUMN_ROWS + row];
+                vars[v].im = bench->args[(BENCH_COLUMN_VARS + column) * BENCH_COLUMN_ROWS + row];
+                ++column;
+            }
+        }
+        sum += calc_eval_complex(bench->expr, vars, NULL, NULL);
+    }
+    return sum;
+}
+
+/**
+ * \brief           The timed loop of the complex columns evaluated by the columnar evaluator
+ * \param[in]       bench: The benchmark
+ * \param[in]       iterations: A number of rows
+ * \return          A value depending on the work done
+ */
+static double
+run_complex_columns(const bench_t* bench, uint64_t iterations) {
+    const double* re[BENCH_COLUMN_VARS + 1] = {NULL};
+    const double* im[BENCH_COLUMN_VARS + 1] = {NULL};
+    double* result_re = &bench->args[2 * BENCH_COLUMN_VARS * BENCH_COLUMN_ROWS];
+    double* result_im = result_re + BENCH_COLUMN_ROWS;
+    size_t count = calc_var_count(bench->expr);
+    double sum = 0;
+    for (size_t v = 0, column = 0; v < count && column < BENCH_COLUMN_VARS; ++v) {
+        if (strcmp(calc_var_name(bench->expr, v), "i") != 0) {         /* The imaginary unit has no column */
+            re[v] = &bench->args[column * BENCH_COLUMN_ROWS];
+            im[v] = &bench->args[(BENCH_COLUMN_VARS + column) * BENCH_COLUMN_ROWS];
+            ++column;
+        }
+    }
+    for (uint64_t n = 0; n < iterations; n += BENCH_COLUMN_ROWS) {
+        size_t rows = iterations - n < BENCH_COLUMN_ROWS ? (size_t)(iterations - n) : BENCH_COLUMN_ROWS;
+        calc_eval_complex_columns(bench->expr, rows, re, im, result_re, result_im, NULL);
+        sum += result_re[0];
+    }
+    return sum;
+}
+
+/**
+ * \brief           The timed loop of the signals evaluated a row at a time in double precision
+ * \param[in]       bench: The benchmark
+ * \param[in]       iterations: A number of rows
+ * \return          A value depending on the work done
+ * \note            The variables of the expression take the columns of \ref bench_t::args in the order of their slots
+ */
+static double
+run_signal_rows(const bench_t* bench, uint64_t iterations) {
+    double sum = 0;
+    for (uint64_t n = 0; n < iterations; ++n) {
+        size_t row = n % BENCH_SIGNAL_ROWS;
+        double vars[BENCH_SIGNAL_VARS] = {bench->args[row], bench->args[BENCH_SIGNAL_ROWS + row]};
+        sum += calc_eval_ctx(bench->context, bench->expr, vars, NULL);
+    }
+    return sum;
+}
+
+/**
+ * \brief           The timed loop of the signals evaluated in float columns
+ * \param[in]       bench: The benchmark
+ * \param[in]       iterations: A number of rows
+ * \return          A value depending on the work done
+ */
+static double
+run_signal_columns(const bench_t* bench, uint64_t iterations) {
+    const float* vars[BENCH_SIGNAL_VARS] = {bench->samples, bench->samples + BENCH_SIGNAL_ROWS};
+    float* result = bench->samples + BENCH_SIGNAL_VARS * BENCH_SIGNAL_ROWS;
+    double sum = 0;
+    for (uint64_t n = 0; n < iterations; n += BENCH_SIGNAL_ROWS) {
+        size_t rows = iterations - n < BENCH_SIGNAL_ROWS ? (size_t)(iterations - n) : BENCH_SIGNAL_ROWS;
+        calc_eval_float_columns(bench->expr, rows, vars, result, NULL);
+        sum += result[0];
+    }
+    return sum;
+}
+
+/**
+ * \brief           The timed loop of the gradient expressions evaluated without partials, the cost of the value alone
+ * \param[in]       bench: The benchmark
+ * \param[in]       iterations: A number of rows
+ * \return          A value depending on the work done
+ * \note            The variables of the expression take the columns of \ref bench_t::args in the order of their slots
+ */
+static double
+run_gradient_eval(const bench_t* bench, uint64_t iterations) {
+    size_t count = calc_var_count(bench->expr);
+    double sum = 0;
+    for (uint64_t n = 0; n < iterations; ++n) {
+        double vars[BENCH_GRADIENT_VARS];
+        size_t row = n % BENCH_GRADIENT_ROWS;
+        for (size_t v = 0; v < count; ++v) {
+            vars[v] = bench->args[v * BENCH_GRADIENT_ROWS + row];
+        }
+        sum += calc_eval_ctx(bench->context, bench->expr, vars, NULL);
+    }
+    return sum;
+}
+
+/**
+ * \brief           The timed loop of the gradients calculated a row at a time in forward mode
+ * \param[in]       bench: The benchmark
+ * \param[in]       iterations: A number of rows
+ * \return          A value depending on the work done
+ */
+static double
+run_gradient_dual(const bench_t* bench, uint64_t iterations) {
+    size_t count = calc_var_count(bench->expr);
+    double sum = 0;
+    for (uint64_t n = 0; n < iterations; ++n) {
+        double vars[BENCH_GRADIENT_VARS], gradient[BENCH_GRADIENT_VARS];
+        size_t row = n % BENCH_GRADIENT_ROWS;
+        for (size_t v = 0; v < count; ++v) {
+            vars[v] = bench->args[v * BENCH_GRADIENT_ROWS + row];
+        }
+        sum += calc_eval_dual(bench->expr, vars, gradient, NULL) + gradient[0];
+    }
+    return sum;
+}
+
+/**
+ * \brief           The timed loop of the gradients calculated in columns in forward mode
+ * \param[in]       bench: The benchmark
+ * \param[in]       iterations: A number of rows
+ * \return          A value depending on the work done
+ */
+static double
+run_gradient_columns(const bench_t* bench, uint64_t iterations) {
+    const double* vars[BENCH_GRADIENT_VARS];
+    double* gradient[BENCH_GRADIENT_VARS];
+    double* result = &bench->args[BENCH_GRADIENT_VARS * BENCH_GRADIENT_ROWS];
+    double sum = 0;
+    for (size_t v = 0; v < BENCH_GRADIENT_VARS; ++v) {
+        vars[v] = &bench->args[v * BENCH_GRADIENT_ROWS];
+        gradient[v] = &bench->args[(BENCH_GRADIENT_VARS + 1 + v) * BENCH_GRADIENT_ROWS];
+    }
+    for (uint64_t n = 0; n < iterations; n += BENCH_GRADIENT_ROWS) {
+        size_t rows = iterations - n < BENCH_GRADIENT_ROWS ? (size_t)(iterations - n) : BENCH_GRADIENT_ROWS;
+        calc_eval_dual_columns(bench->expr, rows, vars, result, gradient, NULL);
+        sum += result[0] + gradient[0][0];
+    }
+    return sum;
+}
+
+/**
+ * \brief           The timed loop of the gradients calculated a row at a time in reverse mode
+ * \param[in]       bench: The benchmark
+ * \param[in]       iterations: A number of rows
+ * \return          A value depending on the work done
+ * \note            The tape is kept in the context of the benchmark, so the loop does not allocate
+ */
+static double
+run_gradient_tape(const bench_t* bench, uint64_t iterations) {
+    size_t count = calc_var_count(bench->expr);
+    double sum = 0;
+    for (uint64_t n = 0; n < iterations; ++n) {
+        double vars[BENCH_GRADIENT_VARS], gradient[BENCH_GRADIENT_VARS];
+        size_t row = n % BENCH_GRADIENT_ROWS;
+        for (size_t v = 0; v < count; ++v) {
+            vars[v] = bench->args[v * BENCH_GRADIENT_ROWS + row];
+        }
+        sum += calc_eval_gradient(bench->context, bench->expr, vars, gradient, NULL) + gradient[0];
+    }
+    return sum;
+}
+
+/**
+ * \brief           The timed loop of the gradients evaluated as the expression and its symbolic partial derivatives
+ * \param[in]       bench: The benchmark
+ * \param[in]       iterations: A number of rows
+ * \return          A value depending on the work done
+ */
+static double
+run_gradient_diff(const bench_t* bench, uint64_t iterations) {
+    size_t count = calc_var_count(bench->expr);
+    double sum = 0;
+    for (uint64_t n = 0; n < iterations; ++n) {
+        double vars[BENCH_GRADIENT_VARS];
+        size_t row = n % BENCH_GRADIENT_ROWS;
+        for (size_t v = 0; v < count; ++v) {
+            vars[v] = bench->args[v * BENCH_GRADIENT_ROWS + row];
+        }
+        sum += calc_eval_ctx(bench->context, bench->expr, vars, NULL);
+        for (size_t v = 0; v < count; ++v) {
+            sum += calc_eval_ctx(bench->context, bench->derivatives[v], vars, NULL);
+        }
+    }
+    return sum;
+}
+
+/**
+ * \brief           The timed loop of the integrals on the calling thread
+ * \param[in]       bench: The benchmark
+ * \param[in]       iterations: A number of integrals
+ * \return          A value depending on the work done
+ */
+static double
+run_integrate(const bench_t* bench, uint64_t iterations) {
+    double sum = 0;
+    for (uint64_t n = 0; n < iterations; ++n) {
+        sum += calc_integrate(bench->expr, "x", NULL, 0, 1, BENCH_INTEGRATE_TOLERANCE, 1, NULL, NULL);
+    }
+    return sum;
+}
+
+/**
+ * \brief           The timed loop of the integrals shared by \ref BENCH_INTEGRATE_THREADS threads
+ * \param[in]       bench: The benchmark
+ * \param[in]       iterations: A number of integrals
+ * \return          A value depending on the work done
+ */
+static double
+run_integrate_threads(const bench_t* bench, uint64_t iterations) {
+    double sum = 0;
+    for (uint64_t n = 0; n < iterations; ++n) {
+        sum += calc_integrate(bench->expr, "x", NULL, 0, 1, BENCH_INTEGRATE_TOLERANCE, BENCH_INTEGRATE_THREADS, NULL, NULL);
+    }
+    return sum;
+}
+
+/**
+ * \brief           The timed loop of the formatting benchmarks
+ * \param[in]       bench: The benchmark
+ * \param[in]       iterations: A number of operations
+ * \return          A value depending on the work done
+ * \note            Both integral and fractional values are formatted, as they take different paths
+ */
+static double
+run_format(const bench_t* bench, uint64_t iterations) {
+    const corpus_t* corpus = bench->corpus;
+    char text[512];
+    double length = 0;
+    for (uint64_t n = 0; n < iterations; ++n) {
+        size_t i = n % corpus->count;
+        length += calc_format((double)corpus->lengths[i] / 7.0 + (double)i, text, sizeof(text));
+    }
+    return length;
+}
+
+/**
+ * \brief           The timed loop of the builtin benchmarks, a call through the registry per operation
+ * \param[in]       bench: The benchmark
+ * \param[in]       iterations: A number of operations
+ * \return          A value depending on the work done
+ */
+static double
+run_builtin(const bench_t* bench, uint64_t iterations) {
+    calc_function_impl_t impl = bench->function->impl;
+    double sum = 0;
+    for (uint64_t n = 0; n < iterations; ++n) {
+        sum += impl(&bench->args[2 * (n % BENCH_ARGS)]);
+    }
+    return sum;
+}
+
+/**
+ * \brief           The timed loop of the arbitrary-precision benchmarks, an evaluation and its printing per operation
+ * \param[in]       bench: The benchmark
+ * \param[in]       iterations: A number of operations
+ * \return          A value depending on the work done
+ */
+static double
+run_big(const bench_t* bench, uint64_t iterations) {
+    double length = 0;
+    for (uint64_t n = 0; n < iterations; ++n) {
+        char* text = calc_eval_big(bench->expr, NULL, bench->digits, NULL);
+        if (text != NULL) {
+            length += (double)strlen(text);
+            free(text);
+        }
+    }
+    return length;
+}
+
+/**
+ * \brief           The timed loop of the decimal benchmarks, an evaluation in fixed point decimals per operation
+ * \param[in]       bench: The benchmark
+ * \param[in]       iterations: A number of operations
+ * \return          A value depending on the work done
+ */
+static double
+run_decimal(const bench_t* bench, uint64_t iterations) {
+    const corpus_t* corpus = bench->corpus;
+    calc_decimal_t decimal;
+    double sum = 0;
+    for (uint64_t n = 0; n < iterations; ++n) {
+        calc_eval_decimal(corpus->exprs[n % corpus->count], NULL, (uint32_t)bench->digits, &decimal, NULL);
+        sum += (double)decimal.low;
+    }
+    return sum;
+}
+
+/**
+ * \brief           The timed loop of the arbitrary-precision benchmarks on a corpus, an evaluation and its printing per operation
+ * \param[in]       bench: The benchmark
+ * \param[in]       iterations: A number of operations
+ * \return          A value depending on the work done
+ */
+static double
+run_big_corpus(const bench_t* bench, uint64_t iterations) {
+    const corpus_t* corpus = bench->corpus;
+    double length = 0;
+    for (uint64_t n = 0; n < iterations; ++n) {
+        char* text = calc_eval_big(corpus->exprs[n % corpus->count], NULL, bench->digits, NULL);
+        if (text != NULL) {
+            length += (double)strlen(text);
+            free(text);
+        }
+    }
+    return length;
+}
+
+/**
+ * \brief           A function used to time a benchmark
+ * \param[in]       bench: The benchmark
+ * \param[in]       samples: A number of samples
+ * \param[in]       sample_ns: Minimal duration of a sample
+ * \param[out]      result: Statistics of the samples
+ * \note            The number of operations per sample is doubled until a sample lasts long enough, then it is kept for all samples
+ */
+static void
+measure(const bench_t* bench, size_t samples, uint64_t sample_ns, result_t* result) {
+    double times[BENCH_MAX_SAMPLES];
+    uint64_t iterations = 1, start, elapsed;
+    double sum = 0, squares = 0, t;
+
+    for (;;) {                                  /* Calibrate and warm up */
+        start = now_ns();
+        sink = bench->run(bench, iterations);
+        elapsed = now_ns() - start;
+        if (elapsed >= sample_ns || iterations >= (1ULL << 40)) {
+            break;
+        }
+        iterations *= 2;
+    }
+    counters_start();                           /* The counters cover all samples, not the calibration */
+    for (size_t s = 0; s < samples; ++s) {
+        start = now_ns();
+        sink = bench->run(bench, iterations);
+        elapsed = now_ns() - start;
+        times[s] = (double)elapsed / (double)iterations;
+        sum += times[s];
+    }
+    counters_stop(result->counters);
+    for (size_t c = 0; c < BENCH_COUNTERS; ++c) {
+        result->counters[c] /= (double)samples * (double)iterations;
+    }
+    result->mean = sum / (double)samples;
+    for (size_t s = 0; s < samples; ++s) {
+        squares += (times[s] - result->mean) * (times[s] - result->mean);
+    }
+    t = samples >= 30 ? 1.96 : samples >= 10 ? 2.26 : 2.78;    /* Student's t for 95 %, coarse for small sample counts */
+    result->ci95 = t * sqrt(squares / (double)(samples - 1)) / sqrt((double)samples);
+    qsort(times, samples, sizeof(double), compare_doubles);
+    result->median = times[samples / 2];
+    result->min = times[0];
+    result->iterations = iterations;
+    result->samples = samples;
+}
+
+/**
+ * \brief           A function used to sort samples
+ * \param[in]       a: The first sample
+ * \param[in]       b: The second sample
+ * \return          Negative, zero or positive as for qsort
+ */
+static int
+compare_doubles(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * \brief           A function used to print a column of the counters
+ * \param[in]       value: The value, NaN if not available
+ * \param[in]       width: Width of the column
+ * \param[in]       precision: Digits after the decimal point
+ */
+static void
+print_counter(double value, int width, int precision) {
+    if (isnan(value)) {
+        printf(" %*s", width, "n/a");
+    } else {
+        printf(" %*.*f", width, precision, value);
+    }
+}
+
+#ifdef __linux__
+
+/**
+ * \brief           A function used to open the hardware counters of this process
+ * \return          A number of counters opened
+ * \note            Every counter is opened on its own, so a machine lacking some events still reports the others.
+ *                  Only user space is counted, which is allowed with the default perf_event_paranoid setting.
+ */
+static size_t
+counters_open(void) {
+    static const uint32_t types[BENCH_COUNTERS] = {PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE, PERF_TYPE_HARDWARE};
+    static const uint64_t configs[BENCH_COUNTERS] = {
+        PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CPU_CYCLES,
+        PERF_COUNT_HW_BRANCH_MISSES,
+        PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+        PERF_COUNT_HW_CACHE_MISSES,
+    };
+    size_t opened = 0;
+    int error = 0;
+    for (size_t c = 0; c < BENCH_COUNTERS; ++c) {
+        struct perf_event_attr attr = {0};
+        attr.size = sizeof(attr);
+        attr.type = types[c];
+        attr.config = configs[c];
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        counter_fds[c] = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+        if (counter_fds[c] < 0) {
+            error = errno;
+        } else {
+            ++opened;
+        }
+    }
+    if (opened == 0) {
+        fprintf(stderr, "hardware counters are not available (%s), only the time is reported\n", strerror(error));
+    } else if (opened < BENCH_COUNTERS) {
+        fprintf(stderr, "%zu of %d hardware counters are available (%s), the others are reported as n/a\n",
+                opened, BENCH_COUNTERS, strerror(error));
+    }
+    return opened;
+}
+
+/**
+ * \brief           A function used to reset and start the counters
+ */
+static void
+counters_start(void) {
+    for (size_t c = 0; c < BENCH_COUNTERS; ++c) {
+        if (counter_fds[c] >= 0) {
+            ioctl(counter_fds[c], PERF_EVENT_IOC_RESET, 0);
+            ioctl(counter_fds[c], PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+}
+
+/**
+ * \brief           A function used to stop and read the counters
+ * \param[out]      values: Events counted since \ref counters_start, NaN for counters not available
+ * \note            When the kernel multiplexes more events than the processor counts at once, the values are scaled to the whole period
+ */
+static void
+counters_stop(double* values) {
+    for (size_t c = 0; c < BENCH_COUNTERS; ++c) {
+        uint64_t data[3];                       /* The value, the time enabled and the time running */
+        values[c] = NAN;
+        if (counter_fds[c] < 0) {
+            continue;
+        }
+        ioctl(counter_fds[c], PERF_EVENT_IOC_DISABLE, 0);
+        if (read(counter_fds[c], data, sizeof(data)) == (ssize_t)sizeof(data) && data[2] > 0) {
+            values[c] = (double)data[0] * ((double)data[1] / (double)data[2]);
+        }
+    }
+}
+
+#else /* __linux__ */
+
+/**
+ * \brief           A function used to open the hardware counters
+ * \return          0, the counters are read through perf_event_open which is only available on Linux
+ */
+static size_t
+counters_open(void) {
+    fprintf(stderr, "hardware counters are only supported on Linux\n");
+    return 0;
+}
+
+/**
+ * \brief           A function used to start the counters, nothing to do without them
+ */
+static void
+counters_start(void) {
+}
+
+/**
+ * \brief           A function used to read the counters
+ * \param[out]      values: Set to NaN, no counter is available
+ */
+static void
+counters_stop(double* values) {
+    for (size_t c = 0; c < BENCH_COUNTERS; ++c) {
+        values[c] = NAN;
+    }
+}
+
+#endif /* __linux__ */
@@ -0,0 +1,323 @@
+/**
+ * \file            calc_check.c
+ * \brief           Regression checks of the evaluation modes
+ */
+
+/*
+ * Copyright (c) 2024 Daniil VERES
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * Author:          Daniil VERES <daniaveres@gmail.com>
+ * Version:         v1.0.0
+ */
+
+                    /* Functions used: */
+#include <math.h>   /* fabs, isinf, signbit */
+#include <stdint.h> /* uint8_t */
+#include <stdio.h>  /* printf, fprintf, snprintf */
+#include <stdlib.h> /* malloc, free */
+#include <string.h> /* strlen, strcmp, memcpy */
+#include "calc.h"
+
+                                        /* Constants used: */
+#define CHECK_BUFFER_SIZE 128           /*!< Size of a formatted result */
+#define CHECK_INTEGRATE_TOLERANCE 1e-10 /*!< The relative tolerance of the integrals */
+#define CHECK_DIFF_TOLERANCE 1e-12      /*!< The relative tolerance of the derivatives */
+
+static unsigned failures;               /*!< A number of failed checks */
+
+static void expect(uint8_t ok, const char* source, const char* what);      /* A function used to record a check */
+static void check_exact(const char* source, double value, const char* text);    /* A function used to check an exact evaluation */
+static void check_big(const char* source, size_t digits, const char* text);     /* A function used to check an arbitrary-precision evaluation */
+static void check_integral(const char* source, double a, double b, double value, calc_error_code_t code);  /* A function used to check an integral */
+static void check_nesting(const char* open, const char* close, size_t depth, uint8_t valid);  /* A function used to check a deeply nested expression */
+static void check_diff(const char* source, double x, const char* derivative, calc_error_code_t code);   /* A function used to check a derivative */
+
+/**
+ * \brief           Main function of the regression checks
+ * \return          0 if every check has passed, 1 otherwise
+ */
+int
+main(void) {
+    /* An embedded NUL byte makes the input invalid instead of cutting the checks short */
+    expect(calc_validate("\0abc", 4) == 0, "\\0abc", "is invalid");
+    expect(calc_validate("\0\n", 2) == 0, "\\0\\n", "is invalid");
+    expect(calc_validate("1+1\0", 4) == 0, "1+1\\0", "is invalid");
+    expect(calc_validate_complex("\0", 1) == 0, "\\0", "is invalid");
+    expect(calc_validate("1+1\n", 4) == 1, "1+1", "is valid");
+
+    /* Nesting too deep for the recursive parser is invalid input instead of a stack overflow */
+    check_nesting("(", ")", 999, 1);
+    check_nesting("(", ")", 1000, 0);
+    check_nesting("(", ")", 100000, 0);
+    check_nesting("sin(", ")", 100000, 0);
+    check_nesting("-(", ")", 100000, 0);
+    check_nesting("max(1,", ")", 100000, 0);
+
+    /* Exact zeros of operands above 2^53 take their value from the integer, not from the rounded operands */
+    check_exact("9007199254740993%3", 0, "0");
+    check_exact("1/(9007199254740993%3)", INFINITY, NULL);
+    check_exact("1/(-(9007199254740993%3))", -INFINITY, NULL);
+    check_exact("(2^53+1)*3-2^53*3-3", 0, "0");
+    check_exact("9007199254740993*3-27021597764222979", 0, "0");
+    check_exact("9007199254740993-9007199254740992", 1, "1");
+
+    /* The factorial of a fraction is calculated to the digits asked for, Γ(4.5) = 105 sqrt(pi) / 16 */
+    check_big("fact(3.5)", 40, "11.63172839656744892914422410942626526211");
+    check_big("fact(3.5)", 100, "11.63172839656744892914422410942626526210891830580316552890311362090973030512864869027311368484669937");
+    check_big("fact(1/3)", 40, "0.8929795115692492112185643136582258813762");
+    check_big("fact(100.25)", 40, "2.955837447543366894934869824097275758339e+158");
+    check_big("fact(3.5)", 100000, NULL);
+    check_big("fact(2^1100+0.5)", 40, NULL);
+    check_big("2-cosh(0)", 20, "1");
+
+    /* An integral which does not meet the tolerance is reported, the integrable singularities at the bounds converge */
+    check_integral("1/x", -1, 1, NAN, CALC_ERROR_NOT_CONVERGED);
+    check_integral("1/x", 0, 1, NAN, CALC_ERROR_NOT_CONVERGED);
+    check_integral("ln(x)", 0, 1, -1, CALC_OK);
+    check_integral("1/sqrt(x)", 0, 1, 2, CALC_OK);
+
+    /* The derivative is undefined where the expression is, as in the forward and the reverse mode */
+    check_diff("ln(x)", -0.4, NULL, CALC_ERROR_UNDEFINED_FUNCTION);
+    check_diff("atanh(x)", 1.3, NULL, CALC_ERROR_UNDEFINED_FUNCTION);
+    check_diff("arctanh(x)", 2.6, NULL, CALC_ERROR_UNDEFINED_FUNCTION);
+    check_diff("arccoth(x)", 1.3, NULL, CALC_ERROR_UNDEFINED_FUNCTION);
+    check_diff("lg(x)", -0.4, NULL, CALC_ERROR_UNDEFINED_FUNCTION);
+    check_diff("x+0*sqrt(x)", -1, NULL, CALC_ERROR_UNDEFINED_FUNCTION);
+    check_diff("ln(ln(x))", 0.5, NULL, CALC_ERROR_UNDEFINED_FUNCTION);
+    check_diff("x*ln(-1)", 2, NULL, CALC_ERROR_UNDEFINED_FUNCTION);
+    check_diff("sqrt(5%x*0)*0", 0, NULL, CALC_ERROR_UNDEFINED_FUNCTION);
+    check_diff("x+sqrt(-1/(-0))", 1, "1", CALC_OK);
+
+    /* Every rule of the symbolic derivative against a closed form and both automatic modes, '^' binds like '*' */
+    check_diff("-x*x+x/(1+x)", 2, "-2*x+1/(1+x)^2", CALC_OK);
+    check_diff("x%3", 4.5, "1", CALC_OK);
+    check_diff("7%x", 2.5, "-2", CALC_OK);
+    check_diff("x^(-2)", 2, "-2/(x^3)", CALC_OK);
+    check_diff("x^3.5", 2, "3.5*(x^2.5)", CALC_OK);
+    check_diff("2^x", 3, "2^x*ln(2)", CALC_OK);
+    check_diff("x^x", 1.5, "x^x*(ln(x)+1)", CALC_OK);
+    check_diff("sqrt(x)", 2, "1/(2*sqrt(x))", CALC_OK);
+    check_diff("ln(x)", 0.4, "1/x", CALC_OK);
+    check_diff("exp(2*x)", 0.3, "2*exp(2*x)", CALC_OK);
+    check_diff("sin(x^2)", 0.7, "2*x*cos(x^2)", CALC_OK);
+    check_diff("cos(x)", 0.7, "-sin(x)", CALC_OK);
+    check_diff("tan(x)", 0.7, "1/cos(x)^2", CALC_OK);
+    check_diff("ctan(x)", 0.7, "-1/(sin(x)^2)", CALC_OK);
+    check_diff("asin(x)", 0.3, "1/sqrt(1-x^2)", CALC_OK);
+    check_diff("acos(x)", 0.3, "-1/sqrt(1-x^2)", CALC_OK);
+    check_diff("atan(x)", 2, "1/(1+x^2)", CALC_OK);
+    check_diff("arcctan(x)", 2, "-1/(1+x^2)", CALC_OK);
+    check_diff("sinh(x)", 1.5, "cosh(x)", CALC_OK);
+    check_diff("cosh(x)", 1.5, "sinh(x)", CALC_OK);
+    check_diff("tanh(x)", 1.5, "1/cosh(x)^2", CALC_OK);
+    check_diff("ctanh(x)", 1.5, "-1/(sinh(x)^2)", CALC_OK);
+    check_diff("asinh(x)", 1.5, "1/sqrt(x^2+1)", CALC_OK);
+    check_diff("asinh(x)", -1e300, "-1/x", CALC_OK);
+    check_diff("acosh(x)", 1.5, "1/sqrt(x^2-1)", CALC_OK);
+    check_diff("atanh(x)", 0.5, "1/(1-x^2)", CALC_OK);
+    check_diff("arccoth(x)", -0.5, "1/(1-x^2)", CALC_OK);
+    check_diff("abs(x^3)", -1.5, "-3*(x^2)", CALC_OK);
+    check_diff("abs(x)", 2, "1", CALC_OK);
+    check_diff("floor(x)*x+sign(x)", 2.5, "floor(x)", CALC_OK);
+    check_diff("rad(x)", 1, "rad(1)", CALC_OK);
+    check_diff("deg(x)", 1, "deg(1)", CALC_OK);
+    check_diff("log(x, x^2+1)", 3, "2*x/((x^2+1)*ln(x))-ln(x^2+1)/(x*(ln(x)^2))", CALC_OK);
+    check_diff("log(2, x)", 3, "1/(x*ln(2))", CALC_OK);
+    check_diff("lg(x)", 3, "1/(x*ln(10))", CALC_OK);
+    check_diff("min(x, 2-x)", 0.5, "1", CALC_OK);
+    check_diff("max(x, 2-x)", 0.5, "-1", CALC_OK);
+
+    printf("%s: %u failed\n", failures == 0 ? "OK" : "FAILED", failures);
+    return failures == 0 ? 0 : 1;
+}
+
+/**
+ * \brief           A function used to record a check
+ * \param[in]       ok: Set to `1` when the check has passed
+ * \param[in]       source: The expression
+ * \param[in]       what: A description of the check
+ */
+static void
+expect(uint8_t ok, const char* source, const char* what) {
+    if (!ok) {
+        fprintf(stderr, "FAILED: %s: %s\n", source, what);
+        ++failures;
+    }
+}
+
+/**
+ * \brief           A function used to check an exact evaluation
+ * \param[in]       source: An expression without variables
+ * \param[in]       value: The expected double result, a zero also checks its sign
+ * \param[in]       text: The expected formatted integer result, NULL if the result is not an integer
+ */
+static void
+check_exact(const char* source, double value, const char* text) {
+    calc_error_t error;
+    calc_result_t result;
+    char buffer[CHECK_BUFFER_SIZE];
+    calc_expr_t* expr = calc_compile(source, strlen(source), &error);
+    double got;
+
+    expect(expr != NULL, source, "compiles");
+    if (expr == NULL) {
+        return;
+    }
+    got = calc_eval_exact(NULL, expr, NULL, &result, &error);
+    expect(error.code == CALC_OK, source, "evaluates");
+    expect(got == value && result.value == value && signbit(got) == signbit(value), source, "double result");
+    expect(text == NULL ? !result.is_integer : result.is_integer, source, "is an integer");
+    if (text != NULL) {
+        calc_format_result(&result, buffer, sizeof(buffer));
+        expect(strcmp(buffer, text) == 0, source, "formatted result");
+    }
+    calc_free(expr);
+}
+
+/**
+ * \brief           A function used to check an arbitrary-precision evaluation
+ * \param[in]       source: An expression without variables
+ * \param[in]       digits: A number of significant digits
+ * \param[in]       text: The expected result, NULL if the evaluation must report invalid input
+ */
+static void
+check_big(const char* source, size_t digits, const char* text) {
+    calc_error_t error;
+    calc_expr_t* expr = calc_compile(source, strlen(source), &error);
+    char* result;
+
+    expect(expr != NULL, source, "compiles");
+    if (expr == NULL) {
+        return;
+    }
+    result = calc_eval_big(expr, NULL, digits, &error);
+    if (text == NULL) {
+        expect(result == NULL && error.code == CALC_ERROR_INVALID_INPUT, source, "reports invalid input");
+    } else {
+        expect(result != NULL && strcmp(result, text) == 0, source, "printed result");
+    }
+    free(result);
+    calc_free(expr);
+}
+
+/**
+ * \brief           A function used to check an integral over x
+ * \param[in]       source: An expression of x
+ * \param[in]       a: The lower bound
+ * \param[in]       b: The upper bound
+ * \param[in]       value: The exact integral, not checked if the integration fails
+ * \param[in]       code: The expected error code
+ */
+static void
+check_integral(const char* source, double a, double b, double value, calc_error_code_t code) {
+    calc_error_t error;
+    calc_expr_t* expr = calc_compile(source, strlen(source), &error);
+    double got;
+
+    expect(expr != NULL, source, "compiles");
+    if (expr == NULL) {
+        return;
+    }
+    got = calc_integrate(expr, "x", NULL, a, b, CHECK_INTEGRATE_TOLERANCE, 1, NULL, &error);
+    expect(error.code == code, source, code == CALC_OK ? "integrates" : calc_error_string(code));
+    expect(code != CALC_OK || fabs(got - value) <= CHECK_INTEGRATE_TOLERANCE * fabs(value), source, "integral");
+    calc_free(expr);
+}
+
+/**
+ * \brief           A function used to check a deeply nested expression
+ * \param[in]       open: The text opening a level, e.g. "sin("
+ * \param[in]       close: The text closing a level
+ * \param[in]       depth: A number of levels around the number 1
+ * \param[in]       valid: Set to `1` if the expression must compile and evaluate, `0` if it must report invalid input
+ */
+static void
+check_nesting(const char* open, const char* close, size_t depth, uint8_t valid) {
+    size_t open_len = strlen(open), close_len = strlen(close), len = 0;
+    char* source = (char*)malloc(depth * (open_len + close_len) + 1);
+    char name[CHECK_BUFFER_SIZE];
+    calc_error_t error;
+    calc_expr_t* expr;
+
+    if (source == NULL) {
+        return;
+    }
+    snprintf(name, sizeof(name), "%s1%s nested %zu times", open, close, depth);
+    for (size_t i = 0; i < depth; ++i) {
+        memcpy(source + len, open, open_len);
+        len += open_len;
+    }
+    source[len++] = '1';
+    for (size_t i = 0; i < depth; ++i) {
+        memcpy(source + len, close, close_len);
+        len += close_len;
+    }
+    expr = calc_compile(source, len, &error);
+    if (valid) {
+        expect(expr != NULL && calc_eval(expr, NULL, &error) == 1 && error.code == CALC_OK, name, "evaluates");
+    } else {
+        expect(expr == NULL && error.code == CALC_ERROR_INVALID_INPUT, name, "reports invalid input");
+    }
+    calc_free(expr);
+    free(source);
+}
+
+/**
+ * \brief           A function used to check a derivative
+ * \param[in]       source: An expression of x
+ * \param[in]       x: The point
+ * \param[in]       derivative: The derivative in a closed form, NULL if it is not checked
+ * \param[in]       code: The expected error code
+ * \note            The symbolic derivative is checked against the closed form, the forward mode and the reverse mode
+ */
+static void
+check_diff(const char* source, double x, const char* derivative, calc_error_code_t code) {
+    char name[CHECK_BUFFER_SIZE];
+    calc_error_t error;
+    calc_context_t* context = calc_context_create();
+    calc_expr_t* expr = calc_compile(source, strlen(source), &error);
+    calc_expr_t* diff = expr != NULL ? calc_diff(expr, "x", &error) : NULL;
+    calc_expr_t* closed = derivative != NULL ? calc_compile(derivative, strlen(derivative), &error) : NULL;
+    double got, expected, forward = 0, reverse = 0;
+
+    snprintf(name, sizeof(name), "d/dx %s at %g", source, x);
+    expect(context != NULL && expr != NULL && diff != NULL && (derivative == NULL || closed != NULL), name, "differentiates");
+    if (context != NULL && diff != NULL && (derivative == NULL || closed != NULL)) {
+        got = calc_eval(diff, &x, &error);
+        expect(error.code == code, name, calc_error_string(code));
+        calc_eval_dual(expr, &x, &forward, &error);
+        expect(error.code == code, name, "the forward mode agrees on the error");
+        calc_eval_gradient(context, expr, &x, &reverse, &error);
+        expect(error.code == code, name, "the reverse mode agrees on the error");
+        if (code == CALC_OK) {
+            expected = closed != NULL ? calc_eval(closed, &x, &error) : got;
+            expect(fabs(got - expected) <= CHECK_DIFF_TOLERANCE * fabs(expected), name, derivative != NULL ? derivative : "value");
+            expect(fabs(got - forward) <= CHECK_DIFF_TOLERANCE * fabs(forward), name, "the forward mode agrees");
+            expect(fabs(got - reverse) <= CHECK_DIFF_TOLERANCE * fabs(reverse), name, "the reverse mode agrees");
+        }
+    }
+    calc_free(closed);
+    calc_free(diff);
+    calc_free(expr);
+    calc_context_free(context);
+}
@@ -0,0 +1,150 @@
+/**
+ * \file            calc_digits.c
+ * \brief           Benchmark of constants calculated to many digits in arbitrary precision
+ */
+
+/*
+ * Copyright (c) 2024 Daniil VERES
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * Author:          Daniil VERES <daniaveres@gmail.com>
+ * Version:         v1.0.0
+ */
+
+                            /* Functions used: */
+#include <stdio.h>          /* printf, fprintf, fflush */
+#include <stdlib.h>         /* strtoul, free */
+#include <string.h>         /* strlen */
+#include <sys/resource.h>   /* getrusage */
+#include <sys/wait.h>       /* waitpid */
+#include <time.h>           /* clock_gettime */
+#include <unistd.h>         /* getopt, fork */
+#include "calc.h"
+
+                                        /* Constants used: */
+#define DIGITS_DEFAULT_DIGITS 1000000   /*!< Default number of digits */
+#define DIGITS_SHOWN 20                 /*!< Leading and trailing digits printed of a result */
+
+static double now(void);                                                /* A function used to get a monotonic time in seconds */
+static int run(const char* expression, size_t digits);                  /* A function used to time an expression in this process */
+
+/**
+ * \brief           Main function
+ * \param[in]       argc: A number of arguments
+ * \param[in]       argv: Arguments: [-d digits] [expression ...]
+ * \return          0 if every expression has been calculated, 1 otherwise
+ * \note            The expressions default to pi and e, `4*atan(1)` and `exp(1)`. Every one is calculated in a child process,
+ *                  so the peak resident memory reported is its own.
+ */
+int
+main(int argc, char** argv) {
+    static const char* const defaults[] = {"4*atan(1)", "exp(1)"};
+    const char* const* expressions = defaults;
+    size_t digits = DIGITS_DEFAULT_DIGITS, count = sizeof(defaults) / sizeof(defaults[0]);
+    int option, failures = 0;
+
+    while ((option = getopt(argc, argv, "d:")) != -1) {     /* Parse the options */
+        switch (option) {
+            case 'd':
+                digits = strtoul(optarg, NULL, 10);
+                break;
+            default:
+                digits = 0;
+                optind = argc;
+                break;
+        }
+    }
+    if (digits == 0) {
+        fprintf(stderr, "usage: %s [-d digits] [expression ...]\n", argv[0]);
+        return 1;
+    }
+    if (optind < argc) {
+        expressions = (const char* const*)&argv[optind];
+        count = (size_t)(argc - optind);
+    }
+    for (size_t i = 0; i < count; ++i) {
+        pid_t pid;
+        int status;
+        fflush(stdout);                         /* Not to be printed again by the child */
+        pid = fork();
+        if (pid == 0) {
+            int result = run(expressions[i], digits);
+            fflush(stdout);
+            _exit(result);
+        } else if (pid < 0 || waitpid(pid, &status, 0) != pid || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            fprintf(stderr, "%s: failed\n", expressions[i]);
+            ++failures;
+        }
+    }
+    return failures == 0 ? 0 : 1;
+}
+
+/**
+ * \brief           A function used to get a monotonic time
+ * \return          The time in seconds
+ */
+static double
+now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+/**
+ * \brief           A function used to calculate an expression and report the time and the peak memory
+ * \param[in]       expression: The expression
+ * \param[in]       digits: A number of significant digits
+ * \return          0 on success, 1 if the expression cannot be calculated
+ * \note            The time covers the calculation and the conversion to decimal, the memory is the peak resident size of the process
+ */
+static int
+run(const char* expression, size_t digits) {
+    calc_error_t error;
+    calc_expr_t* expr = calc_compile(expression, strlen(expression), &error);
+    struct rusage usage;
+    double start, elapsed;
+    size_t length;
+    char* text;
+
+    if (expr == NULL) {
+        fprintf(stderr, "%s: %s\n", expression, calc_error_string(error.code));
+        return 1;
+    }
+    start = now();
+    text = calc_eval_big(expr, NULL, digits, &error);
+    elapsed = now() - start;
+    calc_free(expr);
+    if (text == NULL) {
+        fprintf(stderr, "%s: %s\n", expression, calc_error_string(error.code));
+        return 1;
+    }
+    getrusage(RUSAGE_SELF, &usage);
+    length = strlen(text);
+    printf("%-12s %zu digits in %.3f s, peak memory %.1f MiB\n", expression, digits, elapsed, (double)usage.ru_maxrss / 1024);
+    if (length > 2 * DIGITS_SHOWN + 3) {
+        printf("             %.*s...%s\n", DIGITS_SHOWN, text, text + length - DIGITS_SHOWN);
+    } else {
+        printf("             %s\n", text);
+    }
+    free(text);
+    return 0;
+}
@@ -0,0 +1,858 @@
+/**
+ * \file            calc_fuzz.c
+ * \brief           Differential fuzzer checking that every evaluation engine and mode agrees with the linear engine
+ */
+
+/*
+ * Copyright (c) 2024 Daniil VERES
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * Author:          Daniil VERES <daniaveres@gmail.com>
+ * Version:         v1.0.0
+ */
+
+                    /* Functions used: */
+#include <float.h>  /* FLT_MAX, FLT_MIN, FLT_EPSILON, DBL_EPSILON */
+#include <math.h>   /* fabs, fmax, isnan, isinf, isfinite, INFINITY, NAN */
+#include <stdint.h> /* uint8_t, uint32_t, uint64_t */
+#include <stdio.h>  /* printf, fprintf, fopen, fread */
+#include <stdlib.h> /* strtoul, strtod, getenv, abort, atexit, free */
+#include <string.h> /* strlen, strcmp, memcpy, memchr */
+#include <time.h>   /* clock_gettime */
+#include "calc.h"
+
+                                        /* Constants used: */
+#define FUZZ_MAX_TEXT 2048              /*!< Maximal length of a generated expression */
+#define FUZZ_MAX_DEPTH 8                /*!< Maximal nesting of generated subexpressions */
+#define FUZZ_MAX_INPUT 4096             /*!< Maximal size of an input read from a file */
+#define FUZZ_REPEAT 8                   /*!< Evaluations of an input per engine, timed together so the clock does not dominate */
+#define FUZZ_DEFAULT_RUNS 100000        /*!< Default number of random inputs of the standalone driver */
+#define FUZZ_DEFAULT_TOLERANCE 1e-12    /*!< Default relative tolerance, absolute below 1 */
+#define FUZZ_FLOAT_TOLERANCE 1e-3      /*!< Relative tolerance of the single precision mode, absolute below 1 */
+#define FUZZ_FLOAT_MAX_CONDITION 1e2   /*!< Largest growth of the rounding errors, see \ref float_condition, under which floats are compared */
+#define FUZZ_FLOAT_MAX_CANCELLATION 1e2 /*!< Largest ratio of an intermediate value to the result under which floats are compared */
+#define FUZZ_PARTIAL_MAX_CONDITION 1e3  /*!< Largest growth of the rounding errors, see \ref partial_condition, under which partials are compared */
+#define FUZZ_MAX_SPANS 1024             /*!< Maximal number of intermediate values recorded while generating an expression */
+#define FUZZ_VARS 3                     /*!< A number of variables a generated expression may use */
+#define FUZZ_BIG_DIGITS 20              /*!< Significant digits of the arbitrary precision mode, enough to round to the nearest double */
+#define FUZZ_DECIMAL_SCALE 6            /*!< Digits after the point of the decimal mode */
+
+/**
+ * \brief           Bytes of the input consumed as decisions of the generator
+ * \note            Once the bytes run out every decision is 0, which always leads to a short valid expression
+ */
+typedef struct {
+    const uint8_t* data;            /*!< The bytes */
+    size_t size;                    /*!< A number of bytes */
+    size_t pos;                     /*!< The next byte */
+} source_t;
+
+/**
+ * \brief           A part of a generated expression which has a value of its own: a factor, or the first terms or factors of a sum or a product
+ */
+typedef struct {
+    uint16_t start;                 /*!< Offset of the first character */
+    uint16_t end;                   /*!< Offset past the last character */
+} span_t;
+
+/**
+ * \brief           An expression being generated
+ */
+typedef struct {
+    char text[FUZZ_MAX_TEXT];       /*!< The text */
+    size_t len;                     /*!< Length of the text */
+    span_t spans[FUZZ_MAX_SPANS];   /*!< The intermediate values, in the order they are calculated */
+    size_t span_count;              /*!< A number of intermediate values */
+} text_t;
+
+/**
+ * \brief           Enumeration representing the modes checked against the linear engine, after the engines of \ref calc_engine_t
+ */
+typedef enum {
+    FUZZ_MODE_EXACT = CALC_ENGINE_COUNT,    /*!< \ref calc_eval_exact, inside the enclosure of the interval mode */
+    FUZZ_MODE_INTERVAL,             /*!< \ref calc_eval_interval, whose enclosure contains the linear result */
+    FUZZ_MODE_COMPLEX,              /*!< \ref calc_eval_complex_columns with zero imaginary parts, agreeing on real results */
+    FUZZ_MODE_FLOAT,                /*!< \ref calc_eval_float_columns, agreeing within \ref FUZZ_FLOAT_TOLERANCE when well conditioned */
+    FUZZ_MODE_DD,                   /*!< \ref calc_eval_dd, inside the enclosure of the interval mode */
+    FUZZ_MODE_DUAL,                 /*!< \ref calc_eval_dual_columns, agreeing on the values */
+    FUZZ_MODE_GRADIENT,             /*!< \ref calc_eval_gradient, agreeing on the values */
+    FUZZ_MODE_BIG,                  /*!< \ref calc_eval_big, inside the enclosure of the interval mode */
+    FUZZ_MODE_DECIMAL,              /*!< \ref calc_eval_decimal, equal to an integer result of the exact mode */
+    FUZZ_MODE_DIFF,                 /*!< \ref calc_diff, whose partials agree with those of the dual and the gradient modes */
+    FUZZ_MODE_COUNT                 /*!< A number of engines and modes */
+} fuzz_mode_t;
+
+/**
+ * \brief           Results of the modes other than their values, which the checks of the later modes use
+ */
+typedef struct {
+    calc_interval_t enclosure;      /*!< The result of \ref FUZZ_MODE_INTERVAL, which bounds the exact result */
+    calc_result_t exact;            /*!< The result of \ref FUZZ_MODE_EXACT */
+    calc_decimal_t decimal;         /*!< The result of \ref FUZZ_MODE_DECIMAL */
+    double dual[FUZZ_VARS];         /*!< Partial derivatives of \ref FUZZ_MODE_DUAL by slot */
+    double gradient[FUZZ_VARS];     /*!< Partial derivatives of \ref FUZZ_MODE_GRADIENT by slot */
+    double diff[FUZZ_VARS];         /*!< Values of the derivatives of \ref FUZZ_MODE_DIFF by slot */
+    calc_error_code_t diff_codes[FUZZ_VARS];    /*!< Error codes of the derivatives, of \ref calc_diff or of their evaluation */
+    uint8_t differentiated[FUZZ_VARS];  /*!< Set if \ref calc_diff has built the derivative, there is none of `fact` of the variable */
+    uint8_t has_power;              /*!< Set if the expression has a power, whose derivative takes the logarithm of the base */
+} details_t;
+
+/**
+ * \brief           Statistics of an engine or a mode
+ */
+typedef struct {
+    uint64_t evaluations;           /*!< A number of evaluations */
+    uint64_t ns;                    /*!< Time spent in the evaluations */
+    uint64_t mismatches;            /*!< Results out of the tolerance, only possible when mismatches do not abort */
+} engine_stats_t;
+
+static const char* const variable_names[FUZZ_VARS] = {"x", "y", "z"};
+static const double interesting[] = {0, 1, -1, 0.5, -0.5, 2, 3, 10, 170, 171, 1e-300, 1e300, -1e300, 3.14159, 1e15, 9007199254740993.0};
+static const char* const numbers[] = {"0", "1", "2", "3", "7", "10", "0.5", "1.5", "12.25", "100", "170", "171", "1000", "65536", "4294967296"};
+
+static const char* const mode_names[FUZZ_MODE_COUNT - CALC_ENGINE_COUNT] = {"exact", "interval", "complex", "float", "dd", "dual", "gradient",
+                                                                             "big", "decimal", "diff"};
+
+static engine_stats_t stats[FUZZ_MODE_COUNT];       /*!< Statistics of every engine and mode */
+static double tolerance = FUZZ_DEFAULT_TOLERANCE;   /*!< The relative tolerance of the comparison */
+static uint64_t inputs, compiled;                   /*!< Inputs run and inputs which have compiled */
+
+static uint32_t take(source_t* source, uint32_t count);                     /* A function used to take a decision from the input */
+static void append(text_t* text, const char* str);                          /* A function used to append a string to the expression */
+static void mark(text_t* text, size_t start);                               /* A function used to record an intermediate value */
+static void generate_expression(source_t* source, text_t* text, uint32_t depth);  /* A function used to generate a sum */
+static void generate_term(source_t* source, text_t* text, uint32_t depth);  /* A function used to generate a product */
+static void generate_factor(source_t* source, text_t* text, uint32_t depth);    /* A function used to generate a factor */
+static void run_expression(const char* str, size_t len, const double* vars, const text_t* text);  /* A function used to check an expression on every engine */
+static void bind(const calc_expr_t* expr, const double* vars, double* slots);  /* A function used to order the variables by slot */
+static double evaluate(calc_context_t* context, const calc_expr_t* expr, const double* slots, fuzz_mode_t mode,
+                       details_t* details, calc_error_code_t* code);    /* A function used to evaluate an expression in a mode */
+static uint8_t check_mode(const calc_expr_t* expr, const double* slots, fuzz_mode_t mode, const double* results,
+                          const calc_error_code_t* codes, const details_t* details);    /* A function used to check a mode against the linear engine */
+static uint8_t check_partials(const calc_expr_t* expr, const double* slots, const double* results, const calc_error_code_t* codes,
+                              const details_t* details);    /* A function used to check the partials of the three differentiations */
+static uint8_t inside(double value, const calc_interval_t* enclosure, double slack); /* A function used to check a value against an enclosure */
+static uint8_t excused(const text_t* text, const calc_expr_t* expr, const double* vars, const double* slots, fuzz_mode_t mode,
+                       double linear);  /* A function used to excuse a mismatch of a mode by the intermediate values */
+static double float_condition(const calc_expr_t* expr, const double* slots); /* A function used to estimate the growth of rounding errors */
+static double partial_condition(const calc_expr_t* expr, const double* slots, size_t index);   /* A function used to estimate the growth of rounding errors of a partial */
+static const char* mode_name(fuzz_mode_t mode);                             /* A function used to get a name of an engine or a mode */
+static uint8_t agree(double a, calc_error_code_t a_code, double b, calc_error_code_t b_code);  /* A function used to compare two results */
+static uint8_t agree_partial(double a, double b);                          /* A function used to compare two partial derivatives */
+static uint64_t now_ns(void);                                               /* A function used to get a monotonic time in nanoseconds */
+static void print_stats(void);                                              /* A function used to print the agreement and the throughput */
+
+/**
+ * \brief           Entry point of libFuzzer, also called by the standalone driver
+ * \param[in]       data: The input
+ * \param[in]       size: Size of the input
+ * \return          0
+ * \note            An input starting with 0 is passed to the compiler as raw text, to check its robustness.
+ *                  Any other input drives the grammar of the generator, so mutations of the input stay valid expressions.
+ */
+int
+LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    static uint8_t initialized;
+    source_t source = {data, size, 0};
+    text_t text;
+    double vars[FUZZ_VARS];
+    if (!initialized) {
+        const char* env = getenv("CALC_FUZZ_TOLERANCE");
+        if (env != NULL) {
+            tolerance = strtod(env, NULL);
+        }
+        atexit(print_stats);
+        initialized = 1;
+    }
+    ++inputs;
+    if (size > 0 && data[0] == 0) {             /* Raw text */
+        calc_validate((const char*)data + 1, size - 1);
+        run_expression((const char*)data + 1, size - 1, (const double[FUZZ_VARS]){1, 2, 3}, NULL);
+        return 0;
+    }
+    for (size_t i = 0; i < FUZZ_VARS; ++i) {
+        vars[i] = interesting[take(&source, sizeof(interesting) / sizeof(interesting[0]))];
+    }
+    text.len = 0;
+    text.text[0] = '\0';
+    text.span_count = 0;
+    generate_expression(&source, &text, 0);
+    calc_validate(text.text, text.len);         /* The legacy checks must not crash either */
+    run_expression(text.text, text.len, vars, &text);
+    return 0;
+}
+
+#ifndef CALC_FUZZ_LIBFUZZER
+
+/**
+ * \brief           Main function of the standalone driver, used when the harness is not linked with libFuzzer
+ * \param[in]       argc: A number of arguments
+ * \param[in]       argv: Arguments: [-n runs] [-s seed] [files...]
+ * \return          0 if every input has passed, the process is aborted on a mismatch
+ * \note            Files are run as they are, e.g. to reproduce a crash found by libFuzzer. Without files random inputs are run.
+ */
+int
+main(int argc, char** argv) {
+    uint64_t runs = FUZZ_DEFAULT_RUNS, seed = 0x5eed;
+    int files = 0;
+    for (int i = 1; i < argc; ++i) {            /* Parse the options */
+        if (i + 1 < argc && strcmp(argv[i], "-n") == 0) {
+            runs = strtoul(argv[++i], NULL, 10);
+        } else if (i + 1 < argc && strcmp(argv[i], "-s") == 0) {
+            seed = strtoul(argv[++i], NULL, 0);
+        } else if (argv[i][0] == '-') {
+            fprintf(stderr, "usage: %s [-n runs] [-s seed] [files...]\n", argv[0]);
+            return 1;
+        } else {                                /* Run a file */
+            uint8_t data[FUZZ_MAX_INPUT];
+            FILE* file = fopen(argv[i], "rb");
+            size_t size;
+            if (file == NULL) {
+                perror(argv[i]);
+                return 1;
+            }
+            size = fread(data, 1, sizeof(data), file);
+            fclose(file);
+            LLVMFuzzerTestOneInput(data, size);
+            ++files;
+        }
+    }
+    for (uint64_t n = 0; files == 0 && n < runs; ++n) { /* Run random inputs */
+        uint8_t data[256];
+        size_t size;
+        seed ^= seed << 13;                     /* xorshift64 */
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+        size = 1 + seed % sizeof(data);
+        for (size_t i = 0; i < size; ++i) {
+            seed ^= seed << 13;
+            seed ^= seed >> 7;
+            seed ^= seed << 17;
+            data[i] = (uint8_t)(seed >> 24);
+        }
+        LLVMFuzzerTestOneInput(data, size);
+    }
+    return 0;
+}
+
+#endif /* CALC_FUZZ_LIBFUZZER */
+
+/**
+ * \brief           A function used to take a decision from the input
+ * \param[in]       source: The input
+ * \param[in]       count: A number of choices
+ * \return          The choice, below the count
+ */
+static uint32_t
+take(source_t* source, uint32_t count) {
+    if (source->pos >= source->size) {
+        return 0;
+    }
+    return source->data[source->pos++] % count;
+}
+
+/**
+ * \brief           A function used to append a string to the expression
+ * \param[in]       text: The expression
+ * \param[in]       str: The string
+ * \note            A string which does not fit is dropped, the result may be invalid which is a valid test too
+ */
+static void
+append(text_t* text, const char* str) {
+    size_t len = strlen(str);
+    if (text->len + len < sizeof(text->text)) {
+        memcpy(text->text + text->len, str, len + 1);
+        text->len += len;
+    }
+}
+
+/**
+ * \brief           A function used to record an intermediate value of the expression
+ * \param[in]       text: The expression
+ * \param[in]       start: Offset of the text of the value, which ends at the end of the expression
+ * \note            A value beyond \ref FUZZ_MAX_SPANS is not recorded, so its mismatches are not excused
+ */
+static void
+mark(text_t* text, size_t start) {
+    if (text->span_count < FUZZ_MAX_SPANS) {
+        text->spans[text->span_count].start = (uint16_t)start;
+        text->spans[text->span_count].end = (uint16_t)text->len;
+        ++text->span_count;
+    }
+}
+
+/**
+ * \brief           A function used to generate a sum of terms
+ * \param[in]       source: The input
+ * \param[out]      text: The expression
+ * \param[in]       depth: Nesting depth of the sum
+ */
+static void
+generate_expression(source_t* source, text_t* text, uint32_t depth) {
+    uint32_t terms = 1 + take(source, 4);
+    size_t start = text->len;
+    for (uint32_t i = 0; i < terms; ++i) {
+        if (i > 0) {
+            append(text, take(source, 2) ? "-" : "+");
+        }
+        generate_term(source, text, depth);
+        mark(text, start);
+    }
+}
+
+/**
+ * \brief           A function used to generate a product of factors
+ * \param[in]       source: The input
+ * \param[out]      text: The expression
+ * \param[in]       depth: Nesting depth of the product
+ */
+static void
+generate_term(source_t* source, text_t* text, uint32_t depth) {
+    static const char* const operators[] = {"*", "/", ":", "%", "^"};
+    uint32_t factors = 1 + take(source, 3);
+    size_t start = text->len;
+    for (uint32_t i = 0; i < factors; ++i) {
+        if (i > 0) {
+            append(text, operators[take(source, 5)]);
+        }
+        generate_factor(source, text, depth);
+        mark(text, start);
+    }
+}
+
+/**
+ * \brief           A function used to generate a factor: a number, a variable, a negation, parentheses or a call
+ * \param[in]       source: The input
+ * \param[out]      text: The expression
+ * \param[in]       depth: Nesting depth of the factor
+ */
+static void
+generate_factor(source_t* source, text_t* text, uint32_t depth) {
+    uint32_t kind = take(source, depth >= FUZZ_MAX_DEPTH ? 2 : 5);
+    size_t start = text->len;
+    switch (kind) {
+        case 0:
+            append(text, numbers[take(source, sizeof(numbers) / sizeof(numbers[0]))]);
+            break;
+        case 1:
+            append(text, variable_names[take(source, FUZZ_VARS)]);
+            break;
+        case 2:                                 /* Parenthesized, since the grammar rejects two signs in a row */
+            append(text, "(-");
+            generate_factor(source, text, depth + 1);
+            append(text, ")");
+            break;
+        case 3:
+            append(text, "(");
+            generate_expression(source, text, depth + 1);
+            append(text, ")");
+            break;
+        default: {
+            const char* name = calc_alias_name(take(source, (uint32_t)calc_alias_count()));
+            const calc_function_t* function = calc_function_find(name, strlen(name));
+            uint32_t args = function->variadic ? 1 + take(source, 4) : function->arity;
+            append(text, name);
+            append(text, "(");
+            for (uint32_t i = 0; i < args; ++i) {
+                if (i > 0) {
+                    append(text, ",");
+                }
+                generate_expression(source, text, depth + 1);
+            }
+            append(text, ")");
+            break;
+        }
+    }
+    mark(text, start);
+}
+
+/**
+ * \brief           A function used to compile an expression and check that every engine and mode agrees with the linear engine
+ * \param[in]       str: The expression
+ * \param[in]       len: Length of the expression
+ * \param[in]       vars: Values of x, y and z
+ * \param[in]       text: The generated expression with its intermediate values, `NULL` for raw text
+ * \note            The process is aborted on a mismatch, so that libFuzzer keeps the input
+ */
+static void
+run_expression(const char* str, size_t len, const double* vars, const text_t* text) {
+    static calc_context_t* context;
+    double slots[FUZZ_VARS] = {0};              /* Values in the order of the variable slots */
+    double results[FUZZ_MODE_COUNT];
+    calc_error_code_t codes[FUZZ_MODE_COUNT] = {CALC_OK};
+    details_t details = {0};                    /* The results the later modes are checked against */
+    calc_expr_t* expr = calc_compile(str, len, NULL);
+    if (expr == NULL) {
+        return;
+    }
+    if (context == NULL) {
+        context = calc_context_create();
+    }
+    if (calc_var_count(expr) > FUZZ_VARS) {     /* Only possible for raw text, e.g. unknown names */
+        calc_free(expr);
+        return;
+    }
+    ++compiled;
+    bind(expr, vars, slots);
+    details.enclosure.lo = details.enclosure.hi = NAN;
+    details.has_power = memchr(str, '^', len) != NULL;
+    for (size_t m = 0; m < FUZZ_MODE_COUNT; ++m) {  /* Run every engine and mode, the interval mode before those it bounds */
+        fuzz_mode_t mode = m == FUZZ_MODE_EXACT ? FUZZ_MODE_INTERVAL : m == FUZZ_MODE_INTERVAL ? FUZZ_MODE_EXACT : (fuzz_mode_t)m;
+        size_t repeat = mode == FUZZ_MODE_BIG ? 1 : FUZZ_REPEAT;   /* A huge integer takes long enough to be timed alone */
+        uint64_t start;
+        if (mode == FUZZ_MODE_BIG && (codes[CALC_ENGINE_LINEAR] != CALC_OK || isnan(results[CALC_ENGINE_LINEAR])
+                                      || codes[FUZZ_MODE_INTERVAL] != CALC_OK || !isfinite(details.enclosure.lo)
+                                      || !isfinite(details.enclosure.hi))) {
+            continue;                           /* Not checked, and an intermediate beyond doubles, e.g. sin(2^10^7), may take seconds */
+        }
+        start = now_ns();
+        for (size_t r = 0; r < repeat; ++r) {
+            results[mode] = evaluate(context, expr, slots, mode, &details, &codes[mode]);
+        }
+        stats[mode].ns += now_ns() - start;
+        stats[mode].evaluations += repeat;
+        if (!check_mode(expr, slots, mode, results, codes, &details) && !excused(text, expr, vars, slots, mode, results[0])) {
+            ++stats[mode].mismatches;
+            fprintf(stderr, "mismatch: %.*s\n  x=%.17g y=%.17g z=%.17g\n  %s: %.17g (%s)\n  %s: %.17g (%s)\n  %s: [%.17g, %.17g] (%s)\n",
+                    (int)len, str, vars[0], vars[1], vars[2],
+                    mode_name((fuzz_mode_t)CALC_ENGINE_LINEAR), results[0], calc_error_string(codes[0]),
+                    mode_name(mode), results[mode], calc_error_string(codes[mode]),
+                    mode_name(FUZZ_MODE_INTERVAL), details.enclosure.lo, details.enclosure.hi, calc_error_string(codes[FUZZ_MODE_INTERVAL]));
+            for (size_t i = 0; mode == FUZZ_MODE_DIFF && i < calc_var_count(expr); ++i) {
+                fprintf(stderr, "  d/d%s: dual %.17g, gradient %.17g, diff %.17g (%s)\n", calc_var_name(expr, i), details.dual[i],
+                        details.gradient[i], details.diff[i], calc_error_string(details.diff_codes[i]));
+            }
+            abort();
+        }
+    }
+    calc_free(expr);
+}
+
+/**
+ * \brief           A function used to order values of x, y and z by the variable slots of an expression
+ * \param[in]       expr: A compiled expression
+ * \param[in]       vars: Values of x, y and z
+ * \param[out]      slots: Values of the variables indexed by slot
+ */
+static void
+bind(const calc_expr_t* expr, const double* vars, double* slots) {
+    for (size_t i = 0; i < calc_var_count(expr); ++i) {
+        const char* name = calc_var_name(expr, i);
+        for (size_t v = 0; v < FUZZ_VARS; ++v) {
+            if (strcmp(name, variable_names[v]) == 0) {
+                slots[i] = vars[v];
+            }
+        }
+    }
+}
+
+/**
+ * \brief           A function used to excuse a mismatch of a mode by the intermediate values of the expression
+ * \param[in]       text: The generated expression with its intermediate values, `NULL` for raw text
+ * \param[in]       expr: The compiled expression
+ * \param[in]       vars: Values of x, y and z
+ * \param[in]       slots: Values of the variables indexed by slot
+ * \param[in]       mode: The engine or the mode
+ * \param[in]       linear: The result of the linear engine
+ * \return          1 if the mismatch is excused, 0 otherwise
+ * \note            The interval, exact, double-double, arbitrary precision, complex and float modes define an intermediate error, infinity
+ *                  or NaN differently from the linear engine, e.g. a domain error on a more accurate argument, a one-sided
+ *                  enclosure of a division by zero or a complex result of a negative base, so their mismatches are excused
+ *                  when the linear engine has one. Mismatches of the float mode are also excused when an intermediate value
+ *                  is much larger than the result, has an absolute rounding error in float above the tolerance or rounds
+ *                  to float across an integer or a half, or when the rounding errors grow, see \ref float_condition.
+ *                  The intermediate values of raw text are not known, so its mismatches of these modes are always excused.
+ *                  The other engines and modes have the semantics of the linear engine, or are checked only where their
+ *                  results are defined, as the decimal and the diff modes, and are never excused.
+ */
+static uint8_t
+excused(const text_t* text, const calc_expr_t* expr, const double* vars, const double* slots, fuzz_mode_t mode,
+        double linear) {
+    double largest = 0;                         /* The largest magnitude of an intermediate value */
+    uint8_t crossed = 0;                        /* Set if an intermediate value rounds to float across an integer or a half */
+    if ((size_t)mode < CALC_ENGINE_COUNT || mode == FUZZ_MODE_DUAL || mode == FUZZ_MODE_GRADIENT || mode == FUZZ_MODE_DECIMAL
+        || mode == FUZZ_MODE_DIFF) {
+        return 0;
+    } else if (text == NULL) {
+        return 1;
+    }
+    for (size_t i = 0; i < text->span_count; ++i) {
+        double span_slots[FUZZ_VARS] = {0}, value;
+        calc_error_t error = {CALC_OK, 0};
+        calc_expr_t* span = calc_compile(text->text + text->spans[i].start, text->spans[i].end - text->spans[i].start, NULL);
+        if (span == NULL) {
+            continue;
+        }
+        bind(span, vars, span_slots);
+        value = calc_eval(span, span_slots, &error);
+        calc_free(span);
+        if (error.code != CALC_OK || !isfinite(value)) {
+            return 1;
+        }
+        largest = fmax(largest, fabs(value));
+        crossed |= floor((float)value) != floor(value) || ceil((float)value) != ceil(value)
+                   || round((float)value) != round(value);
+    }
+    return mode == FUZZ_MODE_FLOAT
+           && (largest > FUZZ_FLOAT_MAX_CANCELLATION * fmax(1.0, fabs(linear))
+               || largest * FLT_EPSILON > FUZZ_FLOAT_TOLERANCE  /* An absolute rounding error above the tolerance, which a periodic function or % keeps */
+               || crossed                       /* trunc, floor, ceil or round jumps */
+               || float_condition(expr, slots) > FUZZ_FLOAT_MAX_CONDITION);
+}
+
+/**
+ * \brief           A function used to evaluate an expression in an engine or a mode
+ * \param[in]       context: An evaluation context
+ * \param[in]       expr: A compiled expression
+ * \param[in]       slots: Values of the variables indexed by slot
+ * \param[in]       mode: The engine or the mode
+ * \param[out]      details: The results of the mode other than its value, the other members are not written
+ * \param[out]      code: An error code of the result
+ * \return          The result, the real part of a complex one, the value of the expression for \ref FUZZ_MODE_DIFF
+ */
+static double
+evaluate(calc_context_t* context, const calc_expr_t* expr, const double* slots, fuzz_mode_t mode,
+         details_t* details, calc_error_code_t* code) {
+    size_t count = calc_var_count(expr);
+    const double* columns[FUZZ_VARS];
+    double* gradient[FUZZ_VARS];
+    calc_error_t error = {CALC_OK, 0};
+    double result = NAN, im;
+    for (size_t i = 0; i < count; ++i) {
+        columns[i] = &slots[i];
+        gradient[i] = &details->dual[i];
+    }
+    switch (mode) {
+        case FUZZ_MODE_EXACT:
+            result = calc_eval_exact(context, expr, slots, &details->exact, &error);
+            break;
+        case FUZZ_MODE_INTERVAL: {
+            calc_interval_t points[FUZZ_VARS];
+            for (size_t i = 0; i < count; ++i) {
+                points[i].lo = points[i].hi = slots[i];
+            }
+            result = calc_eval_interval(expr, points, &details->enclosure, &error);
+            break;
+        }
+        case FUZZ_MODE_COMPLEX:
+            calc_eval_complex_columns(expr, 1, columns, NULL, &result, &im, &error);
+            if (error.code == CALC_OK && im != 0) { /* A complex result of real variables is not a result of the linear engine */
+                error.code = CALC_ERROR_UNDEFINED_FUNCTION;
+            }
+            break;
+        case FUZZ_MODE_FLOAT: {
+            float values[FUZZ_VARS], single;
+            const float* float_columns[FUZZ_VARS];
+            for (size_t i = 0; i < count; ++i) {
+                values[i] = (float)slots[i];
+                float_columns[i] = &values[i];
+            }
+            calc_eval_float_columns(expr, 1, float_columns, &single, &error);
+            result = single;
+            break;
+        }
+        case FUZZ_MODE_DD: {
+            calc_dd_t values[FUZZ_VARS];
+            for (size_t i = 0; i < count; ++i) {
+                values[i].hi = slots[i];
+                values[i].lo = 0;
+            }
+            result = calc_eval_dd(expr, values, NULL, &error);
+            break;
+        }
+        case FUZZ_MODE_DUAL:
+            calc_eval_dual_columns(expr, 1, columns, &result, gradient, &error);
+            break;
+        case FUZZ_MODE_GRADIENT:
+            result = calc_eval_gradient(context, expr, slots, details->gradient, &error);
+            break;
+        case FUZZ_MODE_BIG: {
+            char* text = calc_eval_big(expr, slots, FUZZ_BIG_DIGITS, &error);
+            result = text != NULL ? strtod(text, NULL) : NAN;  /* Rounded once more, within the tolerance */
+            free(text);
+            break;
+        }
+        case FUZZ_MODE_DECIMAL:
+            result = calc_eval_decimal(expr, slots, FUZZ_DECIMAL_SCALE, &details->decimal, &error);
+            break;
+        case FUZZ_MODE_DIFF:
+            for (size_t i = 0; i < count; ++i) {
+                calc_expr_t* derivative = calc_diff(expr, calc_var_name(expr, i), &error);
+                details->diff[i] = derivative != NULL ? calc_eval(derivative, slots, &error) : NAN;
+                details->diff_codes[i] = error.code;
+                details->differentiated[i] = derivative != NULL;
+                calc_free(derivative);
+            }
+            result = calc_eval(expr, slots, &error);
+            break;
+        default:
+            result = calc_eval_engine(context, expr, slots, (calc_engine_t)mode, &error);
+            break;
+    }
+    *code = error.code;
+    return result;
+}
+
+/**
+ * \brief           A function used to check the result of an engine or a mode against the linear engine
+ * \param[in]       expr: A compiled expression
+ * \param[in]       slots: Values of the variables indexed by slot
+ * \param[in]       mode: The engine or the mode
+ * \param[in]       results: The results of the engines and the modes run so far, the linear engine first
+ * \param[in]       codes: Error codes of the results
+ * \param[in]       details: The other results of the modes run so far
+ * \return          1 if the result agrees, 0 otherwise
+ * \note            The engines and the modes calculated in double precision agree as of \ref agree. The exact, the
+ *                  double-double and the arbitrary precision modes are more accurate than the linear engine, so they are checked
+ *                  against the enclosure of the exact result instead, widened by the tolerance. An enclosure with an infinite bound
+ *                  is near a pole, where a more accurate argument may be on its other side, so it is not used. The other modes are compared only where
+ *                  their results are defined the same way: the complex mode on real results, the float mode on
+ *                  variables and results in the range of floats, the decimal mode where the exact mode has an integer result,
+ *                  so that no operation has been rounded to the scale. See \ref excused for the mismatches of these modes
+ *                  and \ref check_partials for the derivatives.
+ */
+static uint8_t
+check_mode(const calc_expr_t* expr, const double* slots, fuzz_mode_t mode, const double* results,
+           const calc_error_code_t* codes, const details_t* details) {
+    const calc_interval_t* enclosure = &details->enclosure;
+    double linear = results[CALC_ENGINE_LINEAR], value = results[mode];
+    calc_error_code_t linear_code = codes[CALC_ENGINE_LINEAR], code = codes[mode];
+    uint8_t bounded = codes[FUZZ_MODE_INTERVAL] == CALC_OK && isfinite(enclosure->lo) && isfinite(enclosure->hi);
+    switch (mode) {
+        case FUZZ_MODE_INTERVAL:                /* Where the linear engine has an intermediate NaN, e.g. of inf*0, the enclosure */
+            return linear_code != CALC_OK || isnan(linear) || code != CALC_OK   /* may be NaN or [0, 0] and fail in a call */
+                   || isnan(value) || inside(linear, enclosure, 0);
+        case FUZZ_MODE_EXACT:
+        case FUZZ_MODE_DD:
+        case FUZZ_MODE_BIG:
+            return linear_code != CALC_OK || isnan(linear) || !bounded
+                   || code != CALC_OK           /* Domains are checked on more accurate arguments, which may be out of them */
+                   || isnan(value) || inside(value, enclosure, tolerance);
+        case FUZZ_MODE_DECIMAL: {
+            char exact[48], decimal[96], expected[96];   /* An integer has at most 39 digits */
+            if (codes[FUZZ_MODE_EXACT] != CALC_OK || !details->exact.is_integer || code != CALC_OK || !details->decimal.is_decimal) {
+                return 1;                       /* A result out of the range of the scale is calculated in double precision */
+            }
+            calc_format_result(&details->exact, exact, sizeof(exact));
+            calc_format_decimal(&details->decimal, decimal, sizeof(decimal));
+            snprintf(expected, sizeof(expected), "%s.%0*d", exact, FUZZ_DECIMAL_SCALE, 0);
+            return strcmp(decimal, expected) == 0;
+        }
+        case FUZZ_MODE_COMPLEX:                 /* An intermediate NaN, which leaves the enclosure NaN, may be complex instead */
+            return linear_code != CALC_OK || !isfinite(linear) || !bounded || agree(linear, linear_code, value, code);
+        case FUZZ_MODE_FLOAT:
+            for (size_t i = 0; i < calc_var_count(expr); ++i) {
+                if (fabs(slots[i]) > FLT_MAX || (slots[i] != 0 && fabs(slots[i]) < FLT_MIN)) {
+                    return 1;
+                }
+            }
+            if (linear_code != CALC_OK || !isfinite(linear) || fabs(linear) > FLT_MAX || !bounded) {
+                return 1;
+            }
+            return code != CALC_OK || !isfinite(value)  /* Intermediate values may leave the range of floats */
+                   || fabs(linear - value) <= FUZZ_FLOAT_TOLERANCE * fmax(1.0, fabs(linear));
+        case FUZZ_MODE_DIFF:
+            return agree(linear, linear_code, value, code) && check_partials(expr, slots, results, codes, details);
+        default:
+            return agree(linear, linear_code, value, code);
+    }
+}
+
+/**
+ * \brief           A function used to check the partial derivatives of the dual, the gradient and the diff modes with each other
+ * \param[in]       expr: A compiled expression
+ * \param[in]       slots: Values of the variables indexed by slot
+ * \param[in]       results: The results of the engines and the modes, the linear engine first
+ * \param[in]       codes: Error codes of the results
+ * \param[in]       details: The partial derivatives
+ * \return          1 if the partials agree, 0 otherwise
+ * \note            Where the expression is undefined every derivative must be undefined too. Elsewhere the derivative may
+ *                  still be undefined where the partial of the dual mode is NaN, in a power, whose derivative takes the
+ *                  logarithm of a base the dual mode gives the partial 0 at, or where \ref calc_diff has no derivative.
+ *                  The partials of a finite result agree as of \ref agree_partial, unless the partial is ill-conditioned,
+ *                  see \ref partial_condition: the three modes sum the same terms in different orders, so a cancellation
+ *                  of large terms, as in the partial of `z/(-z)+z` at 1e-300, may leave any of them without a correct digit.
+ */
+static uint8_t
+check_partials(const calc_expr_t* expr, const double* slots, const double* results, const calc_error_code_t* codes,
+               const details_t* details) {
+    for (size_t i = 0; i < calc_var_count(expr); ++i) {
+        if (codes[CALC_ENGINE_LINEAR] != CALC_OK) {
+            if (details->diff_codes[i] != codes[CALC_ENGINE_LINEAR]) {
+                return 0;
+            }
+        } else if (!isfinite(results[CALC_ENGINE_LINEAR])) {
+            /* The partials of an intermediate infinity or NaN are not defined by the rules */
+        } else if (details->diff_codes[i] != CALC_OK) {
+            if ((details->differentiated[i] && !isnan(details->dual[i]) && !details->has_power)
+                || !agree_partial(details->dual[i], details->gradient[i])) {
+                return 0;
+            }
+        } else if ((!agree_partial(details->dual[i], details->gradient[i]) || !agree_partial(details->dual[i], details->diff[i]))
+                   && partial_condition(expr, slots, i) <= FUZZ_PARTIAL_MAX_CONDITION) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/**
+ * \brief           A function used to compare the results of two engines
+ * \param[in]       a: The first result
+ * \param[in]       a_code: An error code of the first result
+ * \param[in]       b: The second result
+ * \param[in]       b_code: An error code of the second result
+ * \return          1 if the results agree, 0 otherwise
+ * \note            The error codes must be the same. NaN agrees with NaN only and an infinity with the same infinity only,
+ *                  finite values agree within the relative tolerance, which is absolute for values below 1.
+ */
+static uint8_t
+agree(double a, calc_error_code_t a_code, double b, calc_error_code_t b_code) {
+    if (a_code != b_code) {
+        return 0;
+    } else if (a_code != CALC_OK) {
+        return 1;
+    } else if (isnan(a) || isnan(b)) {
+        return isnan(a) && isnan(b);
+    } else if (isinf(a) || isinf(b)) {
+        return a == b;
+    }
+    return fabs(a - b) <= tolerance * fmax(1.0, fmax(fabs(a), fabs(b)));
+}
+
+/**
+ * \brief           A function used to compare two partial derivatives
+ * \param[in]       a: The first partial
+ * \param[in]       b: The second partial
+ * \return          1 if the partials agree, 0 otherwise
+ * \note            Finite partials agree as of \ref agree. A partial of an intermediate value may overflow where its value
+ *                  does not, e.g. of `y/z` for a tiny `z`, and then one differentiation gives an infinity, another NaN and
+ *                  a third a finite partial, where the infinity has met a partial which has underflowed to 0.
+ *                  So a partial which is not finite agrees with any other.
+ */
+static uint8_t
+agree_partial(double a, double b) {
+    return !isfinite(a) || !isfinite(b) || agree(a, CALC_OK, b, CALC_OK);
+}
+
+/**
+ * \brief           A function used to check a value against an enclosure
+ * \param[in]       value: The value
+ * \param[in]       enclosure: The enclosure
+ * \param[in]       slack: A relative widening of the enclosure, absolute below 1
+ * \return          1 if the value is inside the widened enclosure, 0 otherwise
+ */
+static uint8_t
+inside(double value, const calc_interval_t* enclosure, double slack) {
+    double lo = isfinite(enclosure->lo) ? enclosure->lo - slack * fmax(1.0, fabs(enclosure->lo)) : enclosure->lo;
+    double hi = isfinite(enclosure->hi) ? enclosure->hi + slack * fmax(1.0, fabs(enclosure->hi)) : enclosure->hi;
+    return lo <= value && value <= hi;
+}
+
+/**
+ * \brief           A function used to estimate the growth of rounding errors of an expression
+ * \param[in]       expr: A compiled expression
+ * \param[in]       slots: Values of the variables indexed by slot
+ * \return          The relative width of the enclosure of the result for variables known to a float epsilon,
+ *                  in float epsilons, infinite if there is no bounded enclosure
+ * \note            Rounding errors of literals and of the operations grow the same way as those of the variables
+ *                  as long as the literals are far from each other, so this is an estimate only
+ */
+static double
+float_condition(const calc_expr_t* expr, const double* slots) {
+    calc_interval_t widened[FUZZ_VARS], enclosure;
+    calc_error_t error;
+    for (size_t i = 0; i < calc_var_count(expr); ++i) {
+        widened[i].lo = slots[i] - fabs(slots[i]) * FLT_EPSILON;
+        widened[i].hi = slots[i] + fabs(slots[i]) * FLT_EPSILON;
+    }
+    calc_eval_interval(expr, widened, &enclosure, &error);
+    if (error.code != CALC_OK || !isfinite(enclosure.lo) || !isfinite(enclosure.hi)) {
+        return INFINITY;
+    }
+    return (enclosure.hi - enclosure.lo) / (FLT_EPSILON * fmax(1.0, fmax(fabs(enclosure.lo), fabs(enclosure.hi))));
+}
+
+/**
+ * \brief           A function used to estimate the growth of rounding errors of a partial derivative
+ * \param[in]       expr: A compiled expression
+ * \param[in]       slots: Values of the variables indexed by slot
+ * \param[in]       index: The slot of the variable of the partial
+ * \return          The relative width of the enclosure of the derivative of \ref calc_diff for variables known to a double
+ *                  epsilon, in double epsilons, infinite if there is no bounded enclosure
+ * \note            An estimate as \ref float_condition is, only calculated for partials which do not agree
+ */
+static double
+partial_condition(const calc_expr_t* expr, const double* slots, size_t index) {
+    calc_interval_t widened[FUZZ_VARS], enclosure;
+    calc_error_t error;
+    calc_expr_t* derivative = calc_diff(expr, calc_var_name(expr, index), &error);
+    if (derivative == NULL) {
+        return INFINITY;
+    }
+    for (size_t i = 0; i < calc_var_count(expr); ++i) {
+        widened[i].lo = slots[i] - fabs(slots[i]) * DBL_EPSILON;
+        widened[i].hi = slots[i] + fabs(slots[i]) * DBL_EPSILON;
+    }
+    calc_eval_interval(derivative, widened, &enclosure, &error);
+    calc_free(derivative);
+    if (error.code != CALC_OK || !isfinite(enclosure.lo) || !isfinite(enclosure.hi)) {
+        return INFINITY;
+    }
+    return (enclosure.hi - enclosure.lo) / (DBL_EPSILON * fmax(1.0, fmax(fabs(enclosure.lo), fabs(enclosure.hi))));
+}
+
+/**
+ * \brief           A function used to get a name of an engine or a mode
+ * \param[in]       mode: The engine or the mode
+ * \return          The name
+ */
+static const char*
+mode_name(fuzz_mode_t mode) {
+    return (size_t)mode < CALC_ENGINE_COUNT ? calc_engine_name((calc_engine_t)mode) : mode_names[mode - CALC_ENGINE_COUNT];
+}
+
+/**
+ * \brief           A function used to get a monotonic time in nanoseconds
+ * \return          The time
+ */
+static uint64_t
+now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * \brief           A function used to print the agreement and the throughput of every engine and mode
+ */
+static void
+print_stats(void) {
+    fprintf(stderr, "%llu inputs, %llu compiled, tolerance %g, float tolerance %g\n", (unsigned long long)inputs,
+            (unsigned long long)compiled, tolerance, FUZZ_FLOAT_TOLERANCE);
+    fprintf(stderr, "%-12s %14s %10s %14s %10s\n", "engine", "evaluations", "ns/eval", "evaluations/s", "mismatches");
+    for (size_t e = 0; e < FUZZ_MODE_COUNT; ++e) {
+        double ns = stats[e].evaluations > 0 ? (double)stats[e].ns / (double)stats[e].evaluations : 0.0;
+        fprintf(stderr, "%-12s %14llu %10.1f %14.0f %10llu\n", mode_name((fuzz_mode_t)e),
+                (unsigned long long)stats[e].evaluations, ns, ns > 0 ? 1e9 / ns : 0.0, (unsigned long long)stats[e].mismatches);
+    }
+}
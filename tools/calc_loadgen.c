@@ -0,0 +1,336 @@
+/**
+ * \file            calc_loadgen.c
+ * \brief           Load generator measuring latency of the calculator server
+ */
+
+/*
+ * Copyright (c) 2024 Daniil VERES
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * Author:          Daniil VERES <daniaveres@gmail.com>
+ * Version:         v1.0.0
+ */
+
+                        /* Functions used: */
+#include <errno.h>      /* errno */
+#include <stdint.h>     /* uint8_t, uint64_t */
+#include <stdio.h>      /* printf, fprintf, perror */
+#include <stdlib.h>     /* strtoul, malloc, calloc, free, qsort */
+#include <string.h>     /* strlen, memchr, memmove, memcpy */
+#include <sys/epoll.h>  /* epoll_create1, epoll_ctl, epoll_wait */
+#include <sys/socket.h> /* socket, connect */
+#include <sys/un.h>     /* sockaddr_un */
+#include <time.h>       /* clock_gettime */
+#include <unistd.h>     /* getopt, read, write, close */
+
+                                        /* Constants used: */
+#define LOADGEN_DEFAULT_CONNECTIONS 64  /*!< Default number of connections */
+#define LOADGEN_DEFAULT_REQUESTS 200000 /*!< Default number of requests */
+#define LOADGEN_MAX_EVENTS 256          /*!< Maximum number of events handled per epoll_wait */
+#define LOADGEN_BUFFER 4096             /*!< Size of the receive buffer of a connection */
+
+/**
+ * \brief           Expressions sent when none is given on the command line
+ */
+static const char* const default_expressions[] = {
+    "2+3*4-5/2\n",
+    "sqrt(16)+sin(0.5)^2+cos(0.5)^2\n",
+    "log(2,1024)*ln(exp(3))\n",
+    "min(4,2,8)-max(1,7,3)+fact(10)\n",
+    "atan(1)*4-abs(0-3.5)+round(2.5)\n",
+};
+
+/**
+ * \brief           State of a client connection
+ */
+typedef struct {
+    int fd;                         /*!< Socket of the connection */
+    char in[LOADGEN_BUFFER];        /*!< Received bytes not forming a complete reply yet */
+    size_t in_len;                  /*!< A number of bytes in the receive buffer */
+    double* sent_at;                /*!< Times the requests in flight have been sent, a ring of the pipeline depth */
+    size_t sent;                    /*!< A number of requests sent, the ring index of the next request */
+    size_t answered;                /*!< A number of replies received, the ring index of the oldest request in flight */
+    size_t next;                    /*!< Index of the next expression to send */
+} client_t;
+
+/**
+ * \brief           Options and results of the run
+ */
+typedef struct {
+    const char* const* expressions; /*!< Expressions to send, each terminated by a new line */
+    size_t expression_count;        /*!< A number of expressions */
+    size_t depth;                   /*!< A number of requests each connection keeps in flight */
+    uint64_t to_send;               /*!< Requests not sent yet */
+    uint64_t replies;               /*!< Replies received */
+    uint64_t errors;                /*!< Replies reporting an error */
+    double* latencies;              /*!< Round trip time of every request in seconds */
+} loadgen_t;
+
+static double now(void);                                                /* A function used to get a monotonic time in seconds */
+static uint8_t send_requests(loadgen_t* run, client_t* client);        /* A function used to fill the pipeline of a connection */
+static uint8_t receive_replies(loadgen_t* run, client_t* client);      /* A function used to read replies of a connection */
+static int compare_doubles(const void* a, const void* b);              /* A function used to sort latencies */
+static double percentile(const double* sorted, uint64_t count, double p);   /* A function used to get a percentile of sorted latencies */
+
+/**
+ * \brief           Main function
+ * \param[in]       argc: A number of arguments
+ * \param[in]       argv: Arguments: -s <socket> [-c connections] [-n requests] [-p depth] [-e expression]
+ * \return          0 if all requests have been answered without errors, 1 otherwise
+ * \note            Every connection keeps `depth` requests in flight (1 by default) and tops the pipeline up with a single write whenever replies arrive
+ */
+int
+main(int argc, char** argv) {
+    const char* path = NULL;                    /* A path of the server socket */
+    size_t connections = LOADGEN_DEFAULT_CONNECTIONS;
+    uint64_t requests = LOADGEN_DEFAULT_REQUESTS;
+    const char* expression = NULL;              /* A single expression given on the command line */
+    char* line = NULL;                          /* The expression terminated by a new line */
+    loadgen_t run = {0};
+    struct sockaddr_un address = {0};
+    struct epoll_event events[LOADGEN_MAX_EVENTS];
+    client_t* clients;
+    int epoll_fd, option;
+    double start, elapsed;
+
+    run.depth = 1;
+    while ((option = getopt(argc, argv, "s:c:n:p:e:")) != -1) { /* Parse the options */
+        switch (option) {
+            case 's':
+                path = optarg;
+                break;
+            case 'c':
+                connections = strtoul(optarg, NULL, 10);
+                break;
+            case 'n':
+                requests = strtoull(optarg, NULL, 10);
+                break;
+            case 'p':
+                run.depth = strtoul(optarg, NULL, 10);
+                break;
+            case 'e':
+                expression = optarg;
+                break;
+            default:
+                path = NULL;
+                optind = argc;
+                break;
+        }
+    }
+    if (path == NULL || connections == 0 || requests == 0 || run.depth == 0 || strlen(path) >= sizeof(address.sun_path)) {
+        fprintf(stderr, "usage: %s -s <socket> [-c connections] [-n requests] [-p depth] [-e expression]\n", argv[0]);
+        return 1;
+    }
+    if (expression != NULL) {                   /* Send a single expression */
+        line = (char*)malloc(strlen(expression) + 2);
+        if (line == NULL) {
+            return 1;
+        }
+        memcpy(line, expression, strlen(expression));
+        memcpy(line + strlen(expression), "\n", 2);
+        run.expressions = (const char* const*)&line;
+        run.expression_count = 1;
+    } else {
+        run.expressions = default_expressions;
+        run.expression_count = sizeof(default_expressions) / sizeof(default_expressions[0]);
+    }
+    run.to_send = requests;
+    run.latencies = (double*)malloc(requests * sizeof(double));
+    clients = (client_t*)calloc(connections, sizeof(client_t));
+    epoll_fd = epoll_create1(0);
+    if (run.latencies == NULL || clients == NULL || epoll_fd < 0) {
+        perror("loadgen");
+        return 1;
+    }
+
+    address.sun_family = AF_UNIX;
+    memcpy(address.sun_path, path, strlen(path) + 1);
+    for (size_t i = 0; i < connections; ++i) {  /* Open all connections before the measurement */
+        struct epoll_event event = {0};
+        clients[i].fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (clients[i].fd < 0 || connect(clients[i].fd, (struct sockaddr*)&address, sizeof(address)) < 0) {
+            perror(path);
+            return 1;
+        }
+        clients[i].next = i % run.expression_count;
+        clients[i].sent_at = (double*)malloc(run.depth * sizeof(double));
+        if (clients[i].sent_at == NULL) {
+            perror("loadgen");
+            return 1;
+        }
+        event.events = EPOLLIN;
+        event.data.ptr = &clients[i];
+        epoll_ctl(epoll_fd, EPOLL_CTL_ADD, clients[i].fd, &event);
+    }
+
+    start = now();
+    for (size_t i = 0; i < connections && run.to_send > 0; ++i) {  /* Fill the pipeline of every connection */
+        if (!send_requests(&run, &clients[i])) {
+            perror("write");
+            return 1;
+        }
+    }
+    while (run.replies < requests) {            /* Loop until every request has been answered */
+        int count = epoll_wait(epoll_fd, events, LOADGEN_MAX_EVENTS, -1);
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            perror("epoll_wait");
+            return 1;
+        }
+        for (int i = 0; i < count; ++i) {
+            if (!receive_replies(&run, (client_t*)events[i].data.ptr)) {
+                fprintf(stderr, "connection closed by the server\n");
+                return 1;
+            }
+        }
+    }
+    elapsed = now() - start;
+
+    qsort(run.latencies, run.replies, sizeof(double), compare_doubles);
+    printf("requests:    %llu (%llu errors)\n", (unsigned long long)run.replies, (unsigned long long)run.errors);
+    printf("connections: %zu, pipeline depth %zu\n", connections, run.depth);
+    printf("throughput:  %.0f requests/s\n", (double)run.replies / elapsed);
+    printf("latency:     p50 %.1f us, p90 %.1f us, p99 %.1f us, p99.9 %.1f us, max %.1f us\n",
+           percentile(run.latencies, run.replies, 0.50) * 1e6, percentile(run.latencies, run.replies, 0.90) * 1e6,
+           percentile(run.latencies, run.replies, 0.99) * 1e6, percentile(run.latencies, run.replies, 0.999) * 1e6,
+           run.latencies[run.replies - 1] * 1e6);
+
+    for (size_t i = 0; i < connections; ++i) {
+        close(clients[i].fd);
+        free(clients[i].sent_at);
+    }
+    close(epoll_fd);
+    free(clients);
+    free(run.latencies);
+    free(line);
+    return run.errors == 0 ? 0 : 1;
+}
+
+/**
+ * \brief           A function used to fill the pipeline of a connection
+ * \param[in]       run: State of the run
+ * \param[in]       client: A connection
+ * \return          1 on success, 0 if the requests could not be sent
+ * \note            All the requests are sent with a single write
+ */
+static uint8_t
+send_requests(loadgen_t* run, client_t* client) {
+    char buffer[LOADGEN_BUFFER];                /* Requests to send */
+    size_t len = 0, sent = 0;
+    double time = now();
+    while (client->sent - client->answered < run->depth && run->to_send > 0) {  /* Loop until the pipeline is full */
+        const char* request = run->expressions[client->next];
+        size_t request_len = strlen(request);
+        if (len + request_len > sizeof(buffer)) {
+            if (len == 0) {                     /* A request longer than the buffer is never sent */
+                return 0;
+            }
+            break;
+        }
+        memcpy(buffer + len, request, request_len);
+        len += request_len;
+        client->sent_at[client->sent++ % run->depth] = time;
+        client->next = (client->next + 1) % run->expression_count;
+        --run->to_send;
+    }
+    while (sent < len) {                        /* The socket is blocking, the whole batch is written */
+        ssize_t n = write(client->fd, buffer + sent, len - sent);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return 0;
+        }
+        sent += (size_t)n;
+    }
+    return 1;
+}
+
+/**
+ * \brief           A function used to read replies of a connection and send the following requests
+ * \param[in]       run: State of the run
+ * \param[in]       client: A connection
+ * \return          1 on success, 0 if the connection has been closed
+ */
+static uint8_t
+receive_replies(loadgen_t* run, client_t* client) {
+    ssize_t received = read(client->fd, client->in + client->in_len, sizeof(client->in) - client->in_len);
+    size_t start = 0;
+    double time;
+    if (received <= 0) {
+        return received < 0 && errno == EINTR;
+    }
+    time = now();
+    client->in_len += (size_t)received;
+    for (;;) {                                  /* Loop through complete replies */
+        char* end = (char*)memchr(client->in + start, '\n', client->in_len - start);
+        if (end == NULL) {
+            break;
+        }
+        if (end - (client->in + start) >= 6 && memcmp(client->in + start, "error:", 6) == 0) {
+            ++run->errors;
+        }
+        run->latencies[run->replies++] = time - client->sent_at[client->answered++ % run->depth];
+        start = (size_t)(end - client->in) + 1;
+    }
+    memmove(client->in, client->in + start, client->in_len - start);
+    client->in_len -= start;
+    return send_requests(run, client);
+}
+
+/**
+ * \brief           A function used to compare latencies for qsort
+ * \param[in]       a: The first latency
+ * \param[in]       b: The second latency
+ * \return          A negative number, zero or a positive number as a is less, equal or greater than b
+ */
+static int
+compare_doubles(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * \brief           A function used to get a percentile of sorted latencies
+ * \param[in]       sorted: Latencies sorted in ascending order
+ * \param[in]       count: A number of latencies
+ * \param[in]       p: A fraction between 0 and 1
+ * \return          The latency below which the given fraction of requests has finished
+ */
+static double
+percentile(const double* sorted, uint64_t count, double p) {
+    uint64_t index = (uint64_t)(p * (double)count);
+    return sorted[index < count ? index : count - 1];
+}
+
+/**
+ * \brief           A function used to get a monotonic time
+ * \return          The time in seconds
+ */
+static double
+now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
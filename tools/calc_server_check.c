@@ -0,0 +1,193 @@
+/**
+ * \file            calc_server_check.c
+ * \brief           Regression checks of the server mode
+ */
+
+/*
+ * Copyright (c) 2024 Daniil VERES
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * Author:          Daniil VERES <daniaveres@gmail.com>
+ * Version:         v1.0.0
+ */
+
+                        /* Functions used: */
+#include <errno.h>      /* errno */
+#include <fcntl.h>      /* open */
+#include <signal.h>     /* kill */
+#include <stdint.h>     /* uint8_t */
+#include <stdio.h>      /* printf, fprintf, snprintf, perror */
+#include <string.h>     /* strlen, memcpy, memcmp */
+#include <sys/socket.h> /* socket, connect, shutdown, setsockopt */
+#include <sys/time.h>   /* timeval */
+#include <sys/un.h>     /* sockaddr_un */
+#include <sys/wait.h>   /* waitpid */
+#include <time.h>       /* nanosleep */
+#include <unistd.h>     /* fork, execl, dup2, read, write, close, unlink, getpid */
+
+                                        /* Constants used: */
+#define SERVER_CHECK_BUFFER (1 << 20)   /*!< Size of the replies of a connection */
+#define SERVER_CHECK_LINES 20000        /*!< Requests sent at once, their replies do not fit in the socket buffers */
+#define SERVER_CHECK_TIMEOUT_S 5        /*!< Longest wait for a reply before the check fails */
+#define SERVER_CHECK_PAUSE_MS 100       /*!< Time the server gets to fill the socket before the replies are read */
+#define SERVER_CHECK_START_TRIES 100    /*!< Attempts to connect while the server starts, 10 ms apart */
+
+static unsigned failures;               /*!< A number of failed checks */
+static char requests[SERVER_CHECK_BUFFER];  /*!< Requests of the pipelined checks */
+static char expected[SERVER_CHECK_BUFFER];  /*!< Replies of the pipelined checks */
+
+static int connect_server(const char* path);                                           /* A function used to connect to the server */
+static void check_exchange(const char* path, const char* request, size_t len, const char* replies);  /* A function used to check the replies to a request */
+
+/**
+ * \brief           Main function of the server regression checks
+ * \param[in]       argc: A number of arguments
+ * \param[in]       argv: Arguments: <calculator>
+ * \return          0 if every check has passed, 1 otherwise
+ * \note            The calculator is started with `--server` on a socket in /tmp and stopped with SIGTERM at the end
+ */
+int
+main(int argc, char** argv) {
+    char path[sizeof(((struct sockaddr_un*)0)->sun_path)];
+    pid_t server;
+    int fd;
+
+    if (argc != 2) {
+        fprintf(stderr, "usage: %s <calculator>\n", argv[0]);
+        return 1;
+    }
+    snprintf(path, sizeof(path), "/tmp/calc_server_check.%ld.sock", (long)getpid());
+    server = fork();
+    if (server < 0) {
+        perror("fork");
+        return 1;
+    } else if (server == 0) {                   /* The statistics printed at the end are not checked */
+        int null = open("/dev/null", O_WRONLY);
+        dup2(null, STDOUT_FILENO);
+        dup2(null, STDERR_FILENO);
+        execl(argv[1], argv[1], "--server", path, (char*)NULL);
+        _exit(127);
+    }
+    fd = connect_server(path);
+    if (fd < 0) {
+        fprintf(stderr, "FAILED: %s: the server has not started\n", path);
+        kill(server, SIGTERM);
+        waitpid(server, NULL, 0);
+        return 1;
+    }
+    close(fd);
+
+    /* A NUL byte from the socket is answered as invalid input and the following requests are still answered */
+    check_exchange(path, "\0\n1+1\n", sizeof("\0\n1+1\n") - 1, "error: invalid input\n2\n");
+    check_exchange(path, "1+\0" "1\n2*3\n", sizeof("1+\0" "1\n2*3\n") - 1, "error: invalid input\n6\n");
+
+    /* A client which half-closes gets every reply, also of a last line without the new line */
+    check_exchange(path, "1+1\n2*3", sizeof("1+1\n2*3") - 1, "2\n6\n");
+    check_exchange(path, "2*3", sizeof("2*3") - 1, "6\n");
+    for (size_t i = 0; i < SERVER_CHECK_LINES; ++i) {  /* The server has to wait for the client to read the replies */
+        memcpy(requests + i * 5, "2^60\n", 5);
+        memcpy(expected + i * 20, "1152921504606846976\n", 21);
+    }
+    check_exchange(path, requests, SERVER_CHECK_LINES * 5, expected);
+
+    kill(server, SIGTERM);
+    waitpid(server, NULL, 0);
+    unlink(path);
+    printf("%s: %u failed\n", failures == 0 ? "OK" : "FAILED", failures);
+    return failures == 0 ? 0 : 1;
+}
+
+/**
+ * \brief           A function used to connect to the server
+ * \param[in]       path: A path of the server socket
+ * \return          A connected socket, -1 if the server has not started in time
+ * \note            Replies not received within \ref SERVER_CHECK_TIMEOUT_S make the reads fail instead of waiting forever
+ */
+static int
+connect_server(const char* path) {
+    struct sockaddr_un address = {0};
+    struct timeval timeout = {SERVER_CHECK_TIMEOUT_S, 0};
+    struct timespec pause = {0, 10 * 1000 * 1000};
+    address.sun_family = AF_UNIX;
+    memcpy(address.sun_path, path, strlen(path) + 1);
+    for (int tries = 0; tries < SERVER_CHECK_START_TRIES; ++tries) {   /* Loop until the server listens */
+        int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0) {
+            return -1;
+        }
+        if (connect(fd, (struct sockaddr*)&address, sizeof(address)) == 0) {
+            setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+            return fd;
+        }
+        close(fd);
+        nanosleep(&pause, NULL);
+    }
+    return -1;
+}
+
+/**
+ * \brief           A function used to check the replies to a request
+ * \param[in]       path: A path of the server socket
+ * \param[in]       request: Bytes sent on a new connection, which is half-closed afterwards
+ * \param[in]       len: Length of the request
+ * \param[in]       replies: Everything the server is expected to send before it closes the connection
+ */
+static void
+check_exchange(const char* path, const char* request, size_t len, const char* replies) {
+    static char buffer[SERVER_CHECK_BUFFER];
+    size_t received = 0;
+    size_t sent = 0;
+    uint8_t closed = 0;
+    struct timespec pause = {0, SERVER_CHECK_PAUSE_MS * 1000 * 1000};
+    int fd = connect_server(path);
+
+    if (fd < 0) {
+        fprintf(stderr, "FAILED: %s: connects\n", replies);
+        ++failures;
+        return;
+    }
+    while (sent < len) {                        /* The socket is blocking, the whole request is written */
+        ssize_t written = write(fd, request + sent, len - sent);
+        if (written < 0 && errno != EINTR) {
+            break;
+        }
+        sent += written > 0 ? (size_t)written : 0;
+    }
+    shutdown(fd, SHUT_WR);
+    nanosleep(&pause, NULL);                    /* Let the server answer everything before the replies are read */
+    while (received < sizeof(buffer)) {         /* Loop until the server closes the connection */
+        ssize_t got = read(fd, buffer + received, sizeof(buffer) - received);
+        if (got < 0 && errno == EINTR) {
+            continue;
+        } else if (got <= 0) {
+            closed = got == 0;
+            break;
+        }
+        received += (size_t)got;
+    }
+    close(fd);
+    if (!closed || received != strlen(replies) || memcmp(buffer, replies, received) != 0) {
+        fprintf(stderr, "FAILED: expected %zu bytes \"%.40s\", got %zu bytes \"%.*s\"%s\n", strlen(replies), replies, received, (int)(received < 40 ? received : 40), buffer,
+                closed ? "" : " without a close");
+        ++failures;
+    }
+}
@@ -0,0 +1,172 @@
+/**
+ * \file            calc_shm_bench.c
+ * \brief           Round trip latency and throughput benchmark of the shared memory transport
+ */
+
+/*
+ * Copyright (c) 2024 Daniil VERES
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * Author:          Daniil VERES <daniaveres@gmail.com>
+ * Version:         v1.0.0
+ */
+
+                    /* Functions used: */
+#include <stdint.h> /* uint64_t */
+#include <stdio.h>  /* printf, fprintf */
+#include <stdlib.h> /* strtoull, malloc, free, qsort */
+#include <string.h> /* strlen */
+#include <time.h>   /* clock_gettime */
+#include <unistd.h> /* getopt */
+#include "calc_shm.h"
+
+                                        /* Constants used: */
+#define SHM_BENCH_DEFAULT_REQUESTS 200000   /*!< Default number of requests */
+#define SHM_BENCH_DEFAULT_EXPRESSION "2+3*4-5/2"    /*!< Default expression */
+
+static double now(void);                                                /* A function used to get a monotonic time in seconds */
+static int compare_doubles(const void* a, const void* b);              /* A function used to sort latencies */
+static double percentile(const double* sorted, uint64_t count, double p);   /* A function used to get a percentile of sorted latencies */
+
+/**
+ * \brief           Main function
+ * \param[in]       argc: A number of arguments
+ * \param[in]       argv: Arguments: -m <name> [-n requests] [-p depth] [-e expression]
+ * \return          0 if all requests have been answered without errors, 1 otherwise
+ * \note            The first pass sends one request at a time and reports the round trip latency,
+ *                  the second pass keeps `depth` requests in the ring and reports the throughput
+ */
+int
+main(int argc, char** argv) {
+    const char* name = NULL;                    /* A name of the shared memory object */
+    const char* expression = SHM_BENCH_DEFAULT_EXPRESSION;
+    uint64_t requests = SHM_BENCH_DEFAULT_REQUESTS, errors = 0, syscalls;
+    size_t depth = CALC_SHM_SLOTS / 2, len;
+    double* latencies;
+    double start, elapsed;
+    calc_shm_t* shm;
+    calc_error_t error;
+    int option;
+
+    while ((option = getopt(argc, argv, "m:n:p:e:")) != -1) {   /* Parse the options */
+        switch (option) {
+            case 'm':
+                name = optarg;
+                break;
+            case 'n':
+                requests = strtoull(optarg, NULL, 10);
+                break;
+            case 'p':
+                depth = strtoul(optarg, NULL, 10);
+                break;
+            case 'e':
+                expression = optarg;
+                break;
+            default:
+                name = NULL;
+                optind = argc;
+                break;
+        }
+    }
+    if (name == NULL || requests == 0 || depth == 0 || depth > CALC_SHM_SLOTS) {
+        fprintf(stderr, "usage: %s -m <name> [-n requests] [-p depth (1..%d)] [-e expression]\n", argv[0], CALC_SHM_SLOTS);
+        return 1;
+    }
+    shm = calc_shm_open(name);
+    latencies = (double*)malloc(requests * sizeof(double));
+    if (shm == NULL || latencies == NULL) {
+        fprintf(stderr, "%s: no ring, is `calculator --shm %s` running?\n", argv[0], name);
+        return 1;
+    }
+    len = strlen(expression);
+
+    syscalls = calc_shm_syscalls(shm);
+    for (uint64_t i = 0; i < requests; ++i) {   /* Round trips, one request at a time */
+        double sent = now();
+        calc_shm_eval(shm, expression, len, &error);
+        latencies[i] = now() - sent;
+        errors += error.code != CALC_OK;
+    }
+    syscalls = calc_shm_syscalls(shm) - syscalls;
+    qsort(latencies, requests, sizeof(double), compare_doubles);
+    printf("expression:  %s\n", expression);
+    printf("round trip:  p50 %.2f us, p90 %.2f us, p99 %.2f us, p99.9 %.2f us, max %.2f us, %.3f futex calls per request\n",
+           percentile(latencies, requests, 0.50) * 1e6, percentile(latencies, requests, 0.90) * 1e6,
+           percentile(latencies, requests, 0.99) * 1e6, percentile(latencies, requests, 0.999) * 1e6,
+           latencies[requests - 1] * 1e6, (double)syscalls / (double)requests);
+
+    syscalls = calc_shm_syscalls(shm);
+    start = now();
+    for (uint64_t sent = 0, received = 0; received < requests;) {  /* Pipelined requests */
+        while (sent < requests && calc_shm_in_flight(shm) < depth && calc_shm_submit(shm, expression, len)) {
+            ++sent;
+        }
+        calc_shm_collect(shm, &error);
+        errors += error.code != CALC_OK;
+        ++received;
+    }
+    elapsed = now() - start;
+    syscalls = calc_shm_syscalls(shm) - syscalls;
+    printf("pipelined:   %.0f requests/s with %zu in flight, %.3f futex calls per request\n",
+           (double)requests / elapsed, depth, (double)syscalls / (double)requests);
+    printf("errors:      %llu\n", (unsigned long long)errors);
+
+    calc_shm_close(shm);
+    free(latencies);
+    return errors == 0 ? 0 : 1;
+}
+
+/**
+ * \brief           A function used to compare latencies for qsort
+ * \param[in]       a: The first latency
+ * \param[in]       b: The second latency
+ * \return          A negative number, zero or a positive number as a is less, equal or greater than b
+ */
+static int
+compare_doubles(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * \brief           A function used to get a percentile of sorted latencies
+ * \param[in]       sorted: Latencies sorted in ascending order
+ * \param[in]       count: A number of latencies
+ * \param[in]       p: A fraction between 0 and 1
+ * \return          The latency below which the given fraction of requests has finished
+ */
+static double
+percentile(const double* sorted, uint64_t count, double p) {
+    uint64_t index = (uint64_t)(p * (double)count);
+    return sorted[index < count ? index : count - 1];
+}
+
+/**
+ * \brief           A function used to get a monotonic time
+ * \return          The time in seconds
+ */
+static double
+now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
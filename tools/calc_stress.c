@@ -0,0 +1,213 @@
+/**
+ * \file            calc_stress.c
+ * \brief           Multithreaded stress test and scaling measurement of the calculator library
+ */
+
+/*
+ * Copyright (c) 2024 Daniil VERES
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE
+ * AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * Author:          Daniil VERES <daniaveres@gmail.com>
+ * Version:         v1.0.0
+ */
+
+                    /* Functions used: */
+#include <pthread.h>/* pthread_create, pthread_join */
+#include <stdint.h> /* uint8_t, uint64_t */
+#include <stdio.h>  /* printf, fprintf */
+#include <stdlib.h> /* strtoul, malloc, free */
+#include <string.h> /* strlen, memcmp */
+#include <time.h>   /* clock_gettime */
+#include "calc.h"
+
+                                        /* Constants used: */
+#define STRESS_DEFAULT_THREADS 4        /*!< Default maximum number of threads */
+#define STRESS_DEFAULT_ITERATIONS 20000 /*!< Default number of passes over the corpus per thread */
+#define STRESS_COMPILE_EVERY 16         /*!< Every n-th pass a thread compiles the corpus itself instead of using shared handles */
+
+/**
+ * \brief           Expressions evaluated by every thread, both through shared handles and through own compilations
+ */
+static const char* const corpus[] = {
+    "2+3*4-5/2",
+    "sqrt(x*x+y*y)",
+    "sin(x)^2+cos(x)^2",
+    "log(2, 1024)*ln(exp(y))",
+    "min(x, y, 3)-max(1, x, y)",
+    "fact(6)/(x+1)%7",
+    "atan(x/y)+arctg(y:x)-acot(x)",
+    "sinh(x)-ch(y)+th(0.5)+arsinh(x)",
+    "abs(-x)*sign(y-x)+round(x*y)-floor(x)+ceil(y)-trunc(x)",
+    "deg(rad(x))+lg(100)+sqrt(16)",
+};
+
+#define CORPUS_SIZE (sizeof(corpus) / sizeof(corpus[0]))  /*!< A number of expressions in the corpus */
+
+/**
+ * \brief           State of a single worker thread
+ */
+typedef struct {
+    calc_expr_t* const* shared;     /*!< Handles compiled once and shared by all threads */
+    const double* expected;         /*!< Results of the single-threaded reference run */
+    const double* vars;             /*!< Values of the variables */
+    size_t iterations;              /*!< A number of passes over the corpus */
+    uint64_t evaluations;           /*!< A number of evaluations done */
+    uint64_t mismatches;            /*!< A number of results different from the reference */
+} worker_t;
+
+static void* worker(void* arg);                                     /* A function run by every thread */
+static double now(void);                                            /* A function used to get a monotonic time in seconds */
+static double eval_with_vars(calc_context_t* context, const calc_expr_t* expr, const double* vars); /* A function used to evaluate with variables bound by name */
+
+/**
+ * \brief           Main function
+ * \param[in]       argc: A number of arguments
+ * \param[in]       argv: Arguments: [max threads] [iterations]
+ * \return          0 if all results matched the reference, 1 otherwise
+ * \note            The thread count is doubled from 1 to the maximum, the throughput of every step is reported relative to one thread.
+ *                  Build with `make stress-tsan` to run the same workload under ThreadSanitizer.
+ */
+int
+main(int argc, char** argv) {
+    size_t max_threads = argc > 1 ? strtoul(argv[1], NULL, 10) : STRESS_DEFAULT_THREADS;
+    size_t iterations = argc > 2 ? strtoul(argv[2], NULL, 10) : STRESS_DEFAULT_ITERATIONS;
+    calc_expr_t* shared[CORPUS_SIZE];           /* Handles shared by all threads */
+    double expected[CORPUS_SIZE];               /* Results of the reference run */
+    const double vars[] = {0.75, 1.25};         /* Values of x and y */
+    double base_rate = 0;                       /* Evaluations per second of one thread */
+    uint64_t mismatches = 0;
+    calc_context_t* context = calc_context_create();
+
+    if (max_threads == 0 || iterations == 0 || context == NULL) {
+        fprintf(stderr, "usage: %s [max threads] [iterations]\n", argv[0]);
+        return 1;
+    }
+    for (size_t i = 0; i < CORPUS_SIZE; ++i) {  /* Compile the corpus and calculate the reference results */
+        calc_error_t error;
+        shared[i] = calc_compile(corpus[i], strlen(corpus[i]), &error);
+        if (shared[i] == NULL) {
+            fprintf(stderr, "failed to compile '%s': %s\n", corpus[i], calc_error_string(error.code));
+            return 1;
+        }
+        expected[i] = eval_with_vars(context, shared[i], vars);
+    }
+    calc_context_free(context);
+
+    printf("%8s %16s %10s %10s\n", "threads", "evaluations/s", "speedup", "mismatches");
+    for (size_t threads = 1; threads <= max_threads; threads *= 2) {   /* Loop through thread counts */
+        pthread_t* ids = (pthread_t*)malloc(threads * sizeof(pthread_t));
+        worker_t* workers = (worker_t*)calloc(threads, sizeof(worker_t));
+        uint64_t evaluations = 0, step_mismatches = 0;
+        double start, elapsed, rate;
+        if (ids == NULL || workers == NULL) {
+            fprintf(stderr, "failed to allocate memory\n");
+            return 1;
+        }
+        start = now();
+        for (size_t t = 0; t < threads; ++t) {
+            workers[t].shared = shared;
+            workers[t].expected = expected;
+            workers[t].vars = vars;
+            workers[t].iterations = iterations;
+            pthread_create(&ids[t], NULL, worker, &workers[t]);
+        }
+        for (size_t t = 0; t < threads; ++t) {
+            pthread_join(ids[t], NULL);
+            evaluations += workers[t].evaluations;
+            step_mismatches += workers[t].mismatches;
+        }
+        elapsed = now() - start;
+        rate = (double)evaluations / elapsed;
+        if (threads == 1) {
+            base_rate = rate;
+        }
+        printf("%8zu %16.0f %9.2fx %10llu\n", threads, rate, rate / base_rate, (unsigned long long)step_mismatches);
+        mismatches += step_mismatches;
+        free(ids);
+        free(workers);
+    }
+    for (size_t i = 0; i < CORPUS_SIZE; ++i) {
+        calc_free(shared[i]);
+    }
+    return mismatches == 0 ? 0 : 1;
+}
+
+/**
+ * \brief           A function run by every thread
+ * \param[in]       arg: The state of the worker, see \ref worker_t
+ * \return          NULL
+ * \note            Evaluations of shared handles run concurrently with compilations of private ones, so both paths are checked for races
+ */
+static void*
+worker(void* arg) {
+    worker_t* state = (worker_t*)arg;
+    calc_context_t* context = calc_context_create();    /* A context owned by this thread */
+    if (context == NULL) {
+        state->mismatches = 1;
+        return NULL;
+    }
+    for (size_t n = 0; n < state->iterations; ++n) {    /* Loop through the passes */
+        for (size_t i = 0; i < CORPUS_SIZE; ++i) {      /* Loop through the corpus */
+            double result;
+            if (n % STRESS_COMPILE_EVERY == 0) {        /* Check if this pass compiles privately */
+                calc_expr_t* expr = calc_compile(corpus[i], strlen(corpus[i]), NULL);
+                result = eval_with_vars(context, expr, state->vars);
+                calc_free(expr);
+            } else {
+                result = eval_with_vars(context, state->shared[i], state->vars);
+            }
+            if (memcmp(&result, &state->expected[i], sizeof(double)) != 0) {  /* Results must be bit-identical */
+                ++state->mismatches;
+            }
+            ++state->evaluations;
+        }
+    }
+    calc_context_free(context);
+    return NULL;
+}
+
+/**
+ * \brief           A function used to evaluate an expression binding variables by name
+ * \param[in]       context: An evaluation context
+ * \param[in]       expr: A compiled expression
+ * \param[in]       vars: Values of x and y
+ * \return          The result of the calculation
+ */
+static double
+eval_with_vars(calc_context_t* context, const calc_expr_t* expr, const double* vars) {
+    double slots[2];                                    /* Values in the order of the variable slots */
+    for (size_t i = 0; i < calc_var_count(expr) && i < 2; ++i) {
+        slots[i] = calc_var_name(expr, i)[0] == 'x' ? vars[0] : vars[1];
+    }
+    return calc_eval_ctx(context, expr, slots, NULL);
+}
+
+/**
+ * \brief           A function used to get a monotonic time
+ * \return          The time in seconds
+ */
+static double
+now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}